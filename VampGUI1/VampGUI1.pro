@@ -9,7 +9,7 @@
 #QMAKE_RUN_CXX = $(CXX) $(CXXFLAGS) $(INCPATH) -c --target=i686-pc-mingw32 $src -o $obj
 #QMAKE_RUN_CC = $(CC) $(CCFLAGS) $(INCPATH) -c --target=i686-pc-mingw32 $src -o $obj
 
-QT       += webkitwidgets core gui printsupport
+QT       += webkitwidgets core gui printsupport concurrent
 #QT     += network
 greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
 
@@ -45,40 +45,40 @@ QMAKE_CXXFLAGS += -Wno-missing-braces
 SOURCES += main.cpp\
     mainwindow.cpp \
     vampconfigdialog.cpp \
-    json.cpp \
-    configfile.cpp \
     projectitem.cpp \
     projectmodel.cpp \
     fileinstinfo.cpp \
+    coverageindex.cpp \
     vamp.cpp \
     vamp_rewrite.cpp \
-    mcdcExprTree.cpp \
-    vamp_process.cpp \
+    processjob.cpp \
     vamp_ostream.cpp \
     vamp_preprocessor.cpp \
+    preproccache.cpp \
     path.cpp
 
 HEADERS  += mainwindow.h \
     vampconfigdialog.h \
-    json.h \
-    configfile.h \
     projectitem.h \
     projectmodel.h \
     fileinstinfo.h \
+    coverageindex.h \
     vamp.h \
     vamp_rewrite.h \
     vamp_ostream.h \
-    mcdcExprTree.h \
+    processjob.h \
     stdcapture.h \
-    vamp_process.h \
     vamp_preprocessor.h \
+    preproccache.h \
     splash.h \
-    version.h \
     path.h
 
 FORMS    += mainwindow.ui \
     vampconfigdialog.ui
 
+# Report engine, shared with vamp-report
+include(vampcore.pri)
+
 
 #INCLUDEPATH += c:/cygwin/usr/local/include
 #INCLUDEPATH += c:/cygwin/usr/local/include/clang/include
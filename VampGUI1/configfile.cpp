@@ -56,6 +56,15 @@ void ConfigFile::ParseConfig(Json &n, VAMP_CONFIG &vo)
         if (nodeName == "mcdc_stack_size")
             vo.mcdcStackSize = i->as_int();
         else
+        if (nodeName == "register_probes")
+            vo.registerProbes = i->as_bool();
+        else
+        if (nodeName == "probe_shards")
+            vo.probeShards = i->as_int();
+        else
+        if (nodeName == "skip_covered")
+            vo.skipCovered = i->as_bool();
+        else
         if (nodeName == "lang_standard")
         {
             string langStd = i->as_string();
@@ -123,6 +132,9 @@ bool ConfigFile::ParseConfigFile(string fileName, VAMP_CONFIG &vo)
     vo.saveSuffix = "";
     vo.mcdcStackSize = MCDC_STACK_SIZE;
     vo.langStandard = clang::LangStandard::lang_c89;
+    vo.registerProbes = false;
+    vo.probeShards = 0;
+    vo.skipCovered = false;
 
 #ifdef USE_QT
     QFile jsonFile(QString::fromStdString(fileName));
@@ -154,6 +166,9 @@ bool ConfigFile::ParseConfigFile(string fileName, VAMP_CONFIG &vo)
   CDBG << "saveDirectory: " << vo.saveDirectory << endl;
   CDBG << "saveSuffix: " << vo.saveSuffix << endl;
   CDBG << "mcdcStackSize: " << vo.mcdcStackSize << endl;
+  CDBG << "registerProbes: " << (vo.registerProbes ? "true" : "false") << endl;
+  CDBG << "probeShards: " << vo.probeShards << endl;
+  CDBG << "skipCovered: " << (vo.skipCovered ? "true" : "false") << endl;
   CDBG << "includePaths:" << endl;
   vector<string>::iterator it;
   for (it = vo.includePaths.begin(); it != vo.includePaths.end(); it++)
@@ -187,7 +202,7 @@ bool ConfigFile::ParseConfigFile(string fileName, VAMP_CONFIG &vo)
         QMessageBox::warning(0, QString("Error"), QString("Bad config file: %1\n%2").arg(jsonSource).arg(QString::fromStdString(jsonErr.str())));
 #else
         *vampErr << "Bad config file: " << jsonSource << endl;
-        *vampErr << jsonErr;
+        *vampErr << jsonErr.str();
 #endif
         return false;
     }
@@ -203,6 +218,9 @@ bool ConfigFile::ParseConfigFile(string fileName, VAMP_CONFIG &vo)
     cerr << "saveDirectory: " << vo.saveDirectory << endl;
     cerr << "saveSuffix: " << vo.saveSuffix << endl;
     cerr << "mcdcStackSize: " << vo.mcdcStackSize << endl;
+    cerr << "registerProbes: " << (vo.registerProbes ? "true" : "false") << endl;
+    cerr << "probeShards: " << vo.probeShards << endl;
+    cerr << "skipCovered: " << (vo.skipCovered ? "true" : "false") << endl;
 #endif
 
     return true;
@@ -239,6 +257,33 @@ void ConfigFile::ParseReportConfig(Json &n, VAMP_REPORT_CONFIG &vpo)
         else
         if (nodeName == "html_suffix")
            vpo.htmlSuffix = i->as_string();
+        else
+        if (nodeName == "compact_html")
+           vpo.compactHtml = i->as_bool();
+        else
+        if (nodeName == "generate_html")
+           vpo.generateHtml = i->as_bool();
+        else
+        if (nodeName == "export_lcov")
+           vpo.exportLcov = i->as_bool();
+        else
+        if (nodeName == "export_cobertura")
+           vpo.exportCobertura = i->as_bool();
+        else
+        if (nodeName == "export_json")
+           vpo.exportJson = i->as_bool();
+        else
+        if (nodeName == "merge_headers")
+           vpo.mergeHeaders = i->as_bool();
+        else
+        if (nodeName == "merge_variants")
+           vpo.mergeVariants = i->as_bool();
+        else
+        if (nodeName == "mcdc_solver_node_limit")
+           vpo.mcdcSolverNodeLimit = i->as_int();
+        else
+        if (nodeName == "mcdc_solver_time_limit")
+           vpo.mcdcSolverTimeLimit = i->as_int();
 
         ++i;
     }
@@ -255,6 +300,15 @@ bool ConfigFile::ParseReportConfigFile(string fileName, VAMP_REPORT_CONFIG &vpo)
     vpo.reportSeparator = ",";
     vpo.htmlDirectory = ".";
     vpo.htmlSuffix = "";
+    vpo.compactHtml = false;
+    vpo.generateHtml = true;
+    vpo.exportLcov = false;
+    vpo.exportCobertura = false;
+    vpo.exportJson = false;
+    vpo.mergeHeaders = false;
+    vpo.mergeVariants = false;
+    vpo.mcdcSolverNodeLimit = MCDC_SOLVER_NODE_LIMIT;
+    vpo.mcdcSolverTimeLimit = MCDC_SOLVER_TIME_LIMIT;
 
 #ifdef USE_QT
     QFile jsonFile(QString::fromStdString(fileName));
@@ -303,7 +357,7 @@ bool ConfigFile::ParseReportConfigFile(string fileName, VAMP_REPORT_CONFIG &vpo)
         QMessageBox::warning(0, QString("Error"), QString("Bad config file: %1\n%2").arg(jsonSource).arg(QString::fromStdString(jsonErr.str())));
 #else
         *vampErr << "Bad config file: " << jsonSource << endl;
-        *vampErr << jsonErr;
+        *vampErr << jsonErr.str();
 #endif
 
         return false;
@@ -319,6 +373,15 @@ bool ConfigFile::ParseReportConfigFile(string fileName, VAMP_REPORT_CONFIG &vpo)
   cerr << "reportSeparator: \"" << vpo.reportSeparator << "\"" << endl;
   cerr << "htmlDirectory: " << vpo.htmlDirectory << endl;
   cerr << "htmlSuffix: " << vpo.htmlSuffix << endl;
+  cerr << "compactHtml: " << vpo.compactHtml << endl;
+  cerr << "generateHtml: " << vpo.generateHtml << endl;
+  cerr << "exportLcov: " << vpo.exportLcov << endl;
+  cerr << "exportCobertura: " << vpo.exportCobertura << endl;
+  cerr << "exportJson: " << vpo.exportJson << endl;
+  cerr << "mergeHeaders: " << vpo.mergeHeaders << endl;
+  cerr << "mergeVariants: " << vpo.mergeVariants << endl;
+  cerr << "mcdcSolverNodeLimit: " << vpo.mcdcSolverNodeLimit << endl;
+  cerr << "mcdcSolverTimeLimit: " << vpo.mcdcSolverTimeLimit << endl;
 //  cerr << "includePaths:" << endl;
 //  vector<QString>::iterator it;
 //  for (it = vpo.includePaths.begin(); it != vpo.includePaths.end(); it++)
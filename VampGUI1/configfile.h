@@ -19,9 +19,11 @@
 
 #include <fstream>
 #include "json.h"
+#include "mcdcSolver.h"
 #include "clang/Frontend/LangStandard.h"
 
 #define MCDC_STACK_SIZE 4
+#define PROBE_SHARD_ALIGN 64    // Cache line size separating probe shards
 
 typedef struct {
     // From vamp.cfg
@@ -34,8 +36,26 @@ typedef struct {
     string saveSuffix;
     int mcdcStackSize;
     clang::LangStandard::Kind langStandard;
+    bool registerProbes;
+    int probeShards;
+    bool skipCovered;
 } VAMP_CONFIG;
 
+// Probes already covered by earlier runs, left out when re-instrumenting
+// with skip_covered. Each is indexed by the number passed to its probe.
+typedef struct {
+    vector<bool> stmt;      // Statements
+    vector<bool> branch;    // Branches with both outcomes taken
+    vector<bool> cond;      // Conditions with both outcomes taken
+    vector<bool> mcdc;      // MC/DC expressions with all operands shown
+    int options;            // Coverage options of history
+    int stmtSize;           // Sizes of history tables the coverage came
+    int branchSize;         // from, which must match the new build
+    int condSize;
+    int mcdcSize;
+    string history;         // Coverage carried forward, as hex history
+} VAMP_COVERED_PROBES;
+
 typedef struct {
     // From vamp_process.cfg
     bool combineHistory;
@@ -45,6 +65,15 @@ typedef struct {
     string reportSeparator;
     string htmlDirectory;
     string htmlSuffix;
+    bool compactHtml;
+    bool generateHtml;
+    bool exportLcov;
+    bool exportCobertura;
+    bool exportJson;
+    bool mergeHeaders;
+    bool mergeVariants;
+    int mcdcSolverNodeLimit;
+    int mcdcSolverTimeLimit;
 } VAMP_REPORT_CONFIG;
 
 typedef struct {
@@ -0,0 +1,239 @@
+/*  Copyright 2016, Robert Ankeney
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/
+*/
+
+
+#include "coverageindex.h"
+#include "json.h"
+#include <QFile>
+#include <QTextStream>
+#include <sstream>
+#include <stdlib.h>
+
+#define COVERAGE_INDEX_VERSION 2
+
+// Quote str for the index, escaping as JSON
+static QString quote(const QString &str)
+{
+    return QString::fromStdString(jsonQuote(str.toStdString()));
+}
+
+CoverageIndex::CoverageIndex()
+{
+    changed = false;
+}
+
+// Discard all entries
+void CoverageIndex::clear(void)
+{
+    indexName = "";
+    entries.clear();
+    changed = false;
+}
+
+// Load index from fileName. A missing, damaged or out of date index is
+// treated as empty, so every .vrpt is read once and the index rebuilt.
+void CoverageIndex::load(QString fileName)
+{
+    clear();
+    indexName = fileName;
+
+    if (!QFile::exists(fileName))
+        return;
+
+    ostringstream jsonErr;
+    Json json(&jsonErr, true);
+    try
+    {
+        json.ParseFile(fileName.toStdString());
+
+        vector<JsonNode>::iterator i = json.jsonNodes.begin();
+        int version = 0;
+
+        while (i != json.jsonNodes.end())
+        {
+            string nodeName = i->name();
+
+            if (nodeName == "version")
+            {
+                version = i->as_int();
+            }
+            else
+            if ((nodeName == "files") && (version == COVERAGE_INDEX_VERSION))
+            {
+                // Each file is:
+                // "<vrpt>", "<source>", <mod time>, "<file>", <overflow>,
+                //   <8 totals>,
+                //   [ "<function>", <6 totals>, ... ]
+                vector<JsonNode> &files = json.GetArray(*i);
+                vector<JsonNode>::iterator j = files.begin();
+
+                while (j != files.end())
+                {
+                    vector<JsonNode> &file = json.GetArray(*j);
+                    if (file.size() != 14)
+                        throw(1);
+
+                    INDEX_ENTRY entry;
+                    QString vrptName = QString::fromStdString(file[0].as_string());
+                    entry.sourceName = QString::fromStdString(file[1].as_string());
+                    entry.vrptModTime = atoll(file[2].as_string().c_str());
+                    fileInstInfo &info = entry.fileInfo;
+                    info.fileName = QString::fromStdString(file[3].as_string());
+                    info.mcdcStackOverflow = file[4].as_bool();
+                    info.totalStatementCount = file[5].as_int();
+                    info.totalStatementsCovered = file[6].as_int();
+                    info.totalBranchCount = file[7].as_int();
+                    info.totalBranchesCovered = file[8].as_int();
+                    info.totalMcdcCount = file[9].as_int();
+                    info.totalMcdcCovered = file[10].as_int();
+                    info.totalConditionCount = file[11].as_int();
+                    info.totalConditionsCovered = file[12].as_int();
+
+                    vector<JsonNode> &funcs = json.GetArray(file[13]);
+                    if (funcs.size() % 7)
+                        throw(1);
+
+                    for (size_t k = 0; k < funcs.size(); k += 7)
+                    {
+                        FUNCTION_INFO functionInfo;
+                        functionInfo.functionName = QString::fromStdString(funcs[k].as_string());
+                        functionInfo.statementCount = funcs[k + 1].as_int();
+                        functionInfo.statementsCovered = funcs[k + 2].as_int();
+                        functionInfo.branchCount = funcs[k + 3].as_int();
+                        functionInfo.branchesCovered = funcs[k + 4].as_int();
+                        functionInfo.decisionCount = funcs[k + 5].as_int();
+                        functionInfo.decisionsCovered = funcs[k + 6].as_int();
+                        info.functionInfo.push_back(functionInfo);
+                    }
+
+                    entries.insert(vrptName, entry);
+                    ++j;
+                }
+            }
+
+            ++i;
+        }
+    }
+    catch(int i)
+    {
+        // Rebuild index from .vrpt files
+        entries.clear();
+    }
+}
+
+// Write index back out if any entry changed since it was loaded.
+// Entries whose source or .vrpt file no longer exists are dropped.
+bool CoverageIndex::save(void)
+{
+    if (indexName.isEmpty())
+        return true;
+
+    QHash<QString, INDEX_ENTRY>::iterator e = entries.begin();
+    while (e != entries.end())
+    {
+        if (!QFile::exists(e.key()) || !QFile::exists(e.value().sourceName))
+        {
+            e = entries.erase(e);
+            changed = true;
+        }
+        else
+            ++e;
+    }
+
+    if (!changed)
+        return true;
+
+    QFile indexFile(indexName);
+    if (!indexFile.open(QFile::WriteOnly | QFile::Truncate))
+        return false;
+
+    QTextStream out(&indexFile);
+    out << "{\n";
+    out << "  \"version\": " << COVERAGE_INDEX_VERSION << ",\n";
+    out << "  \"files\":\n  [\n";
+
+    QHash<QString, INDEX_ENTRY>::const_iterator i = entries.constBegin();
+    while (i != entries.constEnd())
+    {
+        const fileInstInfo &info = i.value().fileInfo;
+
+        if (i != entries.constBegin())
+            out << ",\n";
+        out << "    [" << quote(i.key()) << ", " << quote(i.value().sourceName) << ", " <<
+               i.value().vrptModTime << ", " <<
+               quote(info.fileName) << ", " <<
+               (info.mcdcStackOverflow ? "true" : "false") << ", " <<
+               info.totalStatementCount << ", " <<
+               info.totalStatementsCovered << ", " <<
+               info.totalBranchCount << ", " <<
+               info.totalBranchesCovered << ", " <<
+               info.totalMcdcCount << ", " <<
+               info.totalMcdcCovered << ", " <<
+               info.totalConditionCount << ", " <<
+               info.totalConditionsCovered << ",\n      [";
+
+        for (int j = 0; j < info.functionInfo.size(); ++j)
+        {
+            const FUNCTION_INFO &functionInfo = info.functionInfo[j];
+
+            if (j > 0)
+                out << ",\n       ";
+            out << quote(functionInfo.functionName) << ", " <<
+                   functionInfo.statementCount << ", " <<
+                   functionInfo.statementsCovered << ", " <<
+                   functionInfo.branchCount << ", " <<
+                   functionInfo.branchesCovered << ", " <<
+                   functionInfo.decisionCount << ", " <<
+                   functionInfo.decisionsCovered;
+        }
+        out << "]]";
+        ++i;
+    }
+
+    out << "\n  ]\n}\n";
+    out.flush();
+    indexFile.close();
+
+    changed = false;
+    return true;
+}
+
+// Get totals for vrptName if the index holds them for this version of
+// the file. Leaves fileInfo.instInfo as the caller set it.
+bool CoverageIndex::find(QString vrptName, qint64 vrptModTime, fileInstInfo &fileInfo)
+{
+    QHash<QString, INDEX_ENTRY>::const_iterator i = entries.constFind(vrptName);
+
+    if ((i == entries.constEnd()) || (i.value().vrptModTime != vrptModTime))
+        return false;
+
+    INST_INFO instInfo = fileInfo.instInfo;
+    fileInfo = i.value().fileInfo;
+    fileInfo.instInfo = instInfo;
+    return true;
+}
+
+// Record totals just read from vrptName, the report on sourceName
+void CoverageIndex::update(QString vrptName, QString sourceName, qint64 vrptModTime,
+                           fileInstInfo &fileInfo)
+{
+    INDEX_ENTRY entry;
+    entry.sourceName = sourceName;
+    entry.vrptModTime = vrptModTime;
+    entry.fileInfo = fileInfo;
+    entries.insert(vrptName, entry);
+    changed = true;
+}
@@ -0,0 +1,54 @@
+/*  Copyright 2016, Robert Ankeney
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/
+*/
+
+
+#ifndef COVERAGEINDEX_H
+#define COVERAGEINDEX_H
+
+#include "fileinstinfo.h"
+#include <QString>
+#include <QHash>
+
+// Project-wide index of per-file and per-function coverage totals,
+// keyed by .vrpt file name. Saved alongside the project so opening a
+// project reads one file rather than every .vrpt. An entry is only used
+// while its .vrpt file is unchanged; otherwise the .vrpt is read again
+// and the entry replaced.
+class CoverageIndex
+{
+public:
+    CoverageIndex();
+
+    void load(QString fileName);
+    bool save(void);
+    void clear(void);
+    bool find(QString vrptName, qint64 vrptModTime, fileInstInfo &fileInfo);
+    void update(QString vrptName, QString sourceName, qint64 vrptModTime,
+                fileInstInfo &fileInfo);
+
+private:
+    typedef struct {
+        QString sourceName;     // Project source the .vrpt reports on
+        qint64 vrptModTime;     // Modification time of .vrpt (msec)
+        fileInstInfo fileInfo;  // Totals read from .vrpt
+    } INDEX_ENTRY;
+
+    QString indexName;
+    QHash<QString, INDEX_ENTRY> entries;
+    bool changed;
+};
+
+#endif // COVERAGEINDEX_H
@@ -0,0 +1,58 @@
+/*  Copyright 2016, Robert Ankeney
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/
+*/
+
+
+#include "fnvhash.h"
+#include <fstream>
+#include <stdio.h>
+
+// FNV-1a hash of a block of data, continuing from hash
+unsigned long long fnvHash(const char *data, size_t len,
+                           unsigned long long hash)
+{
+  for (size_t i = 0; i < len; i++)
+  {
+    hash ^= (unsigned char) data[i];
+    hash *= 0x100000001b3ULL;
+  }
+
+  return hash;
+}
+
+string hashStr(unsigned long long hash)
+{
+  char hashAsc[20];
+  snprintf(hashAsc, sizeof(hashAsc), "%016llx", hash);
+  return hashAsc;
+}
+
+// Hash contents of fileName; empty string if it cannot be read
+string hashFile(const string &fileName)
+{
+  ifstream file(fileName.c_str(), ios::in | ios::binary);
+  if (!file.is_open())
+    return "";
+
+  unsigned long long hash = FNV_OFFSET_BASIS;
+  char buf[65536];
+  while (file.good())
+  {
+    file.read(buf, sizeof(buf));
+    hash = fnvHash(buf, file.gcount(), hash);
+  }
+
+  return hashStr(hash);
+}
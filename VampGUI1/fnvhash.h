@@ -0,0 +1,34 @@
+/*  Copyright 2016, Robert Ankeney
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/
+*/
+
+
+#ifndef FNVHASH_H
+#define FNVHASH_H
+
+#include <string>
+
+using namespace std;
+
+#define FNV_OFFSET_BASIS 0xcbf29ce484222325ULL   // Starting value of a hash
+
+// FNV-1a hashes used to tell whether report and preprocessor inputs have
+// changed, as 16 hex digit strings
+unsigned long long fnvHash(const char *data, size_t len,
+                           unsigned long long hash = FNV_OFFSET_BASIS);
+string hashStr(unsigned long long hash);
+string hashFile(const string &fileName);
+
+#endif // FNVHASH_H
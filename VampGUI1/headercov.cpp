@@ -0,0 +1,375 @@
+/*  Copyright 2016, Robert Ankeney
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/
+*/
+
+
+
+// Merge coverage of header code instrumented in several source files.
+// Each report writes the header regions it saw to a HEADER_COV_EXT file;
+// once reports are done, those of every source file in the project whose
+// report is still current are folded into one report per header.
+
+#include "headercov.h"
+#include "mergedreport.h"
+#include <algorithm>
+
+void HeaderCoverage::clear()
+{
+  regions.clear();
+  summaries.clear();
+  reportDir.clear();
+}
+
+// Add region, folding it into any region with the same key. The same
+// text instruments to the same decisions, so their outcomes are merged
+// by line, type and order on the line.
+void HeaderCoverage::add(const headerRegionType &region)
+{
+  headerKeyType key(region.file, make_pair(region.line, region.hash));
+  map<headerKeyType, headerRegionType>::iterator it = regions.find(key);
+
+  if (it == regions.end())
+  {
+    regions.insert(make_pair(key, region));
+    return;
+  }
+
+  headerRegionType &r = it->second;
+  r.units.insert(region.units.begin(), region.units.end());
+
+  map<int, long long>::const_iterator l;
+  for (l = region.lineHits.begin(); l != region.lineHits.end(); ++l)
+    r.lineHits[l->first] += l->second;
+
+  mergeDecisions(r.decisions, region.decisions);
+}
+
+// Write regions as:
+//   VHC <version>
+//   <region count>
+//   then for each region:
+//     <line> <hash> <unit count> <line count> <decision count>
+//     <file>
+//     <function>
+//     <unit>...
+//     <line> <hits>...
+//     <line> <type> <outcomes taken, as 1 or 0 for each; - if none>...
+void HeaderCoverage::write(ostream &out) const
+{
+  out << HEADER_COV_MAGIC << " " << HEADER_COV_VERSION << "\n";
+  out << regions.size() << "\n";
+
+  map<headerKeyType, headerRegionType>::const_iterator it;
+  for (it = regions.begin(); it != regions.end(); ++it)
+  {
+    const headerRegionType &r = it->second;
+
+    out << r.line << " " << r.hash << " " << r.units.size() << " " <<
+           r.lineHits.size() << " " << r.decisions.size() << "\n";
+    out << r.file << "\n";
+    out << r.function << "\n";
+
+    set<string>::const_iterator u;
+    for (u = r.units.begin(); u != r.units.end(); ++u)
+      out << *u << "\n";
+
+    writeLineHits(out, r.lineHits);
+    writeDecisions(out, r.decisions);
+  }
+}
+
+// Read regions written by write(), adding them to those held
+bool HeaderCoverage::read(istream &in)
+{
+  string magic;
+  int version;
+  int regionCnt;
+
+  in >> magic >> version >> regionCnt;
+  if (!in.good() || (magic != HEADER_COV_MAGIC) ||
+      (version != HEADER_COV_VERSION) || (regionCnt < 0))
+    return false;
+
+  for (int i = 0; i < regionCnt; i++)
+  {
+    headerRegionType r;
+    int unitCnt;
+    int lineCnt;
+    int decisionCnt;
+
+    in >> r.line >> r.hash >> unitCnt >> lineCnt >> decisionCnt;
+    in.get();
+    getline(in, r.file);
+    getline(in, r.function);
+    if (!in.good() || (unitCnt < 0) || (lineCnt < 0) || (decisionCnt < 0))
+      return false;
+
+    for (int u = 0; u < unitCnt; u++)
+    {
+      string unit;
+      getline(in, unit);
+      r.units.insert(unit);
+    }
+
+    readLineHits(in, lineCnt, r.lineHits);
+    readDecisions(in, decisionCnt, r.decisions);
+
+    if (in.fail())
+      return false;
+
+    add(r);
+  }
+
+  return true;
+}
+
+bool HeaderCoverage::save(string fileName) const
+{
+  ofstream out(fileName.c_str(), ios::out | ios::binary | ios::trunc);
+  if (!out.is_open())
+    return false;
+
+  write(out);
+  out.close();
+  return !out.fail();
+}
+
+bool HeaderCoverage::load(string fileName, ostream *errStr)
+{
+  ifstream in(fileName.c_str(), ios::in | ios::binary);
+  if (!in.is_open())
+  {
+    *errStr << "Cannot read header coverage file " << fileName << ENDL;
+    return false;
+  }
+
+  if (!read(in))
+  {
+    *errStr << "Bad header coverage file " << fileName << ENDL;
+    return false;
+  }
+
+  return true;
+}
+
+// Load the header coverage files among the outputs of a report.
+// Merged reports are written beside the first one loaded.
+bool HeaderCoverage::addOutputs(const vector<string> &outputs, ostream *errStr)
+{
+  bool result = true;
+  vector<string> names = findOutputs(outputs, HEADER_COV_EXT, reportDir);
+
+  for (int i = 0; i < names.size(); i++)
+  {
+    if (!load(names[i], errStr))
+      result = false;
+  }
+
+  return result;
+}
+
+// Write one report for each header, named after it
+bool HeaderCoverage::genReports(ostream *outStr, ostream *errStr)
+{
+  bool result = true;
+  set<string> reportNames;
+
+  summaries.clear();
+
+  // Regions are ordered by header, so each header's are together
+  map<headerKeyType, headerRegionType>::iterator it = regions.begin();
+  while (it != regions.end())
+  {
+    string file = it->first.first;
+    vector<headerRegionType *> fileRegions;
+
+    for (; (it != regions.end()) && (it->first.first == file); ++it)
+      fileRegions.push_back(&it->second);
+
+    // util.h -> util_h_hdr
+    string name = mergedReportName(file, HEADER_REPORT_SUFFIX, reportNames);
+
+    headerSummaryType summary;
+    summary.file = file;
+    summary.report = reportDir + DIRECTORY_SEPARATOR + name + ".html";
+
+    *outStr << "Generating " << summary.report << ENDL;
+    if (genReport(file, fileRegions, summary, errStr))
+    {
+      *outStr << file << ": " << summary.linesHit << " of " <<
+                 summary.lines << " lines, " << summary.outcomesTaken <<
+                 " of " << summary.outcomes << " outcomes covered in " <<
+                 summary.units << " files" << ENDL;
+      summaries.push_back(summary);
+    }
+    else
+      result = false;
+  }
+
+  return result;
+}
+
+// Write merged report for header file from its regions, showing each
+// header line colored by its coverage summed over all files
+bool HeaderCoverage::genReport(const string &file,
+                               vector<headerRegionType *> &fileRegions,
+                               headerSummaryType &summary, ostream *errStr)
+{
+  map<int, long long> hits;                // Hits of each line with code
+  map<int, pair<int, int> > outcomes;      // Outcomes, taken of each line
+  set<string> units;
+
+  for (int i = 0; i < fileRegions.size(); i++)
+  {
+    headerRegionType *r = fileRegions[i];
+
+    units.insert(r->units.begin(), r->units.end());
+
+    map<int, long long>::iterator l;
+    for (l = r->lineHits.begin(); l != r->lineHits.end(); ++l)
+      hits[l->first] += l->second;
+
+    for (int d = 0; d < r->decisions.size(); d++)
+    {
+      pair<int, int> &o = outcomes[r->decisions[d].line];
+      o.first += r->decisions[d].taken.size();
+      o.second += count(r->decisions[d].taken.begin(),
+                        r->decisions[d].taken.end(), true);
+    }
+  }
+
+  summary.regions = fileRegions.size();
+  summary.units = units.size();
+  summary.lines = hits.size();
+  summary.linesHit = 0;
+  summary.outcomes = 0;
+  summary.outcomesTaken = 0;
+
+  map<int, long long>::iterator h;
+  for (h = hits.begin(); h != hits.end(); ++h)
+  {
+    if (h->second)
+      ++summary.linesHit;
+  }
+
+  map<int, pair<int, int> >::iterator o;
+  for (o = outcomes.begin(); o != outcomes.end(); ++o)
+  {
+    summary.outcomes += o->second.first;
+    summary.outcomesTaken += o->second.second;
+  }
+
+  // Header text; without it only the lines with code are shown
+  vector<string> text;
+  if (!readSourceLines(file, text))
+    *errStr << "Cannot read " << file << "; showing lines with code only" <<
+               ENDL;
+
+  ofstream htmlFile(summary.report.c_str());
+  if (!htmlFile.is_open())
+  {
+    *errStr << "Cannot create " << summary.report << ENDL;
+    return false;
+  }
+
+  writeMergedHead(htmlFile, file);
+  htmlFile << "    <p>" << summary.linesHit << " of " << summary.lines <<
+              " lines and " << summary.outcomesTaken << " of " <<
+              summary.outcomes << " branch and condition outcomes covered," <<
+              " merged from:" << ENDL;
+  set<string>::iterator u;
+  for (u = units.begin(); u != units.end(); ++u)
+    htmlFile << "      <br>" << htmlEscape(*u) << ENDL;
+  htmlFile << "    </p>" << ENDL;
+
+  htmlFile << "    <table border=\"1\" cellpadding=\"4\">" << ENDL;
+  htmlFile << "      <tr><th>Function</th><th>Line</th><th>Files</th>" <<
+              "<th>Lines</th><th>Outcomes</th></tr>" << ENDL;
+  for (int i = 0; i < fileRegions.size(); i++)
+  {
+    headerRegionType *r = fileRegions[i];
+    int linesHit = 0;
+    int taken = 0;
+    int total = 0;
+
+    map<int, long long>::iterator l;
+    for (l = r->lineHits.begin(); l != r->lineHits.end(); ++l)
+    {
+      if (l->second)
+        ++linesHit;
+    }
+    for (int d = 0; d < r->decisions.size(); d++)
+    {
+      total += r->decisions[d].taken.size();
+      taken += count(r->decisions[d].taken.begin(),
+                     r->decisions[d].taken.end(), true);
+    }
+
+    htmlFile << "      <tr><td>" << htmlEscape(r->function) << "</td><td>" <<
+                r->line << "</td><td>" << r->units.size() << "</td><td>" <<
+                linesHit << "/" << r->lineHits.size() << "</td><td>" <<
+                taken << "/" << total << "</td></tr>" << ENDL;
+  }
+  htmlFile << "    </table>" << ENDL;
+
+  // Line, hits summed over all files, then the header text
+  map<int, mergedLineType> lines;
+  for (h = hits.begin(); h != hits.end(); ++h)
+  {
+    mergedLineType &m = lines[h->first];
+    char hitsText[24];
+    snprintf(hitsText, sizeof(hitsText), "%8lld", h->second);
+    m.hits = hitsText;
+    m.hit = (h->second != 0);
+  }
+  for (o = outcomes.begin(); o != outcomes.end(); ++o)
+  {
+    mergedLineType &m = lines[o->first];
+    m.hasDecision = true;
+    m.outcomes = o->second.first;
+    m.taken = o->second.second;
+  }
+
+  writeMergedSource(htmlFile, text, lines);
+
+  htmlFile.close();
+  if (htmlFile.fail())
+  {
+    *errStr << "Cannot write " << summary.report << ENDL;
+    return false;
+  }
+
+  return true;
+}
+
+// Write summaries of the reports as a JSON array of
+//   {"file": <header>, "report": <report>, "files": <count>,
+//    "regions": <count>, "lines": [hit, total], "outcomes": [taken, total]}
+void HeaderCoverage::writeJson(ostream &out)
+{
+  out << "[";
+  for (int i = 0; i < summaries.size(); i++)
+  {
+    headerSummaryType &s = summaries[i];
+
+    out << (i ? ",\n    " : "\n    ") << "{\"file\": " <<
+           jsonQuote(s.file) << ", \"report\": " << jsonQuote(s.report) <<
+           ", \"files\": " << s.units << ", \"regions\": " << s.regions <<
+           ", \"lines\": [" << s.linesHit << "," << s.lines << "]" <<
+           ", \"outcomes\": [" << s.outcomesTaken << "," << s.outcomes <<
+           "]}";
+  }
+  out << (summaries.empty() ? "]" : "\n  ]");
+}
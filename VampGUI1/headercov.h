@@ -0,0 +1,86 @@
+/*  Copyright 2016, Robert Ankeney
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/
+*/
+
+
+#ifndef HEADERCOV_H
+#define HEADERCOV_H
+
+#include "vamp_process.h"
+#include <map>
+#include <set>
+
+#define HEADER_COV_MAGIC "VHC"       // Tag at start of header coverage file
+#define HEADER_COV_VERSION 1         // Layout version of header coverage file
+#define HEADER_REPORT_SUFFIX "_hdr"  // Added to name of merged header report
+
+// Coverage of the code from one place in a header, as instrumented in
+// one or more source files. Lines are those of the header.
+typedef struct {
+  string file;                           // Original header
+  int line;                              // Line region starts on
+  string hash;                           // Hash of region's preprocessed text
+  string function;                       // Function region holds
+  set<string> units;                     // Source files region came from
+  map<int, long long> lineHits;          // Hits of each line with code
+  vector<decisionExportType> decisions;  // Outcomes of each decision
+} headerRegionType;
+
+// Totals of one merged header report
+typedef struct {
+  string file;                   // Original header
+  string report;                 // Report written for it
+  int regions;                   // Distinct regions found in header
+  int units;                     // Source files it was merged from
+  int lines;                     // Lines with code
+  int linesHit;
+  int outcomes;                  // Branch and condition outcomes
+  int outcomesTaken;
+} headerSummaryType;
+
+// Header code is instrumented again in every file that includes it.
+// Regions are keyed by header, line and content hash so the copies fold
+// into one; each header then gets a single report, however many files
+// include it. Copies that preprocess differently stay separate regions.
+class HeaderCoverage
+{
+public:
+  void clear();
+  void add(const headerRegionType &region);
+  bool empty() const { return regions.empty(); }
+
+  void write(ostream &out) const;
+  bool read(istream &in);
+  bool save(string fileName) const;
+  bool load(string fileName, ostream *errStr);
+  bool addOutputs(const vector<string> &outputs, ostream *errStr);
+
+  bool genReports(ostream *outStr, ostream *errStr);
+  void writeJson(ostream &out);
+
+  string reportDir;              // Where genReports writes; set by addOutputs
+  vector<headerSummaryType> summaries;  // Reports written by genReports
+
+private:
+  // Header, start line and content hash
+  typedef pair<string, pair<int, string> > headerKeyType;
+
+  bool genReport(const string &file, vector<headerRegionType *> &fileRegions,
+                 headerSummaryType &summary, ostream *errStr);
+
+  map<headerKeyType, headerRegionType> regions;
+};
+
+#endif // HEADERCOV_H
@@ -15,22 +15,49 @@
 */
 
 #include "json.h"
-#ifdef USE_QT
-#include <QMessageBox>
+#include <string.h>
+#include <stdio.h>
+#include <fstream>
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
 #endif
 
+// Return value as a string. Arrays are rebuilt in the compact form
+// ParseArray() accepts.
+string JsonNode::as_string(void)
+{
+  if (type != JSON_ARRAY)
+    return nodeData;
+
+  string str = "[";
+  for (size_t i = 0; i < elements.size(); i++)
+  {
+    if (i)
+      str += ",";
+    if (elements[i].type == JSON_STRING)
+      str += "\"" + elements[i].nodeData + "\"";
+    else
+      str += elements[i].as_string();
+  }
+  str += "]";
+
+  return str;
+}
+
 char Json::getCh(void)
 {
-  if (*ptr == 0)
+  if (ptr >= end)
   {
-#ifdef USE_QT
-    QMessageBox::critical(0, QString("Error"), QString("Unexpected end of file at line %1 - aborting").arg(line));
-#else
     *jsonErr << "Unexpected end of file at line " << line << " - aborting" << ENDL;
-#endif
     throw(1);
   }
 
+  if (*ptr == '\n')
+    ++line;
+
   return *ptr++;
 }
 
@@ -44,13 +71,14 @@ char Json::nextCh(void)
   do
   {
     tryAgain = false;
-    if ((ch == '/') && (getCh() == '*'))
+    if ((ch == '/') && (ptr < end) && (*ptr == '*'))
     {
       // Skip comment
-      while ((getCh() != '/') || (*(ptr - 2) != '*')) ;
+      getCh();
+      while ((getCh() != '*') || (ptr >= end) || (*ptr != '/')) ;
+      getCh();
       tryAgain = true;
       ch = getCh();
-      ch = getCh();
     }
 
     // Ignore white space
@@ -70,21 +98,178 @@ char Json::nextCh(void)
   return ch;
 }
 
+// Parse a string following '"' up to and including the closing quote,
+// decoding escapes as written by jsonQuote()
+void Json::parseEscapedString(string &str)
+{
+  char ch;
+
+  while ((ch = getCh()) != '"')
+  {
+    if (ch != '\\')
+    {
+      str += ch;
+      continue;
+    }
+
+    ch = getCh();
+    switch (ch)
+    {
+      case 'b':
+        str += '\b';
+        break;
+      case 'f':
+        str += '\f';
+        break;
+      case 'n':
+        str += '\n';
+        break;
+      case 'r':
+        str += '\r';
+        break;
+      case 't':
+        str += '\t';
+        break;
+      case 'u':
+      {
+        if (end - ptr < 4)
+        {
+          *jsonErr << "Bad escape at line " << line << " - aborting" << ENDL;
+          throw(1);
+        }
+
+        unsigned code = strtoul(string(ptr, 4).c_str(), NULL, 16);
+        ptr += 4;
+
+        // As UTF-8
+        if (code < 0x80)
+          str += (char) code;
+        else
+        if (code < 0x800)
+        {
+          str += (char) (0xc0 | (code >> 6));
+          str += (char) (0x80 | (code & 0x3f));
+        }
+        else
+        {
+          str += (char) (0xe0 | (code >> 12));
+          str += (char) (0x80 | ((code >> 6) & 0x3f));
+          str += (char) (0x80 | (code & 0x3f));
+        }
+        break;
+      }
+      default:
+        // \", \\ and \/
+        str += ch;
+        break;
+    }
+  }
+}
+
+// Parse one value starting at ptr into node
+// Strings are taken verbatim up to the closing quote (no escapes), as
+// the files written by vamp hold raw path names, unless jsonEscapes is set.
+void Json::parseValue(JsonNode &node)
+{
+  char ch = nextCh();
+
+  if ((ch == '"') && jsonEscapes)
+  {
+    node.type = JSON_STRING;
+    parseEscapedString(node.nodeData);
+  }
+  else
+  if (ch == '"')
+  {
+    const char *start = ptr;
+    const char *quote = (const char *) memchr(ptr, '"', end - ptr);
+    if (quote == NULL)
+    {
+      *jsonErr << "Unterminated string at line " << line << " - aborting" << ENDL;
+      throw(1);
+    }
+
+    for (const char *p = start; p < quote; p++)
+      if (*p == '\n')
+        ++line;
+
+    node.type = JSON_STRING;
+    node.nodeData.assign(start, quote - start);
+    ptr = quote + 1;
+  }
+  else
+  if (ch == '[')
+  {
+    node.type = JSON_ARRAY;
+    parseArrayElements(node.elements);
+  }
+  else
+  if ((ch == ',') || (ch == ']') || (ch == '}') || (ch == ':'))
+  {
+    *jsonErr << "Unexpected '" << ch << "' at line " << line << " - aborting" << ENDL;
+    throw(1);
+  }
+  else
+  {
+    // Literal - runs to the next separator
+    const char *start = ptr - 1;
+    while ((ptr < end) &&
+           (*ptr != ',') && (*ptr != ']') && (*ptr != '}') &&
+           (*ptr != ' ') && (*ptr != '\t') && (*ptr != '\r') && (*ptr != '\n') &&
+           (*ptr != '/'))
+      ++ptr;
+
+    node.type = JSON_LITERAL;
+    node.nodeData.assign(start, ptr - start);
+  }
+}
+
+// Parse array elements following '[' up to and including ']'
+void Json::parseArrayElements(vector<JsonNode> &array)
+{
+  const char *save = ptr;
+  int saveLine = line;
+
+  if (nextCh() == ']')
+  {
+    // Empty array
+    return;
+  }
+  ptr = save;
+  line = saveLine;
+
+  char ch;
+  do
+  {
+    array.push_back(JsonNode());
+    parseValue(array.back());
+
+    ch = nextCh();
+    if ((ch != ',') && (ch != ']'))
+    {
+      *jsonErr << "Expected ',' or ']' at line " << line << " - aborting" << ENDL;
+      throw(1);
+    }
+  } while (ch == ',');
+}
+
 void Json::ParseJson(string str)
+{
+  ParseJson(str.data(), str.size());
+}
+
+void Json::ParseJson(const char *data, size_t len)
 {
   char ch;
 
   line = 1;
-  ptr = str.data();
+  ptr = data;
+  end = data + len;
 
   ch = nextCh();
   if (ch != '{')
   {
-#ifdef USE_QT
-    QMessageBox::critical(0, QString("Error"), QString("Expected '{' at line %1 - aborting").arg(line));
-#else
     *jsonErr << "Expected '{' at line " << line << " - aborting" << ENDL;
-#endif
     throw(1);
   }
 
@@ -96,162 +281,139 @@ void Json::ParseJson(string str)
     ch = nextCh();
     if (ch != '"')
     {
-#ifdef USE_QT
-      QMessageBox::critical(0, QString("Error"), QString("Expected '\"' at line %1 - aborting").arg(line));
-#else
       *jsonErr << "Expected '\"' at line " << line << " - aborting" << ENDL;
-#endif
       throw(1);
     }
 
-    ch = getCh();
-    while (ch != '"')
-    {
-      jsonNode.nodeName += ch;
-      ch = getCh();
-    }
+    const char *start = ptr;
+    while (getCh() != '"') ;
+    jsonNode.nodeName.assign(start, ptr - start - 1);
 
     if (nextCh() != ':')
     {
-#ifdef USE_QT
-      QMessageBox::critical(0, QString("Error"), QString("Expected ':' at line %1 - aborting").arg(line));
-#else
       *jsonErr << "Expected ':' at line " << line << " - aborting" << ENDL;
-#endif
       throw(1);
     }
 
     // Now get node value
-    int arrayDepth = 0;
-
-    do {
-      ch = nextCh();
-      jsonNode.nodeData += ch;
-      if (ch == '[')
-      {
-        ++arrayDepth;
-      }
-      else
-      if (ch == ']')
-      {
-        if (arrayDepth-- == 0)
-        {
-#ifdef USE_QT
-          QMessageBox::critical(0, QString("Error"), QString("Unexpected ']' at line %1 - aborting").arg(line));
-#else
-          *jsonErr << "Unexpected ']' at line " << line << " - aborting" << ENDL;
-#endif
-          throw(1);
-        }
-      }
-      else
-      if (ch == '"')
-      {
-        // Get string
-        do {
-          ch = getCh();
-          jsonNode.nodeData += ch;
-        } while (ch != '"');
-      }
-    } while ((arrayDepth > 0) || ((ch != ',') && (ch != '}')));
-
-    if (jsonNode.nodeData[0] == '"')
-    {
-      // Remove quotes and ',' or '}'
-      jsonNode.nodeData =
-           jsonNode.nodeData.substr(1, jsonNode.nodeData.size() - 3);
-    }
-    else
-    {
-      // Remove ',' or '}'
-      jsonNode.nodeData.resize(jsonNode.nodeData.size() - 1);
-    }
     jsonNodes.push_back(jsonNode);
+    parseValue(jsonNodes.back());
+
+    ch = nextCh();
   } while (ch == ',');
 
   if (ch != '}')
   {
-#ifdef USE_QT
-    QMessageBox::critical(0, QString("Error"), QString("Expected '}' at line %1 - aborting").arg(line));
-#else
     *jsonErr << "Expected '}' at line " << line << " - aborting" << ENDL;
-#endif
     throw(1);
   }
-
 }
 
-void Json::ParseArray(string str, vector<JsonNode> &array)
+// Map fileName into memory and parse it
+void Json::ParseFile(string fileName)
 {
-  char ch;
+#ifdef _WIN32
+  ifstream jsonFile(fileName.c_str());
+  if (!jsonFile.is_open())
+  {
+    *jsonErr << "Cannot open " << fileName << " - aborting" << ENDL;
+    throw(1);
+  }
 
-  if (str == "[]")
+  ostringstream jsonSource;
+  jsonSource << jsonFile.rdbuf();
+  ParseJson(jsonSource.str());
+#else
+  int fd = open(fileName.c_str(), O_RDONLY);
+  if (fd == -1)
   {
-    // Empty array - return
-    return;
+    *jsonErr << "Cannot open " << fileName << " - aborting" << ENDL;
+    throw(1);
+  }
+
+  struct stat fileStat;
+  if ((fstat(fd, &fileStat) == -1) || (fileStat.st_size == 0))
+  {
+    close(fd);
+    *jsonErr << "Cannot read " << fileName << " - aborting" << ENDL;
+    throw(1);
   }
 
+  size_t len = fileStat.st_size;
+  void *addr = mmap(NULL, len, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (addr == MAP_FAILED)
+  {
+    *jsonErr << "Cannot read " << fileName << " - aborting" << ENDL;
+    throw(1);
+  }
+
+  try
+  {
+    ParseJson((const char *) addr, len);
+  }
+  catch(int i)
+  {
+    munmap(addr, len);
+    throw;
+  }
+  munmap(addr, len);
+#endif
+}
+
+// Parse array text (such as from JsonNode::as_string()) into array
+void Json::ParseArray(string str, vector<JsonNode> &array)
+{
+  line = 1;
   ptr = str.data();
+  end = str.data() + str.size();
+
   if (nextCh() != '[')
   {
-#ifdef USE_QT
-    QMessageBox::critical(0, QString("Error"), QString("Expected '[' in array - aborting"));
-#else
     *jsonErr << "Expected '[' in array" << " - aborting" << ENDL;
-#endif
     throw(1);
   }
 
-  // Now get node value
-  int arrayDepth = 0;
+  parseArrayElements(array);
+}
+
+// Get the elements of an array node
+vector<JsonNode> &Json::GetArray(JsonNode &node)
+{
+  if (node.type != JSON_ARRAY)
+  {
+    *jsonErr << "Expected '[' in array" << " - aborting" << ENDL;
+    throw(1);
+  }
 
-  do {
-    JsonNode node;
+  return node.elements;
+}
 
-    do {
-      ch = nextCh();
-      node.nodeData += ch;
+// Quote str for a JSON file, escaping quotes, backslashes and control
+// characters
+string jsonQuote(const string &str)
+{
+  string out("\"");
 
-      if (ch == '[')
-      {
-        ++arrayDepth;
-      }
-      else
-      if (ch == ']')
-      {
-        while (arrayDepth-- && (*ptr == ']'))
-        {
-          ch = nextCh();
-          node.nodeData += ch;
-        }
-        if (arrayDepth == 0)
-        {
-          ch = nextCh();
-          node.nodeData += ch;
-        }
-      }
-      else
-      if (ch == '"')
-      {
-        // Get string
-        do {
-          ch = getCh();
-          node.nodeData += ch;
-        } while (ch != '"');
-      }
-    } while ((arrayDepth > 0) || ((ch != ',') && (ch != ']')));
+  for (size_t i = 0; i < str.size(); i++)
+  {
+    unsigned char ch = str[i];
 
-    if (node.nodeData[0] == '"')
+    if ((ch == '"') || (ch == '\\'))
     {
-      // Remove quotes and ',' or '}'
-      node.nodeData = node.nodeData.substr(1, node.nodeData.size() - 3);
+      out += '\\';
+      out += ch;
     }
     else
+    if (ch < 0x20)
     {
-      // Remove ',' or ']'
-      node.nodeData.resize(node.nodeData.size() - 1);
+      char hex[8];
+      sprintf(hex, "\\u%04x", ch);
+      out += hex;
     }
-    array.push_back(node);
-    arrayDepth = 0;
-  } while (ch != ']');
+    else
+      out += ch;
+  }
+
+  return out + "\"";
 }
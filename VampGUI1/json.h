@@ -26,36 +26,66 @@
 
 using namespace std;
 
+enum JsonType {
+  JSON_LITERAL,     // Number, true, false or null
+  JSON_STRING,
+  JSON_ARRAY
+};
+
 class JsonNode {
 public:
+  JsonNode() : type(JSON_LITERAL)
+  {
+  }
   string name(void) { return nodeName; }
-  string as_string(void) { return nodeData; }
+  string as_string(void);
   bool as_bool(void) { return (nodeData == "true"); }
   int as_int(void) { return atoi(nodeData.data()); }
+  bool is_array(void) { return (type == JSON_ARRAY); }
 
   string nodeName;
-  string nodeData;
+  string nodeData;              // Value, unless an array
+  JsonType type;
+  vector<JsonNode> elements;    // Elements of an array
 };
 
+// Parses a JSON database. Errors are written to the error stream given
+// to the constructor and reported by throw(1); the caller decides how to
+// show them, so a Json may be used from any thread.
+// The input is tokenized once; arrays at every depth are parsed into
+// JsonNode::elements and fetched with GetArray() without re-scanning.
+// Strings are taken verbatim unless escapes is set, for files written
+// with jsonQuote().
 class Json
 {
 public:
-    Json(std::ostringstream *errStr) : jsonErr(errStr)
+    Json(std::ostringstream *errStr, bool escapes = false) :
+      jsonErr(errStr), jsonEscapes(escapes)
     {
     }
 
     void ParseJson(string str);
+    void ParseJson(const char *data, size_t len);
+    void ParseFile(string fileName);
     void ParseArray(string str, vector<JsonNode> &array);
+    vector<JsonNode> &GetArray(JsonNode &node);
 
     vector<JsonNode> jsonNodes;
 
 private :
   char getCh(void);
   char nextCh(void);
+  void parseValue(JsonNode &node);
+  void parseEscapedString(string &str);
+  void parseArrayElements(vector<JsonNode> &array);
 
   std::ostringstream *jsonErr;
+  bool jsonEscapes;
   const char *ptr;
+  const char *end;
   int line;
 };
 
+string jsonQuote(const string &str);
+
 #endif // JSON_H
@@ -23,6 +23,10 @@
 #include "vamp_process.h"
 #include "vamp_preprocessor.h"
 #include "splash.h"
+#include "processjob.h"
+#include "preproccache.h"
+#include "headercov.h"
+#include "variantcov.h"
 #include <QFileDialog>
 #include <QFile>
 #include <QMessageBox>
@@ -31,6 +35,12 @@
 #include <QProgressDialog>
 #include <QDateTime>
 #include <QDir>
+#include <QThreadPool>
+#include <QThread>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QFileSystemWatcher>
+#include <QtConcurrent/QtConcurrentRun>
 //#include <QtPrintSupport/QPrinter>
 //#include <QtPrintSupport/QPrintDialog>
 #include <QPrinter>
@@ -64,6 +74,26 @@ MainWindow::MainWindow(QWidget *parent) :
     vcDataChanged = false;
     vcReportDataChanged = false;
     vcPreProcDataChanged = false;
+    processingItems = false;
+
+    // Watch for new history files while Project->Watch History is checked
+    histWatcher = new QFileSystemWatcher(this);
+    connect(histWatcher, SIGNAL(directoryChanged(QString)), this, SLOT(histChanged(QString)));
+    connect(histWatcher, SIGNAL(fileChanged(QString)), this, SLOT(histChanged(QString)));
+    histTimer.setSingleShot(true);
+    connect(&histTimer, SIGNAL(timeout()), this, SLOT(processChangedHistories()));
+    watchJobTimer.setInterval(100);
+    connect(&watchJobTimer, SIGNAL(timeout()), this, SLOT(checkWatchJobs()));
+
+    // Preprocess, instrument and process run in the background and
+    // report back through queued signals
+    batchProgressDialog = NULL;
+    ppCache = NULL;
+    batchPreproc = NULL;
+    connect(this, SIGNAL(batchOutput(QString,QColor)), this, SLOT(showBatchOutput(QString,QColor)));
+    connect(this, SIGNAL(batchError(QString)), this, SLOT(showBatchError(QString)));
+    connect(this, SIGNAL(batchProgress(int,QString)), this, SLOT(showBatchProgress(int,QString)));
+    connect(&batchWatcher, SIGNAL(finished()), this, SLOT(batchFinished()));
 //    ui->menu_Project->setVisible(false);
 //    ui->splitter->sizeHint()
 
@@ -140,6 +170,8 @@ void MainWindow::closeEvent(QCloseEvent *event)
 {
     if (saveProject(true))
     {
+        stopBatch();
+        stopHistWatch();
         event->accept();
     }
     else
@@ -160,6 +192,9 @@ void MainWindow::setDefaultVcData(VAMP_CONFIG &vcData)
     vcData.saveSuffix = "";
     vcData.mcdcStackSize = 4;
     vcData.langStandard = clang::LangStandard::lang_c89;
+    vcData.registerProbes = false;
+    vcData.probeShards = 0;
+    vcData.skipCovered = false;
 }
 
 // Set default vamp_process.cfg info
@@ -172,6 +207,15 @@ void MainWindow::setDefaultVcReportData(VAMP_REPORT_CONFIG &vcReportData)
     vcReportData.reportSeparator = ",";
     vcReportData.htmlDirectory = "VAMP_HTML";
     vcReportData.htmlSuffix = "";
+    vcReportData.compactHtml = false;
+    vcReportData.generateHtml = true;
+    vcReportData.exportLcov = false;
+    vcReportData.exportCobertura = false;
+    vcReportData.exportJson = false;
+    vcReportData.mergeHeaders = false;
+    vcReportData.mergeVariants = false;
+    vcReportData.mcdcSolverNodeLimit = MCDC_SOLVER_NODE_LIMIT;
+    vcReportData.mcdcSolverTimeLimit = MCDC_SOLVER_TIME_LIMIT;
 }
 
 // Set default preprocessor info (kept in .vproj file)
@@ -214,6 +258,9 @@ void MainWindow::saveVcData(void)
     out << "  \"save_directory\": \"" << fixPath(vcData.saveDirectory, false) << "\",\n";
     out << "  \"save_suffix\": \"" << QString::fromStdString(vcData.saveSuffix) << "\",\n";
     out << "  \"mcdc_stack_size\": " << vcData.mcdcStackSize << ",\n";
+    out << "  \"register_probes\": " << (vcData.registerProbes ? "true" : "false") << ",\n";
+    out << "  \"probe_shards\": " << vcData.probeShards << ",\n";
+    out << "  \"skip_covered\": " << (vcData.skipCovered ? "true" : "false") << ",\n";
     if (vcData.langStandard == clang::LangStandard::lang_c89)
         out << "  \"lang_standard\": \"lang_c89\"\n";
     else
@@ -261,7 +308,16 @@ void MainWindow::saveVcReportData(void)
     out << "  \"do_report\": " << (vcReportData.generateReport ? "true" : "false") << ",\n";
     out << "  \"report_separator\": \"" << QString::fromStdString(vcReportData.reportSeparator) << "\",\n";
     out << "  \"html_directory\": \"" << fixPath(vcReportData.htmlDirectory, false) << "\",\n";
-    out << "  \"html_suffix\": \"" << QString::fromStdString(vcReportData.htmlSuffix) << "\"\n";
+    out << "  \"html_suffix\": \"" << QString::fromStdString(vcReportData.htmlSuffix) << "\",\n";
+    out << "  \"compact_html\": " << (vcReportData.compactHtml ? "true" : "false") << ",\n";
+    out << "  \"generate_html\": " << (vcReportData.generateHtml ? "true" : "false") << ",\n";
+    out << "  \"export_lcov\": " << (vcReportData.exportLcov ? "true" : "false") << ",\n";
+    out << "  \"export_cobertura\": " << (vcReportData.exportCobertura ? "true" : "false") << ",\n";
+    out << "  \"export_json\": " << (vcReportData.exportJson ? "true" : "false") << ",\n";
+    out << "  \"merge_headers\": " << (vcReportData.mergeHeaders ? "true" : "false") << ",\n";
+    out << "  \"merge_variants\": " << (vcReportData.mergeVariants ? "true" : "false") << ",\n";
+    out << "  \"mcdc_solver_node_limit\": " << vcReportData.mcdcSolverNodeLimit << ",\n";
+    out << "  \"mcdc_solver_time_limit\": " << vcReportData.mcdcSolverTimeLimit << "\n";
     out << "}\n";
     out.flush();
     vcReportDataChanged = false;
@@ -363,6 +419,9 @@ void MainWindow::loadProjectData(QString fileName)
         return;
     }
 
+    // Totals for each file come from the coverage index where current
+    coverageIndex.load(coverageIndexName());
+
     // Parse project file
     vector<JsonNode>::iterator i = json.jsonNodes.begin();
     int cnt = 0;
@@ -420,8 +479,7 @@ void MainWindow::loadProjectData(QString fileName)
         else
         if (nodeName == "include_paths")
         {
-            vector<JsonNode> incPaths;
-            json.ParseArray(i->as_string(), incPaths);
+            vector<JsonNode> &incPaths = json.GetArray(*i);
 
             // Load include paths from JSON config file
             vector<JsonNode>::const_iterator j = incPaths.begin();
@@ -436,8 +494,7 @@ void MainWindow::loadProjectData(QString fileName)
         else
         if (nodeName == "defines_list")
         {
-            vector<JsonNode> defsList;
-            json.ParseArray(i->as_string(), defsList);
+            vector<JsonNode> &defsList = json.GetArray(*i);
 
             // Load include paths from JSON config file
             vector<JsonNode>::const_iterator j = defsList.begin();
@@ -453,8 +510,7 @@ void MainWindow::loadProjectData(QString fileName)
         if (nodeName == "project_files")
         {
             // Get list of project files
-            vector<JsonNode> projFiles;
-            json.ParseArray(i->as_string(), projFiles);
+            vector<JsonNode> &projFiles = json.GetArray(*i);
             vector<JsonNode>::const_iterator j = projFiles.begin();
 //            ui->projectTreeView->setCursor(Qt::WaitCursor);
 //            QApplication::setOverrideCursor(QCursor(Qt::WaitCursor));
@@ -501,6 +557,9 @@ void MainWindow::loadProjectData(QString fileName)
 
         ++i;
     }
+
+    // Keep any totals read from .vrpt files for next time
+    coverageIndex.save();
 #ifdef VAMP_DEBUG
   cerr << "doPreProcess: " << (vcPreProcData.doPreProcess ? "true" : "false") << endl;
   cerr << "useVampPreprocessor: " << (vcPreProcData.useVampPreprocessor ? "true" : "false") << endl;
@@ -534,6 +593,12 @@ void MainWindow::getDirFileNames(QString pathName, QString &dirName, QString &fi
     fileName = pathName.mid(index);
 }
 
+// Name of project coverage index (<project>.vidx)
+QString MainWindow::coverageIndexName(void)
+{
+    return projectDirName + projectName + ".vidx";
+}
+
 // Load the .vrpt file coverage info for the given source file
 void MainWindow::loadFileInfo(QString fileName, fileInstInfo &fileInfo)
 {
@@ -596,37 +661,6 @@ void MainWindow::loadFileInfo(QString fileName, fileInstInfo &fileInfo)
         return;
     }
 
-    QFile jsonFile(vrptName);
-    if (!jsonFile.open(QFile::ReadOnly | QFile::Text))
-    {
-        QMessageBox::critical(0, QString("Error"), QString("Cannot read file %1:\n%2")
-                                                   .arg(vrptName)
-                                                   .arg(jsonFile.errorString()));
-        return;
-    }
-
-    QTextStream in(&jsonFile);
-
-    // Read file into a string
-    QString jsonSource = in.readAll();
-
-    jsonFile.close();
-
-    // Now parse it
-    ostringstream jsonErr;
-    Json json(&jsonErr);
-    try
-    {
-      json.ParseJson(jsonSource.toStdString());
-    }
-    catch(int i)
-    {
-        QMessageBox::warning(0, QString("Error"), QString("Bad report file: %1\n%2").arg(vrptName).arg(QString::fromStdString(jsonErr.str())));
-        return;
-    }
-
-    vector<JsonNode>::iterator i = json.jsonNodes.begin();
-
     // Check to see if .vrpt file is older than source
     // If so, set:
     // fileInfo.instInfo = INST_OLD;
@@ -658,6 +692,25 @@ void MainWindow::loadFileInfo(QString fileName, fileInstInfo &fileInfo)
             fileInfo.instInfo = INST_OLD;
     }
 
+    // Use project coverage index if it has this version of the .vrpt
+    qint64 vrptModMsec = vrptModTime.toMSecsSinceEpoch();
+    if (coverageIndex.find(vrptName, vrptModMsec, fileInfo))
+        return;
+
+    ostringstream jsonErr;
+    Json json(&jsonErr);
+    try
+    {
+      json.ParseFile(vrptName.toStdString());
+    }
+    catch(int i)
+    {
+        QMessageBox::warning(0, QString("Error"), QString("Bad report file: %1\n%2").arg(vrptName).arg(QString::fromStdString(jsonErr.str())));
+        return;
+    }
+
+    vector<JsonNode>::iterator i = json.jsonNodes.begin();
+
     // Parse .vrpt file
     while (i != json.jsonNodes.end())
     {
@@ -717,8 +770,7 @@ void MainWindow::loadFileInfo(QString fileName, fileInstInfo &fileInfo)
         if (nodeName == "function_info")
         {
             // Get list of functions and their instrumentation info
-            vector<JsonNode> funcInfo;
-            json.ParseArray(i->as_string(), funcInfo);
+            vector<JsonNode> &funcInfo = json.GetArray(*i);
             vector<JsonNode>::iterator j = funcInfo.begin();
 
             while (j != funcInfo.end())
@@ -748,6 +800,8 @@ void MainWindow::loadFileInfo(QString fileName, fileInstInfo &fileInfo)
 
         ++i;
     }
+
+    coverageIndex.update(vrptName, fileName, vrptModMsec, fileInfo);
 }
 
 // Create string list of file stats for each column
@@ -1048,6 +1102,64 @@ void MainWindow::genFileList(QString curPath, QModelIndex parent, QStringList &r
     }
 }
 
+// Embedded folder icon used for each folder row of the project summary
+static const char *summaryFolderIcon =
+    "<img src=\"data:image/bmp,BMv%04%00%00%00%00%00%006%00%00"
+    "%00%28%00%00%00%16%00%00%00%10%00%00%00%01%00%18%00%00%00"
+    "%00%00%40%04%00%00%C2%1E%00%00%C2%1E%00%00%00%00%00%00%00"
+    "%00%00%00%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF"
+    "%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%ED%F8%FA%BA%E3"
+    "%EC~%C8%DAL%B2%CCd%B0%C4%AE%D1%DC%E8%F4%F8%FF%FF%FF%FF%FF"
+    "%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%00%00%FF%FF%FF%FF%FF%FF%FF"
+    "%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF"
+    "%FF%8E%D7%E7_%C3%D9%5D%C0%D6%5E%BF%D6%60%BF%D6D%AF%CAK%A6"
+    "%C1V%B8%D4%5E%C0%D7%5D%BF%D7%5C%BE%D6r%C7%DB%B5%E1%EC%00"
+    "%00%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF"
+    "%FF%FF%FF%FF%FF%FF%FF%FF%FFl%CE%E1%80%D4%E4w%CE%E0o%C9%DDg"
+    "%C4%DAD%AF%CAC%A6%C3N%B8%D7N%C1%DEN%C1%DEN%C1%DEP%C1%DDs%C7"
+    "%DB%00%00%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF"
+    "%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FFp%D1%E4%89%DB%E8%80%D4%E4w"
+    "%CE%E0o%C9%DDD%AF%CAE%A8%C4N%B8%D7N%C1%DEN%C1%DEN%C1%DE%D3"
+    "%A5I%5D%BF%D7%00%00%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF"
+    "%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FFu%D4%E7%92%E1%EC"
+    "%89%DB%E8%80%D4%E4w%CE%E0E%B0%CAI%A9%C4R%BA%D8R%C3%DFN%C1"
+    "%DEN%C1%DE%DD%B9%5D%5E%C0%D8%00%00%88%88%88%26%26%26%26%26"
+    "%26%26%26%26%26%26%26%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FFy"
+    "%D8%E9%9B%E7%F0%92%E1%EC%89%DB%E8%80%D4%E4G%B2%CCN%AC%C6V%BC"
+    "%D9%5B%C7%E1V%C5%E0R%C3%DF%EC%EC%EC%60%C1%D9%00%00%BD%BD%BD"
+    "%2B%2B%2BXXXYYYYYY%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%7D%DB"
+    "%EC%A3%EC%F4%9B%E7%F0%92%E1%EC%89%DB%E8J%B4%CET%AF%C8%5C%BF"
+    "%DAf%CD%E4%60%CA%E3%5B%C7%E1%EC%EC%ECb%C2%DA%00%00%FF%FF%FF"
+    "%BD%BD%BD%2B%2B%2BXXXYYY%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF"
+    "%81%DE%EE%AA%F1%F7%A3%EC%F4%9B%E7%F0%92%E1%ECN%B7%D0%5B%B2%C9c"
+    "%C2%DCs%D3%E8m%D0%E6f%CD%E4%EC%EC%ECc%C3%DB%00%00%FF%FF%FF%FF"
+    "%FF%FF%BD%BD%BD%2B%2B%2BXXX%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF"
+    "%FF%84%E0%F0%B0%F5%F9%AA%F1%F7%A3%EC%F4%C6%F1%F6R%BA%D2a%B6%CBi"
+    "%C6%DE%82%DA%ECz%D7%EAs%D3%E8m%D0%E6e%C5%DC%00%00%FF%FF%FF%FF"
+    "%FF%FF%FF%FF%FF%BD%BD%BD%2B%2B%2B%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF"
+    "%FF%FF%88%E3%F2%B4%F7%FB%B0%F5%F9%AA%F1%F7%E8%FA%FCV%BD%D4h%B9"
+    "%CDp%C9%E0%90%E2%F0%89%DE%EE%82%DA%ECo%CC%E2%A6%DD%EB%00%00%FF"
+    "%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%BF%BF%BF%FF%FF%FF%FF%FF%FF%FF"
+    "%FF%FF%FF%FF%FF%8A%E5%F3%B4%F7%FB%B4%F7%FB%B0%F5%F9%F4%FD%FEZ%C0"
+    "%D7n%BC%CEv%CC%E1%9E%E9%F3%97%E5%F2%90%E2%F0k%C9%DF%FF%FF%FF%00"
+    "%00%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF"
+    "%FF%FF%FF%FF%FF%FF%FF%8D%E6%F5%B4%F7%FB%B4%F7%FB%B4%F7%FB%FC%FF"
+    "%FF_%C4%DAt%BE%D0%7D%CF%E3%AC%EF%F7%A5%EC%F5%9E%E9%F3n%CA%E1%FF"
+    "%FF%FF%00%00%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF"
+    "%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%8D%E7%F5%B4%F7%FB%B4%F7%FB%B4%F7%"
+    "FB%FF%FF%FFd%C8%DDx%C0%D1%81%D2%E5%B7%F4%FA%B1%F2%F9%AC%EF%F7p%CC"
+    "%E2%FF%FF%FF%00%00%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF"
+    "%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%8D%E7%F5%B4%F7%FB%B4%F7%FB"
+    "%FC%FF%FF%FC%FF%FFi%CB%E0%7F%C6%D5%AE%EE%F6%BF%F9%FC%BB%F7%FB%B7"
+    "%F4%FAr%CD%E4%FF%FF%FF%00%00%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF"
+    "%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FD%FE%FE%8D%E7%F5%B1%F6%FB"
+    "%E9%FB%FD%99%EA%F4%87%DF%EDy%CD%DC%BC%F5%FA%C2%FA%FD%C2%FA%FD%C2"
+    "%FA%FD%B6%F4%F9%86%D5%E8%FF%FF%FF%00%00%FF%FF%FF%FF%FF%FF%FF%FF"
+    "%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%AF%ED"
+    "%F8%8E%E7%F5%8D%E4%F4%89%E0%F2%88%DE%F1%89%DD%F1%86%DB%EF%83%D9"
+    "%EE%80%D7%EC%7D%D5%EA%8B%D8%EA%C0%E9%F3%FF%FF%FF%00%00\"\n"
+    "width=\"16\" height=\"14\" alt=\"embedded folder icon\">\n";
+
 void MainWindow::genSummary(QString &outStr, int level, QModelIndex parent)
 {
     QAbstractItemModel *model = ui->projectTreeView->model();
@@ -1101,61 +1213,7 @@ void MainWindow::genSummary(QString &outStr, int level, QModelIndex parent)
                 else
                     outStr += "<td";
                 outStr += " colspan=" + QString::number(cols) + ">\n";
-                outStr += "<img src=\"data:image/bmp,BMv%04%00%00%00%00%00%006%00%00";
-                outStr += "%00%28%00%00%00%16%00%00%00%10%00%00%00%01%00%18%00%00%00";
-                outStr += "%00%00%40%04%00%00%C2%1E%00%00%C2%1E%00%00%00%00%00%00%00";
-                outStr += "%00%00%00%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF";
-                outStr += "%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%ED%F8%FA%BA%E3";
-                outStr += "%EC~%C8%DAL%B2%CCd%B0%C4%AE%D1%DC%E8%F4%F8%FF%FF%FF%FF%FF";
-                outStr += "%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%00%00%FF%FF%FF%FF%FF%FF%FF";
-                outStr += "%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF";
-                outStr += "%FF%8E%D7%E7_%C3%D9%5D%C0%D6%5E%BF%D6%60%BF%D6D%AF%CAK%A6";
-                outStr += "%C1V%B8%D4%5E%C0%D7%5D%BF%D7%5C%BE%D6r%C7%DB%B5%E1%EC%00";
-                outStr += "%00%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF";
-                outStr += "%FF%FF%FF%FF%FF%FF%FF%FF%FFl%CE%E1%80%D4%E4w%CE%E0o%C9%DDg";
-                outStr += "%C4%DAD%AF%CAC%A6%C3N%B8%D7N%C1%DEN%C1%DEN%C1%DEP%C1%DDs%C7";
-                outStr += "%DB%00%00%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF";
-                outStr += "%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FFp%D1%E4%89%DB%E8%80%D4%E4w";
-                outStr += "%CE%E0o%C9%DDD%AF%CAE%A8%C4N%B8%D7N%C1%DEN%C1%DEN%C1%DE%D3";
-                outStr += "%A5I%5D%BF%D7%00%00%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF";
-                outStr += "%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FFu%D4%E7%92%E1%EC";
-                outStr += "%89%DB%E8%80%D4%E4w%CE%E0E%B0%CAI%A9%C4R%BA%D8R%C3%DFN%C1";
-                outStr += "%DEN%C1%DE%DD%B9%5D%5E%C0%D8%00%00%88%88%88%26%26%26%26%26";
-                outStr += "%26%26%26%26%26%26%26%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FFy";
-                outStr += "%D8%E9%9B%E7%F0%92%E1%EC%89%DB%E8%80%D4%E4G%B2%CCN%AC%C6V%BC";
-                outStr += "%D9%5B%C7%E1V%C5%E0R%C3%DF%EC%EC%EC%60%C1%D9%00%00%BD%BD%BD";
-                outStr += "%2B%2B%2BXXXYYYYYY%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%7D%DB";
-                outStr += "%EC%A3%EC%F4%9B%E7%F0%92%E1%EC%89%DB%E8J%B4%CET%AF%C8%5C%BF";
-                outStr += "%DAf%CD%E4%60%CA%E3%5B%C7%E1%EC%EC%ECb%C2%DA%00%00%FF%FF%FF";
-                outStr += "%BD%BD%BD%2B%2B%2BXXXYYY%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF";
-                outStr += "%81%DE%EE%AA%F1%F7%A3%EC%F4%9B%E7%F0%92%E1%ECN%B7%D0%5B%B2%C9c";
-                outStr += "%C2%DCs%D3%E8m%D0%E6f%CD%E4%EC%EC%ECc%C3%DB%00%00%FF%FF%FF%FF";
-                outStr += "%FF%FF%BD%BD%BD%2B%2B%2BXXX%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF";
-                outStr += "%FF%84%E0%F0%B0%F5%F9%AA%F1%F7%A3%EC%F4%C6%F1%F6R%BA%D2a%B6%CBi";
-                outStr += "%C6%DE%82%DA%ECz%D7%EAs%D3%E8m%D0%E6e%C5%DC%00%00%FF%FF%FF%FF";
-                outStr += "%FF%FF%FF%FF%FF%BD%BD%BD%2B%2B%2B%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF";
-                outStr += "%FF%FF%88%E3%F2%B4%F7%FB%B0%F5%F9%AA%F1%F7%E8%FA%FCV%BD%D4h%B9";
-                outStr += "%CDp%C9%E0%90%E2%F0%89%DE%EE%82%DA%ECo%CC%E2%A6%DD%EB%00%00%FF";
-                outStr += "%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%BF%BF%BF%FF%FF%FF%FF%FF%FF%FF";
-                outStr += "%FF%FF%FF%FF%FF%8A%E5%F3%B4%F7%FB%B4%F7%FB%B0%F5%F9%F4%FD%FEZ%C0";
-                outStr += "%D7n%BC%CEv%CC%E1%9E%E9%F3%97%E5%F2%90%E2%F0k%C9%DF%FF%FF%FF%00";
-                outStr += "%00%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF";
-                outStr += "%FF%FF%FF%FF%FF%FF%FF%8D%E6%F5%B4%F7%FB%B4%F7%FB%B4%F7%FB%FC%FF";
-                outStr += "%FF_%C4%DAt%BE%D0%7D%CF%E3%AC%EF%F7%A5%EC%F5%9E%E9%F3n%CA%E1%FF";
-                outStr += "%FF%FF%00%00%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF";
-                outStr += "%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%8D%E7%F5%B4%F7%FB%B4%F7%FB%B4%F7%";
-                outStr += "FB%FF%FF%FFd%C8%DDx%C0%D1%81%D2%E5%B7%F4%FA%B1%F2%F9%AC%EF%F7p%CC";
-                outStr += "%E2%FF%FF%FF%00%00%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF";
-                outStr += "%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%8D%E7%F5%B4%F7%FB%B4%F7%FB";
-                outStr += "%FC%FF%FF%FC%FF%FFi%CB%E0%7F%C6%D5%AE%EE%F6%BF%F9%FC%BB%F7%FB%B7";
-                outStr += "%F4%FAr%CD%E4%FF%FF%FF%00%00%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF";
-                outStr += "%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FD%FE%FE%8D%E7%F5%B1%F6%FB";
-                outStr += "%E9%FB%FD%99%EA%F4%87%DF%EDy%CD%DC%BC%F5%FA%C2%FA%FD%C2%FA%FD%C2";
-                outStr += "%FA%FD%B6%F4%F9%86%D5%E8%FF%FF%FF%00%00%FF%FF%FF%FF%FF%FF%FF%FF";
-                outStr += "%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%FF%AF%ED";
-                outStr += "%F8%8E%E7%F5%8D%E4%F4%89%E0%F2%88%DE%F1%89%DD%F1%86%DB%EF%83%D9";
-                outStr += "%EE%80%D7%EC%7D%D5%EA%8B%D8%EA%C0%E9%F3%FF%FF%FF%00%00\"\n";
-                outStr += "width=\"16\" height=\"14\" alt=\"embedded folder icon\">\n";
+                outStr += summaryFolderIcon;
                 outStr += model->index(i, 0, parent).data().toString() + "\n";
                 outStr += "</td>\n";
                 outStr += "</tr>\n";
@@ -1235,6 +1293,13 @@ void MainWindow::editConfig(void)
         vc.getVcPreProcData(vcPreProcData, vcPreProcDataChg);
         if (vcPreProcDataChg)
             vcPreProcDataChanged = true;
+
+        // Directories and suffixes decide where histories are written
+        if (ui->action_Watch_History->isChecked() &&
+            (vcDataChg || vcReportDataChg || vcPreProcDataChg))
+        {
+            syncHistWatch();
+        }
     }
 }
 
@@ -1267,6 +1332,9 @@ void MainWindow::checkProject(QString fileName, bool isNew)
     // Enable Project menu option "Generate vamp_output.c"
     ui->action_Generate_vamp_output_c->setEnabled(true);
 
+    // Enable Project menu option "Watch History"
+    ui->action_Watch_History->setEnabled(true);
+
     fileName = fixPath(fileName, false);
     int index = fileName.lastIndexOf('/') + 1;
     if (index == 0)
@@ -1654,6 +1722,10 @@ void MainWindow::removeItem()
     } while (killParent);
 
     projectChanged = true;
+
+    // Stop watching histories of removed files
+    if (ui->action_Watch_History->isChecked())
+        syncHistWatch();
 }
 
 // Return index for selected file.
@@ -1719,48 +1791,12 @@ void MainWindow::preprocessItem()
     if (pathName[0] != '/')
         pathName = "/" + pathName;
 #endif
-    // Not sure why this doesn't work here:
-//    ui->tabWidget->show();
-    int cnt = 0;
-
-    QProgressDialog progressDialog(this,
-                                   Qt:: Dialog |
-                                   //Qt:: FramelessWindowHint |
-                                   Qt:: WindowTitleHint |
-                                   Qt:: CustomizeWindowHint);
-
-    progressDialog.setCancelButtonText(0);
-    progressDialog.setRange(0, fileList.size());
-    progressDialog.setWindowTitle(tr("Preprocessing Files"));
-
-    int successCnt = 0;
-    int failCnt = 0;
-
+    // Prefix path to each file in list
     for (int i = 0; i < fileList.size(); i++)
-    {
-        QString fileName = pathName + fileList[i];
-
-        progressDialog.setValue(cnt++);
-        progressDialog.setLabelText(tr("Preprocessing %1...")
-                                    .arg(fileName));
-        qApp->processEvents();
-
-        // Now preprocess fileName, and force generation
-        // (i.e. ignore if the current preprocessed file is "current"
-        if (preprocessFile(fileName, true))
-            ++successCnt;
-        else
-            ++failCnt;
-    }
-
-    ostringstream result;
-    result << successCnt << " succeeded, " << failCnt << " failed.\n";
-    QPlainTextEditAppendText(ui->outputTextEdit, QString::fromStdString(result.str()));
+        fileList[i] = pathName + fileList[i];
 
-    if (failCnt)
-    {
-        QPlainTextEditAppendText(ui->outputTextEdit, "Errors occurred!\n", Qt::red);
-    }
+    // Preprocess on a worker thread so the project can still be browsed
+    startBatch(BATCH_PREPROCESS, fileList);
 }
 
 // Instrument file or folder
@@ -1809,47 +1845,12 @@ void MainWindow::instrumentItem()
         pathName = "/" + pathName;
 #endif
 
-    // Not sure why this doesn't work here:
-//    ui->tabWidget->show();
-    int cnt = 0;
-
-    QProgressDialog progressDialog(this,
-                                   Qt:: Dialog |
-                                   //Qt:: FramelessWindowHint |
-                                   Qt:: WindowTitleHint |
-                                   Qt:: CustomizeWindowHint);
-
-    progressDialog.setCancelButtonText(0);
-    progressDialog.setRange(0, fileList.size());
-    progressDialog.setWindowTitle(tr("Instrumenting Files"));
-
-    int successCnt = 0;
-    int failCnt = 0;
-
+    // Prefix path to each file in list
     for (int i = 0; i < fileList.size(); i++)
-    {
-        QString fileName = pathName + fileList[i];
-
-        progressDialog.setValue(cnt++);
-        progressDialog.setLabelText(tr("Instrumenting %1...")
-                                    .arg(fileName));
-        qApp->processEvents();
-
-        // Now instrument fileName
-        if (instrumentFile(fileName))
-            ++successCnt;
-        else
-            ++failCnt;
-    }
-
-    ostringstream result;
-    result << successCnt << " succeeded, " << failCnt << " failed.\n";
-    QPlainTextEditAppendText(ui->outputTextEdit, QString::fromStdString(result.str()));
+        fileList[i] = pathName + fileList[i];
 
-    if (failCnt)
-    {
-        QPlainTextEditAppendText(ui->outputTextEdit, "Errors occurred!\n", Qt::red);
-    }
+    // Instrument on a worker thread so the project can still be browsed
+    startBatch(BATCH_INSTRUMENT, fileList);
 }
 
 // Process file or folder
@@ -1887,55 +1888,12 @@ void MainWindow::processItem()
         pathName = "/" + pathName;
 #endif
 
-    int cnt = 0;
-
-    QProgressDialog progressDialog(this,
-                                   Qt:: Dialog |
-                                   //Qt:: FramelessWindowHint |
-                                   Qt:: WindowTitleHint |
-                                   Qt:: CustomizeWindowHint);
-
-    progressDialog.setCancelButtonText(0);
-    progressDialog.setRange(0, fileList.size());
-    progressDialog.setWindowTitle(tr("Processing Files"));
-
-    int successCnt = 0;
-    int failCnt = 0;
-
+    // Prefix path to each file in list
     for (int i = 0; i < fileList.size(); i++)
-    {
-        QString fileName = pathName + fileList[i];
-
-        progressDialog.setValue(cnt++);
-        progressDialog.setLabelText(tr("Processing %1...")
-                                    .arg(fileName));
-        qApp->processEvents();
-
-        // Now process fileName
-        if (processFile(fileName))
-            ++successCnt;
-        else
-            ++failCnt;
-
-        // Update info for file
-        QStringList fileInfo;
-        fileInstInfo instInfo;
-        // Load .vrpt for file
-        loadFileInfo(fileName, instInfo);
-        // Load any instrumentation info from .vrpt file
-        getFileStats(instInfo, fileInfo);
-        // Insert file and stats into project tree
-        insertPath(fileName, fileInfo);
-    }
-
-    ostringstream result;
-    result << successCnt << " succeeded, " << failCnt << " failed.\n";
-    QPlainTextEditAppendText(ui->outputTextEdit, QString::fromStdString(result.str()));
+        fileList[i] = pathName + fileList[i];
 
-    if (failCnt)
-    {
-        QPlainTextEditAppendText(ui->outputTextEdit, "Errors occurred!\n", Qt::red);
-    }
+    // Generate reports in the background so the project can still be browsed
+    startBatch(BATCH_PROCESS, fileList);
 }
 
 // Add files to project
@@ -2093,7 +2051,7 @@ bool MainWindow::getPreProcFilename(QString fileName, QString &pathName, QString
             }
             else
             {
-                QMessageBox::warning(0, QString("Warning"), QString("Specified file %1 not in project path %2")
+                reportError(QString("Warning"), QString("Specified file %1 not in project path %2")
                                       .arg(fileName)
                                       .arg(projectDirName));
                 return false;
@@ -2289,101 +2247,36 @@ bool MainWindow::getHtmlFilename(QString fileName, QString &outPath, QString &ht
     return true;
 }
 
-// Take preprocessed source and remove all linemarkers of the form:
-// # linenum filename flags
-// Save useful linemarkers to a preprocessed map file in the same directory as the preprocessed file
-bool MainWindow::mapPreprocessedSource(QString &source, QString fileName, QString &preProcFileName)
+// Save line markers taken from preprocessed source to a preprocessed map
+// file in the same directory as the preprocessed file
+bool MainWindow::saveLineMap(PPMap &lineMap, QString fileName, QString &preProcFileName)
 {
     // Remove file extension and add new .ppmap extension
     int index = preProcFileName.lastIndexOf(".");
     if (index < 0)
     {
-        QMessageBox::critical(0, QString("Error"), QString("Illegal preprocessed filename %1")
+        reportError(QString("Error"), QString("Illegal preprocessed filename %1")
                               .arg(preProcFileName));
         return false;
     }
 
-    QString preprocMapName = preProcFileName.left(index) + ".ppmap";
-    QFile ppMapFile(preprocMapName);
-    if (!ppMapFile.open(QFile::WriteOnly | QFile::Truncate))
-    {
-        QMessageBox::critical(this, tr("Error"), tr("Cannot create map file %1:\n%2")
-                             .arg(fileName)
-                             .arg(ppMapFile.errorString()));
-        return false;
-    }
-
-    QTextStream ppMapOut(&ppMapFile);
-    ppMapOut << "{\n  \"filename\": \"" << fileName << "\",\n";
-    ppMapOut << "  \"preproc_filename\": \"" << preProcFileName << "\",\n";
-    ppMapOut << "  \"linemarkers\":\n  [";
-    bool gotMarker = false;    // Flag when linemarker added
-
-    QString newSrc;
-    int lineNum = 1;
-    bool startLine = true;
+    QString preprocMapName = preProcFileName.left(index) + PPMAP_EXT;
 
-    // Search for # at start of line
-    // Count line numbers whenever a '\n' is encountered
-    for (int i = 0; i < source.size(); ++i)
+    lineMap.fileName = fileName.toStdString();
+    lineMap.ppFileName = preProcFileName.toStdString();
+    if (!lineMap.save(preprocMapName.toStdString()))
     {
-        if (startLine && (source[i] == '#') && (source[i + 1] == ' '))
-        {
-            // Linemarker found - handle it
-            i += 2; // Skip # and space
-            int curLine = 0;
-            while ((source[i] >= '0') && (source[i] <= '9'))
-                curLine = curLine * 10 + source[i++].digitValue();
-
-            i += 2; // Skip space and "
-            QString srcName;
-            while (source[i] != '"')
-                srcName += source[i++];
-
-            // Skip to end of line
-            while (source[i] != '\n')
-                ++i;
-
-            // Now do something useful with curLine and fileName
-            // Weed out things like "<command-line" and "<built-in>"
-            if (srcName[0] != '<')
-            {
-//                if (srcName == fileName)
-//                    cout << "Match";
-                if (gotMarker)
-                    ppMapOut << ",";
-                else
-                    gotMarker = true;
-
-                ppMapOut << "\n    [ " << lineNum << ", " << curLine << ", ";
-                ppMapOut << "\"" << srcName << "\" ]";
-            }
-        }
-        else
-        {
-            newSrc += source[i];
-            if (source[i] == '\n')
-            {
-                ++lineNum;
-                startLine = true;
-            }
-            else
-                startLine = false;
-        }
+        reportError(tr("Error"), tr("Cannot create map file %1")
+                             .arg(preprocMapName));
+        return false;
     }
 
-    ppMapOut << "\n  ]\n}\n";
-    ppMapOut.flush();
-    ppMapFile.close();
-
-    // Return preprocessed source minus the linemarkers
-    source = newSrc;
-
     return true;
 }
 
 // Preprocess specified file
-bool MainWindow::preprocessFile(QString fileName, bool force)
+// result, if given, is the built-in preprocessor output from a batch worker
+bool MainWindow::preprocessFile(QString fileName, bool force, PREPROC_RESULT *result)
 {
     QString pathName;
     QString preProcFileName;
@@ -2391,7 +2284,7 @@ bool MainWindow::preprocessFile(QString fileName, bool force)
     // Get path and filename of preprocessed file
     if (!getPreProcFilename(fileName, pathName, preProcFileName))
     {
-        QMessageBox::critical(0, QString("Error"), QString("Illegal filename %1")
+        reportError(QString("Error"), QString("Illegal filename %1")
                               .arg(preProcFileName));
         return false;
     }
@@ -2399,7 +2292,7 @@ bool MainWindow::preprocessFile(QString fileName, bool force)
 
     if (preProcFileName == fileName)
     {
-        QMessageBox::critical(0, QString("Error"), QString("Will overwrite original - either directory or suffix must be non-null"));
+        reportError(QString("Error"), QString("Will overwrite original - either directory or suffix must be non-null"));
         return false;
     }
 
@@ -2407,10 +2300,10 @@ bool MainWindow::preprocessFile(QString fileName, bool force)
     QDir preProcDir(pathName);
     if (!preProcDir.exists(pathName))
     {
-        QPlainTextEditAppendText(ui->outputTextEdit, "Creating directory " + pathName + "\n");
+        emit batchOutput("Creating directory " + pathName + "\n");
         if (!preProcDir.mkpath("."))
         {
-            QMessageBox::critical(0, QString("Error"), QString("Could not create directory %1")
+            reportError(QString("Error"), QString("Could not create directory %1")
                                   .arg(pathName));
             return false;
         }
@@ -2439,34 +2332,45 @@ bool MainWindow::preprocessFile(QString fileName, bool force)
     if (doPreProc)
     {
       QString ppSource;
+      PPMap lineMap;
 
-      QPlainTextEditAppendText(ui->outputTextEdit, "Preprocessing ");
-      QPlainTextEditAppendText(ui->outputTextEdit, fileName, Qt::blue);
-      QPlainTextEditAppendText(ui->outputTextEdit, " ...\n");
-      appendAnsiText(ui->errorTextEdit,  "\033[37m-----\033[0m\033[30m " + preProcFileName + " \033[0m\033[37m-----\033[0m\n\n");
+      emit batchOutput("Preprocessing ");
+      emit batchOutput(fileName, Qt::blue);
+      emit batchOutput(" ...\n");
+      emit batchError("\033[37m-----\033[0m\033[30m " + preProcFileName + " \033[0m\033[37m-----\033[0m\n\n");
 
       if (vcPreProcData.useVampPreprocessor)
       {
-          // Use internal preprocessor
-          VampPreprocessor vampPreproc;
-          string outStr, errStr;
+          // Use internal preprocessor (the batch's if there is one),
+          // unless a batch worker already has
+          PREPROC_RESULT ppResult;
+          if (result == NULL)
+          {
+              VampPreprocessor localPreproc;
+              runVampPreprocessor(batchPreproc ? *batchPreproc : localPreproc,
+                                  fileName, ppResult);
+              result = &ppResult;
+          }
 
-          retVal = vampPreproc.Preprocess(fileName.toUtf8().data(), outStr, errStr, vcPreProcData);
-          appendAnsiText(ui->errorTextEdit, QString::fromStdString(errStr));
+          if (result->cached)
+              emit batchOutput("Using cached preprocessor output\n");
+          emit batchError(QString::fromStdString(result->errStr));
 
+          retVal = result->success;
           if (retVal)
           {
-              ppSource = QString::fromStdString(outStr.c_str());
-
+              ppSource = QString::fromStdString(result->outStr);
+              lineMap = result->lineMap;
           }
-        }
+      }
       else
       {
         // Call external preprocessor
-        // Create a process to perform preprocessing
-        myProcess = new QProcess(this);
+        // Create a process to perform preprocessing (no parent as this
+        // may run on a batch thread)
+        QProcess ppProcess;
         // Set path to where project vamp.cfg lives
-        myProcess->setWorkingDirectory(projectDirName);
+        ppProcess.setWorkingDirectory(projectDirName);
 
 //        connect (myProcess, SIGNAL(readyReadStandardOutput()), this, SLOT(printOutput()));
 //        connect (myProcess, SIGNAL(readyReadStandardError()), this, SLOT(printError()));
@@ -2511,17 +2415,28 @@ bool MainWindow::preprocessFile(QString fileName, bool force)
 //        preProcArgs.replaceInStrings("%outfile%", preProcFileName, Qt::CaseInsensitive);
 
         // Start specified preprocessor
-        myProcess->start(QString::fromStdString(vcPreProcData.preProcPath), preProcArgs);
-        myProcess->waitForFinished();
+        ppProcess.start(QString::fromStdString(vcPreProcData.preProcPath), preProcArgs);
+        ppProcess.waitForFinished(-1);
 
-        QByteArray ppSrcArray = myProcess->readAllStandardOutput();
-        ppSource = QString(ppSrcArray);
+        QByteArray ppSrcArray = ppProcess.readAllStandardOutput();
+        if (vcPreProcData.showLineMarkers)
+        {
+            // Move linemarkers into map
+            string ppText;
+            {
+                vamp_linemarker_ostream ppOut(ppText, lineMap);
+                ppOut.write(ppSrcArray.constData(), ppSrcArray.size());
+            }
+            ppSource = QString::fromStdString(ppText);
+        }
+        else
+            ppSource = QString(ppSrcArray);
 
-        QByteArray ppErrArray = myProcess->readAllStandardError();
+        QByteArray ppErrArray = ppProcess.readAllStandardError();
 //        QString ppErr = QString(ppErrArray);
 
 //        QPlainTextEditAppendText(ui->outputTextEdit, ppErrArray);
-        QPlainTextEditAppendText(ui->errorTextEdit, ppErrArray);
+        emit batchError(QString(ppErrArray));
 /*
         cout << "Normal Exit = " << (int) (myProcess->exitStatus() == QProcess::NormalExit) << "\n";
         if (myProcess->exitStatus() != QProcess::NormalExit)
@@ -2538,15 +2453,15 @@ bool MainWindow::preprocessFile(QString fileName, bool force)
       {
           if (vcPreProcData.showLineMarkers)
           {
-              // Strip linemarkers and build database mapping preprocessed lines to source lines
-              if (!mapPreprocessedSource(ppSource, fileName, preProcFileName))
+              // Save database mapping preprocessed lines to source lines
+              if (!saveLineMap(lineMap, fileName, preProcFileName))
                   return false;
           }
 
           QFile ppoFile(preProcFileName);
           if (!ppoFile.open(QFile::WriteOnly | QFile::Truncate))
           {
-              QMessageBox::critical(this, tr("Error"), tr("Cannot create file %1:\n%2")
+              reportError(tr("Error"), tr("Cannot create file %1:\n%2")
                                    .arg(fileName)
                                    .arg(ppoFile.errorString()));
               return false;
@@ -2557,14 +2472,14 @@ bool MainWindow::preprocessFile(QString fileName, bool force)
           ppOut.flush();
           ppoFile.close();
 
-          QPlainTextEditAppendText(ui->outputTextEdit, "Preprocessing complete.\n");
+          emit batchOutput("Preprocessing complete.\n");
       }
       else
       {
           //QPlainTextEditAppendText(ui->outputTextEdit, "\nFatal error(s) occurred - instrumentation aborted\n");
 
-          QPlainTextEditAppendText(ui->outputTextEdit, "Preprocessing ");
-          QPlainTextEditAppendText(ui->outputTextEdit, "failed.\n", Qt::red);
+          emit batchOutput("Preprocessing ");
+          emit batchOutput("failed.\n", Qt::red);
       }
     }
 
@@ -2594,9 +2509,9 @@ bool MainWindow::instrumentFile(QString fileName)
     QString pathName;
     getPreProcFilename(fileName, pathName, inName);
 
-    QPlainTextEditAppendText(ui->outputTextEdit, "Instrumenting ");
-    QPlainTextEditAppendText(ui->outputTextEdit, fileName, Qt::blue);
-    QPlainTextEditAppendText(ui->outputTextEdit, " ...\n");
+    emit batchOutput("Instrumenting ");
+    emit batchOutput(fileName, Qt::blue);
+    emit batchOutput(" ...\n");
 
     // FIXME: Check dates and see if instrumentation needed
 
@@ -2665,11 +2580,37 @@ bool MainWindow::instrumentFile(QString fileName)
     char respath[512];
     char *pth = realpath(argv[1], respath);
     vErr << "\033[37m+++++\033[0m\033[30m " << pth << " \033[0m\033[37m+++++\033[0m\n\n";
+
+    // Leave out probes already covered by earlier runs, if the combined
+    // history (or coverage carried forward) still matches the source
+    VAMP_COVERED_PROBES covered;
+    bool gotCovered = false;
+    int ext = outName.lastIndexOf(".");
+    QString jsonName = outName.left(ext) + ".json";
+    if (vcData.skipCovered && (ext != -1) && QFile::exists(jsonName))
+    {
+        ostringstream cOut;
+        ostringstream cErr;
+        VampProcess vampProcess(&cOut, &cErr);
+        QByteArray jName = jsonName.toUtf8();
+        gotCovered = vampProcess.getCoveredProbes(jName.data(), vcReportData, covered);
+        if (gotCovered)
+        {
+            emit batchOutput("Skipping probes covered by " + jsonName + "\n");
+        }
+        else
+        {
+            emit batchError(QString::fromStdString(cErr.str()));
+            emit batchOutput("No usable coverage history - instrumenting all probes\n");
+        }
+    }
+
 // FIXME: vcData is already computed. vamp.Instrument parses vamp.cfg!
 //    vamp.Instrument(2, argv, vcData.langStandard);
-    bool success = vamp->Instrument(2, argv, outName.toStdString(), vcData);
-    QPlainTextEditAppendText(ui->outputTextEdit, QString::fromStdString(vOut.str()));
-    appendAnsiText(ui->errorTextEdit, QString::fromStdString(vErr.str()));
+    bool success = vamp->Instrument(2, argv, outName.toStdString(), vcData,
+                                    gotCovered ? &covered : NULL);
+    emit batchOutput(QString::fromStdString(vOut.str()));
+    emit batchError(QString::fromStdString(vErr.str()));
 
     delete vamp;
 
@@ -2683,8 +2624,8 @@ bool MainWindow::instrumentFile(QString fileName)
 
     string coutString = coutOutput.str();
     string cerrString = cerrOutput.str();
-    QPlainTextEditAppendText(ui->outputTextEdit, QString::fromStdString(coutString));
-    QPlainTextEditAppendText(ui->errorTextEdit, QString::fromStdString(cerrString));
+    emit batchOutput(QString::fromStdString(coutString));
+    emit batchError(QString(QString::fromStdString(cerrString)));
     cout.rdbuf(cout_strbuf);
     cerr.rdbuf(cerr_strbuf);
 #endif
@@ -2693,145 +2634,748 @@ bool MainWindow::instrumentFile(QString fileName)
     return success;
 }
 
-// Process results for specified file
-bool MainWindow::processFile(QString fileName)
+// Create job to process results for specified file
+// Returns 0 if the file name is not usable
+ProcessJob *MainWindow::createProcessJob(QString fileName)
 {
     // Get path to .json file (instrumentation)
     QString instrPath;
     QString instrFileName;
     getInstrFilename(fileName, instrPath, instrFileName);
-//    QString pathName;
-//    QString shortFileName;
-//    getDirFileNames(instrFileName, pathName, shortFileName);
-//    int i = shortFileName.lastIndexOf(".");
     int i = instrFileName.lastIndexOf(".");
     if (i == -1)
     {
-        QMessageBox::critical(0, QString("Error"), QString("Illegal filename %1")
+        reportError(QString("Error"), QString("Illegal filename %1")
                               .arg(instrFileName));
-        return false;
+        return 0;
     }
 
-//    addPath(vcData.saveDirectory, pathName);
-/*    if (!vcData.saveDirectory.isEmpty())
-        pathName += vcData.saveDirectory + "/";*/
-//    QString procFileName = pathName + shortFileName.left(i) + QString::fromStdString(vcReportData.htmlSuffix) + ".json";
     QString procFileName = instrFileName.left(i) + ".json";
 
-//    QPlainTextEditAppendText(ui->outputTextEdit, "Processing results from " + procFileName + " ...\n");
-    QPlainTextEditAppendText(ui->outputTextEdit, "Processing results from ");
-    QPlainTextEditAppendText(ui->outputTextEdit, procFileName + " ...\n", Qt::blue);
-
-#ifdef USE_PROCESS
-    // Create process to perform instrumentation
-    myProcess = new QProcess(this);
-    myProcess->setProcessChannelMode(QProcess::MergedChannels);
-
-    connect (myProcess, SIGNAL(readyReadStandardOutput()), this, SLOT(printOutput()));
-    connect (myProcess, SIGNAL(readyReadStandardError()), this, SLOT(printError()));
-
-    QString program = "./vamp_process";
-    QStringList arguments;
-    arguments.push_back(procFileName);
-    myProcess->start(program, arguments);
-    myProcess->waitForFinished();
-#else
-/*    static char argv0[] = "./vamp_process";
-    char *argv[2];
-    argv[0] = argv0;//"./vamp_process";
-    QByteArray fName = fileName.toUtf8();
-    argv[1] = fName.data();
-*/
-
-    // Set path to where project vamp.cfg lives
-    QDir::setCurrent(projectDirName);
-    ostringstream vOut;
-    ostringstream vErr;
-
-    // Add a delimiter to error output
-    char respath[512];
-    char *pth = realpath(procFileName.toUtf8().data(), respath);
-//    vErr << "\033[37m+++++\033[0m\033[30m " << procFileName.toUtf8().data() << " \033[0m\033[37m+++++\033[0m\n\n";
-    vErr << "\033[37m+++++\033[0m\033[30m " << pth << " \033[0m\033[37m+++++\033[0m\n\n";
-
-    VampProcess vampProcess(&vOut, &vErr);
+    QString preProcPath;
+    QString preProcFileName;
     if (vcPreProcData.showLineMarkers)
-    {
-        QString preProcPath;
-        QString preProcFileName;
         getInstrFilename(fileName, preProcPath, preProcFileName);
 
-        vampProcess.processLineMarkers(preProcFileName.toUtf8().data());
-    }
-    QString htmlFileName;
-    QString htmlPath;
-    getHtmlFilename(fileName, htmlPath, htmlFileName);
-    bool processSuccess = vampProcess.processFile(procFileName.toUtf8().data(), vcReportData);
+    return new ProcessJob(procFileName.toStdString(),
+                          preProcFileName.toStdString(),
+                          vcPreProcData.showLineMarkers,
+                          vcReportData);
+}
+
+// Show buffered output of a finished process job
+bool MainWindow::showProcessJob(ProcessJob *job)
+{
+    emit batchOutput("Processing results from ");
+    emit batchOutput(
+                             QString::fromStdString(job->jsonName) + " ...\n", Qt::blue);
 
-    QPlainTextEditAppendText(ui->outputTextEdit, QString::fromStdString(vOut.str()));
-    appendAnsiText(ui->errorTextEdit, QString::fromStdString(vErr.str()));
-    if (!processSuccess)
+    emit batchOutput(QString::fromStdString(job->outStr));
+    emit batchError(QString::fromStdString(job->errStr));
+    if (!job->success)
     {
-        QPlainTextEditAppendText(ui->outputTextEdit, "Process results failed\n");
+        emit batchOutput("Process results failed\n");
     }
-    return processSuccess;
-#endif
+    return job->success;
 }
 
-// Show specified file in right-hand pane
-// isHtml is true if file is in HTML format
-// isHtml is false implies place file within <pre><file></pre>;
-// used when file is a source file
-void MainWindow::showHtmlFile(QString fileName, bool isHtml)
+// Show error in a message box, or in the error pane if called from a
+// background batch (message boxes can only be shown from the GUI thread)
+void MainWindow::reportError(QString title, QString msg)
 {
-    // read from file
-    QFile file(fileName);
+    if (QThread::currentThread() == qApp->thread())
+        QMessageBox::critical(this, title, msg);
+    else
+        emit batchError(title + ": " + msg + "\n");
+}
 
-    if (!file.open(QIODevice::ReadOnly)) {
-        QMessageBox::information(this, tr("Unable to open file"), tr("%1:\n%2")
-                                 .arg(fileName)
-                                 .arg(file.errorString()));
+// Start preprocessing, instrumenting or processing fileList on a worker
+// thread. Output arrives through batchOutput() and batchError() while the
+// project remains browsable.
+void MainWindow::startBatch(BATCH_TYPE type, QStringList fileList)
+{
+    // Reports started by the history watcher write the same outputs
+    if (batchWatcher.isRunning() || !watchJobs.isEmpty() ||
+        (watchPool.activeThreadCount() > 0))
+    {
+        QMessageBox::information(this, tr("Busy"),
+                                 tr("Wait for current operation to finish or cancel it."));
         return;
     }
 
-    // Set group box title to filename
-    ui->resultsGroupBox->setTitle(fileName);
+    QString title;
+    if (type == BATCH_PREPROCESS)
+        title = tr("Preprocessing Files");
+    else
+    if (type == BATCH_INSTRUMENT)
+        title = tr("Instrumenting Files");
+    else
+        title = tr("Processing Files");
 
-    // Enable display of file view
-    ui->resultsGroupBox->show();
-    ui->webView->show();
-    if (isHtml)
+    batchType = type;
+    batchFiles = fileList;
+    batchProjectFiles = getProjectFiles();
+    batchSuccessCnt = 0;
+    batchFailCnt = 0;
+    batchCancel.storeRelease(0);
+
+    // Set path to where project vamp.cfg lives
+    QDir::setCurrent(projectDirName);
+
+    // Hold off history watcher until these files are done
+    processingItems = true;
+
+    batchProgressDialog = new QProgressDialog(this,
+                                              Qt:: Dialog |
+                                              Qt:: WindowTitleHint |
+                                              Qt:: CustomizeWindowHint);
+    batchProgressDialog->setWindowModality(Qt::NonModal);
+    batchProgressDialog->setAutoClose(false);
+    batchProgressDialog->setAutoReset(false);
+    batchProgressDialog->setRange(0, fileList.size());
+    batchProgressDialog->setWindowTitle(title);
+    batchProgressDialog->setMinimumDuration(0);
+    connect(batchProgressDialog, SIGNAL(canceled()), this, SLOT(cancelBatch()));
+    batchProgressDialog->show();
+
+    batchWatcher.setFuture(QtConcurrent::run(this, &MainWindow::runBatch));
+}
+
+// Worker thread: work through batchFiles until done or cancelled
+void MainWindow::runBatch(void)
+{
+    if (batchType == BATCH_PROCESS)
     {
-        ui->webView->setUrl("file:///" + fileName);
+        runProcessBatch();
         return;
     }
+
+    // Built-in preprocessor output is cached in the project. One
+    // preprocessor is kept for the batch so its file lookups carry over.
+    if (vcPreProcData.useVampPreprocessor)
+        QDir(projectDirName).mkpath(PP_CACHE_DIR);
+    PreprocCache cache((projectDirName + PP_CACHE_DIR).toStdString());
+    VampPreprocessor preproc;
+    ppCache = &cache;
+    batchPreproc = &preproc;
+
+    if ((batchType == BATCH_PREPROCESS) && vcPreProcData.useVampPreprocessor)
+    {
+        runPreprocessBatch();
+    }
     else
     {
-#ifdef FORMAT_HTML
-        QTextStream out(&file);
-        QString output = out.readAll();
-#ifndef ENCODE_HTML
-        output.replace('<', "&lt;");
-        output.replace('>', "&gt;");
-        output.replace('&', "&amp;");
-#endif
+        // Files are instrumented one at a time as the instrumenter keeps
+        // global state
+        for (int i = 0; i < batchFiles.size(); i++)
+        {
+            if (batchCancel.loadAcquire())
+                break;
 
-        output = "<html><body><pre>" + output + "</pre></body></html>";
-        //output = "<textarea name=\"code\" class=\"c++\">" + output + "</textarea>";
-        //output = "<html><body><pre name=\"code\" class=\"c++\">" + output + "</pre></body></html>";
+            emit batchProgress(i, batchFiles[i]);
 
-        // display contents
-        ui->webView->setHtml(output);
-        ////ui->webView->setContent(output.toLocal8Bit());
-        //ui->webView->page()->setLinkDelegationPolicy(QWebPage::DelegateAllLinks);
-#else
-        ui->webView->setUrl("file:///" + fileName);
-        return;
-#endif
-    }
-}
+            bool success;
+            if (batchType == BATCH_PREPROCESS)
+            {
+                // Force generation (i.e. ignore if the current
+                // preprocessed file is "current")
+                success = preprocessFile(batchFiles[i], true);
+            }
+            else
+            {
+                success = instrumentFile(batchFiles[i]);
+            }
 
-// QPlainTextEdit doesn't autoscroll properly (probably when a line wraps
+            if (success)
+                ++batchSuccessCnt;
+            else
+                ++batchFailCnt;
+        }
+    }
+
+    ppCache = NULL;
+    batchPreproc = NULL;
+}
+
+// Run built-in preprocessor on fileName, through the batch's cache
+bool MainWindow::runVampPreprocessor(VampPreprocessor &preproc, QString fileName, PREPROC_RESULT &result)
+{
+    string name = fileName.toUtf8().data();
+
+    PPMap *lineMap = vcPreProcData.showLineMarkers ? &result.lineMap : NULL;
+
+    result.cached = false;
+    if (ppCache)
+        result.success = ppCache->preprocess(preproc, name, result.outStr, result.errStr,
+                                             vcPreProcData, lineMap, result.cached);
+    else
+        result.success = preproc.Preprocess(name, result.outStr, result.errStr,
+                                            vcPreProcData, lineMap);
+
+    result.done = true;
+    return result.success;
+}
+
+// Worker thread: run the built-in preprocessor on a pool sized to the
+// cores, writing results in file order as each finishes. Each worker
+// has its own preprocessor, so its own CompilerInstance and FileManager;
+// only the cache is shared.
+void MainWindow::runPreprocessBatch(void)
+{
+    vector<PREPROC_RESULT> results(batchFiles.size());
+    QMutex resultLock;
+    QWaitCondition resultReady;
+    int nextFile = 0;
+
+    for (int i = 0; i < results.size(); i++)
+        results[i].done = false;
+
+    QThreadPool pool;
+    pool.setMaxThreadCount(QThread::idealThreadCount());
+    for (int w = 0; w < pool.maxThreadCount(); w++)
+    {
+        QtConcurrent::run(&pool, [&]()
+        {
+            VampPreprocessor workerPreproc;
+            for (;;)
+            {
+                int i;
+                {
+                    QMutexLocker lock(&resultLock);
+                    if ((nextFile == batchFiles.size()) || batchCancel.loadAcquire())
+                        return;
+                    i = nextFile++;
+                }
+
+                PREPROC_RESULT result;
+                runVampPreprocessor(workerPreproc, batchFiles[i], result);
+
+                QMutexLocker lock(&resultLock);
+                results[i] = result;
+                resultReady.wakeAll();
+            }
+        });
+    }
+
+    for (int i = 0; i < batchFiles.size(); i++)
+    {
+        {
+            QMutexLocker lock(&resultLock);
+            while (!results[i].done &&
+                   !(batchCancel.loadAcquire() && (i >= nextFile)))
+                resultReady.wait(&resultLock, 20);
+        }
+
+        // Cancelled before file was started
+        if (!results[i].done)
+            break;
+
+        emit batchProgress(i, batchFiles[i]);
+
+        // Force generation (i.e. ignore if the current
+        // preprocessed file is "current")
+        if (preprocessFile(batchFiles[i], true, &results[i]))
+            ++batchSuccessCnt;
+        else
+            ++batchFailCnt;
+
+        // Output has been written - free it
+        string().swap(results[i].outStr);
+    }
+
+    pool.waitForDone();
+}
+
+// Worker thread: generate reports on a pool sized to the cores, showing
+// results in file order as each job finishes
+void MainWindow::runProcessBatch(void)
+{
+    QThreadPool pool;
+    pool.setMaxThreadCount(QThread::idealThreadCount());
+
+    QVector<ProcessJob *> jobs;
+    for (int i = 0; i < batchFiles.size(); i++)
+    {
+        ProcessJob *job = createProcessJob(batchFiles[i]);
+        jobs.push_back(job);
+        if (job)
+            pool.start(job);
+    }
+
+    bool cancelled = false;
+    for (int i = 0; i < jobs.size(); i++)
+    {
+        emit batchProgress(i, batchFiles[i]);
+
+        if (!jobs[i])
+        {
+            ++batchFailCnt;
+            continue;
+        }
+
+        while (!jobs[i]->isDone())
+        {
+            if (!cancelled && batchCancel.loadAcquire())
+            {
+                // Drop jobs not yet started; running ones finish
+                pool.clear();
+                cancelled = true;
+            }
+            if (pool.waitForDone(20) && !jobs[i]->isDone())
+                break;
+        }
+
+        if (jobs[i]->isDone())
+        {
+            if (showProcessJob(jobs[i]))
+                ++batchSuccessCnt;
+            else
+                ++batchFailCnt;
+        }
+
+        delete jobs[i];
+    }
+    pool.waitForDone();
+
+    if (!cancelled)
+        mergeProjectCoverage(batchProjectFiles);
+}
+
+// Worker thread: merge the header coverage and build variants of every
+// file in fileList whose report is current, so a merged report never
+// drops files or variants that were not reported this time. Files whose
+// inputs changed since their report are left out until it is regenerated.
+void MainWindow::mergeProjectCoverage(QStringList fileList)
+{
+    if (!vcReportData.mergeHeaders && !vcReportData.mergeVariants)
+        return;
+
+    HeaderCoverage headerCov;
+    VariantCoverage variantCov;
+    ostringstream mergeErr;
+
+    for (int i = 0; i < fileList.size(); i++)
+    {
+        ProcessJob *job = createProcessJob(fileList[i]);
+        if (job && job->checkUpToDate())
+        {
+            headerCov.addOutputs(job->outputs, &mergeErr);
+            variantCov.addOutputs(job->outputs, &mergeErr);
+        }
+        delete job;
+    }
+
+    if (!headerCov.empty())
+    {
+        ostringstream headerOut;
+        emit batchOutput("Merging header coverage ...\n", Qt::blue);
+        headerCov.genReports(&headerOut, &mergeErr);
+        emit batchOutput(QString::fromStdString(headerOut.str()));
+    }
+    if (!variantCov.empty())
+    {
+        ostringstream variantOut;
+        emit batchOutput("Merging build variants ...\n", Qt::blue);
+        variantCov.genReports(&variantOut, &mergeErr);
+        emit batchOutput(QString::fromStdString(variantOut.str()));
+    }
+    emit batchError(QString::fromStdString(mergeErr.str()));
+}
+
+// Show output from background batch
+void MainWindow::showBatchOutput(QString text, QColor color)
+{
+    QPlainTextEditAppendText(ui->outputTextEdit, text, color);
+}
+
+// Show errors from background batch
+void MainWindow::showBatchError(QString text)
+{
+    appendAnsiText(ui->errorTextEdit, text);
+}
+
+// Update progress as background batch starts on a file
+void MainWindow::showBatchProgress(int fileNum, QString fileName)
+{
+    if (batchProgressDialog == NULL)
+        return;
+
+    QString label;
+    if (batchType == BATCH_PREPROCESS)
+        label = tr("Preprocessing %1...");
+    else
+    if (batchType == BATCH_INSTRUMENT)
+        label = tr("Instrumenting %1...");
+    else
+        label = tr("Processing %1...");
+
+    batchProgressDialog->setValue(fileNum);
+    batchProgressDialog->setLabelText(label.arg(fileName));
+}
+
+// Cancel pressed - batch stops after the file(s) in progress
+void MainWindow::cancelBatch(void)
+{
+    batchCancel.storeRelease(1);
+    if (batchProgressDialog != NULL)
+        batchProgressDialog->setLabelText(tr("Cancelling..."));
+}
+
+// Cancel any background batch and wait for it to finish
+void MainWindow::stopBatch(void)
+{
+    if (batchWatcher.isRunning())
+    {
+        batchCancel.storeRelease(1);
+        batchWatcher.waitForFinished();
+    }
+}
+
+// Background batch done - summarize and refresh project tree
+void MainWindow::batchFinished(void)
+{
+    if (batchProgressDialog != NULL)
+    {
+        batchProgressDialog->deleteLater();
+        batchProgressDialog = NULL;
+    }
+
+    // Now gather the .vrpt summaries into the project tree, unless the
+    // project was closed while the batch ran
+    if ((batchType == BATCH_PROCESS) && (ui->projectTreeView->model() != NULL))
+    {
+        for (int i = 0; i < batchFiles.size(); i++)
+        {
+            // Update info for file
+            QStringList fileInfo;
+            fileInstInfo instInfo;
+            // Load .vrpt for file
+            loadFileInfo(batchFiles[i], instInfo);
+            // Load any instrumentation info from .vrpt file
+            getFileStats(instInfo, fileInfo);
+            // Insert file and stats into project tree
+            insertPath(batchFiles[i], fileInfo);
+        }
+
+        // Regenerated reports replace their entries in the coverage index
+        coverageIndex.save();
+    }
+    processingItems = false;
+
+    if (batchCancel.loadAcquire())
+        QPlainTextEditAppendText(ui->outputTextEdit, "Cancelled.\n", Qt::red);
+
+    ostringstream result;
+    result << batchSuccessCnt << " succeeded, " << batchFailCnt << " failed.\n";
+    QPlainTextEditAppendText(ui->outputTextEdit, QString::fromStdString(result.str()));
+
+    if (batchFailCnt)
+    {
+        QPlainTextEditAppendText(ui->outputTextEdit, "Errors occurred!\n", Qt::red);
+    }
+}
+
+// Full names of the project files
+QStringList MainWindow::getProjectFiles(void)
+{
+    QStringList fileList;
+    genFileList("", QModelIndex(), fileList);
+
+#ifndef _WIN32
+    // Insert starting '/' for non-WIN32 pathnames
+    for (int i = 0; i < fileList.size(); ++i)
+    {
+        if (fileList[i][0] != '/')
+            fileList[i] = "/" + fileList[i];
+    }
+#endif
+
+    return fileList;
+}
+
+// Get name of history file written by instrumented fileName when run
+QString MainWindow::getHistFilename(QString fileName)
+{
+    QString instrPath;
+    QString instrFileName;
+    if (!getInstrFilename(fileName, instrPath, instrFileName))
+        return "";
+
+    // History is named after the source that was instrumented
+    QString preProcPath;
+    QString preProcFileName;
+    if (!getPreProcFilename(fileName, preProcPath, preProcFileName))
+        return "";
+
+    QString histDirName;
+    QString histFileName;
+    getDirFileNames(preProcFileName, histDirName, histFileName);
+    int i = histFileName.lastIndexOf(".");
+    if (i != -1)
+        histFileName = histFileName.left(i);
+    histFileName += ".hist";
+
+    // Relative history directory is relative to the instrumented file
+    if (isAbsolutePath(vcReportData.histDirectory))
+        histDirName = fixPath(vcReportData.histDirectory, true);
+    else
+        histDirName = instrPath + fixPath(vcReportData.histDirectory, true);
+
+    return QDir::cleanPath(histDirName + histFileName);
+}
+
+// Get modification time of history file, or -1 if there is none
+static qint64 histModTime(QString histName)
+{
+    QFileInfo histInfo(histName);
+    if (!histInfo.exists())
+        return -1;
+
+    return histInfo.lastModified().toMSecsSinceEpoch();
+}
+
+// Start watching the history files of every project file
+void MainWindow::startHistWatch(void)
+{
+    stopHistWatch();
+    syncHistWatch();
+
+    QPlainTextEditAppendText(ui->outputTextEdit,
+                             tr("Watching %1 history files\n").arg(histFiles.size()), Qt::blue);
+}
+
+// Watch the history files of the current project files. Histories
+// already watched keep the last modification seen; for new ones only
+// histories written from now on are processed.
+void MainWindow::syncHistWatch(void)
+{
+    QHash<QString, qint64> oldModTimes = histModTimes;
+
+    if (!histWatcher->directories().isEmpty())
+        histWatcher->removePaths(histWatcher->directories());
+    if (!histWatcher->files().isEmpty())
+        histWatcher->removePaths(histWatcher->files());
+
+    histFiles.clear();
+    histModTimes.clear();
+
+    QSet<QString> watched;
+    QStringList fileList = getProjectFiles();
+
+    for (int i = 0; i < fileList.size(); ++i)
+    {
+        QString fileName = fileList[i];
+        QString histName = getHistFilename(fileName);
+        if (histName.isEmpty())
+            continue;
+
+        histFiles.insert(histName, fileName);
+        histModTimes.insert(histName, oldModTimes.contains(histName) ?
+                                      oldModTimes.value(histName) :
+                                      histModTime(histName));
+        watchHistPath(histName, watched);
+    }
+}
+
+// Watch the directory of histName, which catches new or replaced files,
+// and the file itself, which catches rewrites. A directory that doesn't
+// exist yet is covered by watching the nearest one above it that does.
+// watched holds the paths already being watched.
+void MainWindow::watchHistPath(QString histName, QSet<QString> &watched)
+{
+    QString histDirName = QFileInfo(histName).absolutePath();
+    while (!QDir(histDirName).exists() && !QDir(histDirName).isRoot())
+        histDirName = QFileInfo(histDirName).absolutePath();
+
+    if (!watched.contains(histDirName))
+    {
+        histWatcher->addPath(histDirName);
+        watched.insert(histDirName);
+    }
+    if (QFile::exists(histName) && !watched.contains(histName))
+    {
+        histWatcher->addPath(histName);
+        watched.insert(histName);
+    }
+}
+
+// Stop watching history files, waiting for any reports in progress
+void MainWindow::stopHistWatch(void)
+{
+    histTimer.stop();
+
+    if (!histWatcher->directories().isEmpty())
+        histWatcher->removePaths(histWatcher->directories());
+    if (!histWatcher->files().isEmpty())
+        histWatcher->removePaths(histWatcher->files());
+
+    histFiles.clear();
+    histModTimes.clear();
+
+    watchPool.waitForDone();
+    checkWatchJobs();
+
+    // Let any merge started by the last reports finish
+    watchPool.waitForDone();
+}
+
+// Project->Watch History toggled
+void MainWindow::on_action_Watch_History_triggered(bool checked)
+{
+    if (checked)
+        startHistWatch();
+    else
+        stopHistWatch();
+}
+
+// A history file or directory changed. Wait for things to settle,
+// as a test run may write many histories in a burst.
+void MainWindow::histChanged(const QString &path)
+{
+    histTimer.start(HIST_WATCH_DELAY);
+}
+
+// Regenerate reports for files whose history has changed
+void MainWindow::processChangedHistories(void)
+{
+    // Try again later if reports are already being generated or merged
+    if (processingItems || batchWatcher.isRunning() || !watchJobs.isEmpty() ||
+        watchPool.activeThreadCount() > 0)
+    {
+        histTimer.start(HIST_WATCH_DELAY);
+        return;
+    }
+
+    // Pick up history directories created since, and replaced files,
+    // which drop out of the watch list
+    QSet<QString> watched = histWatcher->directories().toSet() +
+                            histWatcher->files().toSet();
+
+    QStringList changedFiles;
+    QHash<QString, qint64>::iterator i = histModTimes.begin();
+    while (i != histModTimes.end())
+    {
+        watchHistPath(i.key(), watched);
+
+        qint64 modTime = histModTime(i.key());
+        if (modTime != i.value())
+        {
+            i.value() = modTime;
+            if (modTime != -1)
+                changedFiles.push_back(histFiles.value(i.key()));
+        }
+        ++i;
+    }
+
+    if (changedFiles.isEmpty())
+        return;
+
+    QDir::setCurrent(projectDirName);
+    watchPool.setMaxThreadCount(QThread::idealThreadCount());
+
+    for (int j = 0; j < changedFiles.size(); ++j)
+    {
+        ProcessJob *job = createProcessJob(changedFiles[j]);
+        if (job)
+        {
+            watchJobs.push_back(job);
+            watchJobFiles.push_back(changedFiles[j]);
+            watchPool.start(job);
+        }
+    }
+
+    watchJobTimer.start();
+}
+
+// Show finished watcher reports in order and update their tree rows
+void MainWindow::checkWatchJobs(void)
+{
+    bool reported = false;
+
+    while (!watchJobs.isEmpty() && watchJobs.front()->isDone())
+    {
+        ProcessJob *job = watchJobs.front();
+        QString fileName = watchJobFiles.front();
+
+        if (showProcessJob(job))
+            reported = true;
+        delete job;
+        watchJobs.pop_front();
+        watchJobFiles.pop_front();
+
+        QStringList fileInfo;
+        fileInstInfo instInfo;
+        loadFileInfo(fileName, instInfo);
+        getFileStats(instInfo, fileInfo);
+        insertPath(fileName, fileInfo);
+    }
+
+    if (watchJobs.isEmpty())
+    {
+        watchJobTimer.stop();
+        coverageIndex.save();
+
+        // Fold the new reports into the merged ones, off the GUI thread
+        if (reported)
+            QtConcurrent::run(&watchPool, this, &MainWindow::mergeProjectCoverage,
+                              getProjectFiles());
+    }
+}
+
+// Show specified file in right-hand pane
+// isHtml is true if file is in HTML format
+// isHtml is false implies place file within <pre><file></pre>;
+// used when file is a source file
+void MainWindow::showHtmlFile(QString fileName, bool isHtml)
+{
+    // read from file
+    QFile file(fileName);
+
+    if (!file.open(QIODevice::ReadOnly)) {
+        QMessageBox::information(this, tr("Unable to open file"), tr("%1:\n%2")
+                                 .arg(fileName)
+                                 .arg(file.errorString()));
+        return;
+    }
+
+    // Set group box title to filename
+    ui->resultsGroupBox->setTitle(fileName);
+
+    // Enable display of file view
+    ui->resultsGroupBox->show();
+    ui->webView->show();
+    if (isHtml)
+    {
+        ui->webView->setUrl("file:///" + fileName);
+        return;
+    }
+    else
+    {
+#ifdef FORMAT_HTML
+        QTextStream out(&file);
+        QString output = out.readAll();
+#ifndef ENCODE_HTML
+        output.replace('<', "&lt;");
+        output.replace('>', "&gt;");
+        output.replace('&', "&amp;");
+#endif
+
+        output = "<html><body><pre>" + output + "</pre></body></html>";
+        //output = "<textarea name=\"code\" class=\"c++\">" + output + "</textarea>";
+        //output = "<html><body><pre name=\"code\" class=\"c++\">" + output + "</pre></body></html>";
+
+        // display contents
+        ui->webView->setHtml(output);
+        ////ui->webView->setContent(output.toLocal8Bit());
+        //ui->webView->page()->setLinkDelegationPolicy(QWebPage::DelegateAllLinks);
+#else
+        ui->webView->setUrl("file:///" + fileName);
+        return;
+#endif
+    }
+}
+
+// QPlainTextEdit doesn't autoscroll properly (probably when a line wraps
 // If scrollbar is 95% down, force an autoscroll
 void MainWindow::QPlainTextEditAppendText(QPlainTextEdit* editor, QString text, QColor color)
 {
@@ -2987,9 +3531,15 @@ void MainWindow::addFiles(QString startDir)
         projectChanged = true;
     }
 
+    coverageIndex.save();
+
     // Recompute base path since something's been added to tree
     getBasePath();
     //cout << "BaseDir = " << baseDir.toStdString() << endl << flush;
+
+    // Start watching histories of added files
+    if (ui->action_Watch_History->isChecked())
+        syncHistWatch();
 }
 
 // File->Exit called
@@ -3178,6 +3728,14 @@ void MainWindow::on_actionSave_Project_triggered()
 // Project->Edit Configuration called
 void MainWindow::on_actionEdit_Configuration_triggered()
 {
+    // Background batch reads the configuration as it goes
+    if (batchWatcher.isRunning())
+    {
+        QMessageBox::information(this, tr("Busy"),
+                                 tr("Wait for current operation to finish or cancel it."));
+        return;
+    }
+
     editConfig();
 }
 
@@ -3186,6 +3744,10 @@ void MainWindow::on_action_Close_Project_triggered()
 {
     if (saveProject(true))
     {
+        // Finish with batch and history watcher while tree is still present
+        stopBatch();
+        stopHistWatch();
+
         // Empty tree
         QAbstractItemModel *model = ui->projectTreeView->model();
         int rowCnt = model->rowCount();
@@ -3194,6 +3756,9 @@ void MainWindow::on_action_Close_Project_triggered()
         // Reset column headers
         ui->projectTreeView->setModel(NULL);
 
+        // Forget coverage totals for project
+        coverageIndex.clear();
+
         // Disable tree view for project
         ui->projectGroupBox->hide();
         ui->projectTreeView->hide();
@@ -3225,6 +3790,10 @@ void MainWindow::on_action_Close_Project_triggered()
         // Disable Project menu option "Generate vamp_output.c"
         ui->action_Generate_vamp_output_c->setEnabled(false);
 
+        // Disable Project menu option "Watch History"
+        ui->action_Watch_History->setChecked(false);
+        ui->action_Watch_History->setEnabled(false);
+
         projectChanged = false;
     }
 }
@@ -3316,6 +3885,247 @@ void MainWindow::on_action_Print_Summary_triggered()
     delete document;
 }
 
+// Generate vamp_output.c and vamp_output.h for files built with
+// register_probes. Each file owns its probe tables and registers a
+// struct _vamp_tu, either in the vamp_tu linker section or (for
+// shared libraries built with VAMP_SHARED) from a constructor.
+// With probe_shards, the shards of each table are merged as they are sent.
+void MainWindow::genRegisteredOutput(QTextStream &out, QTextStream &hOut)
+{
+    hOut << "#ifndef _VAMP_OUTPUT_H\n";
+    hOut << "#define _VAMP_OUTPUT_H\n\n";
+    hOut << "struct _vamp_tu {\n";
+    hOut << "  const char *name;\n";
+    hOut << "  unsigned char *stmt;\n";
+    hOut << "  unsigned int *stmt_count;\n";
+    hOut << "  unsigned int stmt_size;\n";
+    hOut << "  unsigned char *branch;\n";
+    hOut << "  unsigned int branch_size;\n";
+    hOut << "  unsigned char *cond;\n";
+    hOut << "  unsigned int cond_size;\n";
+    hOut << "  unsigned char *mcdc_val_save;\n";
+    hOut << "  unsigned int mcdc_size;\n";
+    hOut << "  const unsigned int *mcdc_val_offset;\n";
+    hOut << "  unsigned long long *mcdc_stack;\n";
+    hOut << "  unsigned long long mcdc_val;\n";
+    hOut << "  unsigned char mcdc_stack_offset;\n";
+    hOut << "  unsigned int mcdc_stack_overflow;\n";
+    hOut << "  struct _vamp_tu *next;\n";
+    hOut << "};\n\n";
+    hOut << "extern void _vamp_register(struct _vamp_tu *tu);\n";
+    hOut << "extern void _vamp_unregister(struct _vamp_tu *tu);\n";
+    hOut << "extern unsigned char _vamp_mcdc_set_first(struct _vamp_tu *tu, unsigned char val, unsigned char bit);\n";
+    hOut << "extern unsigned char _vamp_mcdc_collect(struct _vamp_tu *tu, unsigned char result, unsigned short exprNum, unsigned char byteCnt);\n\n";
+    hOut << "#ifdef VAMP_SHARED\n";
+    hOut << "#define _VAMP_REGISTER_TU(tu) \\\n";
+    hOut << "  static void __attribute__((constructor)) tu##_ctor(void) { _vamp_register(&tu); } \\\n";
+    hOut << "  static void __attribute__((destructor)) tu##_dtor(void) { _vamp_unregister(&tu); }\n";
+    hOut << "#else\n";
+    hOut << "#define _VAMP_REGISTER_TU(tu) \\\n";
+    hOut << "  static struct _vamp_tu *tu##_reg __attribute__((used, section(\"vamp_tu\"))) = &tu;\n";
+    hOut << "#endif\n\n";
+
+    bool sharded = vcData.probeShards > 1;
+    if (sharded)
+    {
+        hOut << "/* Shard of the calling thread, 0 to " << vcData.probeShards - 1 << ". Define VAMP_SHARD_ID\n";
+        hOut << "   when building to supply your own, e.g. the core number on bare metal. */\n";
+        hOut << "#ifdef VAMP_SHARD_ID\n";
+        hOut << "#define _VAMP_SHARD (VAMP_SHARD_ID)\n";
+        hOut << "#else\n";
+        hOut << "extern __thread unsigned int _vamp_shard_slot;\n";
+        hOut << "extern unsigned int _vamp_shard_assign(void);\n";
+        hOut << "#define _VAMP_SHARD (_vamp_shard_slot ? _vamp_shard_slot - 1 : _vamp_shard_assign())\n";
+        hOut << "#endif\n\n";
+    }
+    hOut << "#endif\n";
+
+    out << "#include \"vamp_output.h\"\n\n";
+    out << "/* Records of statically linked files, gathered by the linker */\n";
+    out << "extern struct _vamp_tu *__start_vamp_tu[] __attribute__((weak));\n";
+    out << "extern struct _vamp_tu *__stop_vamp_tu[] __attribute__((weak));\n\n";
+    out << "/* Files of loaded shared libraries */\n";
+    out << "static struct _vamp_tu *_vamp_loaded;\n\n";
+    out << "void _vamp_register(struct _vamp_tu *tu)\n";
+    out << "{\n";
+    out << "  tu->next = _vamp_loaded;\n";
+    out << "  _vamp_loaded = tu;\n";
+    out << "}\n\n";
+    out << "void _vamp_unregister(struct _vamp_tu *tu)\n";
+    out << "{\n";
+    out << "  struct _vamp_tu **p;\n\n";
+    out << "  for (p = &_vamp_loaded; *p; p = &(*p)->next)\n";
+    out << "  {\n";
+    out << "    if (*p == tu)\n";
+    out << "    {\n";
+    out << "      *p = tu->next;\n";
+    out << "      break;\n";
+    out << "    }\n";
+    out << "  }\n";
+    out << "}\n\n";
+
+    if (sharded)
+    {
+        out << "#ifndef VAMP_SHARD_ID\n";
+        out << "/* Threads take shards in turn when they first reach a probe */\n";
+        out << "__thread unsigned int _vamp_shard_slot;\n";
+        out << "static unsigned int _vamp_shard_next;\n\n";
+        out << "unsigned int _vamp_shard_assign(void)\n";
+        out << "{\n";
+        out << "  unsigned int shard = __sync_fetch_and_add(&_vamp_shard_next, 1) % " << vcData.probeShards << ";\n\n";
+        out << "  _vamp_shard_slot = shard + 1;\n";
+        out << "  return shard;\n";
+        out << "}\n";
+        out << "#endif\n\n";
+
+        // Shards are padded to whole cache lines, as declared by vamp
+        out << "/* Combine entry j of every shard of a table */\n";
+        out << "static unsigned char _vamp_merge(const unsigned char *table, unsigned int size, unsigned int j)\n";
+        out << "{\n";
+        out << "  unsigned int stride = (size + " << PROBE_SHARD_ALIGN - 1 << ") / " <<
+               PROBE_SHARD_ALIGN << " * " << PROBE_SHARD_ALIGN << ";\n";
+        out << "  unsigned char val = 0;\n";
+        out << "  int s;\n\n";
+        out << "  for (s = 0; s < " << vcData.probeShards << "; ++s)\n";
+        out << "    val |= table[s * stride + j];\n";
+        out << "  return val;\n";
+        out << "}\n\n";
+        if (vcData.doStmtCount && !vcData.doStmtSingle && !vcData.doBranch)
+        {
+            int perLine = PROBE_SHARD_ALIGN / 4;
+            out << "static unsigned int _vamp_merge_count(const unsigned int *table, unsigned int size, unsigned int j)\n";
+            out << "{\n";
+            out << "  unsigned int stride = (size + " << perLine - 1 << ") / " <<
+                   perLine << " * " << perLine << ";\n";
+            out << "  unsigned int cnt = 0;\n";
+            out << "  int s;\n\n";
+            out << "  for (s = 0; s < " << vcData.probeShards << "; ++s)\n";
+            out << "    cnt += table[s * stride + j];\n";
+            out << "  return cnt;\n";
+            out << "}\n\n";
+        }
+    }
+
+    if (vcData.doMCDC)
+    {
+        int stackSize = vcData.mcdcStackSize;
+        out << "unsigned char _vamp_mcdc_set_first(struct _vamp_tu *tu, unsigned char val, unsigned char bit)\n";
+        out << "{\n  if (tu->mcdc_stack_offset < " << stackSize << ")\n  {\n";
+        out << "    tu->mcdc_stack[tu->mcdc_stack_offset++] = tu->mcdc_val;\n";
+        out << "    tu->mcdc_val = 1;\n";
+        out << "    if (val)\n";
+        out << "      tu->mcdc_val |= ((unsigned long long) 2 << bit);\n  }\n";
+        out << "  else\n  {\n";
+        out << "    tu->mcdc_stack_overflow = 1;\n  }\n";
+        out << "  return val;\n}\n\n";
+        out << "unsigned char _vamp_mcdc_collect(struct _vamp_tu *tu, unsigned char result, unsigned short exprNum, unsigned char byteCnt)\n";
+        out << "{\n";
+        out << "  unsigned long long testval;\n";
+        out << "  int i, j;\n";
+        out << "  if (tu->mcdc_stack_overflow == 0)\n";
+        out << "  {\n    i = tu->mcdc_val_offset[exprNum];\n";
+        out << "    do {\n      testval = 0;\n";
+        out << "      for (j = byteCnt - 1; j >= 0; j--)\n";
+        out << "      {\n        testval = (testval << 8) | tu->mcdc_val_save[i + j];\n";
+        out << "      }\n      i += byteCnt;\n";
+        out << "    } while ((testval != 0) && (testval != tu->mcdc_val));\n";
+        out << "    if (testval == 0)\n";
+        out << "    {\n      i -= byteCnt;\n";
+        out << "      for (j = 0; j < byteCnt; j++)\n";
+        out << "      {\n";
+        out << "        tu->mcdc_val_save[i++] = tu->mcdc_val & 0xff;\n";
+        out << "        tu->mcdc_val >>= 8;\n";
+        out << "      }\n    }\n";
+        out << "    if (tu->mcdc_stack_offset)\n";
+        out << "    {\n";
+        out << "      tu->mcdc_val = tu->mcdc_stack[--tu->mcdc_stack_offset];\n";
+        out << "    }\n";
+        out << "  }\n  else\n  {\n";
+        out << "    tu->mcdc_stack_overflow = exprNum + 1;\n";
+        out << "  }\n\n  return result;\n";
+        out << "}\n\n";
+    }
+
+    // Send one file's results in the same format as _vamp_output()
+    int opts = (vcData.doStmtSingle ? DO_STATEMENT_SINGLE : 0) |
+               (vcData.doStmtCount ? DO_STATEMENT_COUNT : 0) |
+               (vcData.doBranch ? DO_BRANCH : 0) |
+               (vcData.doMCDC ? DO_MCDC : 0) |
+               (vcData.doCC ? DO_CONDITION : 0);
+
+    // Sharded tables are merged by OR (bits) or sum (counts) as sent
+    QString stmtVal = sharded ? "_vamp_merge(tu->stmt, tu->stmt_size, j)" : "tu->stmt[j]";
+    QString countVal = sharded ? "_vamp_merge_count(tu->stmt_count, tu->stmt_size, j)" : "tu->stmt_count[j]";
+    QString branchVal = sharded ? "_vamp_merge(tu->branch, tu->branch_size, j)" : "tu->branch[j]";
+    QString condVal = sharded ? "_vamp_merge(tu->cond, tu->cond_size, j)" : "tu->cond[j]";
+
+    out << "static void _vamp_output_tu(struct _vamp_tu *tu)\n{\n";
+    out << "  const char *p;\n";
+    out << "  unsigned int j;\n";
+    out << "  unsigned int cnt;\n\n";
+    out << "  for (p = tu->name; *p; ++p)\n";
+    out << "    _vamp_send(*p);\n";
+    out << "  _vamp_send(0);\n\n";
+    out << "  _vamp_send(" << opts << ");\n\n";
+    out << "  _vamp_send(tu->stmt_size >> 8);\n";
+    out << "  _vamp_send(tu->stmt_size & 0xff);\n";
+    if (vcData.doStmtSingle || vcData.doBranch)
+    {
+        out << "  for (j = 0; j < tu->stmt_size; ++j)\n";
+        out << "    _vamp_send(" << stmtVal << ");\n";
+    }
+    else
+    if (vcData.doStmtCount)
+    {
+        out << "  for (j = 0; j < tu->stmt_size; ++j)\n";
+        out << "  {\n";
+        out << "    cnt = " << countVal << ";\n";
+        out << "    _vamp_send(cnt >> 24);\n";
+        out << "    _vamp_send((cnt >> 16) & 0xff);\n";
+        out << "    _vamp_send((cnt >> 8) & 0xff);\n";
+        out << "    _vamp_send(cnt & 0xff);\n";
+        out << "  }\n";
+    }
+
+    if (vcData.doBranch)
+    {
+        out << "  _vamp_send(tu->branch_size >> 8);\n";
+        out << "  _vamp_send(tu->branch_size & 0xff);\n";
+        out << "  for (j = 0; j < tu->branch_size; ++j)\n";
+        out << "    _vamp_send(" << branchVal << ");\n";
+    }
+
+    if (vcData.doCC)
+    {
+        out << "  _vamp_send(tu->cond_size >> 8);\n";
+        out << "  _vamp_send(tu->cond_size & 0xff);\n";
+        out << "  for (j = 0; j < tu->cond_size; ++j)\n";
+        out << "    _vamp_send(" << condVal << ");\n";
+    }
+
+    if (vcData.doMCDC)
+    {
+        out << "  _vamp_send(tu->mcdc_size >> 8);\n";
+        out << "  _vamp_send(tu->mcdc_size & 0xff);\n";
+        out << "  for (j = 0; j < tu->mcdc_size; ++j)\n";
+        out << "    _vamp_send(tu->mcdc_val_save[j]);\n";
+
+        // Output stack overflow status
+        out << "  _vamp_send((tu->mcdc_stack_overflow >> 8) & 0xff);\n";
+        out << "  _vamp_send(tu->mcdc_stack_overflow & 0xff);\n";
+    }
+    out << "}\n\n";
+
+    out << "void _vamp_output()\n{\n";
+    out << "  struct _vamp_tu **rec;\n";
+    out << "  struct _vamp_tu *tu;\n\n";
+    out << "  for (rec = __start_vamp_tu; rec < __stop_vamp_tu; ++rec)\n";
+    out << "    _vamp_output_tu(*rec);\n";
+    out << "  for (tu = _vamp_loaded; tu; tu = tu->next)\n";
+    out << "    _vamp_output_tu(tu);\n";
+    out << "}\n";
+}
+
 // Project->Generate vamp_output.c called
 void MainWindow::on_action_Generate_vamp_output_c_triggered()
 {
@@ -3371,6 +4181,20 @@ void MainWindow::on_action_Generate_vamp_output_c_triggered()
 
     out << "/* Auto-generated by VampGui.exe */\n\n";
     hOut << "/* Auto-generated by VampGui.exe */\n\n";
+
+    if (vcData.registerProbes)
+    {
+        // Files register their own tables, so no file list is needed
+        genRegisteredOutput(out, hOut);
+
+        out.flush();
+        voFile.close();
+
+        hOut.flush();
+        vHoFile.close();
+        return;
+    }
+
 #ifdef OLD_VAMP_PROCESS
     for (int i = 0; i < nameList.size(); ++i)
     {
@@ -3406,6 +4230,7 @@ void MainWindow::on_action_Generate_vamp_output_c_triggered()
     vector<int> mcdcSize;
     vector<int> mcdcOffsets;
     vector<int> mcdcOffsetsSize;
+    int mcdcBytes = 4;  // Widest MC/DC vector of any file
 
     // Walk through the .vinf files to build database
     for (int i = 0; i < fileList.size(); ++i)
@@ -3488,8 +4313,7 @@ void MainWindow::on_action_Generate_vamp_output_c_triggered()
             else
             if (nodeName == "mcdc_offsets")
             {
-                vector<JsonNode> offsets;
-                json.ParseArray(node->as_string(), offsets);
+                vector<JsonNode> &offsets = json.GetArray(*node);
 
                 // Load include paths from JSON config file
                 vector<JsonNode>::const_iterator offNode = offsets.begin();
@@ -3504,6 +4328,13 @@ void MainWindow::on_action_Generate_vamp_output_c_triggered()
                 mcdcOffsetsSize.push_back(offsets.size());
             }
             else
+            if (nodeName == "mcdc_bytes")
+            {
+                val = node->as_int();
+                if (val > mcdcBytes)
+                    mcdcBytes = val;
+            }
+            else
             {
                 QMessageBox::warning(0, QString("Warning"), QString("Unknown .vinf node: %1")
                                      .arg(QString::fromStdString(nodeName)));
@@ -3617,6 +4448,10 @@ void MainWindow::on_action_Generate_vamp_output_c_triggered()
         out << QString::fromStdString(condStr.str()) << "\n};\n";
     }
 
+    // Expressions over 31 operands need 64-bit MC/DC vectors
+    QString mcdcValType = (mcdcBytes > 4) ? "unsigned long long" : "unsigned int";
+    QString mcdcBitValue = (mcdcBytes > 4) ? "((unsigned long long) 2 << bit)" : "(2 << bit)";
+
     if (mcdcSize.size() > 0)
     {
         //hOut << "#define _vamp_mcdc_set_first(index, val, bit) _vamp_mcdc_set_first_func(index, (val) != 0, bit)\n";
@@ -3625,9 +4460,9 @@ void MainWindow::on_action_Generate_vamp_output_c_triggered()
         hOut << "extern unsigned char _vamp_mcdc_set_first(unsigned int index, unsigned char val, unsigned char bit);\n";
         hOut << "extern unsigned char _vamp_mcdc_collect(unsigned int index, unsigned char result, unsigned short exprNum, unsigned char byteCnt);\n";
         out << "unsigned char _vamp_mcdc_val_save[" << mcdcOffset << "];\n";
-        hOut << "extern unsigned int _vamp_mcdc_val[" << fileList.size() << "];\n";
-        out << "unsigned int _vamp_mcdc_val[" << fileList.size() << "];\n";
-        out << "static unsigned int _vamp_mcdc_stack[" << fileList.size() * 4 << "];\n";
+        hOut << "extern " << mcdcValType << " _vamp_mcdc_val[" << fileList.size() << "];\n";
+        out << mcdcValType << " _vamp_mcdc_val[" << fileList.size() << "];\n";
+        out << "static " << mcdcValType << " _vamp_mcdc_stack[" << fileList.size() * 4 << "];\n";
         out << "static unsigned char _vamp_mcdc_stack_offset[" << fileList.size() << "];\n";
         out << "static unsigned int _vamp_mcdc_stack_overflow[" << fileList.size() << "];\n";
 #ifdef NEED_MCDC_SIZE
@@ -3686,13 +4521,13 @@ void MainWindow::on_action_Generate_vamp_output_c_triggered()
         out << "    _vamp_mcdc_stack[index * " << vcData.mcdcStackSize << " + _vamp_mcdc_stack_offset[index]++] = _vamp_mcdc_val[index];\n";
         out << "    _vamp_mcdc_val[index] = 1;\n";
         out << "    if (val)\n";
-        out << "      _vamp_mcdc_val[index] |= (2 << bit);\n  }\n";
+        out << "      _vamp_mcdc_val[index] |= " << mcdcBitValue << ";\n  }\n";
         out << "  else\n  {\n";
         out << "    _vamp_mcdc_stack_overflow[index] = 1;\n  }\n";
         out << "  return val;\n}\n";
         out << "\nunsigned char _vamp_mcdc_collect(unsigned int index, unsigned char result, unsigned short exprNum, unsigned char byteCnt)\n";
         out << "{\n";
-        out << "  unsigned int testval;\n";
+        out << "  " << mcdcValType << " testval;\n";
         out << "  int i, j;\n";
         out << "  if (_vamp_mcdc_stack_overflow[index] == 0)\n";
         out << "  {\n    i = _vamp_mcdc_val_offset[_vamp_mcdc_val_offset_index[index] + exprNum];\n";
@@ -20,16 +20,50 @@
 #include "configfile.h"
 #include "projectmodel.h"
 #include "fileinstinfo.h"
+#include "coverageindex.h"
 #include "path.h"
+#include "ppmap.h"
 #include <QMainWindow>
 #include <QHBoxLayout>
 #include <QProcess>
 #include <QPlainTextEdit>
 #include <QScrollBar>
+#include <QTimer>
+#include <QThreadPool>
+#include <QHash>
+#include <QSet>
+#include <QFutureWatcher>
+#include <QAtomicInt>
 
 #include <llvm/Support/Host.h>
 #include <llvm/Support/raw_ostream.h>
 
+class ProcessJob;
+class PreprocCache;
+class VampPreprocessor;
+class QFileSystemWatcher;
+class QProgressDialog;
+
+#define HIST_WATCH_DELAY 1000   // Msec of quiet before changed histories are processed
+
+// Operations run in the background on project files
+enum BATCH_TYPE
+{
+    BATCH_PREPROCESS,
+    BATCH_INSTRUMENT,
+    BATCH_PROCESS
+};
+
+// Built-in preprocessor output for a file, from a batch worker
+typedef struct {
+    string outStr;
+    string errStr;
+    bool success;
+    bool cached;        // Output came from preprocessing cache
+    PPMap lineMap;      // Line markers taken from output
+    bool done;          // Worker has finished with file
+} PREPROC_RESULT;
+
 namespace Ui {
 class MainWindow;
 }
@@ -46,6 +80,7 @@ private:
     QString fixPath(QString qpath, bool addSlash);
     QString fixPath(string path, bool addSlash);
     QString getMinType(int val);
+    void genRegisteredOutput(QTextStream &out, QTextStream &hOut);
     void closeEvent(QCloseEvent *event);
     void setDefaultVcData(VAMP_CONFIG &vcData);
     void setDefaultVcReportData(VAMP_REPORT_CONFIG &vcReportData);
@@ -55,6 +90,7 @@ private:
     void saveProjectData(void);
     void loadProjectData(QString fileName);
     void getDirFileNames(QString pathName, QString &dirName, QString &fileName);
+    QString coverageIndexName(void);
     void loadFileInfo(QString fileName, fileInstInfo &fileInfo);
     void getFileStats(fileInstInfo &fileInfo, QStringList &stats);
     void insertRow(QStringList &list);
@@ -75,10 +111,25 @@ private:
     bool getInstrFilename(QString fileName, QString &outPath, QString &instrFileName);
     bool getInstrFilenameFromIndex(QModelIndex index, QString &instrPathName, QString &instrFileName);
     bool getHtmlFilename(QString fileName, QString &outPath, QString &htmlFileName);
-    bool mapPreprocessedSource(QString &source, QString fileName, QString &preProcFileName);
-    bool preprocessFile(QString fileName, bool force);
+    bool saveLineMap(PPMap &lineMap, QString fileName, QString &preProcFileName);
+    bool runVampPreprocessor(VampPreprocessor &preproc, QString fileName, PREPROC_RESULT &result);
+    bool preprocessFile(QString fileName, bool force, PREPROC_RESULT *result = 0);
     bool instrumentFile(QString fileName);
-    bool processFile(QString fileName);
+    ProcessJob *createProcessJob(QString fileName);
+    bool showProcessJob(ProcessJob *job);
+    void reportError(QString title, QString msg);
+    void startBatch(BATCH_TYPE type, QStringList fileList);
+    void runBatch(void);
+    void runPreprocessBatch(void);
+    void runProcessBatch(void);
+    void mergeProjectCoverage(QStringList fileList);
+    void stopBatch(void);
+    QStringList getProjectFiles(void);
+    QString getHistFilename(QString fileName);
+    void startHistWatch(void);
+    void syncHistWatch(void);
+    void watchHistPath(QString histName, QSet<QString> &watched);
+    void stopHistWatch(void);
     void showHtmlFile(QString fileName, bool isHtml);
     void QPlainTextEditAppendText(QPlainTextEdit* editor, QString text, QColor color = Qt::black);
     void getFileIndex(QModelIndex &index, QModelIndex &child);
@@ -122,6 +173,8 @@ private slots:
 
     void on_webView_linkClicked(const QUrl &arg1);
 
+    void on_action_Watch_History_triggered(bool checked);
+
 public slots:
     void removeItem();
     void preprocessItem();
@@ -141,6 +194,20 @@ public slots:
     void saveErrorAs();
     void showOutputContextMenu(const QPoint &pt);
     void showErrorContextMenu(const QPoint &pt);
+    void histChanged(const QString &path);
+    void processChangedHistories(void);
+    void checkWatchJobs(void);
+    void showBatchOutput(QString text, QColor color);
+    void showBatchError(QString text);
+    void showBatchProgress(int fileNum, QString fileName);
+    void cancelBatch(void);
+    void batchFinished(void);
+
+signals:
+    // Emitted from background batches; queued to the GUI thread
+    void batchOutput(QString text, QColor color = Qt::black);
+    void batchError(QString text);
+    void batchProgress(int fileNum, QString fileName);
 
 private:
     Ui::MainWindow *ui;
@@ -179,6 +246,29 @@ private:
 
     QProcess *myProcess;
 
+    CoverageIndex coverageIndex;  // Coverage totals for each project file
+
+    bool processingItems;                // Process results in progress
+    QFileSystemWatcher *histWatcher;     // Watches history files and directories
+    QTimer histTimer;                    // Delays processing until histories settle
+    QTimer watchJobTimer;                // Polls reports started by watcher
+    QHash<QString, QString> histFiles;   // History file -> project file
+    QHash<QString, qint64> histModTimes; // History file -> last modification seen
+    QThreadPool watchPool;               // Runs reports started by watcher
+    QList<ProcessJob *> watchJobs;       // Reports started by watcher, in order
+    QStringList watchJobFiles;           // Project file for each watcher report
+
+    QFutureWatcher<void> batchWatcher;   // Tracks background batch in progress
+    QProgressDialog *batchProgressDialog; // Progress of batch, offers Cancel
+    QAtomicInt batchCancel;              // Set to stop batch after current file
+    BATCH_TYPE batchType;                // Operation performed by batch
+    QStringList batchFiles;              // Files for batch to work through
+    QStringList batchProjectFiles;       // All project files, for merged reports
+    int batchSuccessCnt;                 // Files batch completed successfully
+    int batchFailCnt;                    // Files batch failed on
+    PreprocCache *ppCache;               // Preprocessing cache used by batch
+    VampPreprocessor *batchPreproc;      // Built-in preprocessor of batch thread
+
     Path path;
 };
 
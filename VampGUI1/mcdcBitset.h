@@ -0,0 +1,174 @@
+/*  Copyright 2016, Robert Ankeney
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/
+*/
+
+#ifndef MCDCBITSET_H
+#define MCDCBITSET_H
+
+#include <string.h>
+
+// Bit set sized at run time to the number of MC/DC conditions of an
+// expression. Sets of up to MCDC_BITSET_INLINE_BITS are held in place,
+// so copying one costs a couple of words; larger sets go on the heap.
+// Binary operators expect both sets to be the same size.
+
+#define MCDC_BITSET_INLINE_BITS 128
+
+class mcdcBitset
+{
+public:
+    mcdcBitset(size_t bits = 0) : bitCnt(0), wordCnt(0), data(inlineData)
+    {
+      resize(bits);
+    }
+
+    mcdcBitset(const mcdcBitset &b) : bitCnt(0), wordCnt(0), data(inlineData)
+    {
+      *this = b;
+    }
+
+    ~mcdcBitset()
+    {
+      if (data != inlineData)
+        delete [] data;
+    }
+
+    mcdcBitset &operator=(const mcdcBitset &b)
+    {
+      if (this != &b)
+      {
+        if (b.wordCnt != wordCnt)
+          allocate(b.wordCnt);
+        bitCnt = b.bitCnt;
+        memcpy(data, b.data, wordCnt * sizeof(wordType));
+      }
+      return *this;
+    }
+
+    // Change size to bits; all bits are cleared
+    void resize(size_t bits)
+    {
+      size_t words = (bits + WORD_BITS - 1) / WORD_BITS;
+      if (words != wordCnt)
+        allocate(words);
+      bitCnt = bits;
+      memset(data, 0, wordCnt * sizeof(wordType));
+    }
+
+    size_t size() const { return bitCnt; }
+
+    bool test(size_t n) const
+    {
+      return (data[n / WORD_BITS] >> (n % WORD_BITS)) & 1;
+    }
+
+    void set(size_t n)
+    {
+      data[n / WORD_BITS] |= (wordType) 1 << (n % WORD_BITS);
+    }
+
+    void reset(size_t n)
+    {
+      data[n / WORD_BITS] &= ~((wordType) 1 << (n % WORD_BITS));
+    }
+
+    bool any() const
+    {
+      for (size_t i = 0; i < wordCnt; i++)
+      {
+        if (data[i])
+          return true;
+      }
+      return false;
+    }
+
+    size_t count() const
+    {
+      size_t cnt = 0;
+      for (size_t i = 0; i < wordCnt; i++)
+        cnt += __builtin_popcountll(data[i]);
+      return cnt;
+    }
+
+    mcdcBitset &operator&=(const mcdcBitset &b)
+    {
+      for (size_t i = 0; i < wordCnt; i++)
+        data[i] &= b.data[i];
+      return *this;
+    }
+
+    mcdcBitset &operator|=(const mcdcBitset &b)
+    {
+      for (size_t i = 0; i < wordCnt; i++)
+        data[i] |= b.data[i];
+      return *this;
+    }
+
+    mcdcBitset &operator^=(const mcdcBitset &b)
+    {
+      for (size_t i = 0; i < wordCnt; i++)
+        data[i] ^= b.data[i];
+      return *this;
+    }
+
+    mcdcBitset operator&(const mcdcBitset &b) const
+    {
+      mcdcBitset r(*this);
+      return r &= b;
+    }
+
+    mcdcBitset operator|(const mcdcBitset &b) const
+    {
+      mcdcBitset r(*this);
+      return r |= b;
+    }
+
+    mcdcBitset operator^(const mcdcBitset &b) const
+    {
+      mcdcBitset r(*this);
+      return r ^= b;
+    }
+
+    bool operator==(const mcdcBitset &b) const
+    {
+      return (bitCnt == b.bitCnt) &&
+             !memcmp(data, b.data, wordCnt * sizeof(wordType));
+    }
+
+    bool operator!=(const mcdcBitset &b) const
+    {
+      return !(*this == b);
+    }
+
+private:
+    typedef unsigned long long wordType;
+    enum { WORD_BITS = 64,
+           INLINE_WORDS = MCDC_BITSET_INLINE_BITS / WORD_BITS };
+
+    void allocate(size_t words)
+    {
+      if (data != inlineData)
+        delete [] data;
+      data = (words > INLINE_WORDS) ? new wordType[words] : inlineData;
+      wordCnt = words;
+    }
+
+    size_t bitCnt;    // Number of bits in set
+    size_t wordCnt;   // Number of words in use
+    wordType *data;   // Points to inlineData or heap storage
+    wordType inlineData[INLINE_WORDS];
+};
+
+#endif // MCDCBITSET_H
@@ -204,7 +204,6 @@ void mcdcExprTree::mergeStr(std::vector<std::string> *leftStr,
 void mcdcExprTree::getFalse(mcdcNode *node, std::vector<std::string> *str)
 {
   std::vector<std::string> leftStr, rightStr;
-  std::string dashes = "--------------------------------";
 
   if (node->lhs == NULL)
   {
@@ -219,7 +218,7 @@ void mcdcExprTree::getFalse(mcdcNode *node, std::vector<std::string> *str)
   {
     // This was an AND - return dashes for remainder
     int cnt = (node->rhs == NULL) ? 1 : nodeCount(node->rhs);
-    std::string r = dashes.substr(0, cnt);
+    std::string r(cnt, '-');
     rightStr.push_back(r);
     //rightStr.push_back(dashes.substr(0, cnt));
 
@@ -269,7 +268,6 @@ void mcdcExprTree::getFalse(mcdcNode *node, std::vector<std::string> *str)
 void mcdcExprTree::getTrue(mcdcNode *node, std::vector<std::string> *str)
 {
   std::vector<std::string> leftStr, rightStr;
-  std::string dashes = "----------------";
 
   if (node->lhs == NULL)
   {
@@ -298,7 +296,7 @@ void mcdcExprTree::getTrue(mcdcNode *node, std::vector<std::string> *str)
     int cnt = (node->rhs == NULL) ? 1 : nodeCount(node->rhs);
     //std::string r = dashes.substr(0, cnt);
     //rightStr.push_back(r);
-    rightStr.push_back(dashes.substr(0, cnt));
+    rightStr.push_back(std::string(cnt, '-'));
 
     // Merge 1 || dash strings and return result in str
     mergeStr(&leftStr, &rightStr, str);
@@ -17,6 +17,7 @@
 #ifndef MCDCEXPRTREE_H
 #define MCDCEXPRTREE_H
 #include <iostream>
+#include <vector>
 
 #ifndef NULL
 #define NULL 0
@@ -47,6 +48,10 @@ typedef int binOp;
 typedef clang::BinaryOperator binOp;
 #define ERROR_OUT std::cout
 
+// Max operands in an MC/DC expression. Each operand takes one bit of the
+// collected vector and bit 0 marks a used entry, filling 64 bits.
+#define MCDC_MAX_OPERANDS 63
+
 struct mcdcNode
 {
   int type;                  // 1 = AND, 0 = OR
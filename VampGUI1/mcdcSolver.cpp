@@ -0,0 +1,263 @@
+/*  Copyright 2016, Robert Ankeney
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/
+*/
+
+#include <algorithm>
+#include "mcdcSolver.h"
+
+using namespace std;
+
+// Sort candidates with fewest added conditions first, then by highest usage
+struct candidateCompare
+{
+  template <typename T>
+  bool operator()(const T &a, const T &b) const
+  {
+    if (a.inc != b.inc)
+      return a.inc < b.inc;
+    if (a.usage != b.usage)
+      return a.usage > b.usage;
+    return a.index < b.index;
+  }
+};
+
+// nodeLimit and timeLimit (in milliseconds) bound the exhaustive search.
+// A limit of 0 disables that budget.
+mcdcSolver::mcdcSolver(int nodeLimit, int timeLimit) :
+  nodeLimit(nodeLimit), timeLimit(timeLimit)
+{
+  nodeCnt = 0;
+  optimal = false;
+  aborted = false;
+}
+
+// Compute fewest additional conditions needed to complete an independent
+// pair for each of operandCnt operands. falseConditions and trueConditions
+// hold the conditions already covered on entry and the recommended set on
+// exit. falseCount/trueCount give how often each condition is part of a
+// pair and are used to break ties. Returns number of conditions added.
+int mcdcSolver::solve(vector<mcdcPair> *mcdcPairs,
+                      int operandCnt,
+                      vector<int> &falseCount,
+                      vector<int> &trueCount,
+                      mcdcBitset &falseConditions,
+                      mcdcBitset &trueConditions)
+{
+  this->falseCount = falseCount.data();
+  this->trueCount = trueCount.data();
+  nodeCnt = 0;
+  aborted = false;
+  memo.clear();
+
+  // Operands without any independent pair can never be covered - skip them
+  levels.clear();
+  for (int i = 0; i < operandCnt; i++)
+  {
+    if (mcdcPairs[i].size())
+      levels.push_back(&mcdcPairs[i]);
+  }
+
+  // Greedy pass: take the cheapest pair for each operand in turn.
+  // This is the answer returned if the search budget runs out.
+  curFalse = falseConditions;
+  curTrue = trueConditions;
+  bestCost = 0;
+  for (int level = 0; level < levels.size(); level++)
+  {
+    vector<candidateType> cand;
+    orderCandidates(level, cand);
+
+    mcdcPair &pair = (*levels[level])[cand.front().index];
+    curFalse.set(pair.f);
+    curTrue.set(pair.t);
+    bestCost += cand.front().inc;
+  }
+  bestFalse = curFalse;
+  bestTrue = curTrue;
+
+  // Branch-and-bound search for a better answer
+  curFalse = falseConditions;
+  curTrue = trueConditions;
+  curHash = 0;
+  startTime = chrono::steady_clock::now();
+  search(0, 0);
+  optimal = !aborted;
+  memo.clear();
+
+  falseConditions = bestFalse;
+  trueConditions = bestTrue;
+  return bestCost;
+}
+
+void mcdcSolver::search(int level, int cost)
+{
+  if (aborted || (cost >= bestCost))
+    return;
+
+  if (level == levels.size())
+  {
+    // Complete set of pairs cheaper than best so far
+    bestCost = cost;
+    bestFalse = curFalse;
+    bestTrue = curTrue;
+    return;
+  }
+
+  if (budgetExceeded())
+  {
+    aborted = true;
+    return;
+  }
+  ++nodeCnt;
+
+  // Each remaining operand needs at least its cheapest pair. A single
+  // added condition may serve several operands, so only the largest of
+  // these is a safe lower bound.
+  int bound = 0;
+  for (int l = level; l < levels.size(); l++)
+  {
+    int c = minPairCost(l);
+    if (c > bound)
+    {
+      bound = c;
+      if (cost + bound >= bestCost)
+        return;
+    }
+  }
+
+  // Skip states already reached at equal or lower cost. Levels hash
+  // as condition numbers that no real condition can have.
+  unsigned long long key = curHash ^ conditionHash(~(unsigned int) level, true);
+  unordered_map<unsigned long long, int>::iterator m = memo.find(key);
+  if (m != memo.end())
+  {
+    if (m->second <= cost)
+      return;
+    m->second = cost;
+  }
+  else
+  {
+    memo[key] = cost;
+  }
+
+  vector<candidateType> cand;
+  orderCandidates(level, cand);
+
+  for (vector<candidateType>::iterator c = cand.begin();
+       !aborted && (c < cand.end());
+       ++c)
+  {
+    if (cost + c->inc >= bestCost)
+      break;
+
+    mcdcPair &pair = (*levels[level])[c->index];
+    bool addFalse = !curFalse.test(pair.f);
+    bool addTrue = !curTrue.test(pair.t);
+
+    if (addFalse)
+    {
+      curFalse.set(pair.f);
+      curHash ^= conditionHash(pair.f, false);
+    }
+    if (addTrue)
+    {
+      curTrue.set(pair.t);
+      curHash ^= conditionHash(pair.t, true);
+    }
+
+    search(level + 1, cost + c->inc);
+
+    // Undo changes for next candidate
+    if (addFalse)
+    {
+      curFalse.reset(pair.f);
+      curHash ^= conditionHash(pair.f, false);
+    }
+    if (addTrue)
+    {
+      curTrue.reset(pair.t);
+      curHash ^= conditionHash(pair.t, true);
+    }
+  }
+}
+
+bool mcdcSolver::budgetExceeded()
+{
+  if (nodeLimit && (nodeCnt >= nodeLimit))
+    return true;
+
+  // Only check the clock occasionally
+  if (timeLimit && !(nodeCnt & 0xff))
+  {
+    chrono::steady_clock::duration elapsed = chrono::steady_clock::now() -
+                                             startTime;
+    if (chrono::duration_cast<chrono::milliseconds>(elapsed).count() >=
+        timeLimit)
+      return true;
+  }
+
+  return false;
+}
+
+// Number of conditions a pair adds to the current state
+int mcdcSolver::pairCost(mcdcPair &pair)
+{
+  return !curFalse.test(pair.f) + !curTrue.test(pair.t);
+}
+
+// Cost of cheapest pair for operand at level
+int mcdcSolver::minPairCost(int level)
+{
+  int minCost = 2;
+  vector<mcdcPair>::iterator pair;
+
+  for (pair = levels[level]->begin();
+       (minCost > 0) && (pair < levels[level]->end());
+       ++pair)
+  {
+    int c = pairCost(*pair);
+    if (c < minCost)
+      minCost = c;
+  }
+
+  return minCost;
+}
+
+// Build list of pairs for level, best candidates first
+void mcdcSolver::orderCandidates(int level, vector<candidateType> &cand)
+{
+  vector<mcdcPair> &pairs = *levels[level];
+
+  cand.resize(pairs.size());
+  for (int i = 0; i < pairs.size(); i++)
+  {
+    cand[i].inc = pairCost(pairs[i]);
+    cand[i].usage = falseCount[pairs[i].f] + trueCount[pairs[i].t];
+    cand[i].index = i;
+  }
+
+  sort(cand.begin(), cand.end(), candidateCompare());
+}
+
+// Hash of a single condition (splitmix64). The state hash is the XOR of
+// the hashes of all conditions added so far, so it can be updated in place.
+unsigned long long mcdcSolver::conditionHash(unsigned int cond, bool isTrue)
+{
+  unsigned long long z = ((unsigned long long) cond << 1 | isTrue) +
+                         0x9e3779b97f4a7c15ULL;
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+  return z ^ (z >> 31);
+}
@@ -0,0 +1,92 @@
+/*  Copyright 2016, Robert Ankeney
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/
+*/
+
+#ifndef MCDCSOLVER_H
+#define MCDCSOLVER_H
+
+#include <vector>
+#include <unordered_map>
+#include <chrono>
+#include "mcdcBitset.h"
+
+#define MCDC_SOLVER_NODE_LIMIT 200000 // Default search node budget
+#define MCDC_SOLVER_TIME_LIMIT 2000   // Default search time budget (ms)
+
+// MC/DC independent pair
+typedef struct {
+  unsigned int f, t;
+} mcdcPair;
+
+// Find the fewest additional False/True condition vectors needed so that
+// every operand has at least one fully covered independent pair.
+// A greedy pass supplies the first answer; a branch-and-bound search then
+// improves on it until it is proven minimal or the budget runs out.
+class mcdcSolver
+{
+public:
+    mcdcSolver(int nodeLimit, int timeLimit);
+
+    int solve(std::vector<mcdcPair> *mcdcPairs,
+              int operandCnt,
+              std::vector<int> &falseCount,
+              std::vector<int> &trueCount,
+              mcdcBitset &falseConditions,
+              mcdcBitset &trueConditions);
+
+    bool isOptimal() { return optimal; }
+    int getNodeCount() { return nodeCnt; }
+
+private:
+    typedef struct {
+      int inc;    // Number of conditions the pair adds
+      int usage;  // How often the pair's halves complete other pairs
+      int index;  // Index of pair within its operand
+    } candidateType;
+
+    void search(int level, int cost);
+    bool budgetExceeded();
+    int pairCost(mcdcPair &pair);
+    int minPairCost(int level);
+    void orderCandidates(int level, std::vector<candidateType> &cand);
+    unsigned long long conditionHash(unsigned int cond, bool isTrue);
+
+    int nodeLimit;
+    int timeLimit;
+    int nodeCnt;
+    bool optimal;
+    bool aborted;
+    std::chrono::steady_clock::time_point startTime;
+
+    // Operands that have independent pairs to choose from
+    std::vector<std::vector<mcdcPair> *> levels;
+    int *falseCount;
+    int *trueCount;
+
+    // Current search state, updated in place and undone on backtrack
+    mcdcBitset curFalse;
+    mcdcBitset curTrue;
+    unsigned long long curHash;
+
+    // Best answer found so far
+    int bestCost;
+    mcdcBitset bestFalse;
+    mcdcBitset bestTrue;
+
+    // Lowest cost at which each (level, covered set) state was reached
+    std::unordered_map<unsigned long long, int> memo;
+};
+
+#endif // MCDCSOLVER_H
@@ -0,0 +1,283 @@
+/*  Copyright 2016, Robert Ankeney
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/
+*/
+
+
+// Helpers shared by the reports merged from the coverage files of a
+// batch of reports: the header reports (headercov.cpp) and the variant
+// reports (variantcov.cpp).
+
+#include "mergedreport.h"
+#include <algorithm>
+#include <string.h>
+
+// Names among the outputs of a report that end in ext. Merged reports
+// are written beside the first one found, so reportDir is set from it if
+// not already set.
+vector<string> findOutputs(const vector<string> &outputs, const char *ext,
+                           string &reportDir)
+{
+  vector<string> found;
+  size_t extLen = strlen(ext);
+
+  for (int i = 0; i < outputs.size(); i++)
+  {
+    const string &name = outputs[i];
+
+    if ((name.size() <= extLen) ||
+        (name.compare(name.size() - extLen, extLen, ext) != 0))
+      continue;
+
+    if (reportDir.empty())
+    {
+      size_t slash = name.rfind(DIRECTORY_SEPARATOR);
+      reportDir = (slash == name.npos) ? "." : name.substr(0, slash);
+    }
+
+    found.push_back(name);
+  }
+
+  return found;
+}
+
+// Name of merged report for file, e.g. util.h -> util_h<suffix>,
+// numbered if another file in reportNames has the same name
+string mergedReportName(const string &file, const char *suffix,
+                        set<string> &reportNames)
+{
+  size_t slash = file.find_last_of("/\\");
+  string base = (slash == file.npos) ? file : file.substr(slash + 1);
+  replace(base.begin(), base.end(), '.', '_');
+
+  string name = base + suffix;
+  for (int n = 2; reportNames.count(name); n++)
+  {
+    ostringstream numbered;
+    numbered << base << "_" << n << suffix;
+    name = numbered.str();
+  }
+  reportNames.insert(name);
+
+  return name;
+}
+
+// Read lines of file into text, without line endings
+bool readSourceLines(const string &file, vector<string> &text)
+{
+  ifstream sourceFile(file.c_str());
+  if (!sourceFile.is_open())
+    return false;
+
+  string line;
+  while (getline(sourceFile, line))
+  {
+    if (!line.empty() && (line[line.size() - 1] == '\r'))
+      line.erase(line.size() - 1);
+    text.push_back(line);
+  }
+
+  return true;
+}
+
+// Escape str for HTML text
+string htmlEscape(const string &str)
+{
+  string out;
+
+  for (size_t i = 0; i < str.size(); i++)
+  {
+    switch (str[i])
+    {
+      case '&':
+        out += "&amp;";
+        break;
+      case '<':
+        out += "&lt;";
+        break;
+      case '>':
+        out += "&gt;";
+        break;
+      default:
+        out += str[i];
+        break;
+    }
+  }
+
+  return out;
+}
+
+// Write line hits as "<line> <hits>", one per line
+void writeLineHits(ostream &out, const map<int, long long> &lineHits)
+{
+  map<int, long long>::const_iterator l;
+  for (l = lineHits.begin(); l != lineHits.end(); ++l)
+    out << l->first << " " << l->second << "\n";
+}
+
+// Read lineCnt line hits written by writeLineHits()
+void readLineHits(istream &in, int lineCnt, map<int, long long> &lineHits)
+{
+  for (int l = 0; l < lineCnt; l++)
+  {
+    int line;
+    long long hits;
+    in >> line >> hits;
+    lineHits[line] = hits;
+  }
+}
+
+// Write decisions as "<line> <type> <outcomes taken>", one per line,
+// with 1 or 0 for each outcome, or - if it has none
+void writeDecisions(ostream &out, const vector<decisionExportType> &decisions)
+{
+  for (int i = 0; i < decisions.size(); i++)
+  {
+    out << decisions[i].line << " " << decisions[i].type << " ";
+    if (decisions[i].taken.empty())
+      out << "-";
+    for (int j = 0; j < decisions[i].taken.size(); j++)
+      out << (decisions[i].taken[j] ? '1' : '0');
+    out << "\n";
+  }
+}
+
+// Read decisionCnt decisions written by writeDecisions()
+void readDecisions(istream &in, int decisionCnt,
+                   vector<decisionExportType> &decisions)
+{
+  decisions.resize(decisionCnt);
+  for (int d = 0; d < decisionCnt; d++)
+  {
+    string taken;
+    in >> decisions[d].line >> decisions[d].type >> taken;
+    if (taken == "-")
+      continue;
+    for (int j = 0; j < taken.size(); j++)
+      decisions[d].taken.push_back(taken[j] == '1');
+  }
+}
+
+// Union newDecisions into decisions. Decisions are matched by line, type
+// and order among those of that type on the line; any not yet held are
+// added. A switch whose cases differ is unioned case by case.
+void mergeDecisions(vector<decisionExportType> &decisions,
+                    const vector<decisionExportType> &newDecisions)
+{
+  // Line, then type and order among decisions of that type on the line
+  typedef pair<int, pair<string, int> > decisionKeyType;
+
+  map<decisionKeyType, int> index;
+  map<pair<int, string>, int> order;
+
+  for (int d = 0; d < decisions.size(); d++)
+  {
+    decisionExportType &dec = decisions[d];
+    int n = order[make_pair(dec.line, dec.type)]++;
+    index[make_pair(dec.line, make_pair(dec.type, n))] = d;
+  }
+
+  order.clear();
+  for (int d = 0; d < newDecisions.size(); d++)
+  {
+    const decisionExportType &dec = newDecisions[d];
+    int n = order[make_pair(dec.line, dec.type)]++;
+    decisionKeyType key(dec.line, make_pair(dec.type, n));
+
+    map<decisionKeyType, int>::iterator it = index.find(key);
+    if (it == index.end())
+    {
+      index[key] = decisions.size();
+      decisions.push_back(dec);
+      continue;
+    }
+
+    vector<bool> &taken = decisions[it->second].taken;
+    if (taken.size() < dec.taken.size())
+      taken.resize(dec.taken.size(), false);
+
+    for (int j = 0; j < dec.taken.size(); j++)
+    {
+      if (dec.taken[j])
+        taken[j] = true;
+    }
+  }
+}
+
+// Start merged report titled title
+void writeMergedHead(ostream &htmlFile, const string &title)
+{
+  htmlFile << "<!DOCTYPE html>" << ENDL;
+  htmlFile << "<html lang=\"en\">" << ENDL;
+  htmlFile << "  <head>" << ENDL;
+  htmlFile << "  <meta charset=\"utf-8\"/>" << ENDL;
+  htmlFile << "    <title>" << htmlEscape(title) << "</title>" << ENDL;
+  htmlFile << "  </head>" << ENDL;
+  htmlFile << "  <body>" << ENDL;
+  htmlFile << "    <h2>" << htmlEscape(title) << "</h2>" << ENDL;
+}
+
+// Finish merged report with the source text, each line colored by its
+// coverage and preceded by its number and hits column. Without the
+// text, only the lines with code are shown.
+void writeMergedSource(ostream &htmlFile, const vector<string> &text,
+                       map<int, mergedLineType> &lines)
+{
+  int lastLine = text.size();
+  if (!lines.empty())
+    lastLine = max(lastLine, lines.rbegin()->first);
+
+  htmlFile << "<pre>" << ENDL;
+  for (int line = 1; line <= lastLine; line++)
+  {
+    map<int, mergedLineType>::iterator l = lines.find(line);
+    bool hasCode = (l != lines.end());
+
+    if (text.empty() && !hasCode)
+      continue;
+
+    int color = 0;
+    if (hasCode)
+    {
+      mergedLineType &m = l->second;
+
+      if ((!m.hits.empty() && !m.hit) || (m.hasDecision && (m.taken == 0)))
+        color = BG_RED;
+      else
+      if (m.taken < m.outcomes)
+        color = BG_YELLOW;
+      else
+        color = BG_GREEN;
+    }
+
+    char prefix[40];
+    snprintf(prefix, sizeof(prefix), "%6d %-10s", line,
+             hasCode ? l->second.hits.c_str() : "");
+
+    htmlFile << prefix;
+    if (color)
+      htmlFile << "<span style=\"background: #" << std::hex << color <<
+                  std::dec << "\">";
+    if (line <= text.size())
+      htmlFile << htmlEscape(text[line - 1]);
+    if (hasCode && l->second.hasDecision)
+      htmlFile << "  [" << l->second.taken << "/" << l->second.outcomes << "]";
+    if (color)
+      htmlFile << "</span>";
+    htmlFile << ENDL;
+  }
+  htmlFile << "</pre>" << ENDL;
+  htmlFile << "  </body>" << ENDL;
+  htmlFile << "</html>" << ENDL;
+}
@@ -0,0 +1,55 @@
+/*  Copyright 2016, Robert Ankeney
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/
+*/
+
+
+#ifndef MERGEDREPORT_H
+#define MERGEDREPORT_H
+
+#include "vamp_process.h"
+#include <map>
+#include <set>
+
+// Coverage of one line of a merged report
+typedef struct {
+  string hits;           // Hits column; empty if line has no statement
+  bool hit;              // Statement on line was hit
+  bool hasDecision;      // Line starts a branch or condition
+  int outcomes;          // Outcomes of decisions on line
+  int taken;             // Outcomes taken
+} mergedLineType;
+
+// Helpers shared by the reports merged from several files (header and
+// variant coverage)
+vector<string> findOutputs(const vector<string> &outputs, const char *ext,
+                           string &reportDir);
+string mergedReportName(const string &file, const char *suffix,
+                        set<string> &reportNames);
+bool readSourceLines(const string &file, vector<string> &text);
+string htmlEscape(const string &str);
+
+void writeLineHits(ostream &out, const map<int, long long> &lineHits);
+void readLineHits(istream &in, int lineCnt, map<int, long long> &lineHits);
+void writeDecisions(ostream &out, const vector<decisionExportType> &decisions);
+void readDecisions(istream &in, int decisionCnt,
+                   vector<decisionExportType> &decisions);
+void mergeDecisions(vector<decisionExportType> &decisions,
+                    const vector<decisionExportType> &newDecisions);
+
+void writeMergedHead(ostream &htmlFile, const string &title);
+void writeMergedSource(ostream &htmlFile, const vector<string> &text,
+                       map<int, mergedLineType> &lines);
+
+#endif // MERGEDREPORT_H
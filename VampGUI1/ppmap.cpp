@@ -0,0 +1,288 @@
+/*  Copyright 2016, Robert Ankeney
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/
+*/
+
+
+#include "ppmap.h"
+#include "json.h"
+#include <algorithm>
+#include <stdio.h>
+
+void PPMap::clear()
+{
+  fileName.clear();
+  ppFileName.clear();
+  files.clear();
+  markers.clear();
+  sourceIndex = -1;
+}
+
+// Lines from ppLine on came from srcLine of file. A marker for a line
+// already marked replaces it, as the preprocessor only keeps the last.
+void PPMap::addMarker(int ppLine, int srcLine, const string &file)
+{
+  ppMarkerType marker;
+
+  marker.ppLine = ppLine;
+  marker.srcLine = srcLine;
+  marker.fileIndex = fileNum(file);
+
+  if (!markers.empty() && (markers.back().ppLine == ppLine))
+    markers.back() = marker;
+  else
+    markers.push_back(marker);
+}
+
+// Index of file in files, adding it if new. Few files are named, and
+// consecutive markers mostly name the same one.
+int PPMap::fileNum(const string &file)
+{
+  if (!markers.empty() && (files[markers.back().fileIndex] == file))
+    return markers.back().fileIndex;
+
+  for (int i = 0; i < files.size(); i++)
+  {
+    if (files[i] == file)
+      return i;
+  }
+
+  files.push_back(file);
+  return files.size() - 1;
+}
+
+// Find fileName among files so lines of the source itself can be told
+// from those of headers
+void PPMap::indexSource()
+{
+  sourceIndex = -1;
+  for (int i = 0; i < files.size(); i++)
+  {
+    if (files[i] == fileName)
+    {
+      sourceIndex = i;
+      break;
+    }
+  }
+}
+
+// Index of the marker covering ppLine, or -1 if ppLine precedes them all
+int PPMap::find(int ppLine) const
+{
+  vector<ppMarkerType>::const_iterator it = markers.begin();
+  int count = markers.size();
+
+  // Last marker with marker.ppLine <= ppLine
+  while (count > 0)
+  {
+    int step = count / 2;
+    if (it[step].ppLine <= ppLine)
+    {
+      it += step + 1;
+      count -= step + 1;
+    }
+    else
+      count = step;
+  }
+
+  return (it - markers.begin()) - 1;
+}
+
+// Line in the preprocessed source of ppLine; -1 if it came from another
+// file or is not mapped
+int PPMap::sourceLine(int ppLine) const
+{
+  int m = find(ppLine);
+
+  if ((m < 0) || (markers[m].fileIndex != sourceIndex))
+    return -1;
+
+  return ppLine - markers[m].ppLine + markers[m].srcLine;
+}
+
+// Original file and line of ppLine; false if not mapped
+bool PPMap::origin(int ppLine, string &file, int &srcLine) const
+{
+  int m = find(ppLine);
+
+  if (m < 0)
+    return false;
+
+  file = files[markers[m].fileIndex];
+  srcLine = ppLine - markers[m].ppLine + markers[m].srcLine;
+  return true;
+}
+
+// Write map as:
+//   VPM <version>
+//   <fileName>
+//   <ppFileName>
+//   <file count>
+//   <file>...
+//   <marker count>
+//   <ppLine> <srcLine> <fileIndex>...
+void PPMap::write(ostream &out) const
+{
+  out << PPMAP_MAGIC << " " << PPMAP_VERSION << "\n";
+  out << fileName << "\n";
+  out << ppFileName << "\n";
+  out << files.size() << "\n";
+  for (int i = 0; i < files.size(); i++)
+    out << files[i] << "\n";
+  out << markers.size() << "\n";
+  for (int i = 0; i < markers.size(); i++)
+    out << markers[i].ppLine << " " << markers[i].srcLine << " " <<
+           markers[i].fileIndex << "\n";
+}
+
+// Read map written by write()
+bool PPMap::read(istream &in)
+{
+  string magic;
+  int version;
+  int fileCnt;
+  int markerCnt;
+
+  clear();
+  in >> magic >> version;
+  if (!in.good() || (magic != PPMAP_MAGIC) || (version != PPMAP_VERSION))
+    return false;
+
+  in.get();
+  getline(in, fileName);
+  getline(in, ppFileName);
+  in >> fileCnt;
+  in.get();
+  if (!in.good() || (fileCnt < 0))
+    return false;
+
+  files.resize(fileCnt);
+  for (int i = 0; i < fileCnt; i++)
+    getline(in, files[i]);
+
+  in >> markerCnt;
+  if (!in.good() || (markerCnt < 0))
+    return false;
+
+  markers.resize(markerCnt);
+  for (int i = 0; i < markerCnt; i++)
+  {
+    in >> markers[i].ppLine >> markers[i].srcLine >> markers[i].fileIndex;
+    if ((markers[i].fileIndex < 0) || (markers[i].fileIndex >= fileCnt))
+      return false;
+  }
+
+  if (in.fail())
+    return false;
+
+  indexSource();
+  return true;
+}
+
+bool PPMap::save(string mapName) const
+{
+  char mapBuf[65536];
+  ofstream out;
+  out.rdbuf()->pubsetbuf(mapBuf, sizeof(mapBuf));
+  out.open(mapName.c_str(), ios::out | ios::binary | ios::trunc);
+  if (!out.is_open())
+    return false;
+
+  write(out);
+  out.close();
+  return !out.fail();
+}
+
+// Load map, accepting the JSON maps written by earlier versions
+bool PPMap::load(string mapName, ostream *errStr)
+{
+  ifstream in(mapName.c_str(), ios::in | ios::binary);
+  if (!in.is_open())
+    return false;
+
+  if (in.peek() == '{')
+  {
+    in.close();
+    return loadJson(mapName, errStr);
+  }
+
+  if (!read(in))
+  {
+    *errStr << "Bad preprocessor map file " << mapName << "\n";
+    clear();
+    return false;
+  }
+
+  return true;
+}
+
+// Load JSON map of form:
+//   {
+//     "filename": <source>,
+//     "preproc_filename": <preprocessed file>,
+//     "linemarkers":
+//     [
+//       // pn = Line number for preprocessed source
+//       // sn = Corresponding line number for original source
+//       // filen = Filename of original source
+//       [<p1>,<s1>,<file1>],
+//           ...
+//       [<pn>,<sn>,<filen>]
+//     ]
+//   }
+bool PPMap::loadJson(string mapName, ostream *errStr)
+{
+  ostringstream jsonErr;
+  Json n(&jsonErr);
+
+  clear();
+  try
+  {
+    n.ParseFile(mapName);
+
+    vector<JsonNode>::iterator i;
+    for (i = n.jsonNodes.begin(); i != n.jsonNodes.end(); ++i)
+    {
+      string nodeName = i->name().data();
+
+      if (nodeName == "filename")
+        fileName = i->as_string();
+      else
+      if (nodeName == "preproc_filename")
+        ppFileName = i->as_string();
+      else
+      if (nodeName == "linemarkers")
+      {
+        vector<JsonNode> &lineMarkers = n.GetArray(*i);
+        vector<JsonNode>::iterator m;
+        for (m = lineMarkers.begin(); m != lineMarkers.end(); ++m)
+        {
+          vector<JsonNode> &loc = n.GetArray(*m);
+          if (loc.size() < 3)
+            throw(1);
+          addMarker(loc[0].as_int(), loc[1].as_int(), loc[2].as_string());
+        }
+      }
+    }
+  }
+  catch(int i)
+  {
+    *errStr << "Bad preprocessor map file " << mapName << " - " << jsonErr.str();
+    clear();
+    return false;
+  }
+
+  indexSource();
+  return true;
+}
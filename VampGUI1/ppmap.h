@@ -0,0 +1,71 @@
+/*  Copyright 2016, Robert Ankeney
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/
+*/
+
+
+#ifndef PPMAP_H
+#define PPMAP_H
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+#define PPMAP_EXT ".ppmap"       // Extension of preprocessor line map file
+#define PPMAP_MAGIC "VPM"        // Tag at start of line map file
+#define PPMAP_VERSION 1          // Layout version of line map file
+
+// Start of a run of preprocessed lines from one place in an original file
+typedef struct {
+  int ppLine;                    // First preprocessed line of run
+  int srcLine;                   // Its line in the original file
+  int fileIndex;                 // Original file, index into PPMap::files
+} ppMarkerType;
+
+// Map from lines of a preprocessed file back to the original files,
+// built from the line markers written by the preprocessor. Markers are
+// kept in preprocessed line order so lookups are a binary search.
+class PPMap
+{
+public:
+  PPMap() : sourceIndex(-1) {}
+
+  void clear();
+  void addMarker(int ppLine, int srcLine, const string &file);
+  int find(int ppLine) const;
+  int sourceLine(int ppLine) const;
+  bool origin(int ppLine, string &file, int &srcLine) const;
+
+  void write(ostream &out) const;
+  bool read(istream &in);
+  bool save(string mapName) const;
+  bool load(string mapName, ostream *errStr);
+
+  string fileName;               // Source that was preprocessed
+  string ppFileName;             // Preprocessed file
+  vector<string> files;          // Original files named by markers
+  vector<ppMarkerType> markers;  // Sorted by ppLine
+
+private:
+  bool loadJson(string mapName, ostream *errStr);
+  int fileNum(const string &file);
+  void indexSource();
+
+  int sourceIndex;               // Index of fileName in files, or -1
+};
+
+#endif // PPMAP_H
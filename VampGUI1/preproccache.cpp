@@ -0,0 +1,209 @@
+/*  Copyright 2016, Robert Ankeney
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/
+*/
+
+
+#include "preproccache.h"
+#include "fnvhash.h"
+#include "version.h"
+#include <fstream>
+#include <sstream>
+#include <stdio.h>
+#include <sys/stat.h>
+#include <thread>
+
+PreprocCache::PreprocCache(string cacheDirName) :
+    cacheDir(cacheDirName)
+{
+}
+
+// Preprocess fileName, using the saved output if its inputs are unchanged
+bool PreprocCache::preprocess(VampPreprocessor &preproc,
+                              string fileName,
+                              string &outString,
+                              string &errString,
+                              VAMP_PREPROC_CONFIG &preprocOpts,
+                              PPMap *lineMap,
+                              bool &cached)
+{
+    string entry = entryName(fileName, preprocOpts);
+
+    cached = load(entry, outString, errString, lineMap);
+    if (cached)
+        return true;
+
+    outString.clear();
+    errString.clear();
+    if (!preproc.Preprocess(fileName, outString, errString, preprocOpts, lineMap))
+        return false;
+
+    save(entry, preproc.includedFiles, preproc.missedFiles, outString, errString,
+         lineMap);
+    return true;
+}
+
+// Cache entry for fileName preprocessed with preprocOpts. The source
+// name is part of the key as it appears in line markers.
+string PreprocCache::entryName(string fileName, VAMP_PREPROC_CONFIG &preprocOpts)
+{
+    ostringstream key;
+
+    key << VAMP_VERSION << "\n" <<
+           fileName << "\n" <<
+           preprocOpts.retainComments << "\n" <<
+           preprocOpts.showLineMarkers << "\n";
+    for (int i = 0; i < preprocOpts.includePaths.size(); ++i)
+        key << "-I" << preprocOpts.includePaths[i] << "\n";
+    for (int i = 0; i < preprocOpts.definesList.size(); ++i)
+        key << "-D" << preprocOpts.definesList[i] << "\n";
+
+    string keyStr = key.str();
+    return cacheDir + "/" + hashStr(fnvHash(keyStr.data(), keyStr.size())) +
+           PP_CACHE_EXT;
+}
+
+// Hash contents of fileName; empty string if it cannot be read.
+// Headers are shared by many sources, so each is only read once.
+string PreprocCache::fileHash(string fileName)
+{
+    {
+        lock_guard<mutex> lock(hashLock);
+        map<string, string>::iterator it = hashes.find(fileName);
+        if (it != hashes.end())
+            return it->second;
+    }
+
+    // Hashed without the lock; two workers may both read a header
+    string hash = hashFile(fileName);
+
+    lock_guard<mutex> lock(hashLock);
+    hashes[fileName] = hash;
+    return hash;
+}
+
+// True if fileName exists
+static bool fileExists(const string &fileName)
+{
+    struct stat statInfo;
+    return stat(fileName.c_str(), &statInfo) == 0;
+}
+
+// Read saved output if every file it was built from is unchanged
+bool PreprocCache::load(string entry, string &outString, string &errString,
+                        PPMap *lineMap)
+{
+    ifstream in(entry.c_str(), ios::in | ios::binary);
+    if (!in.is_open())
+        return false;
+
+    string magic;
+    int version;
+    int fileCnt;
+    int missCnt;
+    in >> magic >> version >> fileCnt;
+    if (!in.good() || (magic != PP_CACHE_MAGIC) || (version != PP_CACHE_VERSION))
+        return false;
+
+    for (int i = 0; i < fileCnt; i++)
+    {
+        string hash;
+        string fileName;
+        in >> hash;
+        in.get();
+        getline(in, fileName);
+        if (!in.good() || hash.empty() || (hash != fileHash(fileName)))
+            return false;
+    }
+
+    // A header now found earlier in the search would shadow one used
+    in >> missCnt;
+    in.get();
+    for (int i = 0; i < missCnt; i++)
+    {
+        string fileName;
+        getline(in, fileName);
+        if (!in.good() || fileExists(fileName))
+            return false;
+    }
+
+    size_t outLen;
+    size_t errLen;
+    int hasMap;
+    in >> outLen >> errLen >> hasMap;
+    in.get();
+    if (!in.good() || (hasMap != (lineMap != NULL)))
+        return false;
+
+    outString.resize(outLen);
+    errString.resize(errLen);
+    if (outLen)
+        in.read(&outString[0], outLen);
+    if (errLen)
+        in.read(&errString[0], errLen);
+
+    if (lineMap && !lineMap->read(in))
+        return false;
+
+    return !in.fail();
+}
+
+// Save output (and line map) along with hashes of the files it was
+// built from, and the include paths tried that did not exist.
+// Written to a temporary file first so a reader never sees a partial entry.
+void PreprocCache::save(string entry, vector<string> &includedFiles,
+                        vector<string> &missedFiles,
+                        string &outString, string &errString, PPMap *lineMap)
+{
+    ostringstream tmpName;
+    tmpName << entry << "." << this_thread::get_id();
+
+    ofstream out(tmpName.str().c_str(), ios::out | ios::binary | ios::trunc);
+    if (!out.is_open())
+        return;
+
+    out << PP_CACHE_MAGIC << " " << PP_CACHE_VERSION << "\n";
+    out << includedFiles.size() << "\n";
+    for (int i = 0; i < includedFiles.size(); i++)
+    {
+        string hash = fileHash(includedFiles[i]);
+        if (hash.empty())
+        {
+            // Input vanished - don't save an entry that can never match
+            out.close();
+            remove(tmpName.str().c_str());
+            return;
+        }
+        out << hash << " " << includedFiles[i] << "\n";
+    }
+    out << missedFiles.size() << "\n";
+    for (int i = 0; i < missedFiles.size(); i++)
+        out << missedFiles[i] << "\n";
+    out << outString.size() << " " << errString.size() << " " <<
+           (lineMap != NULL) << "\n";
+    out << outString << errString;
+    if (lineMap)
+        lineMap->write(out);
+    out.close();
+
+    if (out.fail())
+    {
+        remove(tmpName.str().c_str());
+        return;
+    }
+
+    remove(entry.c_str());
+    if (rename(tmpName.str().c_str(), entry.c_str()) != 0)
+        remove(tmpName.str().c_str());
+}
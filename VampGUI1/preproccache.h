@@ -0,0 +1,63 @@
+/*  Copyright 2016, Robert Ankeney
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/
+*/
+
+
+#ifndef PREPROCCACHE_H
+#define PREPROCCACHE_H
+
+#include "vamp_preprocessor.h"
+#include <map>
+#include <mutex>
+
+#define PP_CACHE_DIR "VAMP_PPCACHE"    // Cache directory within project
+#define PP_CACHE_EXT ".vpp"            // Extension of cache entry files
+#define PP_CACHE_MAGIC "VPP"           // Tag at start of cache entry files
+#define PP_CACHE_VERSION 3             // Layout version of cache entry files
+
+// Output of the built-in preprocessor, saved by source file and options.
+// An entry is used only while the contents of the source and every file
+// it included still match, so edits to any header force a rerun, and
+// while no header has appeared where the include search missed before.
+// File contents are hashed once per cache object; create one per batch.
+// Safe to share between threads, each with its own VampPreprocessor.
+class PreprocCache
+{
+public:
+    PreprocCache(string cacheDirName);
+
+    bool preprocess(VampPreprocessor &preproc,
+                    string fileName,
+                    string &outString,
+                    string &errString,
+                    VAMP_PREPROC_CONFIG &preprocOpts,
+                    PPMap *lineMap,
+                    bool &cached);
+
+private:
+    string entryName(string fileName, VAMP_PREPROC_CONFIG &preprocOpts);
+    string fileHash(string fileName);
+    bool load(string entry, string &outString, string &errString,
+              PPMap *lineMap);
+    void save(string entry, vector<string> &includedFiles,
+              vector<string> &missedFiles,
+              string &outString, string &errString, PPMap *lineMap);
+
+    string cacheDir;
+    std::mutex hashLock;
+    map<string, string> hashes;       // Content hash by file name
+};
+
+#endif // PREPROCCACHE_H
@@ -0,0 +1,45 @@
+/*  Copyright 2016, Robert Ankeney
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/
+*/
+
+#include "processjob.h"
+#include <stdlib.h>
+#include <limits.h>
+
+ProcessJob::ProcessJob(const std::string &jsonFileName,
+                       const std::string &preProcFileName,
+                       bool showLineMarkers,
+                       const VAMP_REPORT_CONFIG &reportConfig) :
+    ReportJob(jsonFileName, preProcFileName, showLineMarkers, reportConfig),
+    done(0)
+{
+    // Results are collected by the GUI after the pool finishes with us
+    setAutoDelete(false);
+}
+
+void ProcessJob::run()
+{
+    ReportJob::run();
+
+    // Add a delimiter to error output
+    char respath[PATH_MAX];
+    char *pth = realpath(jsonName.c_str(), respath);
+    ostringstream delim;
+    delim << "\033[37m+++++\033[0m\033[30m " << (pth ? pth : jsonName.c_str()) <<
+             " \033[0m\033[37m+++++\033[0m\n\n";
+    errStr = delim.str() + errStr;
+
+    done.storeRelease(1);
+}
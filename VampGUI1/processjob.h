@@ -0,0 +1,42 @@
+/*  Copyright 2016, Robert Ankeney
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/
+*/
+
+#ifndef PROCESSJOB_H
+#define PROCESSJOB_H
+
+#include "reportjob.h"
+#include <QRunnable>
+#include <QAtomicInt>
+
+// Generate the report for a single file on a worker thread.
+// The GUI shows the buffered output once the job is done.
+class ProcessJob : public QRunnable, public ReportJob
+{
+public:
+    ProcessJob(const std::string &jsonFileName,
+               const std::string &preProcFileName,
+               bool showLineMarkers,
+               const VAMP_REPORT_CONFIG &reportConfig);
+
+    void run();
+
+    bool isDone() { return done.loadAcquire() != 0; }
+
+private:
+    QAtomicInt done;
+};
+
+#endif // PROCESSJOB_H
@@ -0,0 +1,83 @@
+/*  Copyright 2016, Robert Ankeney
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/
+*/
+
+
+#include "reportjob.h"
+
+ReportJob::ReportJob(const string &jsonFileName, const string &preProcFileName,
+                     bool showLineMarkers,
+                     const VAMP_REPORT_CONFIG &reportConfig) :
+  jsonName(jsonFileName),
+  upToDate(false),
+  success(false),
+  preProcName(preProcFileName),
+  lineMarkers(showLineMarkers),
+  vcReportData(reportConfig)
+{
+}
+
+void ReportJob::run()
+{
+  ostringstream vOut;
+  ostringstream vErr;
+
+  try
+  {
+    VampProcess vampProcess(&vOut, &vErr);
+    if (lineMarkers)
+      vampProcess.processLineMarkers((char *) preProcName.c_str());
+
+    success = vampProcess.processFile((char *) jsonName.c_str(), vcReportData);
+    if (success)
+    {
+      outputs = vampProcess.getReportOutputs();
+      upToDate = vampProcess.isUpToDate();
+      if (!upToDate)
+      {
+        ostringstream totalStr;
+        vampProcess.writeJsonTotals(totalStr);
+        totals = totalStr.str();
+      }
+    }
+  }
+  catch(int i)
+  {
+    success = false;
+  }
+
+  outStr = vOut.str();
+  errStr = vErr.str();
+}
+
+// See if the last report is still current, without generating one. If
+// so its outputs are collected as run() would, for merged reports over
+// files that were not reported this time.
+bool ReportJob::checkUpToDate()
+{
+  ostringstream vOut;
+  ostringstream vErr;
+
+  VampProcess vampProcess(&vOut, &vErr);
+  if (lineMarkers)
+    vampProcess.processLineMarkers((char *) preProcName.c_str());
+
+  upToDate = vampProcess.reportUpToDate(jsonName, vcReportData);
+  success = upToDate;
+  if (upToDate)
+    outputs = vampProcess.getReportOutputs();
+
+  return upToDate;
+}
@@ -0,0 +1,49 @@
+/*  Copyright 2016, Robert Ankeney
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/
+*/
+
+
+#ifndef REPORTJOB_H
+#define REPORTJOB_H
+
+#include "vamp_process.h"
+
+// Generate the report for a single .json database.
+// All output is buffered so callers running several jobs at once can
+// show it in file order. Shared by the GUI and vamp-report.
+class ReportJob
+{
+public:
+  ReportJob(const string &jsonFileName, const string &preProcFileName,
+            bool showLineMarkers, const VAMP_REPORT_CONFIG &reportConfig);
+
+  void run();
+  bool checkUpToDate();
+
+  string jsonName;
+  string outStr;
+  string errStr;
+  string totals;           // JSON coverage totals if report was generated
+  vector<string> outputs;  // Files written, or kept if report was up to date
+  bool upToDate;           // Report was current so was not regenerated
+  bool success;
+
+private:
+  string preProcName;
+  bool lineMarkers;
+  VAMP_REPORT_CONFIG vcReportData;
+};
+
+#endif // REPORTJOB_H
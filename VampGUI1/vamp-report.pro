@@ -0,0 +1,31 @@
+#-------------------------------------------------
+#
+# vamp-report: command line report generator for build servers.
+# Needs neither Qt nor a display.
+#
+#-------------------------------------------------
+
+CONFIG   -= qt app_bundle
+CONFIG   += console thread
+
+TARGET = vamp-report
+TEMPLATE = app
+
+SOURCES += vamp_report.cpp
+
+DEFINES += _GNU_SOURCE
+DEFINES += __STDC_CONSTANT_MACROS
+DEFINES += __STDC_FORMAT_MACROS
+DEFINES += __STDC_LIMIT_MACROS
+
+QMAKE_CXXFLAGS += -fpermissive -std=c++11
+QMAKE_CXXFLAGS_WARN_ON = ""
+QMAKE_CXXFLAGS += -Wno-all
+QMAKE_CXXFLAGS += -Wno-unused-variable
+QMAKE_CXXFLAGS += -Wno-unused-parameter
+QMAKE_CXXFLAGS += -Wno-switch
+QMAKE_CXXFLAGS += -Wreturn-type
+
+include(vampcore.pri)
+
+INCLUDEPATH += c:/llvm/3.7/include
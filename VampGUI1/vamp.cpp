@@ -110,7 +110,10 @@
  *             ...
  *     // Nth MCDC overflow expression starting and ending line/column
  *     [<l1>,<c1>,<l2>,<c2>]
- *   ]
+ *   ],
+ *   // Coverage history of earlier runs, as hex, for probes left out
+ *   // (skip_covered only)
+ *   "pre_covered": "<hex>"
  * }
  * Note the quad <ln>,<cn>,<l(n+1)>,<c(n+1)> denotes:
  * <ln>     Starting line number
@@ -166,6 +169,12 @@
 #include "vamp_ostream.h"
 #include "path.h"
 
+// True if probe num was covered by earlier runs, so can be left out
+static bool coveredProbe(vector<bool> &probes, int num)
+{
+  return (num < probes.size()) && probes[num];
+}
+
 void MyRecursiveASTVisitor::SetVampOptions(VAMP_CONFIG &vo)
 {
   doStmtSingle = vo.doStmtSingle;
@@ -177,6 +186,8 @@ void MyRecursiveASTVisitor::SetVampOptions(VAMP_CONFIG &vo)
   saveSuffix = vo.saveSuffix;
   mcdcStackSize = vo.mcdcStackSize;
   langStandard = vo.langStandard;
+  registerProbes = vo.registerProbes;
+  probeShards = vo.probeShards;
 }
 
 void MyRecursiveASTVisitor::stripPath(string fileName, string &returnPath, string &returnName)
@@ -273,6 +284,7 @@ bool MyRecursiveASTVisitor::PrepareResults(string &dirName, string outName, cons
   mcdcValSaveName = "_vamp_" + fileName + "_mcdc_val_save";
   // REQ# MCDC007
   mcdcValOffsetName = "_vamp_" + fileName + "_mcdc_val_offset";
+  tuName = "_vamp_" + fileName + "_tu";
   // REQ# STMT019
   varName = "_vamp_" + fileName + "_var";
 
@@ -478,7 +490,10 @@ CDBG << "Adding inst at " << instData[useIndex].atLine << ", " << instData[useIn
 #endif
       // REQ# STMT002
       ostringstream repl;
-      repl << prefix << stmtName << "(" << instCnt << ");" << suffix;
+      if (coveredProbe(covered.stmt, instCnt))
+        repl << prefix << suffix;
+      else
+        repl << prefix << stmtName << "(" << instCnt << ");" << suffix;
 
       string str = repl.str();
       vampRewriter.InsertText(instData[useIndex].Loc, str);
@@ -492,6 +507,9 @@ CDBG << "Adding inst at " << instData[useIndex].atLine << ", " << instData[useIn
     instrInfo << "\n  ]";
   }
 
+  if (!CheckCoveredProbes())
+    return false;
+
   vampRewriter.ProcessRewriteNodes(Rewrite);
 
   *outFile << "// Instrumented by VAMP\n\n";
@@ -552,9 +570,14 @@ CDBG << "Adding inst at " << instData[useIndex].atLine << ", " << instData[useIn
       mcdcValType = "static unsigned short ";
     }
     else
+    if (mcdcMultiByte == 4)
     {
       mcdcValType = "static unsigned int ";
     }
+    else
+    {
+      mcdcValType = "static unsigned long long ";
+    }
     // REQ# MCDC010
     *outFile << mcdcValType << mcdcValName << " = 1;\n";
     // REQ# MCDC011
@@ -642,7 +665,7 @@ CDBG << "Adding inst at " << instData[useIndex].atLine << ", " << instData[useIn
     // REQ# MCDC018
     // REQ# MCDC026
     *outFile << "#define " << mcdcSetBitName << "(val, bit) ((val) ? (" <<
-                 mcdcValName << " |= (2 << bit)), 1 : 0)\n";
+                 mcdcValName << " |= " << mcdcBitValue() << "), 1 : 0)\n";
     if (mcdcMultiByte > 1)
     {
       // REQ# MCDC009
@@ -956,6 +979,9 @@ CDBG << "Adding inst at " << instData[useIndex].atLine << ", " << instData[useIn
   *outFile << "}\n\n";
 #else
   ostringstream macros;
+  ostringstream tables;   // MC/DC tables of a file registering its probes
+  // Registered probes pick the calling thread's copy of sharded tables
+  string shard = (registerProbes && (probeShards > 1)) ? "[_VAMP_SHARD]" : "";
 
   // FIXME - Create ostringstreams for macros and externs, so we
   // don't need to repeat the "if (doXXX)", then append them to *outFile.
@@ -972,7 +998,10 @@ CDBG << "Adding inst at " << instData[useIndex].atLine << ", " << instData[useIn
       {
           // REQ# STMT003
           // Output for doStmtSingle or doBranch (myInstCnt > 0)
-          macros << "#define " << stmtName << "(i) _vamp_stmt_array[_vamp_stmt_index[" << indexName << "] + (i >> 3)] |= (1 << (i & 7))\n";
+          if (registerProbes)
+            macros << "#define " << stmtName << "(i) " << instName << shard << "[(i) >> 3] |= (1 << ((i) & 7))\n";
+          else
+            macros << "#define " << stmtName << "(i) _vamp_stmt_array[_vamp_stmt_index[" << indexName << "] + (i >> 3)] |= (1 << (i & 7))\n";
       }
   }
   else
@@ -989,7 +1018,10 @@ CDBG << "Adding inst at " << instData[useIndex].atLine << ", " << instData[useIn
           // FIXME : Handle 16-bit array (add [2])
           //         Watch for overflow?
           // REQ# STMT004
-          macros << "#define " << stmtName << "(i) ++_vamp_stmt_array[_vamp_stmt_index[" << indexName << "] + i]\n";
+          if (registerProbes)
+            macros << "#define " << stmtName << "(i) ++" << instName << shard << "[i]\n";
+          else
+            macros << "#define " << stmtName << "(i) ++_vamp_stmt_array[_vamp_stmt_index[" << indexName << "] + i]\n";
       }
   }
 
@@ -1004,9 +1036,14 @@ CDBG << "Adding inst at " << instData[useIndex].atLine << ", " << instData[useIn
       if (myBranchCnt)
       {
         // REQ# BRCH004
-        macros << "#define " << branchName << "(c, i) ((c) ? ((_vamp_branch_array[_vamp_branch_index[" <<
-                  indexName << "] + (i >> 3)] |= (2 << (i & 7))), 1) : ((_vamp_branch_array[_vamp_branch_index[" <<
-                  indexName << "] + (i >> 3)] |= (1 << (i & 7))), 0))\n";
+        if (registerProbes)
+          macros << "#define " << branchName << "(c, i) ((c) ? ((" << branchesName << shard <<
+                    "[(i) >> 3] |= (2 << ((i) & 7))), 1) : ((" << branchesName << shard <<
+                    "[(i) >> 3] |= (1 << ((i) & 7))), 0))\n";
+        else
+          macros << "#define " << branchName << "(c, i) ((c) ? ((_vamp_branch_array[_vamp_branch_index[" <<
+                    indexName << "] + (i >> 3)] |= (2 << (i & 7))), 1) : ((_vamp_branch_array[_vamp_branch_index[" <<
+                    indexName << "] + (i >> 3)] |= (1 << (i & 7))), 0))\n";
       }
   }
 
@@ -1021,9 +1058,14 @@ CDBG << "Adding inst at " << instData[useIndex].atLine << ", " << instData[useIn
       if (myCondCnt > 0)
       {
         // REQ# COND003
-        macros << "#define " << condName << "(c, i) ((c) ? ((_vamp_cond_array[_vamp_cond_index[" <<
-                  indexName << "] + (i >> 3)] |= (2 << (i & 7))), 1) : ((_vamp_cond_array[_vamp_cond_index[" <<
-                  indexName << "] + (i >> 3)] |= (1 << (i & 7))), 0))\n";
+        if (registerProbes)
+          macros << "#define " << condName << "(c, i) ((c) ? ((" << condsName << shard <<
+                    "[(i) >> 3] |= (2 << ((i) & 7))), 1) : ((" << condsName << shard <<
+                    "[(i) >> 3] |= (1 << ((i) & 7))), 0))\n";
+        else
+          macros << "#define " << condName << "(c, i) ((c) ? ((_vamp_cond_array[_vamp_cond_index[" <<
+                    indexName << "] + (i >> 3)] |= (2 << (i & 7))), 1) : ((_vamp_cond_array[_vamp_cond_index[" <<
+                    indexName << "] + (i >> 3)] |= (1 << (i & 7))), 0))\n";
       }
   }
 
@@ -1049,23 +1091,49 @@ CDBG << "Adding inst at " << instData[useIndex].atLine << ", " << instData[useIn
               *vinfFile << mcdcOpCnt[i];
               myMcdcCnt += mcdcOpCnt[i];
           }
+          // Registered files pass their own tables rather than an index
+          string mcdcFile = indexName;
+          string mcdcVal = "_vamp_mcdc_val[" + indexName + "]";
+          string bitValue = mcdcBitValue();
+          if (registerProbes)
+          {
+            mcdcFile = "&" + tuName;
+            mcdcVal = tuName + ".mcdc_val";
+            bitValue = "((unsigned long long) 2 << bit)";
+
+            // Start of each expression's saved vectors
+            tables << "static unsigned char " << mcdcValSaveName << "[" <<
+                      myMcdcCnt << "];\n";
+            tables << "static const unsigned int " << mcdcValOffsetName <<
+                      "[" << mcdcOpCnt.size() + 1 << "] = {";
+            for (int i = 0, offset = 0; i <= mcdcOpCnt.size(); ++i)
+            {
+              tables << (i ? ", " : " ") << offset;
+              if (i < mcdcOpCnt.size())
+                offset += mcdcOpCnt[i];
+            }
+            tables << " };\n";
+            tables << "static unsigned long long " << mcdcStackName << "[" <<
+                      mcdcStackSize << "];\n";
+          }
+
 // FIXME: Consider directly calling _vamp_mcdc_set_first with val, and returning (val != 0)
         // Insert MC/DC definitions
         // REQ# MCDC027
         macros << "#define " << mcdcSetFirstBitName <<
-                  "(val, bit) _vamp_mcdc_set_first(" << indexName <<
+                  "(val, bit) _vamp_mcdc_set_first(" << mcdcFile <<
                   ", (val) != 0, bit)\n";
         // REQ# MCDC018
         // REQ# MCDC026
         macros << "#define " << mcdcSetBitName <<
-                  "(val, bit) ((val) ? (_vamp_mcdc_val[" <<
-                  indexName << "] |= (2 << bit)), 1 : 0)\n";
+                  "(val, bit) ((val) ? (" << mcdcVal << " |= " <<
+                  bitValue << "), 1 : 0)\n";
         if (mcdcMultiByte > 1)
         {
           // REQ# MCDC009
           // REQ# MCDC019
           macros << "#define " << mcdcName << "(result, exprNum, byteCnt) " <<
-                    "_vamp_mcdc_collect(" << indexName <<
+                    "_vamp_mcdc_collect(" << mcdcFile <<
                     ", result, exprNum, byteCnt)\n";
         }
         else
@@ -1074,20 +1142,82 @@ CDBG << "Adding inst at " << instData[useIndex].atLine << ", " << instData[useIn
           // REQ# MCDC009
           // REQ# MCDC020
           macros << "#define " << mcdcName << "(result, exprNum, byteCnt) " <<
-                    "_vamp_mcdc_collect(" << indexName <<
+                    "_vamp_mcdc_collect(" << mcdcFile <<
                     ", result, exprNum, 1)\n";
         }
       }
 
       *vinfFile << " ],\n";
 
-      *vinfFile << "  \"mcdc_size\": " << myMcdcCnt << "\n";
+      *vinfFile << "  \"mcdc_size\": " << myMcdcCnt << ",\n";
+
+      // Widest MC/DC vector in file, so _vamp_mcdc_val can be sized
+      *vinfFile << "  \"mcdc_bytes\": " << mcdcMultiByte << "\n";
   }
 
   *vinfFile << "}\n";
   vinfFile->close();
 
   *outFile << "#include \"vamp_output.h\"\n\n";
+
+  if (registerProbes)
+  {
+    // The file owns its probe tables; a record in the vamp_tu section
+    // (or a constructor in a shared library) lets _vamp_output() find them
+    string stmtTable = "0";
+    string countTable = "0";
+    int stmtSize = 0;
+    if (doStmtSingle || doBranch)
+    {
+      if (myInstCnt)
+      {
+        stmtTable = DeclareProbeTable("unsigned char", instName, myInstCnt, 1);
+        stmtSize = myInstCnt;
+      }
+    }
+    else
+    if (doStmtCount && instCnt)
+    {
+      countTable = DeclareProbeTable("unsigned int", instName, instCnt, 4);
+      stmtSize = instCnt;
+    }
+
+    string branchTable = "0";
+    int branchSize = 0;
+    if (doBranch && myBranchCnt)
+    {
+      branchTable = DeclareProbeTable("unsigned char", branchesName, myBranchCnt, 1);
+      branchSize = myBranchCnt;
+    }
+
+    string condTable = "0";
+    int condSize = 0;
+    if (doCC && myCondCnt)
+    {
+      condTable = DeclareProbeTable("unsigned char", condsName, myCondCnt, 1);
+      condSize = myCondCnt;
+    }
+
+    int myMcdcCnt = 0;
+    for (int i = 0; i < mcdcOpCnt.size(); ++i)
+      myMcdcCnt += mcdcOpCnt[i];
+
+    bool gotMcdc = doMCDC && (mcdcOpCnt.size() > 0);
+    *outFile << tables.str();
+    *outFile << "static struct _vamp_tu " << tuName << " = {\n";
+    *outFile << "  \"" << fileName << "\", " << stmtTable << ", " <<
+                countTable << ", " << stmtSize << ",\n";
+    *outFile << "  " << branchTable << ", " << branchSize << ", " <<
+                condTable << ", " << condSize << ",\n";
+    if (gotMcdc)
+      *outFile << "  " << mcdcValSaveName << ", " << myMcdcCnt << ", " <<
+                  mcdcValOffsetName << ", " << mcdcStackName << "\n";
+    else
+      *outFile << "  0, 0, 0, 0\n";
+    *outFile << "};\n";
+    *outFile << "_VAMP_REGISTER_TU(" << tuName << ")\n\n";
+  }
+
   *outFile << macros.str() << "\n";
 #endif
 
@@ -1221,6 +1351,12 @@ CDBG << "Adding inst at " << instData[useIndex].atLine << ", " << instData[useIn
     *infoFile << "\n  ]";
   }
 
+  if (!covered.history.empty())
+  {
+    // Coverage of probes left out, for processing of results
+    *infoFile << ",\n  \"pre_covered\": \"" << covered.history << "\"";
+  }
+
   *infoFile << "\n}\n";
 
   *vampOut << "Statements counted: " << stmtCnt << ENDL;
@@ -1791,11 +1927,13 @@ void MyRecursiveASTVisitor::InstrumentWhile(StmtType type, Stmt *s, Stmt *body,
 //CDBG << "While bool =" << expr->isKnownToHaveBooleanValue() << ENDL;
       ostringstream repl;
       repl << ", " << branchCnt << ")";
+      bool skip = coveredProbe(covered.branch, branchCnt);
       branchCnt += 2;
       gotBranchInfo = true;
 
       // REQ# BRCH001
-      vampRewriter.addRewriteNode(locStart, branchName + "(", locEnd, repl.str());
+      if (!skip)
+        vampRewriter.addRewriteNode(locStart, branchName + "(", locEnd, repl.str());
     }
   }
 
@@ -1869,8 +2007,17 @@ void MyRecursiveASTVisitor::InstTreeNode(int *nodeCnt, mcdcNode *node, bool doRH
 
   if (CheckLoc(E->getLocStart()))
   {
+    // Expression already shown for every operand? Count it, but leave
+    // the source alone.
+    bool skip = coveredProbe(covered.mcdc, mcdcCnt);
+
     if (!doRHS && (*nodeCnt == 0))
     {
+      if (skip)
+      {
+        // Nothing to insert
+      }
+      else
       if ((node->lhsMinLine == exprTree.root->lhsMinLine) &&
           (node->lhsMinCol  == exprTree.root->lhsMinCol))
       {
@@ -1894,6 +2041,7 @@ void MyRecursiveASTVisitor::InstTreeNode(int *nodeCnt, mcdcNode *node, bool doRH
       }
     }
     else
+    if (!skip)
     {
       // Insert LHS at start of left-hand expression
       vampRewriter.addMCDCLeftNode(E->getLocStart(), mcdcSetBitName + "(");
@@ -1916,7 +2064,8 @@ void MyRecursiveASTVisitor::InstTreeNode(int *nodeCnt, mcdcNode *node, bool doRH
         ostringstream tmpRepl;
         tmpRepl << ", " << *nodeCnt << ")";
         SourceLocation loc = GetLocAfter(E->getLocEnd());
-        vampRewriter.addMCDCRightNode(loc, tmpRepl.str());
+        if (!skip)
+          vampRewriter.addMCDCRightNode(loc, tmpRepl.str());
       }
 
       // Complete call to _vamp_<file>_mcdc(result, mcdcCnt)
@@ -1937,9 +2086,17 @@ cout << falseStr[i] << "\n";
       int bytes;
       if (*nodeCnt > 6)
       {
+        if (*nodeCnt > 30)
+        {
+          mcdcMultiByte = 8;
+          bytes = 8;
+          mcdcOpCnt.push_back(8 * (falseStr.size() + trueStr.size()));
+        }
+        else
         if (*nodeCnt > 14)
         {
-          mcdcMultiByte = 4;
+          if (mcdcMultiByte < 4)
+            mcdcMultiByte = 4;
           bytes = 4;
           mcdcOpCnt.push_back(4 * (falseStr.size() + trueStr.size()));
         }
@@ -1959,10 +2116,12 @@ cout << falseStr[i] << "\n";
 
       endRepl << ", " << mcdcCnt++ << ", " << bytes << ")";
 
-      vampRewriter.addMCDCRightNode(GetLocAfter(exprTree.root->E->getLocEnd()),
-                                    endRepl.str());
+      if (!skip)
+        vampRewriter.addMCDCRightNode(GetLocAfter(exprTree.root->E->getLocEnd()),
+                                      endRepl.str());
     }
     else
+    if (!skip)
     {
       // Insert count and closing paren at end of left-hand expression
       ostringstream endRepl;
@@ -1975,6 +2134,81 @@ cout << falseStr[i] << "\n";
   }
 }
 
+// Expression setting the MC/DC vector bit for operand "bit". Shifts past
+// bit 30 need a 64-bit constant, so only files with wide expressions use one.
+string MyRecursiveASTVisitor::mcdcBitValue()
+{
+  return (mcdcMultiByte > 4) ? "((unsigned long long) 2 << bit)" : "(2 << bit)";
+}
+
+// Declare a file-local probe table of cnt entries of width bytes.
+// Sharded tables get one copy per shard, each padded to whole cache
+// lines so threads writing different shards never share a line.
+// Returns the address of the first shard for the registration record.
+string MyRecursiveASTVisitor::DeclareProbeTable(string type, string name, int cnt, int width)
+{
+  if (probeShards > 1)
+  {
+    int perLine = PROBE_SHARD_ALIGN / width;
+    int stride = (cnt + perLine - 1) / perLine * perLine;
+    *outFile << "static " << type << " " << name << "[" << probeShards <<
+                "][" << stride << "] __attribute__((aligned(" <<
+                PROBE_SHARD_ALIGN << ")));\n";
+    return name + "[0]";
+  }
+
+  *outFile << "static " << type << " " << name << "[" << cnt << "];\n";
+  return name;
+}
+
+// Verify probes left out for coverage of earlier runs (skip_covered) were
+// numbered from the same source and options as that history. Any change
+// would leave the carried forward coverage on the wrong statements.
+bool MyRecursiveASTVisitor::CheckCoveredProbes()
+{
+  if (covered.history.empty())
+    return true;
+
+  unsigned char opts = (doStmtSingle ? DO_STATEMENT_SINGLE : 0) |
+                       (doStmtCount ? DO_STATEMENT_COUNT : 0) |
+                       (doBranch ? DO_BRANCH : 0) |
+                       (doMCDC ? DO_MCDC : 0) |
+                       (doCC ? DO_CONDITION : 0);
+
+  // Table sizes as stored in the history file
+  int stmtSize = 0;
+  if (doStmtCount)
+    stmtSize = instCnt;
+  else
+  if (doStmtSingle || doBranch)
+    stmtSize = (instCnt + 7) / 8;
+
+  int branchSize = doBranch ? (branchCnt + 6) / 8 : 0;
+
+  int mcdcSize = 0;
+  if (doMCDC)
+  {
+    for (int i = 0; i < mcdcOpCnt.size(); i++)
+      mcdcSize += mcdcOpCnt[i];
+  }
+
+  int condSize = (doCC && !doMCDC) ? (condCnt + 6) / 8 : 0;
+
+  if ((opts != covered.options) ||
+      (stmtSize != covered.stmtSize) ||
+      (branchSize != covered.branchSize) ||
+      (mcdcSize != covered.mcdcSize) ||
+      (condSize != covered.condSize))
+  {
+    *vampErr << "Coverage history of " << fileName <<
+                " does not match source - instrument without skip_covered" <<
+                ENDL;
+    return false;
+  }
+
+  return true;
+}
+
 // Code to do cleanup at end of function. Loc is current SourceLocation.
 void MyRecursiveASTVisitor::FunctionEnd(SourceLocation Loc)
 {
@@ -2014,7 +2248,7 @@ void MyRecursiveASTVisitor::CheckMCDCExprEnd()
     {
       int nodeCnt = 0;
       exprTreeLeafCnt = exprTree.nodeCount(exprTree.root);
-      if (exprTreeLeafCnt < 32)
+      if (exprTreeLeafCnt <= MCDC_MAX_OPERANDS)
       {
         exprTree.getFalse(exprTree.root, &falseStr);
         exprTree.getTrue(exprTree.root, &trueStr);
@@ -2034,7 +2268,8 @@ CDBG << trueStr[i] << ENDL;
       else
       {
         *vampErr << "MC/DC expression too complex at line " << logicalOpLine << ENDL;
-        *vampErr << exprTreeLeafCnt << " operands exceeds maximum of 32" << ENDL;
+        *vampErr << exprTreeLeafCnt << " operands exceeds maximum of " <<
+                    MCDC_MAX_OPERANDS << ENDL;
         *vampErr << "Instrumentation skipped for this expression" << ENDL;
 
 // FIXME - Decide whether to abort or set a fail flag somewhere
@@ -2076,10 +2311,13 @@ Expr *MyRecursiveASTVisitor::VisitBinaryOperator(BinaryOperator *E)
   {
     if (doCC)
     {
+      bool skip = coveredProbe(covered.cond, condCnt);
+
       // REQ# COND002
       // Insert opening paren at start of left-hand expression
       string cmp = condName + "(";
-      vampRewriter.InsertText(E->getLHS()->getLocStart(), cmp);
+      if (!skip)
+        vampRewriter.InsertText(E->getLHS()->getLocStart(), cmp);
 
       ostringstream rRepl;
       rRepl << ", " << condCnt << ")";
@@ -2088,7 +2326,8 @@ Expr *MyRecursiveASTVisitor::VisitBinaryOperator(BinaryOperator *E)
       // Insert count and closing paren at end of right-hand expression
       //Rewrite.InsertTextAfterToken(E->getRHS()->getLocEnd(), rRepl.str());
       SourceLocation loc = GetLocAfter(E->getRHS()->getLocEnd());
-      vampRewriter.InsertText(loc, rRepl.str());
+      if (!skip)
+        vampRewriter.InsertText(loc, rRepl.str());
 
       int line, col;
       // Insert position of LHS
@@ -2371,7 +2610,7 @@ CDBG << "Variable declaration " << ND->getName() <<
              {
                // Yes - insert end of conditional instrumentation now
                // with ", <condition number>)"
-               if (doBranch && CheckLoc(ifEndLoc))
+               if (doBranch && CheckLoc(ifEndLoc) && !ifRepl.empty())
                {
                  // REQ# BRCH001
                  // REQ# BRCH007
@@ -2546,11 +2785,13 @@ CDBG << "getExpansionRange Second = " << l << ", " << c << ENDL;
     {
       ostringstream repl;
       repl << ", " << branchCnt << ")";
+      bool skip = coveredProbe(covered.branch, branchCnt);
       branchCnt += 2;
       gotBranchInfo = true;
       // REQ# BRCH001
-      vampRewriter.addRewriteNode(sr.getBegin(), branchName + "(",
-                                  GetLocAfter(sr.getEnd()), repl.str());
+      if (!skip)
+        vampRewriter.addRewriteNode(sr.getBegin(), branchName + "(",
+                                    GetLocAfter(sr.getEnd()), repl.str());
     }
   }
 
@@ -2715,10 +2956,14 @@ CDBG << "exit() nextCase = " << nextCase << "; type = " << tk << endl;
 #endif
         ostringstream repl;
         repl << ", " << branchCnt << ")";
+        // Leave ifRepl empty if both directions already covered
+        if (!coveredProbe(covered.branch, branchCnt))
+          ifRepl = repl.str();
+        else
+          ifRepl = "";
         branchCnt += 2;
         gotBranchInfo = true;
 
-        ifRepl = repl.str();
 //FIXME: New rewriter should handle this OK
         //Rewrite.InsertText(ifEndLoc, ifRepl.str(), true, true);
         // Flag statement so that ifRepl is placed at the end of the statement
@@ -3245,7 +3490,8 @@ bool MyASTConsumer::HandleTopLevelDecl(DeclGroupRef d)
 
 // Instrument file with command line options and selected vampOptions
 // Returns true on success, and false on failure
-bool Vamp::Instrument(int argc, char *argv[], string outName, VAMP_CONFIG &vampOptions)
+bool Vamp::Instrument(int argc, char *argv[], string outName, VAMP_CONFIG &vampOptions,
+                      VAMP_COVERED_PROBES *covered)
 {
   //CompilerInstance compiler;
 //std::unique_ptr<CompilerInstance> compiler(new CompilerInstance());
@@ -3324,6 +3570,8 @@ IntrusiveRefCntPtr<DiagnosticOptions> diagOpts = new DiagnosticOptions();
   MyASTConsumer astConsumer(Rewrite, vampOut, vampErr);
 
   astConsumer.rv.SetVampOptions(vampOptions);
+  if (covered != NULL)
+    astConsumer.rv.SetCoveredProbes(*covered);
   if (!astConsumer.rv.PrepareResults(dirName, outName, fileName.c_str()))
   {
     return false;
@@ -183,7 +183,8 @@ public :
   Vamp(VAMP_ERR_STREAM *outStr, VAMP_ERR_STREAM *errStr) : vampOut(outStr), vampErr(errStr)
   {
   }
-  bool Instrument(int argc, char *argv[], string outName, VAMP_CONFIG &vampOptions);
+  bool Instrument(int argc, char *argv[], string outName, VAMP_CONFIG &vampOptions,
+                  VAMP_COVERED_PROBES *covered = NULL);
 
 private:
   VAMP_ERR_STREAM *vampOut;
@@ -257,11 +258,14 @@ class MyRecursiveASTVisitor
     mcdcStackSize = MCDC_STACK_SIZE;
     // REQ# CONF020
     langStandard = clang::LangStandard::lang_c89;
+    registerProbes = false;
+    probeShards = 0;
 
     forceStmtInst = false;
   }
 
   void SetVampOptions(VAMP_CONFIG &vo);
+  void SetCoveredProbes(VAMP_COVERED_PROBES &probes) { covered = probes; }
   void stripPath(string fileName, string &returnPath, string &returnName);
   bool PrepareResults(string &dirName, string outName, const char *f);
   bool ProcessResults(string &dirName, time_t &modTime);
@@ -295,6 +299,9 @@ private:
   void NewBlock(StmtType type, SourceLocation loc);
   void InstTree(int *nodeCnt, mcdcNode *node);
   void InstTreeNode(int *nodeCnt, mcdcNode *node, bool doRHS);
+  string mcdcBitValue();
+  string DeclareProbeTable(string type, string name, int cnt, int width);
+  bool CheckCoveredProbes();
 
   bool recoverOnError;
   llvm::raw_fd_ostream *outFile;
@@ -325,6 +332,7 @@ private:
   string mcdcStackOverflowName;
   string mcdcValSaveName;
   string mcdcValOffsetName;
+  string tuName;           // Registration record of file's probe tables
   string varName;
   string infoName;
   int funcCnt;            // Number of functions found
@@ -416,11 +424,19 @@ private:
   string saveSuffix;      // Suffix for vamp-generated files
   int mcdcStackSize;      // Size of MC/DC stack
   clang::LangStandard::Kind langStandard; // Selected language standard
+  bool registerProbes;    // Probe tables are file-local and registered at
+                          // link time rather than indexed through
+                          // vamp_output.c
+  int probeShards;        // Copies of registered probe tables, one per
+                          // thread or core (0 or 1 for none)
+  VAMP_COVERED_PROBES covered; // Probes covered by earlier runs, which
+                          // are left out (skip_covered)
   int mcdcMultiByte;      // Number of bytes used to handle MCDC
                           // expression:
                           // 1 for <= 7 operands
                           // 2 for > 7 && <= 15 operands
                           // 4 for > 15 && <= 31 operands
+                          // 8 for > 31 && <= 63 operands
 #ifdef NEED_BYTE_COUNT
   ostringstream mcdcByteStr;
 #endif
@@ -428,7 +444,7 @@ private:
   vector<string> falseStr;
   vector<string> trueStr;
 
-  // Statements with more than 31 MCDC operators
+  // Statements with more than MCDC_MAX_OPERANDS MCDC operators
   // are not instrumented (error condition)
   vector<STMT_LOC> mcdcOverflow;
 
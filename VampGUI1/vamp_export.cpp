@@ -0,0 +1,753 @@
+/*  Copyright 2016, Robert Ankeney
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/
+*/
+
+
+// Machine-readable coverage exports (LCOV, Cobertura XML and JSON).
+// Built from the database and history once the coverage passes have run,
+// so they do not depend on the HTML report being generated.
+
+#include "vamp_process.h"
+#include "headercov.h"
+#include "variantcov.h"
+#include "version.h"
+#include <map>
+
+// Coverage of one line, merged from statements and decisions on it
+typedef struct {
+  bool hasCode;          // Line holds an instrumented statement
+  long long hits;        // Times line was executed (1 if not counting)
+  int outcomes;          // Branch/condition outcomes on line
+  int taken;             // Outcomes taken
+} lineExportType;
+
+// Escape str for an XML attribute
+static string xmlEscape(const string &str)
+{
+  string out;
+
+  for (size_t i = 0; i < str.size(); i++)
+  {
+    switch (str[i])
+    {
+      case '&':
+        out += "&amp;";
+        break;
+      case '<':
+        out += "&lt;";
+        break;
+      case '>':
+        out += "&gt;";
+        break;
+      case '"':
+        out += "&quot;";
+        break;
+      default:
+        out += str[i];
+        break;
+    }
+  }
+
+  return out;
+}
+
+// Rate as Cobertura writes it (0.0 - 1.0); 1 if there is nothing to cover
+static string coverageRate(long long covered, long long total)
+{
+  char rate[32];
+
+  sprintf(rate, "%.4f", total ? (double) covered / total : 1.0);
+  return rate;
+}
+
+// Get hit count for each line holding an instrumented statement, in line
+// order. Lines are those highlighted in the HTML report; counts come from
+// the nearest preceding statement probe.
+void VampProcess::getLineHits(vector<pair<int, long long> > &lineHits)
+{
+  if (!doStmtSingle && !doStmtCount)
+    return;
+
+  int whichStmt = 0;
+  long long count = 0;
+
+  for (int i = 0; i < db.functionInfo.size(); i++)
+  {
+    for (int line = db.functionInfo[i].loc.lhsLine;
+         line <= db.functionInfo[i].loc.rhsLine; line++)
+    {
+      bool hasCode = false;
+      bool covered = false;
+
+      for (int col = 1; col <= attribs.length(line);
+           col = attribs.runEnd(line, col) + 1)
+      {
+        unsigned char attrib = attribs.get(line, col);
+
+        if (attrib & STMT_CODE)
+        {
+          hasCode = true;
+          if (attrib & STMT_COVERED)
+            covered = true;
+        }
+      }
+
+      if (doStmtCount)
+      {
+        while ((whichStmt < db.instInfo.size()) &&
+               (db.instInfo[whichStmt].line <= line))
+          count = hist.covCntInfo[whichStmt++];
+      }
+
+      if (hasCode)
+      {
+        long long hits = 0;
+        if (covered)
+          hits = (doStmtCount && (count > 0)) ? count : 1;
+        lineHits.push_back(make_pair(line, hits));
+      }
+    }
+  }
+}
+
+// Get outcomes of each branch and condition from the history
+void VampProcess::getDecisions(vector<decisionExportType> &decisions)
+{
+  if (doBranch)
+  {
+    vector<ifElseInfoType>::iterator ifIter = db.ifElseInfo.begin();
+    vector<whileInfoType>::iterator whileIter = db.whileInfo.begin();
+    vector<forInfoType>::iterator forIter = db.forInfo.begin();
+    vector<switchInfoType>::iterator swIter = db.switchInfo.begin();
+    vector<branchInfoType>::iterator br;
+
+    for (br = db.branchInfo.begin(); br < db.branchInfo.end(); br++)
+    {
+      decisionExportType decision;
+      int branchNum = -1;
+
+      decision.type = br->statementType;
+
+      if (((br->statementType == "while") || (br->statementType == "do")) &&
+          (whileIter != db.whileInfo.end()))
+      {
+        decision.line = whileIter->exprLoc.lhsLine;
+        branchNum = whileIter->branchNum;
+        whileIter++;
+      }
+      else
+      if ((br->statementType == "for") && (forIter != db.forInfo.end()))
+      {
+        decision.line = forIter->exprLoc.lhsLine;
+        branchNum = forIter->branchNum;
+        forIter++;
+      }
+      else
+      if ((br->statementType == "if") && (ifIter != db.ifElseInfo.end()))
+      {
+        decision.line = ifIter->exprLoc.lhsLine;
+        branchNum = ifIter->branchNum;
+        ifIter++;
+      }
+      else
+      if ((br->statementType == "switch") && (swIter != db.switchInfo.end()))
+      {
+        // Each case is an outcome
+        decision.line = swIter->switchExprLoc.lhsLine;
+        for (int c = 0; c < swIter->caseInfo.size(); c++)
+        {
+          int instNum = swIter->caseInfo[c].instNum;
+          if (doStmtCount)
+            decision.taken.push_back(hist.covCntInfo[instNum] != 0);
+          else
+            decision.taken.push_back((hist.coveredInfo[instNum >> 3] &
+                                      (1 << (instNum & 7))) != 0);
+        }
+        swIter++;
+      }
+      else
+        continue;
+
+      if (branchNum >= 0)
+      {
+        if ((branchNum / 8) >= hist.branchCount)
+          continue;
+
+        int covered = (hist.brInfo[branchNum / 8] >> (branchNum & 7)) & 3;
+        decision.taken.push_back((covered & 2) != 0);   // TRUE
+        decision.taken.push_back((covered & 1) != 0);   // FALSE
+      }
+
+      decisions.push_back(decision);
+    }
+  }
+
+  if (doCC)
+  {
+    vector<condInfoType>::iterator cond;
+
+    for (cond = db.condInfo.begin(); cond < db.condInfo.end(); cond++)
+    {
+      if ((cond->condNum / 8) >= hist.condCount)
+        continue;
+
+      decisionExportType decision;
+      int covered = (hist.condInfo[cond->condNum / 8] >> (cond->condNum & 7)) & 3;
+
+      decision.line = cond->lhsLoc.lhsLine;
+      decision.type = "condition";
+      decision.taken.push_back((covered & 2) != 0);     // TRUE
+      decision.taken.push_back((covered & 1) != 0);     // FALSE
+      decisions.push_back(decision);
+    }
+  }
+}
+
+// Path of the source the line numbers refer to
+static string exportSourceName(VampDB &db)
+{
+  if (db.pathName.empty())
+    return db.fileName;
+
+  return db.pathName + DIRECTORY_SEPARATOR + db.fileName;
+}
+
+// Write LCOV tracefile. MC/DC results use the MCDC records of LCOV 2.2,
+// with the TRUE and FALSE halves of each operand's pair as its senses.
+bool VampProcess::genLcov(string fileName)
+{
+  ofstream out(fileName.c_str());
+  if (!out)
+  {
+    *vampErr << "Cannot create " << fileName << ENDL;
+    return false;
+  }
+
+  vector<pair<int, long long> > lineHits;
+  vector<decisionExportType> decisions;
+  getLineHits(lineHits);
+  getDecisions(decisions);
+
+  out << "TN:\n";
+  out << "SF:" << exportSourceName(db) << "\n";
+
+  // Functions are hit if any of their lines are
+  int funcHit = 0;
+  vector<long long> funcHits(db.functionInfo.size(), 0);
+  for (int i = 0, l = 0; i < db.functionInfo.size(); i++)
+  {
+    while ((l < lineHits.size()) &&
+           (lineHits[l].first <= db.functionInfo[i].loc.rhsLine))
+    {
+      if (lineHits[l].first >= db.functionInfo[i].loc.lhsLine)
+        funcHits[i] = max(funcHits[i], lineHits[l].second);
+      ++l;
+    }
+
+    out << "FN:" << db.functionInfo[i].loc.lhsLine << "," <<
+           db.functionInfo[i].function << "\n";
+  }
+  for (int i = 0; i < db.functionInfo.size(); i++)
+  {
+    out << "FNDA:" << funcHits[i] << "," << db.functionInfo[i].function << "\n";
+    if (funcHits[i])
+      ++funcHit;
+  }
+  out << "FNF:" << db.functionInfo.size() << "\n";
+  out << "FNH:" << funcHit << "\n";
+
+  // Branches and conditions, one block per decision
+  int brFound = 0;
+  int brHit = 0;
+  for (int i = 0; i < decisions.size(); i++)
+  {
+    bool reached = find(decisions[i].taken.begin(), decisions[i].taken.end(),
+                        true) != decisions[i].taken.end();
+
+    for (int j = 0; j < decisions[i].taken.size(); j++)
+    {
+      out << "BRDA:" << decisions[i].line << "," << i << "," << j << ",";
+      if (reached)
+        out << (decisions[i].taken[j] ? 1 : 0);
+      else
+        out << "-";
+      out << "\n";
+
+      ++brFound;
+      if (decisions[i].taken[j])
+        ++brHit;
+    }
+  }
+  if (brFound)
+  {
+    out << "BRF:" << brFound << "\n";
+    out << "BRH:" << brHit << "\n";
+  }
+
+  // MC/DC operands
+  int mcdcFound = 0;
+  int mcdcHit = 0;
+  for (int i = 0; i < mcdcExport.size(); i++)
+  {
+    mcdcExportType &e = mcdcExport[i];
+    int groupSize = e.senses.size();
+
+    for (int j = 0; j < groupSize; j++)
+    {
+      out << "MCDC:" << e.line << "," << groupSize << ",t," <<
+             ((e.senses[j] & 2) ? 1 : 0) << "," << j << "," <<
+             e.operands[j] << "\n";
+      out << "MCDC:" << e.line << "," << groupSize << ",f," <<
+             ((e.senses[j] & 1) ? 1 : 0) << "," << j << "," <<
+             e.operands[j] << "\n";
+
+      mcdcFound += 2;
+      mcdcHit += ((e.senses[j] & 2) ? 1 : 0) + ((e.senses[j] & 1) ? 1 : 0);
+    }
+  }
+  if (mcdcFound)
+  {
+    out << "MCF:" << mcdcFound << "\n";
+    out << "MCH:" << mcdcHit << "\n";
+  }
+
+  // Lines
+  int linesHit = 0;
+  for (int i = 0; i < lineHits.size(); i++)
+  {
+    out << "DA:" << lineHits[i].first << "," << lineHits[i].second << "\n";
+    if (lineHits[i].second)
+      ++linesHit;
+  }
+  out << "LF:" << lineHits.size() << "\n";
+  out << "LH:" << linesHit << "\n";
+  out << "end_of_record\n";
+
+  out.close();
+  return !out.fail();
+}
+
+// Write Cobertura XML. Branches and conditions on a line are reported as
+// its condition coverage; Cobertura has no place for MC/DC.
+bool VampProcess::genCobertura(string fileName)
+{
+  ofstream out(fileName.c_str());
+  if (!out)
+  {
+    *vampErr << "Cannot create " << fileName << ENDL;
+    return false;
+  }
+
+  vector<pair<int, long long> > lineHits;
+  vector<decisionExportType> decisions;
+  getLineHits(lineHits);
+  getDecisions(decisions);
+
+  // Merge statements and decisions by line
+  map<int, lineExportType> lines;
+  for (int i = 0; i < lineHits.size(); i++)
+  {
+    lineExportType &l = lines[lineHits[i].first];
+    l.hasCode = true;
+    l.hits = lineHits[i].second;
+    l.outcomes = 0;
+    l.taken = 0;
+  }
+  for (int i = 0; i < decisions.size(); i++)
+  {
+    map<int, lineExportType>::iterator it = lines.find(decisions[i].line);
+    if (it == lines.end())
+    {
+      lineExportType l = { false, 0, 0, 0 };
+      it = lines.insert(make_pair(decisions[i].line, l)).first;
+    }
+
+    for (int j = 0; j < decisions[i].taken.size(); j++)
+    {
+      ++it->second.outcomes;
+      if (decisions[i].taken[j])
+        ++it->second.taken;
+    }
+  }
+
+  long long linesValid = 0, linesCovered = 0;
+  long long branchesValid = 0, branchesCovered = 0;
+  map<int, lineExportType>::iterator it;
+  for (it = lines.begin(); it != lines.end(); ++it)
+  {
+    // Lines with only decisions count as hit if any outcome was taken
+    if (!it->second.hasCode)
+      it->second.hits = it->second.taken ? 1 : 0;
+
+    ++linesValid;
+    if (it->second.hits)
+      ++linesCovered;
+    branchesValid += it->second.outcomes;
+    branchesCovered += it->second.taken;
+  }
+
+  string lineRate = coverageRate(linesCovered, linesValid);
+  string branchRate = coverageRate(branchesCovered, branchesValid);
+
+  out << "<?xml version=\"1.0\" ?>\n";
+  out << "<!DOCTYPE coverage SYSTEM " <<
+         "\"http://cobertura.sourceforge.net/xml/coverage-04.dtd\">\n";
+  out << "<coverage line-rate=\"" << lineRate << "\" branch-rate=\"" <<
+         branchRate << "\" lines-covered=\"" << linesCovered <<
+         "\" lines-valid=\"" << linesValid << "\" branches-covered=\"" <<
+         branchesCovered << "\" branches-valid=\"" << branchesValid <<
+         "\" complexity=\"0\" version=\"" << VAMP_VERSION <<
+         "\" timestamp=\"" << (long long) time(NULL) * 1000 << "\">\n";
+  out << "  <sources>\n";
+  out << "    <source>" << xmlEscape(db.pathName) << "</source>\n";
+  out << "  </sources>\n";
+  out << "  <packages>\n";
+  out << "    <package name=\"" << xmlEscape(db.pathName) <<
+         "\" line-rate=\"" << lineRate << "\" branch-rate=\"" <<
+         branchRate << "\" complexity=\"0\">\n";
+  out << "      <classes>\n";
+  out << "        <class name=\"" << xmlEscape(db.fileName) <<
+         "\" filename=\"" << xmlEscape(db.fileName) << "\" line-rate=\"" <<
+         lineRate << "\" branch-rate=\"" << branchRate <<
+         "\" complexity=\"0\">\n";
+
+  // Each line element, indented by indent
+  ostringstream allLines;
+  out << "          <methods>\n";
+  for (int i = 0; i < db.functionInfo.size(); i++)
+  {
+    ostringstream funcLines;
+    long long fValid = 0, fCovered = 0, fOutcomes = 0, fTaken = 0;
+
+    map<int, lineExportType>::iterator first =
+      lines.lower_bound(db.functionInfo[i].loc.lhsLine);
+    map<int, lineExportType>::iterator last =
+      lines.upper_bound(db.functionInfo[i].loc.rhsLine);
+
+    for (it = first; it != last; ++it)
+    {
+      ostringstream line;
+      line << "<line number=\"" << it->first << "\" hits=\"" <<
+              it->second.hits << "\" branch=\"";
+      if (it->second.outcomes)
+      {
+        line << "true\" condition-coverage=\"" <<
+                (100 * it->second.taken / it->second.outcomes) << "% (" <<
+                it->second.taken << "/" << it->second.outcomes << ")\"/>";
+      }
+      else
+        line << "false\"/>";
+
+      funcLines << "                <" << line.str().substr(1) << "\n";
+      allLines << "            " << line.str() << "\n";
+
+      ++fValid;
+      if (it->second.hits)
+        ++fCovered;
+      fOutcomes += it->second.outcomes;
+      fTaken += it->second.taken;
+    }
+
+    out << "            <method name=\"" <<
+           xmlEscape(db.functionInfo[i].function) <<
+           "\" signature=\"\" line-rate=\"" << coverageRate(fCovered, fValid) <<
+           "\" branch-rate=\"" << coverageRate(fTaken, fOutcomes) <<
+           "\" complexity=\"0\">\n";
+    out << "              <lines>\n";
+    out << funcLines.str();
+    out << "              </lines>\n";
+    out << "            </method>\n";
+  }
+  out << "          </methods>\n";
+  out << "          <lines>\n";
+  out << allLines.str();
+  out << "          </lines>\n";
+  out << "        </class>\n";
+  out << "      </classes>\n";
+  out << "    </package>\n";
+  out << "  </packages>\n";
+  out << "</coverage>\n";
+
+  out.close();
+  return !out.fail();
+}
+
+// Write JSON summary: totals and per-function counts as [covered, total],
+// then line hits, decision outcomes and MC/DC operands
+bool VampProcess::genJsonSummary(string fileName)
+{
+  ofstream out(fileName.c_str());
+  if (!out)
+  {
+    *vampErr << "Cannot create " << fileName << ENDL;
+    return false;
+  }
+
+  vector<pair<int, long long> > lineHits;
+  vector<decisionExportType> decisions;
+  getLineHits(lineHits);
+  getDecisions(decisions);
+
+  bool doStmt = doStmtSingle || doStmtCount;
+
+  out << "{\n";
+  out << "  \"file_name\": " << jsonQuote(db.fileName) << ",\n";
+  out << "  \"path_name\": " << jsonQuote(db.pathName) << ",\n";
+  out << "  \"vamp_version\": " << jsonQuote(VAMP_VERSION) << ",\n";
+
+  out << "  \"totals\": ";
+  writeJsonTotals(out);
+  out << ",\n";
+
+  out << "  \"functions\": [\n";
+  for (int i = 0; i < db.functionInfo.size(); i++)
+  {
+    out << "    {\"name\": " << jsonQuote(db.functionInfo[i].function) <<
+           ", \"lines\": [" << db.functionInfo[i].loc.lhsLine << "," <<
+           db.functionInfo[i].loc.rhsLine << "]";
+    if (doStmt && (i < functionStmtCoverageCount.size()))
+      out << ", \"statement\": [" << functionStmtCoverageCount[i] << "," <<
+             db.functionStmtCount[i] << "]";
+    if (doBranch && (i < branchFunctionOperandCount.size()))
+      out << ", \"branch\": [" << branchFunctionCoverageCount[i] << "," <<
+             branchFunctionOperandCount[i] << "]";
+    if (doMCDC && (i < mcdcFunctionOperandCount.size()))
+      out << ", \"mcdc\": [" << mcdcFunctionCoverageCount[i] << "," <<
+             mcdcFunctionOperandCount[i] << "]";
+    if (doCC && (i < condFunctionOperandCount.size()))
+      out << ", \"condition\": [" << condFunctionCoverageCount[i] << "," <<
+             condFunctionOperandCount[i] << "]";
+    out << "}" << ((i + 1 < db.functionInfo.size()) ? "," : "") << "\n";
+  }
+  out << "  ],\n";
+
+  // [line, hits]
+  out << "  \"lines\": [";
+  for (int i = 0; i < lineHits.size(); i++)
+    out << (i ? "," : "") << "[" << lineHits[i].first << "," <<
+           lineHits[i].second << "]";
+  out << "],\n";
+
+  // [line, type, [taken, ...]] with TRUE then FALSE, or each case
+  out << "  \"decisions\": [";
+  for (int i = 0; i < decisions.size(); i++)
+  {
+    out << (i ? ",\n    " : "\n    ") << "[" << decisions[i].line << "," <<
+           jsonQuote(decisions[i].type) << ",[";
+    for (int j = 0; j < decisions[i].taken.size(); j++)
+      out << (j ? "," : "") << (decisions[i].taken[j] ? 1 : 0);
+    out << "]]";
+  }
+  out << "],\n";
+
+  // [line, operands, [halves seen, ...]] with 1 FALSE, 2 TRUE, 3 both
+  out << "  \"mcdc\": [";
+  for (int i = 0; i < mcdcExport.size(); i++)
+  {
+    out << (i ? ",\n    " : "\n    ") << "[" << mcdcExport[i].line << "," <<
+           jsonQuote(mcdcExport[i].operands) << ",[";
+    for (int j = 0; j < mcdcExport[i].senses.size(); j++)
+      out << (j ? "," : "") << (int) mcdcExport[i].senses[j];
+    out << "]]";
+  }
+  out << "]\n";
+  out << "}\n";
+
+  out.close();
+  return !out.fail();
+}
+
+// Index of function holding line, or -1 if none does
+static int functionAt(VampDB &db, int line)
+{
+  int lo = 0;
+  int hi = db.functionInfo.size();
+
+  // First function starting after line
+  while (lo < hi)
+  {
+    int mid = (lo + hi) / 2;
+    if (db.functionInfo[mid].loc.lhsLine <= line)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+
+  if ((lo == 0) || (db.functionInfo[lo - 1].loc.rhsLine < line))
+    return -1;
+
+  return lo - 1;
+}
+
+// Write coverage of the functions that came from headers, by header line,
+// for merging with the other files that include them. Each is keyed by
+// where it starts in its header and a hash of its preprocessed text.
+// Code expanded from header macros stays with the function it is in.
+bool VampProcess::genHeaderCoverage(string fileName)
+{
+  vector<pair<int, long long> > lineHits;
+  vector<decisionExportType> decisions;
+  getLineHits(lineHits);
+  getDecisions(decisions);
+
+  string unit = ppMap.fileName.empty() ? exportSourceName(db) : ppMap.fileName;
+
+  // Region of each function, or -1 if it is from the source itself
+  vector<int> regionNum(db.functionInfo.size(), -1);
+  vector<headerRegionType> regions;
+  for (int i = 0; i < db.functionInfo.size(); i++)
+  {
+    sourceLocationType &loc = db.functionInfo[i].loc;
+    headerRegionType r;
+
+    if ((ppMap.sourceLine(loc.lhsLine) != -1) ||
+        !ppMap.origin(loc.lhsLine, r.file, r.line))
+      continue;
+
+    r.hash = textHash(loc.lhsLine, loc.rhsLine);
+    r.function = db.functionInfo[i].function;
+    r.units.insert(unit);
+    regionNum[i] = regions.size();
+    regions.push_back(r);
+  }
+
+  // Lines expanded more than once keep their best count
+  for (int i = 0; i < lineHits.size(); i++)
+  {
+    int func = functionAt(db, lineHits[i].first);
+    string file;
+    int line;
+
+    if ((func == -1) || (regionNum[func] == -1) ||
+        !ppMap.origin(lineHits[i].first, file, line))
+      continue;
+
+    headerRegionType &r = regions[regionNum[func]];
+    if (file == r.file)
+    {
+      long long &hits = r.lineHits[line];
+      hits = max(hits, lineHits[i].second);
+    }
+  }
+
+  for (int i = 0; i < decisions.size(); i++)
+  {
+    int func = functionAt(db, decisions[i].line);
+    string file;
+    int line;
+
+    if ((func == -1) || (regionNum[func] == -1) ||
+        !ppMap.origin(decisions[i].line, file, line))
+      continue;
+
+    headerRegionType &r = regions[regionNum[func]];
+    if (file == r.file)
+    {
+      r.decisions.push_back(decisions[i]);
+      r.decisions.back().line = line;
+    }
+  }
+
+  HeaderCoverage headerCov;
+  for (int i = 0; i < regions.size(); i++)
+    headerCov.add(regions[i]);
+
+  if (!headerCov.save(fileName))
+  {
+    *vampErr << "Cannot write " << fileName << ENDL;
+    return false;
+  }
+
+  return true;
+}
+
+// Write coverage of the source's own lines, mapped back to the original
+// source, for merging with the other variants it is built as. Lines
+// expanded more than once keep their best count.
+bool VampProcess::genVariantCoverage(string fileName)
+{
+  vector<pair<int, long long> > lineHits;
+  vector<decisionExportType> decisions;
+  getLineHits(lineHits);
+  getDecisions(decisions);
+
+  variantCovType cov;
+  cov.file = ppMap.fileName.empty() ? exportSourceName(db) : ppMap.fileName;
+  cov.variant = db.instrPathName.empty() ? db.instrFileName :
+                db.instrPathName + DIRECTORY_SEPARATOR + db.instrFileName;
+
+  for (int i = 0; i < lineHits.size(); i++)
+  {
+    int line = ppMap.sourceLine(lineHits[i].first);
+
+    if (line != -1)
+    {
+      long long &hits = cov.lineHits[line];
+      hits = max(hits, lineHits[i].second);
+    }
+  }
+
+  for (int i = 0; i < decisions.size(); i++)
+  {
+    int line = ppMap.sourceLine(decisions[i].line);
+
+    if (line != -1)
+    {
+      cov.decisions.push_back(decisions[i]);
+      cov.decisions.back().line = line;
+    }
+  }
+
+  if (!VariantCoverage::save(fileName, cov))
+  {
+    *vampErr << "Cannot write " << fileName << ENDL;
+    return false;
+  }
+
+  return true;
+}
+
+// Write totals for each enabled coverage type as [covered, total]
+void VampProcess::writeJsonTotals(ostream &out)
+{
+  bool doStmt = doStmtSingle || doStmtCount;
+
+  out << "{";
+  const char *sep = "";
+  if (doStmt)
+  {
+    out << sep << "\"statement\": [" << totalStmtCoveredCount << "," <<
+           db.totalStmtCount << "]";
+    sep = ", ";
+  }
+  if (doBranch)
+  {
+    out << sep << "\"branch\": [" << branchTotalCoverageCount << "," <<
+           branchTotalOperandCount << "]";
+    sep = ", ";
+  }
+  if (doMCDC)
+  {
+    out << sep << "\"mcdc\": [" << mcdcTotalCoverageCount << "," <<
+           mcdcTotalOperandCount << "]";
+    sep = ", ";
+  }
+  if (doCC)
+  {
+    out << sep << "\"condition\": [" << condTotalCoverageCount << "," <<
+           condTotalOperandCount << "]";
+  }
+  out << "}";
+}
@@ -26,3 +26,92 @@ void vamp_string_ostream::write_impl(const char *Ptr, size_t Size)
   OS.append(Ptr, Size);
 }
 
+vamp_linemarker_ostream::~vamp_linemarker_ostream()
+{
+  flush();
+
+  if (state == HASH)
+    OS += '#';
+  else
+  if (state == MARKER)
+    addMarker();
+}
+
+void vamp_linemarker_ostream::write_impl(const char *Ptr, size_t Size)
+{
+  size_t textStart = 0;   // Start of text to copy out in one go
+
+  for (size_t i = 0; i < Size; i++)
+  {
+    char ch = Ptr[i];
+
+    if (state == MARKER)
+    {
+      if (ch == '\n')
+      {
+        addMarker();
+        state = TEXT;
+        startLine = true;
+        textStart = i + 1;
+      }
+      else
+        marker += ch;
+    }
+    else
+    if (state == HASH)
+    {
+      if (ch == ' ')
+      {
+        // Line marker - hold it back from the text
+        state = MARKER;
+        marker.clear();
+      }
+      else
+      {
+        // Some other directive (#pragma) - keep it
+        OS += '#';
+        state = TEXT;
+        startLine = false;
+        textStart = i;
+        --i;
+      }
+    }
+    else
+    if (startLine && (ch == '#'))
+    {
+      OS.append(Ptr + textStart, i - textStart);
+      state = HASH;
+    }
+    else
+    {
+      startLine = (ch == '\n');
+      if (startLine)
+        ++lineNum;
+    }
+  }
+
+  if (state == TEXT)
+    OS.append(Ptr + textStart, Size - textStart);
+  pos += Size;
+}
+
+// Record marker of form: linenum "filename" flags
+// Weed out things like "<command-line>" and "<built-in>"
+void vamp_linemarker_ostream::addMarker()
+{
+  size_t nameStart = marker.find('"');
+  size_t nameEnd = marker.rfind('"');
+
+  if ((marker.empty()) || (marker[0] < '0') || (marker[0] > '9') ||
+      (nameStart == marker.npos) || (nameEnd <= nameStart))
+  {
+    // Not a marker after all - put it back
+    OS += "# " + marker + "\n";
+    ++lineNum;
+    return;
+  }
+
+  string srcName = marker.substr(nameStart + 1, nameEnd - nameStart - 1);
+  if (srcName[0] != '<')
+    Map.addMarker(lineNum, atoi(marker.c_str()), srcName);
+}
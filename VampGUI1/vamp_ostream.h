@@ -21,6 +21,7 @@
 #include <fstream>
 #include <sstream>
 #include <exception>
+#include "ppmap.h"
 
 #include "llvm/Support/Host.h"
 #include "llvm/Support/raw_ostream.h"
@@ -114,6 +115,41 @@ private:
   Colors savedColor;
 };
 
+/// vamp_linemarker_ostream - A raw_ostream that writes preprocessor output
+/// to an std::string, moving the line markers (# linenum "filename" flags)
+/// into a PPMap as they arrive instead of into the text.
+class vamp_linemarker_ostream : public raw_ostream {
+  std::string &OS;
+  PPMap &Map;
+
+  enum { TEXT, HASH, MARKER } state;
+  bool startLine;         // Next character starts a line
+  int lineNum;            // Line of text being written
+  std::string marker;     // Line marker being collected
+  uint64_t pos;           // Characters written, markers included
+
+  /// write_impl - See raw_ostream::write_impl.
+  virtual void write_impl(const char *Ptr, size_t Size) LLVM_OVERRIDE;
+
+  /// current_pos - Return the current position within the stream, not
+  /// counting the bytes currently in the buffer.
+  virtual uint64_t current_pos() const LLVM_OVERRIDE { return pos; }
+
+  void addMarker();
+
+public:
+  vamp_linemarker_ostream(std::string &O, PPMap &M) :
+    OS(O), Map(M), state(TEXT), startLine(true), lineNum(1), pos(0) {}
+  ~vamp_linemarker_ostream();
+
+  /// str - Flushes the stream contents to the target string and returns
+  ///  the string's reference.
+  std::string& str() {
+    flush();
+    return OS;
+  }
+};
+
 #ifdef DEFINE_VAMP_OSTREAM_SOURCE
 vamp_string_ostream::~vamp_string_ostream() {
   flush();
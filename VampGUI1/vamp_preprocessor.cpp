@@ -15,22 +15,95 @@
 */
 
 #include "vamp_preprocessor.h"
+#include "clang/Lex/PPCallbacks.h"
+#include "clang/Lex/Preprocessor.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Path.h"
+#include <set>
+
+// Directory name as FileManager keeps it, without trailing separators
+static string trimDirName(string dir)
+{
+  while ((dir.size() > 1) &&
+         llvm::sys::path::is_separator(dir[dir.size() - 1]))
+    dir.erase(dir.size() - 1);
+  return dir;
+}
+
+// Notes, for each #include, the places searched before the file was
+// found: the includer's directory (for "file.h"), then the include
+// paths. A header added at one of them later would be used instead.
+class IncludeMissRecorder : public PPCallbacks
+{
+public:
+  IncludeMissRecorder(SourceManager &sm, vector<string> &includePaths,
+                      set<string> &missed) :
+    sourceMgr(sm), paths(includePaths), missedFiles(missed)
+  {
+  }
+
+  void InclusionDirective(SourceLocation hashLoc, const Token &includeTok,
+                          StringRef fileName, bool isAngled,
+                          CharSourceRange filenameRange,
+                          const FileEntry *file, StringRef searchPath,
+                          StringRef relativePath,
+                          const Module *imported) override
+  {
+    if ((file == NULL) || llvm::sys::path::is_absolute(fileName))
+      return;
+
+    vector<string> dirs;
+    if (!isAngled)
+    {
+      FileID includerID = sourceMgr.getFileID(sourceMgr.getExpansionLoc(hashLoc));
+      const FileEntry *includer = sourceMgr.getFileEntryForID(includerID);
+      if (includer)
+        dirs.push_back(string(includer->getDir()->getName()));
+    }
+    dirs.insert(dirs.end(), paths.begin(), paths.end());
+
+    for (int i = 0; i < dirs.size(); i++)
+    {
+      string dir = trimDirName(dirs[i]);
+      if (dir == trimDirName(searchPath.str()))
+        break;
+
+      string candidate = dir + "/" + fileName.str();
+      if (!llvm::sys::fs::exists(candidate))
+        missedFiles.insert(candidate);
+    }
+  }
+
+private:
+  SourceManager &sourceMgr;
+  vector<string> &paths;
+  set<string> &missedFiles;
+};
 
 VampPreprocessor::VampPreprocessor()
 {
 }
 
 // Preprocess designated file
+// Line markers are moved into lineMap, if given, rather than the output
 bool VampPreprocessor::Preprocess(string fileName,
                                   string &outString,
                                   string &errString,
-                                  VAMP_PREPROC_CONFIG &preprocOpts)
+                                  VAMP_PREPROC_CONFIG &preprocOpts,
+                                  PPMap *lineMap)
 {
   CompilerInstance ci;
 
   DiagnosticOptions *diagOptions = new clang::DiagnosticOptions();
   diagOptions->ShowColors = true;
-  vamp_string_ostream preProcOut(outString);
+  std::unique_ptr<raw_ostream> preProcOut;
+  if (lineMap && preprocOpts.showLineMarkers)
+  {
+    lineMap->clear();
+    preProcOut.reset(new vamp_linemarker_ostream(outString, *lineMap));
+  }
+  else
+    preProcOut.reset(new vamp_string_ostream(outString));
   vamp_string_ostream preProcErr(errString);
 
   TextDiagnosticPrinter *diagPrinter = new TextDiagnosticPrinter(preProcErr, diagOptions);
@@ -43,7 +116,14 @@ bool VampPreprocessor::Preprocess(string fileName,
   TargetInfo *pti = TargetInfo::CreateTargetInfo(ci.getDiagnostics(), pto);
   ci.setTarget(pti);
 
-  ci.createFileManager();
+  // Keep stat results from earlier files
+  if (fileMgr)
+    ci.setFileManager(fileMgr.get());
+  else
+  {
+    ci.createFileManager();
+    fileMgr = &ci.getFileManager();
+  }
   ci.createSourceManager(ci.getFileManager());
 
 //  std::string fileName(argv[argc - 1]);
@@ -83,13 +163,33 @@ bool VampPreprocessor::Preprocess(string fileName,
   Opts.RewriteIncludes = 0;
 
   ci.createPreprocessor(TU_Module);
+
+  set<string> missed;
+  ci.getPreprocessor().addPPCallbacks(std::unique_ptr<PPCallbacks>(
+    new IncludeMissRecorder(ci.getSourceManager(), preprocOpts.includePaths,
+                            missed)));
 //InitializePreprocessor(ci.getPreprocessor(), ppOpts, headerOpts, ci.getFrontendOpts());
   diagPrinter->BeginSourceFile(ci.getLangOpts(), &ci.getPreprocessor());
   DoPrintPreprocessedInput(ci.getPreprocessor(),
                            //&llvm::outs(),
-                           &preProcOut,
+                           preProcOut.get(),
                            ci.getPreprocessorOutputOpts());
   diagPrinter->EndSourceFile();
+  preProcOut.reset();
+
+  // Note inputs (main file first) so output can be reused while they
+  // are unchanged
+  includedFiles.clear();
+  includedFiles.push_back(fileName);
+  SourceManager &sm = ci.getSourceManager();
+  const FileEntry *mainFile = sm.getFileEntryForID(sm.getMainFileID());
+  for (SourceManager::fileinfo_iterator it = sm.fileinfo_begin();
+       it != sm.fileinfo_end(); ++it)
+  {
+    if (it->first != mainFile)
+      includedFiles.push_back(it->first->getName());
+  }
+  missedFiles.assign(missed.begin(), missed.end());
 
   if (ci.getDiagnostics().hasErrorOccurred())
   {
@@ -24,14 +24,18 @@
 #include "clang/Frontend/CompilerInstance.h"
 #include "clang/Basic/TargetInfo.h"
 #include "clang/Frontend/Utils.h"
+#include "clang/Basic/FileManager.h"
 
 #include "configfile.h"
 #include "vamp_ostream.h"
 #include <string>
+#include <vector>
 
 using namespace std;
 using namespace clang;
 
+// Reuse one instance for a series of files (on a single thread) so the
+// file and directory lookups made while searching include paths are kept
 class VampPreprocessor
 {
 public:
@@ -39,7 +43,15 @@ public:
     bool Preprocess(string fileName,
                     string &outString,
                     string &errString,
-                    VAMP_PREPROC_CONFIG &preprocOpts);
+                    VAMP_PREPROC_CONFIG &preprocOpts,
+                    PPMap *lineMap = NULL);
+
+    vector<string> includedFiles;   // Files read by last Preprocess()
+    vector<string> missedFiles;     // Include paths tried there that did
+                                    // not exist
+
+private:
+    llvm::IntrusiveRefCntPtr<FileManager> fileMgr;
 };
 
 #endif // VAMP_PREPROCESSOR_H
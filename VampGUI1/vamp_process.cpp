@@ -15,12 +15,21 @@
 */
 
 #include "vamp_process.h"
+#include "version.h"
+#include "vamp_report_bundle.h"
+#include "fnvhash.h"
 
 string modTimeStr(time_t &modTime)
 {
-  struct tm *modTm = gmtime(&modTime);
+  // Use reentrant form; reports may be generated on several threads
+  struct tm modTm;
+#ifdef _WIN32
+  gmtime_s(&modTm, &modTime);
+#else
+  gmtime_r(&modTime, &modTm);
+#endif
   char modTimeAsc[64];
-  strftime(modTimeAsc, sizeof(modTimeAsc), "%Y-%m-%d %H:%M:%S", modTm);
+  strftime(modTimeAsc, sizeof(modTimeAsc), "%Y-%m-%d %H:%M:%S", &modTm);
   string str(modTimeAsc);
   return str;
 }
@@ -73,7 +82,7 @@ History::~History()
 // - Instrumented statement info
 // - Branch info
 // - MC/DC info
-bool History::loadHistory(string histName, VAMP_ERR_STREAM *vampErr)
+bool History::loadHistory(string histName, VAMP_REPORT_STREAM *vampErr)
 {
   ifstream historyFile (histName.c_str(), ios_base::binary);
   bool result;
@@ -81,139 +90,228 @@ bool History::loadHistory(string histName, VAMP_ERR_STREAM *vampErr)
   // Read input source file
   if (historyFile.is_open())
   {
-    // Load coverage options
-    coverageOptions = historyFile.get();
+    result = readHistory(historyFile, vampErr);
+    historyFile.close();
 
-    if (coverageOptions & DO_STATEMENT_COUNT)
-    {
-      // Load instrumented statement coverage info with counts
-      instCount = (historyFile.get() << 8) | historyFile.get();
+    // Get time of creation (modification) for history file as string
+    struct stat fileStat;
+    stat(histName.c_str(), &fileStat);
+    modTime = modTimeStr(fileStat.st_mtime);
+  }
+  else
+  {
+    *vampErr << "Unable to open history file: " << histName << ENDL;
+
+    result = false;
+  }
+
+  return result;
+}
+
+// Load history carried forward in a database as a hex string (see
+// writeHistory). Time of creation is left to the caller.
+bool History::loadHexHistory(string hex, VAMP_REPORT_STREAM *vampErr)
+{
+  string bytes;
+
+  for (int i = 0; i + 1 < hex.size(); i += 2)
+    bytes += (char) strtol(hex.substr(i, 2).c_str(), NULL, 16);
+
+  istringstream in(bytes);
+  if (!readHistory(in, vampErr) || !in.good())
+  {
+    *vampErr << "Corrupt coverage history in database - aborting" << ENDL;
+    return false;
+  }
+
+  return true;
+}
+
+// Read history in the format output by _vamp_output()
+bool History::readHistory(istream &in, VAMP_REPORT_STREAM *vampErr)
+{
+  // Discard any history read before
+  free(coveredInfo);
+  free(covCntInfo);
+  free(brInfo);
+  free(mcdcInfo);
+  free(condInfo);
+  coveredInfo = NULL;
+  covCntInfo = NULL;
+  brInfo = NULL;
+  mcdcInfo = NULL;
+  condInfo = NULL;
+
+  // Load coverage options
+  coverageOptions = in.get();
+
+  if (coverageOptions & DO_STATEMENT_COUNT)
+  {
+    // Load instrumented statement coverage info with counts
+    instCount = (in.get() << 8) | in.get();
 #ifdef VAMP_DEBUG_STMT
-      CDBG << histName << " Instrumented statement count = " << instCount << ENDL;
+    CDBG << "Instrumented statement count = " << instCount << ENDL;
 #endif
-      if (instCount)
+    if (instCount)
+    {
+      covCntInfo = (unsigned int *) malloc(instCount * 4);
+      unsigned int *ptr = covCntInfo;
+      for (int i = 0; i < instCount; i++)
       {
-        covCntInfo = (unsigned int *) malloc(instCount * 4);
-        unsigned int *ptr = covCntInfo;
-        for (int i = 0; i < instCount; i++)
-        {
-          // Read 4 bytes into unsigned int
-          *ptr++ = (historyFile.get() << 24) |
-                   (historyFile.get() << 16) |
-                   (historyFile.get() << 8) |
-                    historyFile.get();
+        // Read 4 bytes into unsigned int
+        *ptr++ = (in.get() << 24) |
+                 (in.get() << 16) |
+                 (in.get() << 8) |
+                  in.get();
 #ifdef VAMP_DEBUG_STMT
 CDBG << "covCntInfo[" << i << "] = " << covCntInfo[i] << ENDL;
 #endif
-        }
       }
     }
-    else
-    if (coverageOptions & (DO_STATEMENT_SINGLE | DO_BRANCH))
-    {
-      // Load instrumented statement coverage info
-      // May exist for branch coverage of case statements
-      instCount = (historyFile.get() << 8) | historyFile.get();
+  }
+  else
+  if (coverageOptions & (DO_STATEMENT_SINGLE | DO_BRANCH))
+  {
+    // Load instrumented statement coverage info
+    // May exist for branch coverage of case statements
+    instCount = (in.get() << 8) | in.get();
 #ifdef VAMP_DEBUG_STMT
-CDBG << histName << " Instrumented statement count = " << instCount << ENDL;
+CDBG << "Instrumented statement count = " << instCount << ENDL;
 #endif
-      if (instCount)
+    if (instCount)
+    {
+      coveredInfo = (unsigned char *) malloc(instCount);
+      unsigned char *ptr = coveredInfo;
+      for (int i = 0; i < instCount; i++)
       {
-        coveredInfo = (unsigned char *) malloc(instCount);
-        unsigned char *ptr = coveredInfo;
-        for (int i = 0; i < instCount; i++)
-        {
-          *ptr++ = historyFile.get();
+        *ptr++ = in.get();
 #ifdef VAMP_DEBUG_STMT
 CDBG << "coveredInfo[" << i << "] = " << std::hex << (int) coveredInfo[i] << ENDL;
 #endif
-        }
       }
     }
+  }
 
-    if (coverageOptions & DO_BRANCH)
-    {
-      // Load branch info
-      branchCount = (historyFile.get() << 8) | historyFile.get();
+  if (coverageOptions & DO_BRANCH)
+  {
+    // Load branch info
+    branchCount = (in.get() << 8) | in.get();
 #ifdef VAMP_DEBUG
-CDBG << histName << " Branch count = " << branchCount << ENDL;
+CDBG << "Branch count = " << branchCount << ENDL;
 #endif
-      if (branchCount)
-      {
-        brInfo = (unsigned char *) malloc(branchCount);
-        unsigned char *ptr = brInfo;
-        for (int i = 0; i < branchCount; i++)
-          *ptr++ = historyFile.get();
-      }
+    if (branchCount)
+    {
+      brInfo = (unsigned char *) malloc(branchCount);
+      unsigned char *ptr = brInfo;
+      for (int i = 0; i < branchCount; i++)
+        *ptr++ = in.get();
     }
+  }
 
-    if (coverageOptions & DO_MCDC)
-    {
-      // Load MC/DC info
-      mcdcCount = (historyFile.get() << 8) | historyFile.get();
+  if (coverageOptions & DO_MCDC)
+  {
+    // Load MC/DC info
+    mcdcCount = (in.get() << 8) | in.get();
 #ifdef VAMP_DEBUG
-CDBG << histName << " MCDC count = " << mcdcCount << ENDL;
+CDBG << "MCDC count = " << mcdcCount << ENDL;
 #endif
-      if (mcdcCount)
-      {
-        mcdcInfo = (unsigned char *) malloc(mcdcCount);
-        unsigned char *ptr = mcdcInfo;
-        for (int i = 0; i < mcdcCount; i++)
-          *ptr++ = historyFile.get();
-      }
-    
-      // Get stack overflow flag
-      stackOverflow = 0;
-      stackOverflow = (historyFile.get() << 8) | historyFile.get();
+    if (mcdcCount)
+    {
+      mcdcInfo = (unsigned char *) malloc(mcdcCount);
+      unsigned char *ptr = mcdcInfo;
+      for (int i = 0; i < mcdcCount; i++)
+        *ptr++ = in.get();
+    }
+  
+    // Get stack overflow flag
+    stackOverflow = 0;
+    stackOverflow = (in.get() << 8) | in.get();
 #ifdef VAMP_DEBUG
-CDBG << histName << " Stack Overflow = " << stackOverflow << ENDL;
+CDBG << "Stack Overflow = " << stackOverflow << ENDL;
 #endif
-    }
-    else
-    if (coverageOptions & DO_CONDITION)
-    {
-      // Load Condition info
-      condCount = (historyFile.get() << 8) | historyFile.get();
+  }
+  else
+  if (coverageOptions & DO_CONDITION)
+  {
+    // Load Condition info
+    condCount = (in.get() << 8) | in.get();
 #ifdef VAMP_DEBUG
-CDBG << histName << " Condition count = " << condCount << ENDL;
+CDBG << "Condition count = " << condCount << ENDL;
 #endif
-      if (condCount)
-      {
-        condInfo = (unsigned char *) malloc(condCount);
-        unsigned char *ptr = condInfo;
-        for (int i = 0; i < condCount; i++)
-          *ptr++ = historyFile.get();
-      }
-    }
-    else
+    if (condCount)
     {
-      int count = (historyFile.get() << 8) | historyFile.get();
+      condInfo = (unsigned char *) malloc(condCount);
+      unsigned char *ptr = condInfo;
+      for (int i = 0; i < condCount; i++)
+        *ptr++ = in.get();
+    }
+  }
+  else
+  {
+    int count = (in.get() << 8) | in.get();
 
-      if (count)
-      {
-        *vampErr << "Unexpected byte count in history file - aborting" << ENDL;
-        historyFile.close();
-        return false;
-      }
+    if (count)
+    {
+      *vampErr << "Unexpected byte count in history file - aborting" << ENDL;
+      return false;
     }
+  }
 
-    historyFile.close();
+  return true;
+}
 
-    // Get time of creation (modification) for history file as string
-    struct stat fileStat;
-    stat(histName.c_str(), &fileStat);
-    modTime = modTimeStr(fileStat.st_mtime);
+// Write history in the format output by _vamp_output()
+void History::writeHistory(ostream &out)
+{
+  out.put(coverageOptions);
 
-    result = true;
+  if (coverageOptions & DO_STATEMENT_COUNT)
+  {
+    out.put(instCount >> 8);
+    out.put(instCount & 0xff);
+    for (int i = 0; i < instCount; i++)
+    {
+      out.put(covCntInfo[i] >> 24);
+      out.put((covCntInfo[i] >> 16) & 0xff);
+      out.put((covCntInfo[i] >> 8) & 0xff);
+      out.put(covCntInfo[i] & 0xff);
+    }
   }
   else
+  if (coverageOptions & (DO_STATEMENT_SINGLE | DO_BRANCH))
   {
-    *vampErr << "Unable to open history file: " << histName << ENDL;
+    out.put(instCount >> 8);
+    out.put(instCount & 0xff);
+    out.write((char *) coveredInfo, instCount);
+  }
 
-    result = false;
+  if (coverageOptions & DO_BRANCH)
+  {
+    out.put(branchCount >> 8);
+    out.put(branchCount & 0xff);
+    out.write((char *) brInfo, branchCount);
   }
 
-  return result;
+  if (coverageOptions & DO_MCDC)
+  {
+    out.put(mcdcCount >> 8);
+    out.put(mcdcCount & 0xff);
+    out.write((char *) mcdcInfo, mcdcCount);
+    out.put((stackOverflow >> 8) & 0xff);
+    out.put(stackOverflow & 0xff);
+  }
+  else
+  if (coverageOptions & DO_CONDITION)
+  {
+    out.put(condCount >> 8);
+    out.put(condCount & 0xff);
+    out.write((char *) condInfo, condCount);
+  }
+  else
+  {
+    out.put(0);
+    out.put(0);
+  }
 }
 
 
@@ -233,6 +331,13 @@ VampDB::VampDB()
   showTestCases = true;             // Show recommended test cases
   htmlDirectory = ".";
   htmlSuffix = "_vamp";
+  compactHtml = false;
+  generateHtml = true;
+  exportLcov = false;
+  exportCobertura = false;
+  exportJson = false;
+  mergeHeaders = false;
+  mergeVariants = false;
 }
 
 void VampDB::SetVampOptions(VAMP_REPORT_CONFIG &vo)
@@ -243,7 +348,16 @@ void VampDB::SetVampOptions(VAMP_REPORT_CONFIG &vo)
   generateReport = vo.generateReport;
   htmlDirectory = vo.htmlDirectory;
   htmlSuffix = vo.htmlSuffix;
+  compactHtml = vo.compactHtml;
+  generateHtml = vo.generateHtml;
+  exportLcov = vo.exportLcov;
+  exportCobertura = vo.exportCobertura;
+  exportJson = vo.exportJson;
+  mergeHeaders = vo.mergeHeaders;
+  mergeVariants = vo.mergeVariants;
   reportSeparator = vo.reportSeparator;
+  mcdcSolverNodeLimit = vo.mcdcSolverNodeLimit;
+  mcdcSolverTimeLimit = vo.mcdcSolverTimeLimit;
 }
 
 // Get [lhsLine,lhsCol,rhsLine,rhsCol] from JSON file
@@ -302,8 +416,7 @@ void VampDB::parseFuncInfo(Json &json, vector<JsonNode> &n)
     f.function = i->as_string().data();
     ++i;
 
-    vector<JsonNode> node;
-    json.ParseArray(i->as_string(), node);
+    vector<JsonNode> &node = json.GetArray(*i);
 
     f.loc = getLoc(node);
     functionInfo.push_back(f);
@@ -344,8 +457,7 @@ void VampDB::parseStatementInfo(Json &json, vector<JsonNode> &n)
 
   while (i != n.end())
   {
-    vector<JsonNode> node;
-    json.ParseArray(i->as_string(), node);
+    vector<JsonNode> &node = json.GetArray(*i);
 
     loc = getLoc(node);
 
@@ -384,6 +496,10 @@ void VampDB::parseStatementInfo(Json &json, vector<JsonNode> &n)
       // Ignore statements outside of function
       // (external declarations with initializers)
       // Maybe they shouldn't even be in JSON file
+      outsideStmtInfoType outside;
+      outside.stmtNum = statementInfo.size();
+      outside.loc = loc;
+      outsideStmtInfo.push_back(outside);
 #ifdef VAMP_DEBUG_PARSE
       CDBG << "Ignoring statement at line " <<
               loc.lhsLine << ", " << loc.lhsCol << ENDL;
@@ -429,8 +545,7 @@ void VampDB::parseInstInfo(Json &json, vector<JsonNode> &n)
 
   while (i != n.end())
   {
-    vector<JsonNode> node;
-    json.ParseArray(i->as_string(), node);
+    vector<JsonNode> &node = json.GetArray(*i);
 
     loc = getInstLoc(node);
     instInfo.push_back(loc);
@@ -483,12 +598,10 @@ mcdcExprInfoType VampDB::getMCDCExprInfo(Json &json, vector<JsonNode> &n)
 
   while (cnt--)
   {
-    vector<JsonNode> node;
-    json.ParseArray(i->as_string(), node);
+    vector<JsonNode> &node = json.GetArray(*i);
     opInfo.lhsLoc = getLoc(node);
     ++i;
-    vector<JsonNode> node1;
-    json.ParseArray(i->as_string(), node1);
+    vector<JsonNode> &node1 = json.GetArray(*i);
     opInfo.rhsLoc = getLoc(node1);
     ++i;
     opInfo.andOp = (i->as_string() == "&&");
@@ -509,8 +622,7 @@ void VampDB::parseMCDCExprInfo(Json &json, vector<JsonNode> &n)
 
   while (i != n.end())
   {
-    vector<JsonNode> node;
-    json.ParseArray(i->as_string(), node);
+    vector<JsonNode> &node = json.GetArray(*i);
     op = getMCDCExprInfo(json, node);
     mcdcExprInfo.push_back(op);
 #ifdef VAMP_DEBUG_PARSE
@@ -551,16 +663,13 @@ ifElseInfoType VampDB::parseIfElseInfo(Json &json, vector<JsonNode> &n)
   ifElseInfoType ifElseElement;
 
   vector<JsonNode>::iterator i = n.begin();
-  vector<JsonNode> node;
-  json.ParseArray(i->as_string(), node);
+  vector<JsonNode> &node = json.GetArray(*i);
   ifElseElement.ifLoc = getLoc(node);
   ++i;
-  vector<JsonNode> node1;
-  json.ParseArray(i->as_string(), node1);
+  vector<JsonNode> &node1 = json.GetArray(*i);
   ifElseElement.elseLoc = getLoc(node1);
   ++i;
-  vector<JsonNode> node2;
-  json.ParseArray(i->as_string(), node2);
+  vector<JsonNode> &node2 = json.GetArray(*i);
   ifElseElement.exprLoc = getLoc(node2);
   ++i;
   ifElseElement.branchNum = i->as_int();
@@ -598,12 +707,10 @@ whileInfoType VampDB::parseWhileInfo(Json &json, vector<JsonNode> &n)
   whileInfoType whileElement;
 
   vector<JsonNode>::iterator i = n.begin();
-  vector<JsonNode> node;
-  json.ParseArray(i->as_string(), node);
+  vector<JsonNode> &node = json.GetArray(*i);
   whileElement.whileLoc = getLoc(node);
   ++i;
-  vector<JsonNode> node1;
-  json.ParseArray(i->as_string(), node1);
+  vector<JsonNode> &node1 = json.GetArray(*i);
   whileElement.exprLoc = getLoc(node1);
   ++i;
   whileElement.branchNum = i->as_int();
@@ -637,12 +744,10 @@ forInfoType VampDB::parseForInfo(Json &json, vector<JsonNode> &n)
   forInfoType forElement;
 
   vector<JsonNode>::iterator i = n.begin();
-  vector<JsonNode> node;
-  json.ParseArray(i->as_string(), node);
+  vector<JsonNode> &node = json.GetArray(*i);
   forElement.forLoc = getLoc(node);
   ++i;
-  vector<JsonNode> node1;
-  json.ParseArray(i->as_string(), node1);
+  vector<JsonNode> &node1 = json.GetArray(*i);
   forElement.exprLoc = getLoc(node1);
   ++i;
   forElement.branchNum = i->as_int();
@@ -681,12 +786,10 @@ switchInfoType VampDB::parseSwitchInfo(Json &json, vector<JsonNode> &n)
   caseInfoType caseElement;
 
   vector<JsonNode>::iterator i = n.begin();
-  vector<JsonNode> node;
-  json.ParseArray(i->as_string(), node);
+  vector<JsonNode> &node = json.GetArray(*i);
   switchElement.switchLoc = getLoc(node);
   ++i;
-  vector<JsonNode> node1;
-  json.ParseArray(i->as_string(), node1);
+  vector<JsonNode> &node1 = json.GetArray(*i);
   switchElement.switchExprLoc = getLoc(node1);
   ++i;
   int cnt = i->as_int();
@@ -706,8 +809,7 @@ switchInfoType VampDB::parseSwitchInfo(Json &json, vector<JsonNode> &n)
 
   while (cnt--)
   {
-    vector<JsonNode> node;
-    json.ParseArray(i->as_string(), node);
+    vector<JsonNode> &node = json.GetArray(*i);
     caseElement.caseLoc = getLoc(node);
     i++;
 
@@ -765,10 +867,11 @@ void VampDB::parseBranchInfo(Json &json, vector<JsonNode> &n)
     if ((i->as_string() == "if") ||
         (i->as_string() == "cond"))
     {
+      bool condExpr = (i->as_string() == "cond");
       ++i;
-      vector<JsonNode> node;
-      json.ParseArray(i->as_string(), node);
+      vector<JsonNode> &node = json.GetArray(*i);
       ifElseElement = parseIfElseInfo(json, node);
+      ifElseElement.condExpr = condExpr;
       branch.statementType = "if";
       branch.index = ifInfoIndex++;
       branchInfo.push_back(branch);
@@ -778,8 +881,7 @@ void VampDB::parseBranchInfo(Json &json, vector<JsonNode> &n)
     if (i->as_string() == "while")
     {
       ++i;
-      vector<JsonNode> node;
-      json.ParseArray(i->as_string(), node);
+      vector<JsonNode> &node = json.GetArray(*i);
       whileElement = parseWhileInfo(json, node);
       branch.statementType = "while";
       branch.index = whileInfoIndex++;
@@ -790,8 +892,7 @@ void VampDB::parseBranchInfo(Json &json, vector<JsonNode> &n)
     if (i->as_string() == "for")
     {
       ++i;
-      vector<JsonNode> node;
-      json.ParseArray(i->as_string(), node);
+      vector<JsonNode> &node = json.GetArray(*i);
       forElement = parseForInfo(json, node);
       branch.statementType = "for";
       branch.index = forInfoIndex++;
@@ -802,8 +903,7 @@ void VampDB::parseBranchInfo(Json &json, vector<JsonNode> &n)
     if (i->as_string() == "switch")
     {
       ++i;
-      vector<JsonNode> node;
-      json.ParseArray(i->as_string(), node);
+      vector<JsonNode> &node = json.GetArray(*i);
       switchElement = parseSwitchInfo(json, node);
       branch.statementType = "switch";
       branch.index = switchInfoIndex++;
@@ -821,12 +921,10 @@ condInfoType VampDB::parseConditionElement(Json &json, vector<JsonNode> &n)
 
   vector<JsonNode>::iterator i = n.begin();
 
-  vector<JsonNode> node;
-  json.ParseArray(i->as_string(), node);
+  vector<JsonNode> &node = json.GetArray(*i);
   condElement.lhsLoc = getLoc(node);
   ++i;
-  vector<JsonNode> node1;
-  json.ParseArray(i->as_string(), node1);
+  vector<JsonNode> &node1 = json.GetArray(*i);
   condElement.rhsLoc = getLoc(node1);
   ++i;
    condElement.condition = i->as_string().data();
@@ -865,8 +963,7 @@ void VampDB::parseConditionInfo(Json &json, vector<JsonNode> &n)
 
   while (i != n.end())
   {
-    vector<JsonNode> node;
-    json.ParseArray(i->as_string(), node);
+    vector<JsonNode> &node = json.GetArray(*i);
     condElement = parseConditionElement(json, node);
     condInfo.push_back(condElement);
 
@@ -878,7 +975,7 @@ void VampDB::parseConditionInfo(Json &json, vector<JsonNode> &n)
 //   "mcdc_overflow":
 //   [
 //     // Start and End Locations for each MC/DC expression with more
-//     // than 31 MCDC operators
+//     // than MCDC_MAX_OPERANDS MCDC operators
 //     [<l1>,<c1>,<l2>,<c2>],
 //             ...
 //     [<l1>,<c1>,<l2>,<c2>]
@@ -895,8 +992,7 @@ void VampDB::parseMcdcOverflow(Json &json, vector<JsonNode> &n)
 
   while (i != n.end())
   {
-    vector<JsonNode> node;
-    json.ParseArray(i->as_string(), node);
+    vector<JsonNode> &node = json.GetArray(*i);
 
     loc = getLoc(node);
     mcdcOverflowInfo.push_back(loc);
@@ -914,7 +1010,7 @@ void VampDB::parseMcdcOverflow(Json &json, vector<JsonNode> &n)
 
 
 // Parse information from JSON databse file generated by vamp
-void VampDB::parseJsonDb(Json &n, VAMP_ERR_STREAM *errStr)
+void VampDB::parseJsonDb(Json &n, VAMP_REPORT_STREAM *errStr)
 {
   vampErr = errStr;
 
@@ -922,51 +1018,42 @@ void VampDB::parseJsonDb(Json &n, VAMP_ERR_STREAM *errStr)
 
   while (i != n.jsonNodes.end())
   {
-    vector<JsonNode> nodes;
-
     // get the node name and value as a string
     string nodeName = i->name().data();
 
     if (nodeName == "function_info")
     {
-      n.ParseArray(i->as_string(), nodes);
-      parseFuncInfo(n, nodes);
+      parseFuncInfo(n, n.GetArray(*i));
     }
     else
     if (nodeName == "instr_info")
     {
-      n.ParseArray(i->as_string(), nodes);
-      parseInstInfo(n, nodes);
+      parseInstInfo(n, n.GetArray(*i));
     }
     else
     if (nodeName == "mcdc_expr_info")
     {
-      n.ParseArray(i->as_string(), nodes);
-      parseMCDCExprInfo(n, nodes);
+      parseMCDCExprInfo(n, n.GetArray(*i));
     }
     else
     if (nodeName == "statement_info")
     {
-      n.ParseArray(i->as_string(), nodes);
-      parseStatementInfo(n, nodes);
+      parseStatementInfo(n, n.GetArray(*i));
     }
     else
     if (nodeName == "branch_info")
     {
-      n.ParseArray(i->as_string(), nodes);
-      parseBranchInfo(n, nodes);
+      parseBranchInfo(n, n.GetArray(*i));
     }
     else
     if (nodeName == "condition_info")
     {
-      n.ParseArray(i->as_string(), nodes);
-      parseConditionInfo(n, nodes);
+      parseConditionInfo(n, n.GetArray(*i));
     }
     else
     if (nodeName == "mcdc_overflow")
     {
-      n.ParseArray(i->as_string(), nodes);
-      parseMcdcOverflow(n, nodes);
+      parseMcdcOverflow(n, n.GetArray(*i));
     }
     else
     // find out where to store the values
@@ -1025,6 +1112,14 @@ void VampDB::parseJsonDb(Json &n, VAMP_ERR_STREAM *errStr)
 #endif
       instrModTime = i->as_string().data();
     }
+    else
+    if (nodeName == "pre_covered")
+    {
+#ifdef VAMP_DEBUG_PARSE
+      CDBG << "pre_covered string:" << i->as_string() << ENDL;
+#endif
+      preCovered = i->as_string().data();
+    }
 
     ++i;
   }
@@ -1038,247 +1133,1089 @@ void VampDB::parseJsonDb(Json &n, VAMP_ERR_STREAM *errStr)
   }
 }
 
-// Get [ppSrcLine,srcLine,fileName] from JSON Map file
-// Place into mapType: ppSrcLine,srcLine,fileName
-
-mapType VampProcess::getMapInfo(vector<JsonNode> &n)
-{
-  mapType loc;
-
-  vector<JsonNode>::iterator i = n.begin();
-  loc.ppSrcLine = i->as_int();
-  i++;
-  loc.srcLine  = i->as_int();
-  i++;
-  loc.fileName = i->as_string();
-  return loc;
-}
-
-// Get instr_info from JSON Map file of form:
-//   "linemarkers":
-//   [
-//     // pn = Line number for preprocessed source
-//     // sn = Corresponding line number for original source
-//     // filen = Filename of original source
-//     [<p1>,<s1>,<file1>],
-//         ...
-//     [<pn>,<sn>,<filen>]
-//   ]
-//
-// Place into instInfoType:
-//     [<l1>,<c1>] -> line, col
-
-void VampProcess::parseLineMarkers(Json &json, vector<JsonNode> &n)
+// Sections of binary database (.vdb) file, in file order. Each section
+// is an array of fixed-width records of ints; strings are stored as
+// offsets into the string table.
+enum vdbSectionType {
+  VDB_HEADER,         // File names and times
+  VDB_FUNCTIONS,      // Name, location and statement count per function
+  VDB_STATEMENTS,     // Location per statement
+  VDB_OUTSIDE_STMTS,  // Following statement and location per statement
+                      // outside of any function
+  VDB_INSTR,          // Line, column per instrumented statement
+  VDB_MCDC_EXPR,      // First operand and operand count per expression
+  VDB_MCDC_OPS,       // &&/||, LHS and RHS location per operand
+  VDB_BRANCHES,       // Statement type and index per branch
+  VDB_IF,             // If, else and expression location, branch number,
+                      // ?: flag
+  VDB_WHILE,          // While and expression location, branch number
+  VDB_FOR,            // For and expression location, branch number
+  VDB_SWITCH,         // Switch and expression location, first case, count
+  VDB_CASES,          // Location and instrumented statement per case
+  VDB_CONDITIONS,     // LHS and RHS location, condition, condition number
+  VDB_MCDC_OVERFLOW,  // Location per overflowed MC/DC expression
+  VDB_STRINGS,        // Null-terminated strings, one int per record
+  VDB_SECTION_COUNT
+};
+
+// Record size in ints for each section
+static const int vdbRecordSize[VDB_SECTION_COUNT] =
+  { 8, 6, 4, 5, 2, 2, 9, 2, 14, 9, 9, 10, 5, 10, 4, 1 };
+
+// Statement types held in VDB_BRANCHES
+static const char *vdbBranchTypes[] = { "if", "while", "for", "switch" };
+
+typedef struct {
+  char magic[4];           // VDB_MAGIC
+  int version;             // VDB_VERSION
+  int byteOrder;           // 0x01020304 in writer's byte order
+  int sectionCount;        // VDB_SECTION_COUNT
+  long long jsonSize;      // Size of .json file converted
+  long long jsonModTime;   // Modification time of .json file converted
+} vdbFileHeader;
+
+typedef struct {
+  int offset;              // Offset of section from start of file
+  int count;               // Number of records in section
+} vdbSectionEntry;
+
+// Build filename for binary database file (<file>.json -> <file>.vdb)
+string VampDB::vdbName(string jsonName)
 {
-  mapType loc;
-
-  vector<JsonNode>::iterator i = n.begin();
+  size_t extension = jsonName.rfind(".");
 
-  while (i != n.end())
+  if (extension < jsonName.npos)
   {
-    vector<JsonNode> node;
-    json.ParseArray(i->as_string(), node);
-
-    loc = getMapInfo(node);
-    if (loc.fileName != mapFileName)
-        loc.srcLine = -1;   // Flag as outside of source code
-
-    mapInfo.push_back(loc);
-#ifdef VAMP_DEBUG_PARSE
-    CDBG << "instr_info: " << "[" <<
-         loc.line << "," <<
-         loc.col  << "]" << ENDL;
-#endif
-
-    ++i;
+    jsonName.replace(extension, jsonName.npos - extension + 1, VDB_EXT);
   }
+  else
+  {
+    jsonName += VDB_EXT;
+  }
+
+  return jsonName;
 }
 
-// Parse information from JSON databse file generated by vamp
-void VampProcess::parseJsonMap(Json &n)
+static void vdbPutLoc(vector<int> &sect, sourceLocationType &loc)
 {
-  vector<JsonNode>::iterator i = n.jsonNodes.begin();
+  sect.push_back(loc.lhsLine);
+  sect.push_back(loc.lhsCol);
+  sect.push_back(loc.rhsLine);
+  sect.push_back(loc.rhsCol);
+}
 
-  while (i != n.jsonNodes.end())
-  {
-    vector<JsonNode> nodes;
+static sourceLocationType vdbGetLoc(const int *rec)
+{
+  sourceLocationType loc;
 
-    // get the node name and value as a string
-    string nodeName = i->name().data();
+  loc.lhsLine = rec[0];
+  loc.lhsCol  = rec[1];
+  loc.rhsLine = rec[2];
+  loc.rhsCol  = rec[3];
+  return loc;
+}
 
-    if (nodeName == "filename")
-    {
-#ifdef VAMP_DEBUG_PARSE
-      CDBG << "filename string:" << i->as_string() << ENDL;
-#endif
-      mapFileName = i->as_string().data();
-    }
-    else
-    if (nodeName == "preproc_filename")
-    {
-#ifdef VAMP_DEBUG_PARSE
-      CDBG << "preproc_filename string:" << i->as_string() << ENDL;
-#endif
-      mapPPFileName = i->as_string().data();
-    }
-    else
-    if (nodeName == "linemarkers")
-    {
-        n.ParseArray(i->as_string(), nodes);
-        parseLineMarkers(n, nodes);
-    }
+// Add string to string table, returning its offset
+static int vdbPutString(string &strings, const string &str)
+{
+  int offset = strings.size();
 
-    ++i;
-  }
+  strings += str;
+  strings += '\0';
+  return offset;
 }
 
-// See if a linemarker database exists, and if so, load it
-void VampProcess::processLineMarkers(char *preProcFileName)
+// Write database as a binary .vdb file, tagged with the size and time of
+// the .json file it was converted from so a stale copy is never loaded
+bool VampDB::saveVdb(string vdbFileName, string jsonName)
 {
-    string ppMapName(preProcFileName);
-    size_t ppMapExtension = ppMapName.rfind(".");
-    gotPPMap = false;
+  struct stat jsonStat;
+  if (stat(jsonName.c_str(), &jsonStat) == -1)
+    return false;
 
-    if (ppMapExtension < ppMapName.npos)
-    {
-      ppMapName.replace(ppMapExtension, ppMapName.npos - ppMapExtension + 1, ".ppmap");
+  vector<int> sect[VDB_SECTION_COUNT];
+  string strings;
 
-      string ppLine;
-      ifstream ppMapFile (ppMapName.c_str());
-      ostringstream ppMapSource;
+  vector<int> &header = sect[VDB_HEADER];
+  header.push_back(vdbPutString(strings, fileName));
+  header.push_back(vdbPutString(strings, srcFileName));
+  header.push_back(vdbPutString(strings, pathName));
+  header.push_back(vdbPutString(strings, modTime));
+  header.push_back(vdbPutString(strings, instrFileName));
+  header.push_back(vdbPutString(strings, instrPathName));
+  header.push_back(vdbPutString(strings, instrModTime));
+  header.push_back(vdbPutString(strings, preCovered));
 
-      // Read input source file
-      if (ppMapFile.is_open())
-      {
-        while (ppMapFile.good())
-        {
-          getline(ppMapFile, ppLine);
-          ppMapSource << ppLine;
-        }
+  for (int i = 0; i < functionInfo.size(); ++i)
+  {
+    sect[VDB_FUNCTIONS].push_back(vdbPutString(strings, functionInfo[i].function));
+    vdbPutLoc(sect[VDB_FUNCTIONS], functionInfo[i].loc);
+    sect[VDB_FUNCTIONS].push_back(functionStmtCount[i]);
+  }
 
-        ppMapFile.close();
+  for (int i = 0; i < statementInfo.size(); ++i)
+    vdbPutLoc(sect[VDB_STATEMENTS], statementInfo[i]);
+
+  for (int i = 0; i < outsideStmtInfo.size(); ++i)
+  {
+    sect[VDB_OUTSIDE_STMTS].push_back(outsideStmtInfo[i].stmtNum);
+    vdbPutLoc(sect[VDB_OUTSIDE_STMTS], outsideStmtInfo[i].loc);
+  }
 
-        gotPPMap = true;
+  for (int i = 0; i < instInfo.size(); ++i)
+  {
+    sect[VDB_INSTR].push_back(instInfo[i].line);
+    sect[VDB_INSTR].push_back(instInfo[i].col);
+  }
 
-        ostringstream jsonErr;
-        Json n(&jsonErr);
-        try
-        {
-          n.ParseJson(ppMapSource.str());
-        }
-        catch(int i)
-        {
-          *vampErr << "Bad preprocessor map file " << ppMapName << " - " << jsonErr.str();
-          gotPPMap = false;
-        }
+  for (int i = 0; i < mcdcExprInfo.size(); ++i)
+  {
+    vector<mcdcOpInfoType> &opInfo = mcdcExprInfo[i].opInfo;
 
-        if (gotPPMap)
-        {
-            try
-            {
-              // Now extract map info
-              parseJsonMap(n);
-              gotPPMap = true;
-            }
-            catch(int i)
-            {
-              gotPPMap = false;
-            }
-        }
-      }
+    sect[VDB_MCDC_EXPR].push_back(sect[VDB_MCDC_OPS].size() / vdbRecordSize[VDB_MCDC_OPS]);
+    sect[VDB_MCDC_EXPR].push_back(opInfo.size());
+    for (int j = 0; j < opInfo.size(); ++j)
+    {
+      sect[VDB_MCDC_OPS].push_back(opInfo[j].andOp);
+      vdbPutLoc(sect[VDB_MCDC_OPS], opInfo[j].lhsLoc);
+      vdbPutLoc(sect[VDB_MCDC_OPS], opInfo[j].rhsLoc);
     }
-}
+  }
 
-bool VampProcess::processFile(char *jsonName, VAMP_REPORT_CONFIG &vo)
-{
-  totalMcdcCombCnt = 0;
-  sourceCount = 0;              // Number of lines in source
-  totalStmtCoveredCount = 0;    // Total # stmts covered in source
-  newStmtCoveredCount = 0;      // # new stmts covered in current run
-  mcdcTotalOperandCount = 0;    // # MCDC operands in source code
-  mcdcTotalCoverageCount = 0;   // # MCDC operands covered in source
-  mcdcNewCoverCount = 0;        // # new MCDC operands covered in current run
-  branchTotalOperandCount = 0;  // # Branch operands in source code
-  branchTotalCoverageCount = 0; // # Branch operands covered in source
-  newBranchCoveredCount = 0;    // # new branches covered in current run
-  condTotalOperandCount = 0;    // # Conditions in source code
-  condTotalCoverageCount = 0;   // # Conditions covered in source
-  newCondCoveredCount = 0;      // # new conditions covered in current run
+  for (int i = 0; i < branchInfo.size(); ++i)
+  {
+    int type = 0;
+    while ((type < 4) && (branchInfo[i].statementType != vdbBranchTypes[type]))
+      ++type;
+    if (type == 4)
+      return false;
+    sect[VDB_BRANCHES].push_back(type);
+    sect[VDB_BRANCHES].push_back(branchInfo[i].index);
+  }
 
-  string line;
-  ifstream jsonFile (jsonName);
-  ostringstream jsonSource;
+  for (int i = 0; i < ifElseInfo.size(); ++i)
+  {
+    vdbPutLoc(sect[VDB_IF], ifElseInfo[i].ifLoc);
+    vdbPutLoc(sect[VDB_IF], ifElseInfo[i].elseLoc);
+    vdbPutLoc(sect[VDB_IF], ifElseInfo[i].exprLoc);
+    sect[VDB_IF].push_back(ifElseInfo[i].branchNum);
+    sect[VDB_IF].push_back(ifElseInfo[i].condExpr);
+  }
 
-  db.SetVampOptions(vo);
+  for (int i = 0; i < whileInfo.size(); ++i)
+  {
+    vdbPutLoc(sect[VDB_WHILE], whileInfo[i].whileLoc);
+    vdbPutLoc(sect[VDB_WHILE], whileInfo[i].exprLoc);
+    sect[VDB_WHILE].push_back(whileInfo[i].branchNum);
+  }
 
-  // Read input source file
-  if (jsonFile.is_open())
+  for (int i = 0; i < forInfo.size(); ++i)
+  {
+    vdbPutLoc(sect[VDB_FOR], forInfo[i].forLoc);
+    vdbPutLoc(sect[VDB_FOR], forInfo[i].exprLoc);
+    sect[VDB_FOR].push_back(forInfo[i].branchNum);
+  }
+
+  for (int i = 0; i < switchInfo.size(); ++i)
   {
-//    *vampOut << "Processing " << jsonName << ENDL;
+    vector<caseInfoType> &caseInfo = switchInfo[i].caseInfo;
 
-    while (jsonFile.good())
+    vdbPutLoc(sect[VDB_SWITCH], switchInfo[i].switchLoc);
+    vdbPutLoc(sect[VDB_SWITCH], switchInfo[i].switchExprLoc);
+    sect[VDB_SWITCH].push_back(sect[VDB_CASES].size() / vdbRecordSize[VDB_CASES]);
+    sect[VDB_SWITCH].push_back(caseInfo.size());
+    for (int j = 0; j < caseInfo.size(); ++j)
     {
-      getline(jsonFile, line);
-      jsonSource << line;
+      vdbPutLoc(sect[VDB_CASES], caseInfo[j].caseLoc);
+      sect[VDB_CASES].push_back(caseInfo[j].instNum);
     }
-    jsonFile.close();
+  }
 
-#ifdef VAMP_DEBUG_SRC
-    string src = jsonSource.str();
-    CDBG << src << ENDL;
-#endif
+  for (int i = 0; i < condInfo.size(); ++i)
+  {
+    vdbPutLoc(sect[VDB_CONDITIONS], condInfo[i].lhsLoc);
+    vdbPutLoc(sect[VDB_CONDITIONS], condInfo[i].rhsLoc);
+    sect[VDB_CONDITIONS].push_back(vdbPutString(strings, condInfo[i].condition));
+    sect[VDB_CONDITIONS].push_back(condInfo[i].condNum);
   }
-  else
+
+  for (int i = 0; i < mcdcOverflowInfo.size(); ++i)
+    vdbPutLoc(sect[VDB_MCDC_OVERFLOW], mcdcOverflowInfo[i]);
+
+  // Pad string table out to a whole number of ints
+  strings.resize((strings.size() + sizeof(int) - 1) & ~(sizeof(int) - 1), '\0');
+  sect[VDB_STRINGS].resize(strings.size() / sizeof(int));
+  if (!strings.empty())
+    memcpy(&sect[VDB_STRINGS][0], strings.data(), strings.size());
+
+  vdbFileHeader fileHeader;
+  memcpy(fileHeader.magic, VDB_MAGIC, sizeof(fileHeader.magic));
+  fileHeader.version = VDB_VERSION;
+  fileHeader.byteOrder = 0x01020304;
+  fileHeader.sectionCount = VDB_SECTION_COUNT;
+  fileHeader.jsonSize = jsonStat.st_size;
+  fileHeader.jsonModTime = jsonStat.st_mtime;
+
+  vdbSectionEntry dir[VDB_SECTION_COUNT];
+  int offset = sizeof(fileHeader) + sizeof(dir);
+  for (int i = 0; i < VDB_SECTION_COUNT; ++i)
   {
-    *vampErr << "Unable to open file: " << jsonName << ENDL;
-    return false;
+    dir[i].offset = offset;
+    dir[i].count = sect[i].size() / vdbRecordSize[i];
+    offset += sect[i].size() * sizeof(int);
   }
 
-#ifdef CHANGE_FNAME
-  size_t extension = jsonName.rfind(".");
+  // Write to a temporary name so readers never see a partial file
+  string tmpName = vdbFileName + ".tmp";
+  ofstream vdbFile(tmpName.c_str(), ios::out | ios::binary | ios::trunc);
+  if (!vdbFile.is_open())
+    return false;
 
-  if (extension < jsonName.npos)
+  vdbFile.write((const char *) &fileHeader, sizeof(fileHeader));
+  vdbFile.write((const char *) dir, sizeof(dir));
+  for (int i = 0; i < VDB_SECTION_COUNT; ++i)
   {
-    jsonName.replace(extension, jsonName.npos - extension + 1, "_vamp.json");
-    *vampOut << "Processing " << jsonName << ENDL;
+    if (!sect[i].empty())
+      vdbFile.write((const char *) &sect[i][0], sect[i].size() * sizeof(int));
   }
-  else
+  vdbFile.close();
+
+  if (!vdbFile.good())
   {
-    *vampErr << "Cannot parse " << jsonName << ": Not a C extension" << ENDL;
+    remove(tmpName.c_str());
+    return false;
   }
-#endif
 
+  remove(vdbFileName.c_str());
+  return rename(tmpName.c_str(), vdbFileName.c_str()) == 0;
+}
+
+// Look up string in string table, which is known to end with a null
+static string vdbGetString(const char *strings, int stringsSize, int offset)
+{
+  if ((offset < 0) || (offset >= stringsSize))
+    throw(1);
+
+  return strings + offset;
+}
+
+// Check records first..first+count lie within a section of size records
+static void vdbCheckRange(int first, int count, int size)
+{
+  if ((first < 0) || (count < 0) || (first + count > size))
+    throw(1);
+}
+
+// Discard all data loaded from database file
+void VampDB::clearDb(void)
+{
+  functionInfo.clear();
+  instInfo.clear();
+  mcdcExprInfo.clear();
+  statementInfo.clear();
+  outsideStmtInfo.clear();
+  ifElseInfo.clear();
+  whileInfo.clear();
+  forInfo.clear();
+  switchInfo.clear();
+  branchInfo.clear();
+  condInfo.clear();
+  mcdcOverflowInfo.clear();
+  functionStmtCount.clear();
+  preCovered.clear();
+
+  totalStmtCount = 0;
+  functionCount = 0;
+  ifInfoIndex = 0;
+  whileInfoIndex = 0;
+  forInfoIndex = 0;
+  switchInfoIndex = 0;
+}
+
+// Load database from binary .vdb file. Returns false, leaving the
+// database empty, if the file is missing or damaged, was written by
+// another format version or byte order, or no longer matches the .json
+// file it was converted from. An empty jsonName skips the last check.
+bool VampDB::loadVdb(string vdbFileName, string jsonName)
+{
+  struct stat jsonStat;
+  if (!jsonName.empty() && (stat(jsonName.c_str(), &jsonStat) == -1))
+    return false;
+
+  ifstream vdbFile(vdbFileName.c_str(), ios::in | ios::binary);
+  if (!vdbFile.is_open())
+    return false;
+
+  vdbFile.seekg(0, ios::end);
+  size_t vdbSize = vdbFile.tellg();
+  vdbFile.seekg(0, ios::beg);
+
+  vdbFileHeader fileHeader;
+  vdbSectionEntry dir[VDB_SECTION_COUNT];
+
+  if (vdbSize < sizeof(fileHeader) + sizeof(dir))
+    return false;
+
+  vdbFile.read((char *) &fileHeader, sizeof(fileHeader));
+
+  if ((memcmp(fileHeader.magic, VDB_MAGIC, sizeof(fileHeader.magic)) != 0) ||
+      (fileHeader.version != VDB_VERSION) ||
+      (fileHeader.byteOrder != 0x01020304) ||
+      (fileHeader.sectionCount != VDB_SECTION_COUNT) ||
+      (!jsonName.empty() &&
+       ((fileHeader.jsonSize != jsonStat.st_size) ||
+        (fileHeader.jsonModTime != jsonStat.st_mtime))))
+  {
+    return false;
+  }
+
+  // Read rest of file in one go; it is all runs of ints
+  size_t dataSize = vdbSize - sizeof(fileHeader);
+  vector<int> data((dataSize + sizeof(int) - 1) / sizeof(int));
+  vdbFile.read((char *) &data[0], dataSize);
+  if (!vdbFile.good())
+    return false;
+  vdbFile.close();
+
+  memcpy(dir, &data[0], sizeof(dir));
+
+  const int *sect[VDB_SECTION_COUNT];
+  for (int i = 0; i < VDB_SECTION_COUNT; ++i)
+  {
+    size_t offset = dir[i].offset;
+
+    if ((offset < sizeof(fileHeader) + sizeof(dir)) ||
+        (offset % sizeof(int)) || (dir[i].count < 0) ||
+        (offset + (size_t) dir[i].count * vdbRecordSize[i] * sizeof(int) > vdbSize))
+    {
+      return false;
+    }
+    sect[i] = &data[(offset - sizeof(fileHeader)) / sizeof(int)];
+  }
+
+  const char *strings = (const char *) sect[VDB_STRINGS];
+  int stringsSize = dir[VDB_STRINGS].count * sizeof(int);
+
+  if ((dir[VDB_HEADER].count != 1) ||
+      (stringsSize && strings[stringsSize - 1]))
+  {
+    return false;
+  }
+
+  clearDb();
+
+  try
+  {
+    const int *rec = sect[VDB_HEADER];
+    fileName = vdbGetString(strings, stringsSize, rec[0]);
+    srcFileName = vdbGetString(strings, stringsSize, rec[1]);
+    pathName = vdbGetString(strings, stringsSize, rec[2]);
+    modTime = vdbGetString(strings, stringsSize, rec[3]);
+    instrFileName = vdbGetString(strings, stringsSize, rec[4]);
+    instrPathName = vdbGetString(strings, stringsSize, rec[5]);
+    instrModTime = vdbGetString(strings, stringsSize, rec[6]);
+    preCovered = vdbGetString(strings, stringsSize, rec[7]);
+
+    functionInfo.resize(dir[VDB_FUNCTIONS].count);
+    functionStmtCount.resize(dir[VDB_FUNCTIONS].count);
+    rec = sect[VDB_FUNCTIONS];
+    for (int i = 0; i < dir[VDB_FUNCTIONS].count; ++i, rec += vdbRecordSize[VDB_FUNCTIONS])
+    {
+      functionInfo[i].function = vdbGetString(strings, stringsSize, rec[0]);
+      functionInfo[i].loc = vdbGetLoc(rec + 1);
+      functionStmtCount[i] = rec[5];
+      totalStmtCount += rec[5];
+    }
+    functionCount = functionInfo.size();
+
+    statementInfo.resize(dir[VDB_STATEMENTS].count);
+    rec = sect[VDB_STATEMENTS];
+    for (int i = 0; i < dir[VDB_STATEMENTS].count; ++i, rec += vdbRecordSize[VDB_STATEMENTS])
+      statementInfo[i] = vdbGetLoc(rec);
+
+    outsideStmtInfo.resize(dir[VDB_OUTSIDE_STMTS].count);
+    rec = sect[VDB_OUTSIDE_STMTS];
+    for (int i = 0; i < dir[VDB_OUTSIDE_STMTS].count; ++i, rec += vdbRecordSize[VDB_OUTSIDE_STMTS])
+    {
+      vdbCheckRange(rec[0], 0, statementInfo.size());
+      outsideStmtInfo[i].stmtNum = rec[0];
+      outsideStmtInfo[i].loc = vdbGetLoc(rec + 1);
+    }
+
+    instInfo.resize(dir[VDB_INSTR].count);
+    rec = sect[VDB_INSTR];
+    for (int i = 0; i < dir[VDB_INSTR].count; ++i, rec += vdbRecordSize[VDB_INSTR])
+    {
+      instInfo[i].line = rec[0];
+      instInfo[i].col  = rec[1];
+    }
+
+    mcdcExprInfo.resize(dir[VDB_MCDC_EXPR].count);
+    rec = sect[VDB_MCDC_EXPR];
+    for (int i = 0; i < dir[VDB_MCDC_EXPR].count; ++i, rec += vdbRecordSize[VDB_MCDC_EXPR])
+    {
+      vdbCheckRange(rec[0], rec[1], dir[VDB_MCDC_OPS].count);
+
+      const int *op = sect[VDB_MCDC_OPS] + rec[0] * vdbRecordSize[VDB_MCDC_OPS];
+      mcdcExprInfo[i].opInfo.resize(rec[1]);
+      for (int j = 0; j < rec[1]; ++j, op += vdbRecordSize[VDB_MCDC_OPS])
+      {
+        mcdcExprInfo[i].opInfo[j].andOp = (op[0] != 0);
+        mcdcExprInfo[i].opInfo[j].lhsLoc = vdbGetLoc(op + 1);
+        mcdcExprInfo[i].opInfo[j].rhsLoc = vdbGetLoc(op + 5);
+      }
+    }
+
+    ifElseInfo.resize(dir[VDB_IF].count);
+    rec = sect[VDB_IF];
+    for (int i = 0; i < dir[VDB_IF].count; ++i, rec += vdbRecordSize[VDB_IF])
+    {
+      ifElseInfo[i].ifLoc = vdbGetLoc(rec);
+      ifElseInfo[i].elseLoc = vdbGetLoc(rec + 4);
+      ifElseInfo[i].exprLoc = vdbGetLoc(rec + 8);
+      ifElseInfo[i].branchNum = rec[12];
+      ifElseInfo[i].condExpr = (rec[13] != 0);
+    }
+
+    whileInfo.resize(dir[VDB_WHILE].count);
+    rec = sect[VDB_WHILE];
+    for (int i = 0; i < dir[VDB_WHILE].count; ++i, rec += vdbRecordSize[VDB_WHILE])
+    {
+      whileInfo[i].whileLoc = vdbGetLoc(rec);
+      whileInfo[i].exprLoc = vdbGetLoc(rec + 4);
+      whileInfo[i].branchNum = rec[8];
+    }
+
+    forInfo.resize(dir[VDB_FOR].count);
+    rec = sect[VDB_FOR];
+    for (int i = 0; i < dir[VDB_FOR].count; ++i, rec += vdbRecordSize[VDB_FOR])
+    {
+      forInfo[i].forLoc = vdbGetLoc(rec);
+      forInfo[i].exprLoc = vdbGetLoc(rec + 4);
+      forInfo[i].branchNum = rec[8];
+    }
+
+    switchInfo.resize(dir[VDB_SWITCH].count);
+    rec = sect[VDB_SWITCH];
+    for (int i = 0; i < dir[VDB_SWITCH].count; ++i, rec += vdbRecordSize[VDB_SWITCH])
+    {
+      switchInfo[i].switchLoc = vdbGetLoc(rec);
+      switchInfo[i].switchExprLoc = vdbGetLoc(rec + 4);
+      vdbCheckRange(rec[8], rec[9], dir[VDB_CASES].count);
+
+      const int *cs = sect[VDB_CASES] + rec[8] * vdbRecordSize[VDB_CASES];
+      switchInfo[i].caseInfo.resize(rec[9]);
+      for (int j = 0; j < rec[9]; ++j, cs += vdbRecordSize[VDB_CASES])
+      {
+        vdbCheckRange(cs[4], 1, instInfo.size());
+        switchInfo[i].caseInfo[j].caseLoc = vdbGetLoc(cs);
+        switchInfo[i].caseInfo[j].instNum = cs[4];
+      }
+    }
+
+    // Branch types index into the if/while/for/switch tables just loaded
+    const int typeCount[] = { (int) ifElseInfo.size(), (int) whileInfo.size(),
+                              (int) forInfo.size(), (int) switchInfo.size() };
+    branchInfo.resize(dir[VDB_BRANCHES].count);
+    rec = sect[VDB_BRANCHES];
+    for (int i = 0; i < dir[VDB_BRANCHES].count; ++i, rec += vdbRecordSize[VDB_BRANCHES])
+    {
+      vdbCheckRange(rec[0], 1, 4);
+      vdbCheckRange(rec[1], 1, typeCount[rec[0]]);
+      branchInfo[i].statementType = vdbBranchTypes[rec[0]];
+      branchInfo[i].index = rec[1];
+    }
+
+    condInfo.resize(dir[VDB_CONDITIONS].count);
+    rec = sect[VDB_CONDITIONS];
+    for (int i = 0; i < dir[VDB_CONDITIONS].count; ++i, rec += vdbRecordSize[VDB_CONDITIONS])
+    {
+      condInfo[i].lhsLoc = vdbGetLoc(rec);
+      condInfo[i].rhsLoc = vdbGetLoc(rec + 4);
+      condInfo[i].condition = vdbGetString(strings, stringsSize, rec[8]);
+      condInfo[i].condNum = rec[9];
+    }
+
+    mcdcOverflowInfo.resize(dir[VDB_MCDC_OVERFLOW].count);
+    rec = sect[VDB_MCDC_OVERFLOW];
+    for (int i = 0; i < dir[VDB_MCDC_OVERFLOW].count; ++i, rec += vdbRecordSize[VDB_MCDC_OVERFLOW])
+      mcdcOverflowInfo[i] = vdbGetLoc(rec);
+  }
+  catch(int i)
+  {
+    clearDb();
+    return false;
+  }
+
+  return true;
+}
+
+static void jsonPutLoc(ostream &out, sourceLocationType &loc)
+{
+  out << "[" << loc.lhsLine << "," << loc.lhsCol << "," <<
+                loc.rhsLine << "," << loc.rhsCol << "]";
+}
+
+// Write database in the .json format generated by vamp, so a .vdb file
+// can be converted back. Parsing the output gives the same database.
+void VampDB::writeJsonDb(ostream &out)
+{
+  out << "{\n";
+  out << "  \"filename\": \"" << fileName << "\",\n";
+  out << "  \"src_filename\": \"" << srcFileName << "\",\n";
+  out << "  \"pathname\": \"" << pathName << "\",\n";
+  out << "  \"modtime\": \"" << modTime << "\",\n";
+  out << "  \"instr_filename\": \"" << instrFileName << "\",\n";
+  out << "  \"instr_pathname\": \"" << instrPathName << "\",\n";
+  out << "  \"instr_modtime\": \"" << instrModTime << "\",\n";
+
+  out << "  \"function_info\":\n  [\n";
+  for (int i = 0; i < functionInfo.size(); ++i)
+  {
+    if (i)
+      out << ",\n";
+    out << "    \"" << functionInfo[i].function << "\", ";
+    jsonPutLoc(out, functionInfo[i].loc);
+  }
+  out << "\n  ],\n";
+
+  // Put statements outside of functions back where they were found
+  out << "  \"statement_info\":\n  [\n";
+  int outside = 0;
+  for (int i = 0; i <= statementInfo.size(); ++i)
+  {
+    for (; (outside < outsideStmtInfo.size()) &&
+           (outsideStmtInfo[outside].stmtNum == i); ++outside)
+    {
+      if (i || outside)
+        out << ",\n";
+      out << "    ";
+      jsonPutLoc(out, outsideStmtInfo[outside].loc);
+    }
+    if (i == statementInfo.size())
+      break;
+    if (i || outside)
+      out << ",\n";
+    out << "    ";
+    jsonPutLoc(out, statementInfo[i]);
+  }
+  out << "\n  ]";
+
+  // Last instrumented location is the end of the last function,
+  // added when the database was parsed
+  int instCount = instInfo.size() - (functionInfo.size() ? 1 : 0);
+  if (instCount > 0)
+  {
+    out << ",\n  \"instr_info\":\n  [\n";
+    for (int i = 0; i < instCount; ++i)
+    {
+      if (i)
+        out << ",\n";
+      out << "    [" << instInfo[i].line << "," << instInfo[i].col << "]";
+    }
+    out << "\n  ]";
+  }
+
+  out << ",\n  \"branch_info\":\n  [\n";
+  for (int i = 0; i < branchInfo.size(); ++i)
+  {
+    int index = branchInfo[i].index;
+
+    if (i)
+      out << ",\n";
+    if ((branchInfo[i].statementType == "if") && ifElseInfo[index].condExpr)
+      out << "    \"cond\", [";
+    else
+      out << "    \"" << branchInfo[i].statementType << "\", [";
+    if (branchInfo[i].statementType == "if")
+    {
+      jsonPutLoc(out, ifElseInfo[index].ifLoc);
+      out << ",";
+      jsonPutLoc(out, ifElseInfo[index].elseLoc);
+      out << ",";
+      jsonPutLoc(out, ifElseInfo[index].exprLoc);
+      out << "," << ifElseInfo[index].branchNum;
+    }
+    else
+    if (branchInfo[i].statementType == "while")
+    {
+      jsonPutLoc(out, whileInfo[index].whileLoc);
+      out << ",";
+      jsonPutLoc(out, whileInfo[index].exprLoc);
+      out << "," << whileInfo[index].branchNum;
+    }
+    else
+    if (branchInfo[i].statementType == "for")
+    {
+      jsonPutLoc(out, forInfo[index].forLoc);
+      out << ",";
+      jsonPutLoc(out, forInfo[index].exprLoc);
+      out << "," << forInfo[index].branchNum;
+    }
+    else
+    {
+      jsonPutLoc(out, switchInfo[index].switchLoc);
+      out << ",";
+      jsonPutLoc(out, switchInfo[index].switchExprLoc);
+      out << "," << switchInfo[index].caseInfo.size();
+      for (int j = 0; j < switchInfo[index].caseInfo.size(); ++j)
+      {
+        out << ",";
+        jsonPutLoc(out, switchInfo[index].caseInfo[j].caseLoc);
+      }
+    }
+    out << "]";
+  }
+  out << "\n  ]";
+
+  if (mcdcExprInfo.size())
+  {
+    out << ",\n  \"mcdc_expr_info\":\n  [\n";
+    for (int i = 0; i < mcdcExprInfo.size(); ++i)
+    {
+      vector<mcdcOpInfoType> &opInfo = mcdcExprInfo[i].opInfo;
+
+      if (i)
+        out << ",\n";
+      out << "    [" << opInfo.size();
+      for (int j = 0; j < opInfo.size(); ++j)
+      {
+        out << ", ";
+        jsonPutLoc(out, opInfo[j].lhsLoc);
+        out << ", ";
+        jsonPutLoc(out, opInfo[j].rhsLoc);
+        out << ", \"" << (opInfo[j].andOp ? "&&" : "||") << "\"";
+      }
+      out << "]";
+    }
+    out << "\n  ]";
+  }
+
+  if (condInfo.size())
+  {
+    out << ",\n  \"condition_info\":\n  [\n";
+    for (int i = 0; i < condInfo.size(); ++i)
+    {
+      if (i)
+        out << ",\n";
+      out << "    [";
+      jsonPutLoc(out, condInfo[i].lhsLoc);
+      out << ", ";
+      jsonPutLoc(out, condInfo[i].rhsLoc);
+      out << ", \"" << condInfo[i].condition << "\", " <<
+             condInfo[i].condNum << "]";
+    }
+    out << "\n  ]";
+  }
+
+  if (mcdcOverflowInfo.size())
+  {
+    out << ",\n  \"mcdc_overflow\":\n  [\n";
+    for (int i = 0; i < mcdcOverflowInfo.size(); ++i)
+    {
+      if (i)
+        out << ",\n";
+      out << "   ";
+      jsonPutLoc(out, mcdcOverflowInfo[i]);
+    }
+    out << "\n  ]";
+  }
+
+  if (!preCovered.empty())
+    out << ",\n  \"pre_covered\": \"" << preCovered << "\"";
+
+  out << "\n}\n";
+}
+
+// See if a linemarker database exists, and if so, load it
+void VampProcess::processLineMarkers(char *preProcFileName)
+{
+    string ppMapName(preProcFileName);
+    size_t ppMapExtension = ppMapName.rfind(".");
+    gotPPMap = false;
+    ppMap.clear();
+
+    if (ppMapExtension < ppMapName.npos)
+    {
+      ppMapName.replace(ppMapExtension, ppMapName.npos - ppMapExtension + 1, PPMAP_EXT);
+      ppMapFileName = ppMapName;
+
+      struct stat ppMapStat;
+
+      // Read map file if one was generated
+      if (stat(ppMapName.c_str(), &ppMapStat) == 0)
+        gotPPMap = ppMap.load(ppMapName, vampErr);
+    }
+}
+
+// Build filename for fingerprint file (<file>.json -> <file>.vfp)
+string VampProcess::fingerprintName(string jsonName)
+{
+  size_t extension = jsonName.rfind(".");
+
+  if (extension < jsonName.npos)
+  {
+    jsonName.replace(extension, jsonName.npos - extension + 1, FINGERPRINT_EXT);
+  }
+  else
+  {
+    jsonName += FINGERPRINT_EXT;
+  }
+
+  return jsonName;
+}
+
+// Hash the report options (and vamp version) that affect report output
+string VampProcess::configHash(VAMP_REPORT_CONFIG &vo)
+{
+  ostringstream cfg;
+
+  cfg << VAMP_VERSION << "\n" <<
+         vo.combineHistory << "\n" <<
+         vo.generateReport << "\n" <<
+         vo.showTestCases << "\n" <<
+         vo.histDirectory << "\n" <<
+         vo.reportSeparator << "\n" <<
+         vo.htmlDirectory << "\n" <<
+         vo.htmlSuffix << "\n" <<
+         vo.compactHtml << "\n" <<
+         vo.generateHtml << "\n" <<
+         vo.exportLcov << "\n" <<
+         vo.exportCobertura << "\n" <<
+         vo.exportJson << "\n" <<
+         vo.mergeHeaders << "\n" <<
+         vo.mergeVariants << "\n" <<
+         vo.mcdcSolverNodeLimit << "\n" <<
+         vo.mcdcSolverTimeLimit << "\n" <<
+         ppMapFileName << "\n";
+
+  string cfgStr = cfg.str();
+  return hashStr(fnvHash(cfgStr.data(), cfgStr.size()));
+}
+
+// Hash source lines lhsLine to rhsLine
+string VampProcess::textHash(int lhsLine, int rhsLine)
+{
+  unsigned long long hash = FNV_OFFSET_BASIS;
+
+  for (int line = lhsLine; line <= rhsLine; line++)
+  {
+    SourceSlice text = source[line - 1];
+    hash = fnvHash(text.data(), text.length(), hash);
+    hash = fnvHash("\n", 1, hash);
+  }
+
+  return hashStr(hash);
+}
+
+// Get size, time and (optionally) content hash of an input file
+fingerprintType VampProcess::getFingerprint(string fileName, bool doHash)
+{
+  fingerprintType fp;
+  struct stat fileStat;
+
+  fp.fileName = fileName;
+  if (stat(fileName.c_str(), &fileStat) == -1)
+  {
+    fp.size = -1;
+    fp.modTime = 0;
+  }
+  else
+  {
+    fp.size = fileStat.st_size;
+    fp.modTime = fileStat.st_mtime;
+    if (doHash)
+      fp.hash = hashFile(fileName);
+  }
+
+  return fp;
+}
+
+// Check fingerprint saved by the last run of jsonName against its inputs.
+// Returns true if the options and every input are unchanged and all
+// outputs still exist, so the report need not be regenerated. The
+// outputs are collected into reportOutputs.
+// Inputs whose size and time match are taken as unchanged; otherwise the
+// contents are hashed, so a history rewritten with the same coverage
+// does not force a new report. The fingerprint then records the new
+// times, so the file need not be hashed again next run.
+bool VampProcess::reportUpToDate(string jsonName, VAMP_REPORT_CONFIG &vo)
+{
+  string fpName = fingerprintName(jsonName);
+  struct stat fpStat;
+
+  if (stat(fpName.c_str(), &fpStat) == -1)
+    return false;
 
   ostringstream jsonErr;
   Json n(&jsonErr);
+  bool gotConfig = false;
+  bool gotInputs = false;
+  vector<fingerprintType> inputs;
+  bool refresh = false;          // Times changed, contents did not
+
   try
   {
-    n.ParseJson(jsonSource.str());
+    n.ParseFile(fpName);
+
+    vector<JsonNode>::iterator i = n.jsonNodes.begin();
+    while (i != n.jsonNodes.end())
+    {
+      string nodeName = i->name();
+
+      if (nodeName == "config")
+      {
+        if (i->as_string() != configHash(vo))
+          return false;
+
+        gotConfig = true;
+      }
+      else
+      if (nodeName == "inputs")
+      {
+        vector<JsonNode> &nodes = n.GetArray(*i);
+        for (vector<JsonNode>::iterator j = nodes.begin(); j != nodes.end(); ++j)
+        {
+          vector<JsonNode> &input = n.GetArray(*j);
+          if (input.size() != 4)
+            return false;
+
+          fingerprintType fp = getFingerprint(input[0].as_string(), false);
+          long long size = strtoll(input[1].as_string().c_str(), NULL, 10);
+          long long modTime = strtoll(input[2].as_string().c_str(), NULL, 10);
+          fp.hash = input[3].as_string();
+
+          if (fp.size != size)
+            return false;
+
+          if ((fp.size != -1) && (fp.modTime != modTime))
+          {
+            if (hashFile(fp.fileName) != fp.hash)
+              return false;
+
+            refresh = true;
+          }
+
+          inputs.push_back(fp);
+        }
+
+        gotInputs = true;
+      }
+      else
+      if (nodeName == "outputs")
+      {
+        vector<JsonNode> &nodes = n.GetArray(*i);
+        for (vector<JsonNode>::iterator j = nodes.begin(); j != nodes.end(); ++j)
+        {
+          struct stat outStat;
+          if (stat(j->as_string().c_str(), &outStat) == -1)
+            return false;
+
+          reportOutputs.push_back(j->as_string());
+        }
+      }
+
+      ++i;
+    }
   }
   catch(int i)
   {
-    *vampErr << "Bad database file " << jsonName << " - " << jsonErr.str();
+    // Unreadable fingerprint - regenerate
     return false;
   }
 
-  jsonSource.str("");
+  if (!gotConfig || !gotInputs)
+    return false;
+
+  if (refresh)
+    writeFingerprint(jsonName, configHash(vo), inputs);
+
+  return true;
+}
+
+// Return the outputs recorded in the fingerprint of jsonName, if any
+vector<string> VampProcess::fingerprintOutputs(string jsonName)
+{
+  vector<string> outputs;
+  ostringstream jsonErr;
+  Json n(&jsonErr);
+
+  try
+  {
+    n.ParseFile(fingerprintName(jsonName));
+
+    vector<JsonNode>::iterator i;
+    for (i = n.jsonNodes.begin(); i != n.jsonNodes.end(); ++i)
+    {
+      if (i->name() == "outputs")
+      {
+        vector<JsonNode> &nodes = n.GetArray(*i);
+        for (vector<JsonNode>::iterator j = nodes.begin(); j != nodes.end(); ++j)
+          outputs.push_back(j->as_string());
+      }
+    }
+  }
+  catch(int i)
+  {
+    // No fingerprint, or unreadable
+    outputs.clear();
+  }
+
+  return outputs;
+}
+
+// Record options and inputs used to generate the report for jsonName
+void VampProcess::saveFingerprint(string jsonName, VAMP_REPORT_CONFIG &vo)
+{
+  vector<fingerprintType> inputs;
+
+  for (size_t i = 0; i < reportInputs.size(); i++)
+    inputs.push_back(getFingerprint(reportInputs[i], true));
+
+  writeFingerprint(jsonName, configHash(vo), inputs);
+}
+
+// Write fingerprint of jsonName from the option hash config, inputs and
+// reportOutputs
+void VampProcess::writeFingerprint(string jsonName, string config,
+                                   vector<fingerprintType> &inputs)
+{
+  string fpName = fingerprintName(jsonName);
+  ofstream fpFile(fpName.c_str());
+
+  if (!fpFile.is_open())
+  {
+    *vampErr << "Cannot write fingerprint file " << fpName << ENDL;
+    return;
+  }
+
+  fpFile << "{\n  \"config\": \"" << config << "\",\n";
+
+  fpFile << "  \"inputs\":\n  [\n";
+  for (size_t i = 0; i < inputs.size(); i++)
+  {
+    fingerprintType &fp = inputs[i];
+
+    fpFile << "    [\"" << fp.fileName << "\", \"" << fp.size << "\", \"" <<
+              fp.modTime << "\", \"" << fp.hash << "\"]";
+    if (i + 1 < inputs.size())
+      fpFile << ",";
+    fpFile << "\n";
+  }
+  fpFile << "  ],\n";
+
+  fpFile << "  \"outputs\":\n  [\n";
+  for (size_t i = 0; i < reportOutputs.size(); i++)
+  {
+    fpFile << "    \"" << reportOutputs[i] << "\"";
+    if (i + 1 < reportOutputs.size())
+      fpFile << ",";
+    fpFile << "\n";
+  }
+  fpFile << "  ]\n}\n";
+
+  fpFile.close();
+}
+
+// Generate report for jsonName. Unless force is set, the report is only
+// regenerated if the fingerprint of its inputs has changed.
+bool VampProcess::processFile(char *jsonName, VAMP_REPORT_CONFIG &vo, bool force)
+{
+  totalMcdcCombCnt = 0;
+  sourceCount = 0;              // Number of lines in source
+  totalStmtCoveredCount = 0;    // Total # stmts covered in source
+  newStmtCoveredCount = 0;      // # new stmts covered in current run
+  mcdcTotalOperandCount = 0;    // # MCDC operands in source code
+  mcdcTotalCoverageCount = 0;   // # MCDC operands covered in source
+  mcdcNewCoverCount = 0;        // # new MCDC operands covered in current run
+  branchTotalOperandCount = 0;  // # Branch operands in source code
+  branchTotalCoverageCount = 0; // # Branch operands covered in source
+  newBranchCoveredCount = 0;    // # new branches covered in current run
+  condTotalOperandCount = 0;    // # Conditions in source code
+  condTotalCoverageCount = 0;   // # Conditions covered in source
+  newCondCoveredCount = 0;      // # new conditions covered in current run
+
+  reportInputs.clear();
+  reportOutputs.clear();
+  mcdcExport.clear();
+
+  upToDate = !force && reportUpToDate(jsonName, vo);
+  if (upToDate)
+  {
+    *vampOut << "Report for " << jsonName << " is up to date" << ENDL;
+    return true;
+  }
+  reportOutputs.clear();
+
+  // Discard old fingerprint; it is rewritten once the report succeeds.
+  // Its outputs are kept so pages this report no longer writes can be
+  // removed.
+  oldOutputs = fingerprintOutputs(jsonName);
+  remove(fingerprintName(jsonName).c_str());
+
+  db.SetVampOptions(vo);
+  reportInputs.push_back(jsonName);
+  if (!ppMapFileName.empty())
+    reportInputs.push_back(ppMapFileName);
+
+  // Check database file exists
+  struct stat jsonStat;
+  if (stat(jsonName, &jsonStat) == -1)
+  {
+    *vampErr << "Unable to open file: " << jsonName << ENDL;
+    return false;
+  }
+
+#ifdef CHANGE_FNAME
+  size_t extension = jsonName.rfind(".");
+
+  if (extension < jsonName.npos)
+  {
+    jsonName.replace(extension, jsonName.npos - extension + 1, "_vamp.json");
+    *vampOut << "Processing " << jsonName << ENDL;
+  }
+  else
+  {
+    *vampErr << "Cannot parse " << jsonName << ": Not a C extension" << ENDL;
+  }
+#endif
+
+
+  // Use binary copy of database if it is current, else parse the JSON
+  // and save a binary copy for the next report
+  string vdbFileName = VampDB::vdbName(jsonName);
+  if (!db.loadVdb(vdbFileName, jsonName))
+  {
+    ostringstream jsonErr;
+    Json n(&jsonErr);
+    try
+    {
+      // Database is mapped and parsed in one pass
+      n.ParseFile(jsonName);
+    }
+    catch(int i)
+    {
+      *vampErr << "Bad database file " << jsonName << " - " << jsonErr.str();
+      return false;
+    }
+
+    try
+    {
+      db.parseJsonDb(n, vampErr);
+    }
+    catch(int i)
+    {
+      *vampErr << jsonErr.str();
+      return false;
+    }
 
-  try
-  {
-    db.parseJsonDb(n, vampErr);
-  }
-  catch(int i)
-  {
-    return false;
+    if (!db.saveVdb(vdbFileName, jsonName))
+    {
+      *vampErr << "Cannot write " << vdbFileName << ENDL;
+    }
   }
 
   // Get time of creation (modification) for database file as string
-  struct stat jsonStat;
-  if (stat(jsonName, &jsonStat) == -1)
-  {
-    *vampErr << "Cannot stat database file " << jsonName << " - aborting" << ENDL;
-    return false;
-  }
   string jsonModTime = modTimeStr(jsonStat.st_mtime);
 
   string fName = db.pathName + DIRECTORY_SEPARATOR + db.srcFileName;
@@ -1287,6 +2224,7 @@ bool VampProcess::processFile(char *jsonName, VAMP_REPORT_CONFIG &vo)
   {
     return false;
   }
+  reportInputs.push_back(fName);
 
   // Get time of creation (modification) for source file as string
   struct stat fileStat;
@@ -1312,6 +2250,7 @@ bool VampProcess::processFile(char *jsonName, VAMP_REPORT_CONFIG &vo)
     return false;
   }
   string instrModTime = modTimeStr(instrStat.st_mtime);
+  reportInputs.push_back(instrFile);
   if (instrModTime != db.instrModTime)
   {
     *vampErr << "Error - instrumented file " << instrFile <<
@@ -1371,118 +2310,166 @@ bool VampProcess::processFile(char *jsonName, VAMP_REPORT_CONFIG &vo)
   string histName = histDir + "/" + historyName;
   string combHistName = histDir + "/" + combHistoryName;
 
+  reportInputs.push_back(histName);
   if (db.combineHistory)
+    reportInputs.push_back(combHistName);
+
+  // Coverage so far goes straight into hist when that is all we want
+  History &prevHist = coverageOnly ? hist : oldHist;
+  bool gotOldHist = false;
+  if (db.combineHistory || coverageOnly)
   {
     *vampOut << "Reading combined history file: " << combHistoryName << ENDL;
     //if (!oldHist.loadHistory(db.histDirectory, combHistoryName, vampErr))
-    if (!oldHist.loadHistory(combHistName, vampErr))
-    {
-      db.combineHistory = false;
-    }
-    else
+    if (prevHist.loadHistory(combHistName, vampErr))
     {
-      if (oldHist.modTime < db.instrModTime)
+      if (prevHist.modTime >= db.instrModTime)
+      {
+        gotOldHist = true;
+      }
+      else
+      if (db.preCovered.empty())
       {
 // FIXME - Look for option in vamp_process.cfg to handle this problem
 // Decide to exit, delete or rename combined history file
         *vampErr << "Warning - combined history file " << combHistName <<
                     " older than instrumented source " << instrFile <<
                     " - ignoring" << ENDL;
-        db.combineHistory = false;
       }
-      else
-      {
-        *vampOut << "Reading new history file: " << histName << ENDL;
-        //if (!newHist.loadHistory(db.histDirectory, historyName, vampErr))
-        if (!newHist.loadHistory(histName, vampErr))
-        {
-          return false;
-        }
+    }
+  }
 
-        if (oldHist.coverageOptions != newHist.coverageOptions)
-        {
-          *vampErr << "Coverage options do not match between files " <<
-                      histName << " and " << combHistName << " - aborting" << ENDL;
-          return false;
-        }
+  // Source instrumented with skip_covered carries the coverage of the
+  // probes left out. It stands in for the combined history until one is
+  // generated for the new instrumentation.
+  if (!gotOldHist && !db.preCovered.empty())
+  {
+    *vampOut << "Using coverage carried forward in " << jsonName << ENDL;
+    if (!prevHist.loadHexHistory(db.preCovered, vampErr))
+    {
+      return false;
+    }
+    prevHist.modTime = db.instrModTime;
+    gotOldHist = true;
+  }
 
-        if (newHist.modTime < db.instrModTime)
-        {
-          *vampErr << "New history file " << histName <<
-                      " older than instrumented source " <<
-                      instrFile << " - aborting" << ENDL;
-          return false;
-        }
+  if (coverageOnly)
+  {
+    if (!gotOldHist)
+    {
+      *vampErr << "No current combined history for " << jsonName << ENDL;
+      return false;
+    }
 
-        hist.coverageOptions = oldHist.coverageOptions;
-        hist.instCount = oldHist.instCount;
-        hist.branchCount = oldHist.branchCount;
-        hist.mcdcCount = oldHist.mcdcCount;
-        hist.condCount = oldHist.condCount;
-        hist.stackOverflow = oldHist.stackOverflow | newHist.stackOverflow;
+    db.combineHistory = false;
+    db.outputCombinedHistory = false;
+  }
+  else
+  {
+    db.combineHistory = gotOldHist;
+  }
 
-        if (hist.coverageOptions & DO_STATEMENT_COUNT)
-        {
-          hist.covCntInfo = (unsigned int *) malloc(hist.instCount * 4);
+  if (db.combineHistory)
+  {
+    *vampOut << "Reading new history file: " << histName << ENDL;
+    //if (!newHist.loadHistory(db.histDirectory, historyName, vampErr))
+    if (!newHist.loadHistory(histName, vampErr))
+    {
+      return false;
+    }
 
-          // Save largest of old and new as combined count
-          for (int i = 0; i < hist.instCount; i++)
-          {
-            hist.covCntInfo[i] =
-               (oldHist.covCntInfo[i] > newHist.covCntInfo[i]) ?
-                oldHist.covCntInfo[i] : newHist.covCntInfo[i];
-          }
-        }
-        else
-        if (hist.coverageOptions & (DO_STATEMENT_SINGLE | DO_BRANCH))
-        {
-          // May exist for branch coverage of case statements
-          hist.coveredInfo = (unsigned char *) malloc(hist.instCount);
+    if (oldHist.coverageOptions != newHist.coverageOptions)
+    {
+      *vampErr << "Coverage options do not match between files " <<
+                  histName << " and " << combHistName << " - aborting" << ENDL;
+      return false;
+    }
 
-          // Combine old and new statement coverage bit info
-          for (int i = 0; i < hist.instCount; i++)
-          {
-            hist.coveredInfo[i] = oldHist.coveredInfo[i] | newHist.coveredInfo[i];
-          }
-        }
+    if ((oldHist.instCount != newHist.instCount) ||
+        (oldHist.branchCount != newHist.branchCount) ||
+        (oldHist.mcdcCount != newHist.mcdcCount) ||
+        (oldHist.condCount != newHist.condCount))
+    {
+      *vampErr << "Coverage sizes do not match between files " <<
+                  histName << " and " << combHistName << " - aborting" << ENDL;
+      return false;
+    }
 
-        if (hist.coverageOptions & DO_BRANCH)
-        {
-          hist.brInfo = (unsigned char *) malloc(hist.branchCount);
+    if (newHist.modTime < db.instrModTime)
+    {
+      *vampErr << "New history file " << histName <<
+                  " older than instrumented source " <<
+                  instrFile << " - aborting" << ENDL;
+      return false;
+    }
 
-          // Combine old and new branch bit info
-          for (int i = 0; i < hist.branchCount; i++)
-          {
-            hist.brInfo[i] = oldHist.brInfo[i] | newHist.brInfo[i];
-          }
-        }
+    hist.coverageOptions = oldHist.coverageOptions;
+    hist.instCount = oldHist.instCount;
+    hist.branchCount = oldHist.branchCount;
+    hist.mcdcCount = oldHist.mcdcCount;
+    hist.condCount = oldHist.condCount;
+    hist.stackOverflow = oldHist.stackOverflow | newHist.stackOverflow;
 
-        if (hist.coverageOptions & DO_MCDC)
-        {
-          hist.mcdcInfo = (unsigned char *) malloc(hist.mcdcCount);
+    if (hist.coverageOptions & DO_STATEMENT_COUNT)
+    {
+      hist.covCntInfo = (unsigned int *) malloc(hist.instCount * 4);
 
-          // Clear MC/DC info for now; combine it later
-          for (int i = 0; i < hist.mcdcCount; i++)
-          {
-            hist.mcdcInfo[i] = 0;
-          }
-        }
-        else
-        if (hist.coverageOptions & DO_CONDITION)
-        {
-          hist.condInfo = (unsigned char *) malloc(hist.condCount);
+      // Save largest of old and new as combined count
+      for (int i = 0; i < hist.instCount; i++)
+      {
+        hist.covCntInfo[i] =
+           (oldHist.covCntInfo[i] > newHist.covCntInfo[i]) ?
+            oldHist.covCntInfo[i] : newHist.covCntInfo[i];
+      }
+    }
+    else
+    if (hist.coverageOptions & (DO_STATEMENT_SINGLE | DO_BRANCH))
+    {
+      // May exist for branch coverage of case statements
+      hist.coveredInfo = (unsigned char *) malloc(hist.instCount);
 
-          // Combine old and new condition bit info
-          for (int i = 0; i < oldHist.condCount; i++)
-          {
-            hist.condInfo[i] = oldHist.condInfo[i] | newHist.condInfo[i];
-          }
-        }
+      // Combine old and new statement coverage bit info
+      for (int i = 0; i < hist.instCount; i++)
+      {
+        hist.coveredInfo[i] = oldHist.coveredInfo[i] | newHist.coveredInfo[i];
+      }
+    }
+
+    if (hist.coverageOptions & DO_BRANCH)
+    {
+      hist.brInfo = (unsigned char *) malloc(hist.branchCount);
+
+      // Combine old and new branch bit info
+      for (int i = 0; i < hist.branchCount; i++)
+      {
+        hist.brInfo[i] = oldHist.brInfo[i] | newHist.brInfo[i];
+      }
+    }
+
+    if (hist.coverageOptions & DO_MCDC)
+    {
+      hist.mcdcInfo = (unsigned char *) malloc(hist.mcdcCount);
+
+      // Clear MC/DC info for now; combine it later
+      for (int i = 0; i < hist.mcdcCount; i++)
+      {
+        hist.mcdcInfo[i] = 0;
+      }
+    }
+    else
+    if (hist.coverageOptions & DO_CONDITION)
+    {
+      hist.condInfo = (unsigned char *) malloc(hist.condCount);
+
+      // Combine old and new condition bit info
+      for (int i = 0; i < oldHist.condCount; i++)
+      {
+        hist.condInfo[i] = oldHist.condInfo[i] | newHist.condInfo[i];
       }
     }
   }
 
-  if (!db.combineHistory)
+  if (!db.combineHistory && !coverageOnly)
   {
     *vampOut << "Reading history file: " << historyName << ENDL;
     //if (!hist.loadHistory(db.histDirectory, historyName, vampErr))
@@ -1518,6 +2505,14 @@ bool VampProcess::processFile(char *jsonName, VAMP_REPORT_CONFIG &vo)
     return false;
   }
 
+  // Detail tables are only built when there is an HTML report to show
+  // them. The compact layout has the report script render them from data.
+  buildHtml = db.generateHtml && !coverageOnly && !db.compactHtml;
+  buildData = db.generateHtml && !coverageOnly && db.compactHtml;
+  branchHTMLInfo.setEnabled(buildHtml || buildData);
+  mcdcHTMLInfo.setEnabled(buildHtml || buildData);
+  condHTMLInfo.setEnabled(buildHtml || buildData);
+
   if (doBranch)
   {
     // Process branch coverage info
@@ -1536,11 +2531,15 @@ bool VampProcess::processFile(char *jsonName, VAMP_REPORT_CONFIG &vo)
     processCondition();
   }
 
+  // Coverage found; nothing to output
+  if (coverageOnly)
+    return true;
+
 #ifdef VAMP_DEBUG_SHOW_ATTRIBS
   for (int i = 0; i < source.size(); i++)
   {
-    CDBG << source[i] << ENDL;
-    CDBG << attribs[i] << ENDL;
+    CDBG << source[i].str() << ENDL;
+    CDBG << attribs.str(i + 1) << ENDL;
   }
 #endif
 
@@ -1611,12 +2610,65 @@ bool VampProcess::processFile(char *jsonName, VAMP_REPORT_CONFIG &vo)
   }
 
   htmlName = htmlDir + DIRECTORY_SEPARATOR + htmlName + db.htmlSuffix;
+
+  // Compact reports share a style sheet and script
+  if (db.generateHtml && db.compactHtml && !writeHTMLBundle(htmlDir, htmlName))
+    return false;
   //htmlName = htmlDir + DIRECTORY_SEPARATOR + htmlName +
   //           db.htmlSuffix + ".html";
 #endif
 
-  *vampOut << "Generating " << htmlName << ".html" << ENDL;
-  genHTML(htmlName);
+  if (db.generateHtml)
+  {
+    *vampOut << "Generating " << htmlName << ".html" << ENDL;
+    reportOutputs.push_back(htmlName + ".html");
+    genHTML(htmlName);
+  }
+  genSummary(htmlName);
+
+  reportOutputs.push_back(htmlName + ".vrpt");
+  if (db.generateReport)
+    reportOutputs.push_back(htmlName + ".rpt");
+
+  // Machine-readable exports
+  if (db.exportLcov)
+  {
+    *vampOut << "Generating " << htmlName << LCOV_EXT << ENDL;
+    if (!genLcov(htmlName + LCOV_EXT))
+      return false;
+    reportOutputs.push_back(htmlName + LCOV_EXT);
+  }
+
+  if (db.exportCobertura)
+  {
+    *vampOut << "Generating " << htmlName << COBERTURA_EXT << ENDL;
+    if (!genCobertura(htmlName + COBERTURA_EXT))
+      return false;
+    reportOutputs.push_back(htmlName + COBERTURA_EXT);
+  }
+
+  if (db.exportJson)
+  {
+    *vampOut << "Generating " << htmlName << JSON_SUMMARY_EXT << ENDL;
+    if (!genJsonSummary(htmlName + JSON_SUMMARY_EXT))
+      return false;
+    reportOutputs.push_back(htmlName + JSON_SUMMARY_EXT);
+  }
+
+  // Header coverage is only known through the preprocessor line map
+  if (db.mergeHeaders && gotPPMap)
+  {
+    if (!genHeaderCoverage(htmlName + HEADER_COV_EXT))
+      return false;
+    reportOutputs.push_back(htmlName + HEADER_COV_EXT);
+  }
+
+  if (db.mergeVariants && gotPPMap)
+  {
+    if (!genVariantCoverage(htmlName + VARIANT_COV_EXT))
+      return false;
+    reportOutputs.push_back(htmlName + VARIANT_COV_EXT);
+  }
 /*
   size_t extension = fileName.rfind(".");
 
@@ -1777,38 +2829,218 @@ bool VampProcess::processFile(char *jsonName, VAMP_REPORT_CONFIG &vo)
     fclose(fd);
 #endif
   }
+
+  saveFingerprint(jsonName, vo);
   return true;
 }
 
+// Find statements, branches, conditions and MC/DC expressions already
+// covered by the combined history of a source (or the coverage carried
+// forward in its database), so they can be left out when it is
+// instrumented again (skip_covered). Probes keep their numbers, so the
+// history returned can be combined with that of the new instrumentation.
+bool VampProcess::getCoveredProbes(char *jsonName, VAMP_REPORT_CONFIG &vo,
+                                   VAMP_COVERED_PROBES &probes)
+{
+  coverageOnly = true;
+  bool result = processFile(jsonName, vo, true);
+  coverageOnly = false;
 
-// Load source file <fileName> into string vector
-bool VampProcess::readSource(string fileName)
+  if (!result)
+    return false;
+
+  probes.options = hist.coverageOptions;
+  probes.stmtSize = hist.instCount;
+  probes.branchSize = hist.branchCount;
+  probes.mcdcSize = hist.mcdcCount;
+  probes.condSize = hist.condCount;
+
+  probes.stmt.clear();
+  if (doStmtCount)
+  {
+    for (int i = 0; i < hist.instCount; i++)
+      probes.stmt.push_back(hist.covCntInfo[i] != 0);
+  }
+  else
+  if (doStmtSingle || doBranch)
+  {
+    for (int i = 0; i < hist.instCount * 8; i++)
+      probes.stmt.push_back((hist.coveredInfo[i >> 3] >> (i & 7)) & 1);
+  }
+
+  // Branches and conditions use a pair of bits, numbered by the first;
+  // covered once both outcomes are seen
+  probes.branch.clear();
+  if (doBranch)
+  {
+    for (int i = 0; i < hist.branchCount * 8; i++)
+      probes.branch.push_back(!(i & 1) &&
+                              (((hist.brInfo[i >> 3] >> (i & 7)) & 3) == 3));
+  }
+
+  probes.cond.clear();
+  if (doCC && !doMCDC)
+  {
+    for (int i = 0; i < hist.condCount * 8; i++)
+      probes.cond.push_back(!(i & 1) &&
+                            (((hist.condInfo[i >> 3] >> (i & 7)) & 3) == 3));
+  }
+
+  // MC/DC expressions are covered once every operand is shown to
+  // independently affect the outcome
+  probes.mcdc.clear();
+  if (doMCDC && (mcdcExport.size() == db.mcdcExprInfo.size()))
+  {
+    for (int e = 0; e < mcdcExport.size(); e++)
+    {
+      vector<unsigned char> &senses = mcdcExport[e].senses;
+      bool shown = !senses.empty();
+      for (int i = 0; i < senses.size(); i++)
+        shown = shown && (senses[i] == 3);
+      probes.mcdc.push_back(shown);
+    }
+  }
+
+  // Carry the coverage forward in the new database
+  ostringstream histBytes;
+  hist.writeHistory(histBytes);
+  string bytes = histBytes.str();
+
+  probes.history.clear();
+  for (int i = 0; i < bytes.size(); i++)
+  {
+    char hex[4];
+    sprintf(hex, "%02x", (unsigned char) bytes[i]);
+    probes.history += hex;
+  }
+
+  return true;
+}
+
+
+// Return up to n characters starting at pos
+SourceSlice SourceSlice::substr(size_t pos, size_t n) const
+{
+  if (pos > len)
+    pos = len;
+  if (n > len - pos)
+    n = len - pos;
+
+  return SourceSlice(ptr + pos, n);
+}
+
+// Find last ch at or before pos
+size_t SourceSlice::rfind(char ch, size_t pos) const
+{
+  if (len == 0)
+    return string::npos;
+
+  size_t i = (pos < len) ? pos : len - 1;
+  while (ptr[i] != ch)
+  {
+    if (i-- == 0)
+      return string::npos;
+  }
+
+  return i;
+}
+
+// Map fileName into memory and index its lines
+bool SourceBuffer::open(string fileName)
 {
-  string line;
+  close();
+
+#ifdef _WIN32
+  // No mmap; read the whole file into one buffer instead
   ifstream sourceFile (fileName.c_str());
-  vector<string>::iterator i;
-  bool result;
+  if (!sourceFile.is_open())
+    return false;
 
-  // Read input source file
-  if (sourceFile.is_open())
+  ostringstream contents;
+  contents << sourceFile.rdbuf();
+  text = contents.str();
+  buf = text.data();
+  bufSize = text.size();
+#else
+  int fd = ::open(fileName.c_str(), O_RDONLY);
+  if (fd == -1)
+    return false;
+
+  struct stat fileStat;
+  if (fstat(fd, &fileStat) == -1)
+  {
+    ::close(fd);
+    return false;
+  }
+
+  bufSize = fileStat.st_size;
+  if (bufSize)
   {
-    while ( sourceFile.good() )
+    void *addr = mmap(NULL, bufSize, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (addr == MAP_FAILED)
     {
-      string lineAttr;
+      ::close(fd);
+      bufSize = 0;
+      return false;
+    }
+    buf = (const char *) addr;
+    mapped = true;
+  }
+  else
+  {
+    buf = "";
+  }
+  ::close(fd);
+#endif
 
-      getline(sourceFile, line);
-      source.push_back(line);
+  lineStart.push_back(0);
+  for (const char *p = buf; (p = (const char *) memchr(p, '\n', buf + bufSize - p)) != NULL; )
+    lineStart.push_back(++p - buf);
 
+  return true;
+}
+
+void SourceBuffer::close(void)
+{
+#ifndef _WIN32
+  if (mapped)
+    munmap((void *) buf, bufSize);
+#endif
+  mapped = false;
+  buf = NULL;
+  bufSize = 0;
+  text.clear();
+  lineStart.clear();
+}
+
+// Get line i (0 based), without its newline
+SourceSlice SourceBuffer::operator[](int i)
+{
+  if ((i < 0) || (i >= lineStart.size()))
+    return SourceSlice();
+
+  size_t end = (i + 1 < lineStart.size()) ? lineStart[i + 1] - 1 : bufSize;
+  return SourceSlice(buf + lineStart[i], end - lineStart[i]);
+}
+
+// Load source file <fileName> and index its lines
+bool VampProcess::readSource(string fileName)
+{
+  bool result;
+
+  // Read input source file
+  if (source.open(fileName))
+  {
+    for (int i = 0; i < source.size(); i++)
+    {
       // Create attribute line of all nulls
-      lineAttr.append(line.length(), 0);
-      attribs.push_back(lineAttr);
+      attribs.addLine(source[i].length());
       ++sourceCount;
     }
-    sourceFile.close();
 
 #ifdef VAMP_DEBUG_SRC
-    for (i = source.begin(); i < source.end(); i++)
-      CDBG << *i << ENDL;
+    for (int i = 0; i < source.size(); i++)
+      CDBG << source[i].str() << ENDL;
 #endif
 
     result = true;
@@ -1829,34 +3061,37 @@ bool VampProcess::readSource(string fileName)
 string VampProcess::sourceText(sourceLocationType &loc)
 {
   string str;
+  SourceSlice text;
   int lhsLine = loc.lhsLine;
   int lhsCol = loc.lhsCol;
 
   while (lhsLine < loc.rhsLine)
   {
-    str += source[lhsLine - 1].substr(lhsCol - 1);
+    text = source[lhsLine - 1].substr(lhsCol - 1);
+    str.append(text.data(), text.length());
     ++lhsLine;
     lhsCol = 1;
   }
-  str += source[lhsLine - 1].substr(lhsCol - 1, loc.rhsCol - lhsCol + 1);
+  text = source[lhsLine - 1].substr(lhsCol - 1, loc.rhsCol - lhsCol + 1);
+  str.append(text.data(), text.length());
 
   return str;
 }
 
-// Return a vector of strings of source code from [loc.lhsLine, loc.lhsCol] to
-//                                                [loc.rhsLine, loc.rhsCol]
-// Indent each new line with indent spaces
+// Return a vector of slices of source code from [loc.lhsLine, loc.lhsCol] to
+//                                               [loc.rhsLine, loc.rhsCol]
+// with one slice per line. Callers indent lines after the first as needed.
 void VampProcess::genHtmlSourceText(sourceLocationType &loc,
-                                    int indent,
-                                    vector<string> &strings)
+                                    vector<SourceSlice> &strings)
 {
-  string str;
+  SourceSlice str;
   int lhsLine = loc.lhsLine;
   int lhsCol = loc.lhsCol;
 
   while (lhsLine < loc.rhsLine)
   {
-    while (source[lhsLine - 1][lhsCol - 1] <= 0x20)
+    while ((lhsLine <= source.size()) &&
+           (source[lhsLine - 1][lhsCol - 1] <= 0x20))
     {
       if (lhsCol++ >= source[lhsLine - 1].length())
       {
@@ -1867,49 +3102,93 @@ void VampProcess::genHtmlSourceText(sourceLocationType &loc,
     }
         
     // Works if line not blank...  Compare lhsCol to rhsCol...
-    str += source[lhsLine - 1].substr(lhsCol - 1);
+    strings.push_back(source[lhsLine - 1].substr(lhsCol - 1));
     ++lhsLine;
-    strings.push_back(str);
-    str = "";
-    if (indent)
-      str.insert(0, indent, ' ');
     lhsCol = 1;
   }
 
-  if (lhsLine <= loc.rhsLine)
+  if (lhsLine <= loc.rhsLine)
+  {
+    while ((lhsCol <= loc.rhsCol) && (source[lhsLine - 1][lhsCol - 1] <= 0x20))
+    {
+      lhsCol++;
+    }
+    if (lhsCol < loc.rhsCol)
+    {
+      str = source[lhsLine - 1].substr(lhsCol - 1, loc.rhsCol - lhsCol + 1);
+    }
+  }
+  strings.push_back(str);
+}
+
+// Return a string of source code from [loc.lhsLine, loc.lhsCol] to
+//                                     [loc.rhsLine, loc.rhsCol]
+// Add <br /> at line breaks, and indent next line indent spaces
+string VampProcess::htmlSourceText(sourceLocationType &loc, int indent)
+{
+  vector<SourceSlice> strings;
+  string str;
+
+  genHtmlSourceText(loc, strings);
+  for (int i = 0; i < strings.size(); i++)
+  {
+    if (i && indent)
+      str.append(indent, ' ');
+    str.append(strings[i].data(), strings[i].length());
+    if ((i + 1) != strings.size())
+      str += "<br />";
+  }
+
+  return str;
+}
+
+// Quote s as a JavaScript string that is safe inside a <script> element
+static string jsString(const string &s)
+{
+  string out("\"");
+
+  for (size_t i = 0; i < s.size(); i++)
   {
-    while ((lhsCol <= loc.rhsCol) && (source[lhsLine - 1][lhsCol - 1] <= 0x20))
+    unsigned char ch = s[i];
+
+    if ((ch == '"') || (ch == '\\'))
     {
-      lhsCol++;
+      out += '\\';
+      out += ch;
     }
-    if (lhsCol < loc.rhsCol)
+    else
+    if (ch == '\t')
+      out += "\\t";
+    else
+    if ((ch < 0x20) || (ch == '<') || (ch == '>') || (ch == '&'))
     {
-      str += source[lhsLine - 1].substr(lhsCol - 1, loc.rhsCol - lhsCol + 1);
+      char hex[8];
+      sprintf(hex, "\\x%02x", ch);
+      out += hex;
     }
+    else
+      out += ch;
   }
-  strings.push_back(str);
+
+  return out + "\"";
 }
 
-// Return a string of source code from [loc.lhsLine, loc.lhsCol] to
-//                                     [loc.rhsLine, loc.rhsCol]
-// Add <br /> at line breaks, and indent next line indent spaces
-string VampProcess::htmlSourceText(sourceLocationType &loc, int indent)
+// Return source code from [loc.lhsLine, loc.lhsCol] to [loc.rhsLine, loc.rhsCol]
+// as a JavaScript array with one string per line, for the report script
+string VampProcess::jsSourceText(sourceLocationType &loc)
 {
-  vector<string> strings;
-  //vector<string>::iterator s;
-  string str;
+  vector<SourceSlice> strings;
+  string str("[");
 
-  genHtmlSourceText(loc, indent, strings);
-  //for (s = strings.begin(); s != strings.end(); s++)
+  genHtmlSourceText(loc, strings);
   for (int i = 0; i < strings.size(); i++)
   {
-    //str += *s;
-    str += strings[i];
-    if ((i + 1) != strings.size())
-      str += "<br />";
+    if (i)
+      str += ",";
+    str += jsString(strings[i].str());
   }
 
-  return str;
+  return str + "]";
 }
 
 // Walk through MC/DC tree node to add to list for given leaf
@@ -1918,8 +3197,8 @@ void VampProcess::walkTreeNode(int &nodeCnt,
                                bool doRHS,
                                vector<sourceLocationType> &nodeInfo)
 {
-  // Label for each of up to 31 operands in expression
-  //string opStr("ABCDEFGHIJKLMNOPQRSTUVWXYZabcde");
+  // Label for each of up to MCDC_MAX_OPERANDS operands in expression
+  //string opStr(MCDC_OPERAND_LABELS);
   sourceLocationType loc;
 
   if (doRHS)
@@ -1959,33 +3238,225 @@ void VampProcess::walkTree(int &nodeCnt,
     walkTree(nodeCnt, node->rhs, nodeInfo);
 }
 
-// Check for match between string mcdcStr and strings in testStr
-// Treat '-' in each testStr as a wild card.
-// If checkBoth == true, treat '-' in mcdcStr as a wild card, too.
-int VampProcess::checkMatch(string &mcdcStr,
-                            vector<string> &testStr,
-                            //bool checkBoth = false)
-                            bool checkBoth)
+// Pack '0'/'1'/'-' MC/DC condition strings into mask/value pairs.
+// Character n of each string becomes bit n.
+void VampProcess::packVectors(vector<string> &vecStr, mcdcVectorTable &table)
 {
   vector<string>::iterator n;
-  const char *mStr = mcdcStr.c_str();
-  int len = mcdcStr.length();
-
-  int which = 0;
-  for (n = testStr.begin(); n < testStr.end(); n++, which++)
-  {
-    const char *tStr = n->c_str();
-    int i;
-    for (i = 0; (i < len) &&
-                ((mStr[i] == tStr[i]) || (tStr[i] == '-') ||
-                 (checkBoth && (mStr[i] == '-'))); i++) ;
-    if (i == len)
+
+  table.mask.clear();
+  table.value.clear();
+  table.mask.reserve(vecStr.size());
+  table.value.reserve(vecStr.size());
+
+  for (n = vecStr.begin(); n < vecStr.end(); n++)
+  {
+    mcdcVecType mask = 0;
+    mcdcVecType value = 0;
+    for (int i = 0; i < n->length(); i++)
+    {
+      char ch = (*n)[i];
+      if (ch != '-')
+      {
+        mask |= (mcdcVecType) 1 << i;
+        if (ch == '1')
+          value |= (mcdcVecType) 1 << i;
+      }
+    }
+    table.mask.push_back(mask);
+    table.value.push_back(value);
+  }
+}
+
+// Check for match between observed vector obs and vectors in table.
+// Don't care operands in the table match anything.
+int VampProcess::checkMatch(mcdcVecType obs, mcdcVectorTable &table)
+{
+  const mcdcVecType *mask = table.mask.data();
+  const mcdcVecType *value = table.value.data();
+  int cnt = table.mask.size();
+
+  for (int which = 0; which < cnt; which++)
+  {
+    if ((obs & mask[which]) == value[which])
+      return which;
+  }
+
+  return -1;
+}
+
+// Check for match between vector val and vectors in table, treating
+// operands clear in valMask as don't care as well
+int VampProcess::checkMatch(mcdcVecType val, mcdcVecType valMask,
+                            mcdcVectorTable &table)
+{
+  const mcdcVecType *mask = table.mask.data();
+  const mcdcVecType *value = table.value.data();
+  int cnt = table.mask.size();
+
+  for (int which = 0; which < cnt; which++)
+  {
+    if (((val ^ value[which]) & mask[which] & valMask) == 0)
       return which;
   }
 
   return -1;
 }
 
+// Resolve every possible observation of a narrow expression up front.
+// lookup[obs] is the index of the first matching False vector, the
+// False vector count plus the index of the first matching True vector,
+// or -1 if nothing matches. Tables are filled in reverse so the first
+// match wins, the same as checkMatch().
+void VampProcess::buildMatchLookup(mcdcVectorTable &falseTable,
+                                   mcdcVectorTable &trueTable,
+                                   int operandCnt,
+                                   vector<int> &lookup)
+{
+  mcdcVecType opMask = ((mcdcVecType) 1 << operandCnt) - 1;
+  int falseCnt = falseTable.mask.size();
+
+  lookup.assign((size_t) 1 << operandCnt, -1);
+
+  for (int which = trueTable.mask.size() - 1; which >= 0; which--)
+  {
+    // Visit every setting of the don't care operands
+    mcdcVecType free = ~trueTable.mask[which] & opMask;
+    mcdcVecType sub = free;
+    for (;;)
+    {
+      lookup[trueTable.value[which] | sub] = falseCnt + which;
+      if (!sub)
+        break;
+      sub = (sub - 1) & free;
+    }
+  }
+
+  for (int which = falseCnt - 1; which >= 0; which--)
+  {
+    mcdcVecType free = ~falseTable.mask[which] & opMask;
+    mcdcVecType sub = free;
+    for (;;)
+    {
+      lookup[falseTable.value[which] | sub] = which;
+      if (!sub)
+        break;
+      sub = (sub - 1) & free;
+    }
+  }
+}
+
+// Add attributes for a source line of given length
+void AttribMap::addLine(int length)
+{
+  lineLength.push_back(length);
+  lineRuns.push_back(vector<attribRunType>());
+}
+
+// Get attributes of character at line, col
+unsigned char AttribMap::get(int line, int col)
+{
+  vector<attribRunType> &runs = lineRuns[line - 1];
+  unsigned char attrib = 0;
+
+  for (int lo = 0, hi = runs.size(); lo < hi; )
+  {
+    int mid = (lo + hi) / 2;
+    if (runs[mid].col <= col)
+    {
+      attrib = runs[mid].attrib;
+      lo = mid + 1;
+    }
+    else
+      hi = mid;
+  }
+
+  return attrib;
+}
+
+// Get last column of the run containing line, col
+int AttribMap::runEnd(int line, int col)
+{
+  vector<attribRunType> &runs = lineRuns[line - 1];
+
+  for (int i = 0; i < runs.size(); i++)
+  {
+    if (runs[i].col > col)
+      return runs[i].col - 1;
+  }
+
+  return lineLength[line - 1];
+}
+
+// Start a new run at col (unless one starts there); return its index
+int AttribMap::split(int line, int col)
+{
+  vector<attribRunType> &runs = lineRuns[line - 1];
+
+  if (runs.empty())
+  {
+    attribRunType run = { 1, 0 };
+    runs.push_back(run);
+  }
+
+  int i = runs.size();
+  while (runs[i - 1].col > col)
+    --i;
+
+  if (runs[i - 1].col == col)
+    return i - 1;
+
+  attribRunType run = { col, runs[i - 1].attrib };
+  runs.insert(runs.begin() + i, run);
+  return i;
+}
+
+// OR attrib into columns fromCol to toCol of line.
+// If require is non-zero, only characters already having all of the
+// require attributes are changed.
+void AttribMap::set(int line, int fromCol, int toCol,
+                    unsigned char attrib, unsigned char require)
+{
+  if (fromCol < 1)
+    fromCol = 1;
+  if (toCol > lineLength[line - 1])
+    toCol = lineLength[line - 1];
+  if (fromCol > toCol)
+    return;
+
+  vector<attribRunType> &runs = lineRuns[line - 1];
+  int first = split(line, fromCol);
+  int last = (toCol < lineLength[line - 1]) ? split(line, toCol + 1) :
+                                              runs.size();
+
+  for (int i = first; i < last; i++)
+  {
+    if ((runs[i].attrib & require) == require)
+      runs[i].attrib |= attrib;
+  }
+
+  // Merge runs left with matching attributes
+  int end = (last < runs.size()) ? last + 1 : last;
+  int out = (first > 0) ? first : 1;
+  for (int i = out; i < end; i++)
+  {
+    if (runs[i].attrib != runs[out - 1].attrib)
+      runs[out++] = runs[i];
+  }
+  runs.erase(runs.begin() + out, runs.begin() + end);
+}
+
+// Get attributes of line as one byte per character
+string AttribMap::str(int line)
+{
+  string lineAttr;
+
+  for (int col = 1; col <= lineLength[line - 1]; col++)
+    lineAttr += (char) get(line, col);
+
+  return lineAttr;
+}
+
 // Set specified source code attribute for given range
 void VampProcess::setAttrib(unsigned char attrib, sourceLocationType &range)
 {
@@ -1999,23 +3470,107 @@ void VampProcess::setAttrib(unsigned char attrib, sourceLocationType &range)
     if (lhsLine > attribs.size())
         throw(1);
 
-    while (lhsCol <= attribs[lhsLine - 1].length())
-    {
-      attribs[lhsLine - 1][lhsCol - 1] |= attrib;
-      lhsCol++;
-    }
-    lhsCol = 0;
+    attribs.set(lhsLine, lhsCol, attribs.length(lhsLine), attrib);
+    lhsCol = 1;
     lhsLine++;
   }
 
   // Handle current line
-  if (lhsLine == range.rhsLine)
+  if ((lhsLine == range.rhsLine) && (lhsLine <= attribs.size()))
+  {
+    attribs.set(lhsLine, lhsCol, range.rhsCol, attrib);
+  }
+}
+
+// Get attributes marking a statement covered by instrumentation point inst.
+// newCov is set if the coverage is new in the current run. useCount
+// selects statement counts over single statement bits when combining.
+unsigned char VampProcess::stmtCoverAttrib(int inst, bool useCount, bool &newCov)
+{
+  unsigned char attrib = STMT_COVERED;
+  int index = inst >> 3;
+  int mask = 1 << (inst & 7);
+
+  newCov = false;
+  if (db.combineHistory)
   {
-    while (lhsCol <= range.rhsCol)
+    if (useCount)
     {
-      attribs[lhsLine - 1][lhsCol - 1] |= attrib;
-      lhsCol++;
+      // Check if old history covered
+      if (oldHist.covCntInfo[inst])
+        attrib |= STMT_COVERED_OLD;
+
+      // Check if new history covered
+      if (newHist.covCntInfo[inst] != 0)
+      {
+        attrib |= STMT_COVERED_NEW;
+        // Flag if this is new coverage
+        if (oldHist.covCntInfo[inst] == 0)
+          newCov = true;
+      }
+    }
+    else
+// FIXME: Do we need to deal with doBranch here? Don't think so!
+    if (doStmtSingle)
+    {
+      // Check if old history covered
+      if (oldHist.coveredInfo[index] & mask)
+        attrib |= STMT_COVERED_OLD;
+
+      // Check if new history covered
+      if (newHist.coveredInfo[index] & mask)
+      {
+        attrib |= STMT_COVERED_NEW;
+        if (((oldHist.coveredInfo[index] &
+             newHist.coveredInfo[index]) ^
+             newHist.coveredInfo[index]) & mask)
+          newCov = true;
+      }
+    }
+  }
+
+  return attrib;
+}
+
+// Mark code in columns fromCol to toCol of line as covered, and count
+// the statements that start there.
+// stmt tracks the current statement as the columns are walked: it moves
+// on once its end is passed, and a statement is counted only when its
+// start is reached while it is current.
+void VampProcess::setStmtCovered(int line, int fromCol, int toCol,
+                                 unsigned char attrib, bool newCov,
+                                 vector<sourceLocationType>::iterator &stmt,
+                                 int &coveredCount)
+{
+  if (toCol > attribs.length(line))
+    toCol = attribs.length(line);
+
+  attribs.set(line, fromCol, toCol, attrib, STMT_CODE);
+
+  int col = fromCol;
+  while ((col <= toCol) && (stmt < db.statementInfo.end()))
+  {
+    // Column at which the current statement is passed on this line
+    int endCol = toCol + 1;
+    if (stmt->rhsLine == line)
+      endCol = (stmt->rhsCol > col) ? stmt->rhsCol : col;
+
+    if ((stmt->lhsLine == line) &&
+        (stmt->lhsCol >= col) &&
+        (stmt->lhsCol <= toCol) &&
+        (stmt->lhsCol <= endCol))
+    {
+//CDBG << "Covered " << line << ", " << stmt->lhsCol << "; " << coveredCount << ENDL;
+      ++coveredCount;
+      if (newCov && (attribs.get(line, stmt->lhsCol) & STMT_CODE))
+        ++newStmtCoveredCount;
     }
+
+    if (endCol > toCol)
+      break;
+
+    ++stmt;
+    col = endCol + 1;
   }
 }
 
@@ -2065,7 +3620,7 @@ void VampProcess::processStmt(void)
       {
         // Current statement on same line as last statement
         // Set attribute to move it to new line
-        attribs[curLocLine - 1][stmt->lhsCol - 1] |= STMT_NEW_STMT;
+        attribs.set(curLocLine, stmt->lhsCol, stmt->lhsCol, STMT_NEW_STMT);
 
         minColumn = stmt->lhsCol - 1;
       }
@@ -2079,7 +3634,7 @@ void VampProcess::processStmt(void)
         int tmpColumn = source[stmt->lhsLine - 1].rfind(' ', minColumn - 1);
         if ((minColumn - tmpColumn) < 10)
           minColumn = tmpColumn;
-        attribs[stmt->lhsLine - 1][minColumn] |= STMT_NEW_LINE;
+        attribs.set(stmt->lhsLine, minColumn + 1, minColumn + 1, STMT_NEW_LINE);
         //attribs[stmt->lhsLine - 1][minColumn - 1] |= STMT_NEW_LINE;
       }
 
@@ -2205,6 +3760,9 @@ CDBG << "COVERED: " << line << "," << col << " to " <<
 //CDBG << "Go till line " << instInfo[inst + 1].line << ENDL;
 //          while (line < instInfo[inst + 1].line)
 ////CDBG << "Go till line " << lastLine << ENDL;
+          bool newCov;
+          unsigned char attrib = stmtCoverAttrib(inst, doStmtCount, newCov);
+
           while (line < lastLine)
           {
             if (line >= attribs.size())
@@ -2213,69 +3771,14 @@ CDBG << "COVERED: " << line << "," << col << " to " <<
               throw(1);
             }
 
-            while (col <= attribs[line - 1].length())
-            {
-              bool newStmt = false;
-              if (attribs[line - 1][col - 1] & STMT_CODE)
-              {
-                attribs[line - 1][col - 1] |= STMT_COVERED;
-                if (db.combineHistory)
-                {
-                  if (doStmtCount)
-                  {
-                    // Check if old history covered
-                    if (oldHist.covCntInfo[inst])
-                      attribs[line - 1][col - 1] |= STMT_COVERED_OLD;
-
-                    // Check if new history covered
-                    if (newHist.covCntInfo[inst] != 0)
-                    {
-                      attribs[line - 1][col - 1] |= STMT_COVERED_NEW;
-                      // Flag if this is new coverage
-                      if (oldHist.covCntInfo[inst] == 0)
-                        newStmt = true;
-                    }
-                  }
-                  else
-// FIXME: Do we need to deal with doBranch here? Don't think so!
-                  if (doStmtSingle)
-                  {
-                    // Check if old history covered
-                    if (oldHist.coveredInfo[index] & mask)
-                      attribs[line - 1][col - 1] |= STMT_COVERED_OLD;
-
-                    // Check if new history covered
-                    if (newHist.coveredInfo[index] & mask)
-                    {
-                      attribs[line - 1][col - 1] |= STMT_COVERED_NEW;
-                      if (((oldHist.coveredInfo[index] &
-                           newHist.coveredInfo[index]) ^
-                           newHist.coveredInfo[index]) & mask)
-                        newStmt = true;
-                    }
-                  }
-                }
-              }
-
-              if ((line == stmt->lhsLine) && (col == stmt->lhsCol))
-              {
-                ++coveredCount;
-//CDBG << "Covered " << line << ", " << col << "; " << coveredCount << ENDL;
-                if (newStmt)
-                  ++newStmtCoveredCount;
-              }
-
-              ++col;
-              if ((line == stmt->rhsLine) && (col > stmt->rhsCol))
-              {
-                ++stmt;
-              }
-            }
+            setStmtCovered(line, col, attribs.length(line),
+                           attrib, newCov, stmt, coveredCount);
 
             ++line;
             col = 1;
-            if ((line > stmt->rhsLine) ||
-                ((line == stmt->rhsLine) && (col > stmt->rhsCol)))
+            if ((stmt < db.statementInfo.end()) &&
+                ((line > stmt->rhsLine) ||
+                 ((line == stmt->rhsLine) && (col > stmt->rhsCol))))
             {
               ++stmt;
             }
@@ -2287,65 +3790,10 @@ CDBG << "COVERED: " << line << "," << col << " to " <<
             throw(1);
           }
 
+          attrib = stmtCoverAttrib(inst, !doStmtSingle, newCov);
           //while (col < instInfo[inst + 1].col)
-          while (col < lastCol)
-          {
-            bool newStmt = false;
-            if (attribs[line - 1][col - 1] & STMT_CODE)
-            {
-              attribs[line - 1][col - 1] |= STMT_COVERED;
-              ////lineCovered = true;
-
-              if (db.combineHistory)
-              {
-                if (doStmtSingle)
-                {
-                  // Check if old history covered
-                  if (oldHist.coveredInfo[index] & mask)
-                    attribs[line - 1][col - 1] |= STMT_COVERED_OLD;
-
-                  // Check if new history covered
-                  if (newHist.coveredInfo[index] & mask)
-                  {
-                    attribs[line - 1][col - 1] |= STMT_COVERED_NEW;
-                    if (((oldHist.coveredInfo[index] &
-                         newHist.coveredInfo[index]) ^
-                         newHist.coveredInfo[index]) & mask)
-                      newStmt = true;
-                  }
-                }
-                else
-                {
-                  // Check if old history covered
-                  if (oldHist.covCntInfo[inst])
-                    attribs[line - 1][col - 1] |= STMT_COVERED_OLD;
-
-                  // Check if new history covered
-                  if (newHist.covCntInfo[inst] != 0)
-                  {
-                    attribs[line - 1][col - 1] |= STMT_COVERED_NEW;
-                    // Flag if this is new coverage
-                    if (oldHist.covCntInfo[inst] == 0)
-                      newStmt = true;
-                  }
-                }
-              }
-            }
-
-            if ((line == stmt->lhsLine) && (col == stmt->lhsCol))
-            {
-//CDBG << "Covered " << line << ", " << col << "; " << coveredCount << ENDL;
-              ++coveredCount;
-              if (newStmt)
-                ++newStmtCoveredCount;
-            }
-
-            ++col;
-            if ((line == stmt->rhsLine) && (col > stmt->rhsCol))
-            {
-              ++stmt;
-            }
-          }
+          setStmtCovered(line, col, lastCol - 1,
+                         attrib, newCov, stmt, coveredCount);
         }
       }
       else
@@ -2400,99 +3848,6 @@ string VampProcess::htmlPercentageStyle(string name, int percent)
   return style.str();
 }
 
-// Determine minimum number of additional independent MC/DC conditions
-// needed to complete MC/DC coverage
-int VampProcess::getMinCond(vector<mcdcPair> *mcdcPairs,
-                            int mcdcPairIndex,
-                            bitset<MAX_BITSET> &falseConditions,
-                            bitset<MAX_BITSET> &trueConditions)
-{
-  int minValue = 65535;
-  vector<mcdcPair>::iterator pair = mcdcPairs[mcdcPairIndex].begin();
-  bitset<MAX_BITSET> minFalse, minTrue;
-  bitset<MAX_BITSET> thisFalse, thisTrue;
-  unsigned int thisMin;
-
-  // Recursively walk through each possible independent pair and
-  // compute number of additional conditions needed for that pair.
-  // Determine which of the independent pairs require the fewest number.
-  while (pair < mcdcPairs[mcdcPairIndex].end())
-  {
-    // Determine if there are any pairs below this level.
-    // If so, add the next level's pair count.
-//FIXME - What is this line doing?
-    bool lastPair = (mcdcPairs[mcdcPairIndex + 1].size() == 0);
-    //bool lastPair = ((mcdcPairIndex + 1) >= mcdcPairs->size());
-
-    thisFalse = falseConditions;
-    thisTrue = trueConditions;
-
-    if (falseConditions.test(pair->f))
-    {
-      if (trueConditions.test(pair->t))
-      {
-        // Got both conditions already
-        if (lastPair)
-          thisMin = 0;
-        else
-          thisMin = getMinCond(mcdcPairs, mcdcPairIndex + 1,
-                               thisFalse, thisTrue);
-      }
-      else
-      {
-        // Add True condition of pair
-        thisTrue.set(pair->t);
-
-        if (lastPair)
-          thisMin = 1;
-        else
-          thisMin = 1 + getMinCond(mcdcPairs, mcdcPairIndex + 1,
-                                   thisFalse, thisTrue);
-      }
-    }
-    else
-    if (trueConditions.test(pair->t))
-    {
-      // Add False condition of pair
-      thisFalse.set(pair->f);
-
-      if (lastPair)
-        thisMin = 1;
-      else
-      {
-        thisMin = 1 + getMinCond(mcdcPairs, mcdcPairIndex + 1,
-                                 thisFalse, thisTrue);
-      }
-    }
-    else
-    {
-      // Add both False and True conditions of pair
-      thisFalse.set(pair->f);
-      thisTrue.set(pair->t);
-
-      if (lastPair)
-        thisMin = 2;
-      else
-        thisMin = 2 + getMinCond(mcdcPairs, mcdcPairIndex + 1,
-                                 thisFalse, thisTrue);
-    }
-
-    if (thisMin < minValue)
-    {
-      minValue = thisMin;
-      minFalse = thisFalse;
-      minTrue = thisTrue;
-    }
-
-    ++pair;
-  }
-
-  falseConditions = minFalse;
-  trueConditions = minTrue;
-  return minValue;
-}
-
-
 // Generate HTML for branch or condition coverage (e.g.  "Covered  Not Covered")
 // Return number of conditions covered (0-3).
 // Append HTML to funcHTML.
@@ -2565,6 +3920,12 @@ void VampProcess::processBranch(void)
   vector<switchInfoType>::iterator swIter = db.switchInfo.begin();
   vector<functionInfoType>::iterator func = db.functionInfo.begin();
   ostringstream branchFuncHTML;
+  ostringstream branchFuncData;   // Branch records for the report script
+  // Tables are only built for the HTML report
+  if (!buildHtml)
+    branchFuncHTML.setstate(ios::badbit);
+  if (!buildData)
+    branchFuncData.setstate(ios::badbit);
   int branchFuncCoverCnt = 0;
   int branchFuncOperandCnt = 0;
   int branchCnt = 0;
@@ -2625,6 +3986,12 @@ void VampProcess::processBranch(void)
     else
     if (br->statementType == "switch")
     {
+      if (swIter == db.switchInfo.end())
+      {
+        *vampErr << "Switch branch not found - aborting" << ENDL;
+        throw(1);
+      }
+
       s = swIter->switchExprLoc;
     }
     else
@@ -2638,7 +4005,8 @@ void VampProcess::processBranch(void)
     while (s.lhsLine > func->loc.rhsLine)
     {
       // Save branch info for current function
-      branchHTMLInfo.push_back(branchFuncHTML.str());
+      branchHTMLInfo.push_back(buildData ? branchFuncData.str() :
+                                           branchFuncHTML.str());
 
       // Save coverage statistics for computing percentages
       branchFunctionCoverageCount.push_back(branchFuncCoverCnt);
@@ -2654,6 +4022,7 @@ void VampProcess::processBranch(void)
       ++branchCnt;
 
       branchFuncHTML.str("");
+      branchFuncData.str("");
       func++;
       if (func >= db.functionInfo.end())
       {
@@ -2685,11 +4054,19 @@ CDBG << "Branch " << branchNum << " type " << br->statementType << " at " <<
       branchFuncHTML << "-" << s.rhsLine;
     branchFuncHTML << ":</font>" << ENDL;
     branchFuncHTML << "<br /><br />" << ENDL;
-    branchFuncHTML << "<font size=\"5\">" <<
-                      htmlSourceText(s, 0) <<
-                      "</font></b></center><br />" << ENDL;
+    if (buildHtml)
+      branchFuncHTML << "<font size=\"5\">" <<
+                        htmlSourceText(s, 0) <<
+                        "</font></b></center><br />" << ENDL;
     branchFuncHTML << "</td></tr>" << ENDL;
 
+    // Record is [line, lastLine, [expr], [coverage], [case, covered, ...]]
+    // with coverage [prev, curr, comb] when combining histories
+    if (buildData)
+      branchFuncData << ((branchFuncData.tellp() > 0) ? ",[" : "[") <<
+                        s.lhsLine << "," << s.rhsLine << "," <<
+                        jsSourceText(s) << ",[";
+
     if (br->statementType == "switch")
     {
       //branchFuncHTML << "<tr><td colspan=2 bgcolor=#a0a0ff>" << ENDL;
@@ -2704,7 +4081,7 @@ CDBG << "Branch " << branchNum << " type " << br->statementType << " at " <<
       // Determine longest case string
       int maxCaseLen = 0;
       for (c = swIter->caseInfo.begin();
-           c < swIter->caseInfo.end(); c++)
+           buildHtml && (c < swIter->caseInfo.end()); c++)
       {
         string str = sourceText(c->caseLoc);
         int len = str.length();
@@ -2712,6 +4089,7 @@ CDBG << "Branch " << branchNum << " type " << br->statementType << " at " <<
           maxCaseLen = len;
       }
 
+      branchFuncData << "],[";
       for (c = swIter->caseInfo.begin();
            c < swIter->caseInfo.end(); c++)
       {
@@ -2729,10 +4107,18 @@ CDBG << "Branch " << branchNum << " type " << br->statementType << " at " <<
           covered = false;
 */
 
-        string str = sourceText(c->caseLoc);
-        int spCnt = maxCaseLen - str.length() + 2;
-        str.insert(str.length(), spCnt, ' ');
-        branchFuncHTML << str;
+        if (buildHtml)
+        {
+          string str = sourceText(c->caseLoc);
+          int spCnt = maxCaseLen - str.length() + 2;
+          str.insert(str.length(), spCnt, ' ');
+          branchFuncHTML << str;
+        }
+
+        if (buildData)
+          branchFuncData << ((c > swIter->caseInfo.begin()) ? "," : "") <<
+                            jsString(sourceText(c->caseLoc)) << "," <<
+                            (covered ? 1 : 0);
 
         if (covered)
         {
@@ -2759,8 +4145,11 @@ CDBG << "Branch " << branchNum << " type " << br->statementType << " at " <<
         setAttrib(STMT_BR_COV_TRUE, s);
       }
 
+      branchFuncData << "]]";
       branchFuncOperandCnt += caseCnt;
       branchFuncCoverCnt += caseCoveredCnt;
+
+      swIter++;
     }
     else
     {
@@ -2797,6 +4186,8 @@ CDBG << "Branch value: " << ((oldHist.brInfo[branchNum / 8] >> (branchNum & 7))
           branchFuncHTML << "     Combined Runs      " << ENDL;
           branchFuncHTML << "   TRUE         FALSE   " << ENDL;
           branchFuncCoverCnt += genCoverageHTML(covered, true, s, branchFuncHTML);
+          branchFuncData << oldCovered << "," << newCovered << "," <<
+                            covered << "]]";
 
           // Determine number of newly covered branches
           int newCov = (oldCovered & newCovered) ^ newCovered;
@@ -2817,6 +4208,7 @@ CDBG << "Combined = " << covered << ", Current = " << newCovered << ", New = " <
 
           int covered = (hist.brInfo[branchNum / 8] >> (branchNum & 7)) & 3;
           branchFuncCoverCnt += genCoverageHTML(covered, true, s, branchFuncHTML);
+          branchFuncData << covered << "]]";
         }
 
         branchFuncHTML << ENDL;
@@ -2840,9 +4232,11 @@ CDBG << "Combined = " << covered << ", Current = " << newCovered << ", New = " <
   }
 
   // Save branch info for current function
-  branchHTMLInfo.push_back(branchFuncHTML.str());
+  branchHTMLInfo.push_back(buildData ? branchFuncData.str() :
+                                       branchFuncHTML.str());
 
   branchFuncHTML.str("");
+  branchFuncData.str("");
 
   // Save coverage statistics for computing percentages
   branchFunctionCoverageCount.push_back(branchFuncCoverCnt);
@@ -2871,10 +4265,16 @@ void VampProcess::processCondition(void)
   vector<condInfoType>::iterator cond;
   vector<functionInfoType>::iterator func = db.functionInfo.begin();
   ostringstream condFuncHTML;
+  ostringstream condFuncData;     // Condition records for the report script
   int condFuncCoverCnt = 0;
   int condFuncOperandCnt = 0;
   int condCnt = 0;
 
+  if (!buildHtml)
+    condFuncHTML.setstate(ios::badbit);
+  if (!buildData)
+    condFuncData.setstate(ios::badbit);
+
   for (cond = db.condInfo.begin(); cond < db.condInfo.end(); cond++)
   {
     sourceLocationType s;
@@ -2883,7 +4283,8 @@ void VampProcess::processCondition(void)
     while (cond->lhsLoc.lhsLine > func->loc.rhsLine)
     {
       // Save condition info for current function
-      condHTMLInfo.push_back(condFuncHTML.str());
+      condHTMLInfo.push_back(buildData ? condFuncData.str() :
+                                         condFuncHTML.str());
 
       // Save coverage statistics for computing percentages
       condFunctionCoverageCount.push_back(condFuncCoverCnt);
@@ -2899,6 +4300,7 @@ void VampProcess::processCondition(void)
       ++condCnt;
 
       condFuncHTML.str("");
+      condFuncData.str("");
       func++;
       if (func >= db.functionInfo.end())
       {
@@ -2940,12 +4342,24 @@ void VampProcess::processCondition(void)
                       "</font></b></center><br />" << ENDL;
 */
     condFuncHTML << "<font size=\"5\">";
-    condFuncHTML << "A = " << htmlSourceText(cond->lhsLoc, 0) << "<br />" << ENDL;
-    condFuncHTML << "B = " << htmlSourceText(cond->rhsLoc, 0) << "<br />" << ENDL;
+    if (buildHtml)
+    {
+      condFuncHTML << "A = " << htmlSourceText(cond->lhsLoc, 0) << "<br />" << ENDL;
+      condFuncHTML << "B = " << htmlSourceText(cond->rhsLoc, 0) << "<br />" << ENDL;
+    }
     condFuncHTML << "Boolean Condition: (A " << cond->condition << " B)" << ENDL;
     condFuncHTML << "</font></b></center><br />" << ENDL;
     condFuncHTML << "</td></tr>" << ENDL;
 
+    // Record is [line, lastLine, [A], [B], condition, [coverage]]
+    // with coverage [prev, curr, comb] when combining histories
+    if (buildData)
+      condFuncData << ((condFuncData.tellp() > 0) ? ",[" : "[") <<
+                      cond->lhsLoc.lhsLine << "," << cond->rhsLoc.rhsLine <<
+                      "," << jsSourceText(cond->lhsLoc) << "," <<
+                      jsSourceText(cond->rhsLoc) << "," <<
+                      jsString(cond->condition) << ",[";
+
     if ((cond->condNum / 8) < hist.condCount)
     {
       if (db.combineHistory)
@@ -2975,6 +4389,8 @@ void VampProcess::processCondition(void)
         condFuncHTML << "     Combined Runs      " << ENDL;
         condFuncHTML << "   TRUE         FALSE   " << ENDL;
         condFuncCoverCnt += genCoverageHTML(covered, false, s, condFuncHTML);
+        condFuncData << oldCovered << "," << newCovered << "," <<
+                        covered << "]]";
 
         // Determine number of newly covered conditions
         int newCov = (oldCovered & newCovered) ^ newCovered;
@@ -2995,6 +4411,7 @@ CDBG << "Combined = " << covered << ", Current = " << newCovered << ", New = " <
 
         int covered = (hist.condInfo[cond->condNum / 8] >> (cond->condNum & 7)) & 3;
         condFuncCoverCnt += genCoverageHTML(covered, false, s, condFuncHTML);
+        condFuncData << covered << "]]";
       }
 
       condFuncHTML << ENDL;
@@ -3016,9 +4433,11 @@ CDBG << "Combined = " << covered << ", Current = " << newCovered << ", New = " <
   }
 
   // Save condition info for current function
-  condHTMLInfo.push_back(condFuncHTML.str());
+  condHTMLInfo.push_back(buildData ? condFuncData.str() :
+                                     condFuncHTML.str());
 
   condFuncHTML.str("");
+  condFuncData.str("");
 
   // Save coverage statistics for computing percentages
   condFunctionCoverageCount.push_back(condFuncCoverCnt);
@@ -3049,11 +4468,17 @@ void VampProcess::processMCDC(void)
   vector<mcdcOpInfoType>::iterator op;
   int mcdcExprNum = 0;
   ostringstream mcdcFuncHTML;
+  ostringstream mcdcFuncData;     // Expression records for the report script
   vector<functionInfoType>::iterator func = db.functionInfo.begin();
   int mcdcFuncCoverCnt = 0;
   int mcdcFuncOperandCnt = 0;
   int mcdcCnt = 0;
 
+  if (!buildHtml)
+    mcdcFuncHTML.setstate(ios::badbit);
+  if (!buildData)
+    mcdcFuncData.setstate(ios::badbit);
+
   for (exp = db.mcdcExprInfo.begin();
        exp < db.mcdcExprInfo.end();
        exp++, mcdcExprNum++)
@@ -3065,7 +4490,8 @@ void VampProcess::processMCDC(void)
     while (firstOperand.lhsLoc.lhsLine > func->loc.rhsLine)
     {
       // Save MC/DC Info for current function
-      mcdcHTMLInfo.push_back(mcdcFuncHTML.str());
+      mcdcHTMLInfo.push_back(buildData ? mcdcFuncData.str() :
+                                         mcdcFuncHTML.str());
 
       // Save coverage statistics for computing percentages
       mcdcFunctionCoverageCount.push_back(mcdcFuncCoverCnt);
@@ -3082,6 +4508,7 @@ void VampProcess::processMCDC(void)
 
       //mcdcFuncHTML.clear();
       mcdcFuncHTML.str("");
+      mcdcFuncData.str("");
       func++;
       if (func >= db.functionInfo.end())
       {
@@ -3115,11 +4542,25 @@ void VampProcess::processMCDC(void)
     //mcdcFuncHTML << "<center><b><font size=\"5\">" <<
     //                sourceText(firstOperand.lhsLoc) <<
     //                ":</font></b></center>" << ENDL;
-    mcdcFuncHTML << "<font size=\"5\">" <<
-                    htmlSourceText(firstOperand.lhsLoc, 0) <<
-                    "</font></b></center><br />" << ENDL;
+    if (buildHtml)
+      mcdcFuncHTML << "<font size=\"5\">" <<
+                      htmlSourceText(firstOperand.lhsLoc, 0) <<
+                      "</font></b></center><br />" << ENDL;
     mcdcFuncHTML << "</td></tr>" << ENDL;
 
+    // Record is [line, lastLine, [expr], labels, [[condition], ...],
+    //            [falseVec, ...], falseCovered, [trueVec, ...], trueCovered,
+    //            [[pairCover, false, true, flags, ...], ...], newCoverage,
+    //            tests]
+    // covered strings hold '1' for each vector seen, flags are 1 false
+    // covered, 2 true covered, 4 false new, 8 true new, 16 pair new, and
+    // tests is 0 or [optimal, count, [false, ...], [true, ...]]
+    if (buildData)
+      mcdcFuncData << ((mcdcFuncData.tellp() > 0) ? ",[" : "[") <<
+                      firstOperand.lhsLoc.lhsLine << "," <<
+                      firstOperand.rhsLoc.rhsLine << "," <<
+                      jsSourceText(firstOperand.lhsLoc);
+
     int opCnt = 0;
     for (op = exp->opInfo.begin(); op < exp->opInfo.end(); op++)
     {
@@ -3141,8 +4582,8 @@ void VampProcess::processMCDC(void)
     {
       int leafCnt = 0;
 
-      // Label for each of up to 31 operands in expression
-      string opStr("ABCDEFGHIJKLMNOPQRSTUVWXYZabcde");
+      // Label for each of up to MCDC_MAX_OPERANDS operands in expression
+      string opStr(MCDC_OPERAND_LABELS);
       vector<sourceLocationType> mcdcNodeInfo;
 
       walkTree(leafCnt, exprTree.root, mcdcNodeInfo);
@@ -3189,10 +4630,10 @@ void VampProcess::processMCDC(void)
       mcdcFuncHTML << "<div style='text-align: left'><b><font size=\"5\"><pre>" << ENDL;
 
       vector<sourceLocationType>::iterator node = mcdcNodeInfo.begin();
-      for (int i = 0; node < mcdcNodeInfo.end(); ++i, ++node)
+      for (int i = 0; buildHtml && (node < mcdcNodeInfo.end()); ++i, ++node)
       {
-        vector<string> strings;
-        genHtmlSourceText(*node, 0, strings);
+        vector<SourceSlice> strings;
+        genHtmlSourceText(*node, strings);
         mcdcFuncHTML << opStr[i] << " = " << strings[0] << ENDL;
         for (int j = 1; j < strings.size(); j++)
         {
@@ -3214,6 +4655,28 @@ void VampProcess::processMCDC(void)
 
       int operandCnt = falseStr.front().length();
 
+      // Keep operand coverage for the machine-readable exports
+      mcdcExportType mcdcExp;
+      mcdcExp.line = firstOperand.lhsLoc.lhsLine;
+      mcdcExp.operands = opStr.substr(0, operandCnt);
+      mcdcExport.push_back(mcdcExp);
+
+      // Pack condition vectors for integer matching of observed results
+      mcdcVectorTable falseVec;
+      mcdcVectorTable trueVec;
+      packVectors(falseStr, falseVec);
+      packVectors(trueStr, trueVec);
+
+      // Mask of bits used by operands of an observed result
+      mcdcVecType opMask = (operandCnt < 8 * sizeof(mcdcVecType)) ?
+                           ((mcdcVecType) 1 << operandCnt) - 1 :
+                           ~(mcdcVecType) 0;
+
+      // Narrow expressions resolve each observation with a table lookup
+      vector<int> matchLookup;
+      if (operandCnt <= MCDC_LOOKUP_OPERANDS)
+        buildMatchLookup(falseVec, trueVec, operandCnt, matchLookup);
+
       // Process history and find matches for each MCDC expression
 /*
       unsigned int gotFalse = 0;    // Mask for False results covered
@@ -3223,15 +4686,16 @@ void VampProcess::processMCDC(void)
       unsigned int gotNewFalse = 0; // Mask for new False results covered
       unsigned int gotNewTrue = 0;  // Mask for new True results covered
 */
-      bitset<MAX_BITSET> gotFalse;    // Mask for False results covered
-      bitset<MAX_BITSET> gotTrue;     // Mask for True results covered
-      bitset<MAX_BITSET> gotOldFalse; // Mask for old False results covered
-      bitset<MAX_BITSET> gotOldTrue;  // Mask for old True results covered
-      bitset<MAX_BITSET> gotNewFalse; // Mask for new False results covered
-      bitset<MAX_BITSET> gotNewTrue;  // Mask for new True results covered
+      // Sets are sized to the number of False and True conditions
+      mcdcBitset gotFalse(falseStr.size());    // False results covered
+      mcdcBitset gotTrue(trueStr.size());      // True results covered
+      mcdcBitset gotOldFalse(falseStr.size()); // Old False results covered
+      mcdcBitset gotOldTrue(trueStr.size());   // Old True results covered
+      mcdcBitset gotNewFalse(falseStr.size()); // New False results covered
+      mcdcBitset gotNewTrue(trueStr.size());   // New True results covered
 
       // Compute number of bytes used to store MCDC expression results:
-      // 1 = 1-7, 2 = 8-15, 4 = 15-31
+      // 1 = 1-7, 2 = 8-15, 4 = 16-31, 8 = 32-63
       int byteCnt;
       if (operandCnt < 8)
         byteCnt = 1;
@@ -3239,7 +4703,10 @@ void VampProcess::processMCDC(void)
       if (operandCnt < 16)
         byteCnt = 2;
       else
+      if (operandCnt < 32)
         byteCnt = 4;
+      else
+        byteCnt = 8;
 
       mcdcByteCnt.push_back(byteCnt);
       int mcdcCombCnt = byteCnt * (falseStr.size() + trueStr.size());
@@ -3346,48 +4813,47 @@ CDBG << "Adding mcdcInfo[" << k << "] = " << v << ENDL;
               gotOldFalse = gotFalse;
             }
 
-            unsigned int mcdcVal = hist.mcdcInfo[expr] >> 1;
+            // Use top 7 bits of mcdcInfo[expr], followed by 8 bits
+            // of following mcdcInfo bytes
+            mcdcVecType mcdcVal = hist.mcdcInfo[expr] >> 1;
+            for (int j = 1; j < byteCnt; j++)
+              mcdcVal |= (mcdcVecType) hist.mcdcInfo[expr + j] << (8 * j - 1);
+            mcdcVal &= opMask;
     #ifdef VAMP_DEBUG_MCDC
             char v[256];
-            for (int j = 0; j < mcdcByteCnt[mcdcExprNum]; j++)
+            for (int j = 0; j < byteCnt; j++)
             {
               sprintf(v, "%#x\n", hist.mcdcInfo[expr + j]);
                 CDBG << "mcdcVal[" << j << "] = " << v;
             }
+            sprintf(v, "%#llx", mcdcVal);
     #endif
-            // Use top 7 bits of mcdcInfo[expr], followed by 8 bits
-            // of following mcdcInfo bytes
-            int whichByte = 0;
-            int whichBit = 7;
-
-    /*
-            if (mcdcByteCnt[mcdcExprNum] == 2)
-              mcdcVal |= hist.mcdcInfo[expr + 1];
-    */
-            string mcdcStr;
-            for (int cnt = 0; cnt < operandCnt; cnt++)
+
+            int which;
+            int whichTrue;
+            if (matchLookup.size())
             {
-              mcdcStr += (char) ('0' | (mcdcVal & 1));
-              if (--whichBit)
+              which = matchLookup[mcdcVal];
+              if (which >= (int) falseStr.size())
               {
-                mcdcVal >>= 1;
+                whichTrue = which - falseStr.size();
+                which = -1;
               }
               else
               {
-                whichBit = 8;
-                ++whichByte;
-                mcdcVal = hist.mcdcInfo[expr + whichByte];
+                whichTrue = -1;
               }
             }
+            else
+            {
+              which = checkMatch(mcdcVal, falseVec);
+              whichTrue = (which == -1) ? checkMatch(mcdcVal, trueVec) : -1;
+            }
 
-            int which = checkMatch(mcdcStr, falseStr);
             if (which != -1)
             {
     #ifdef VAMP_DEBUG_MCDC
-              CDBG << mcdcStr << " matches FALSE " << falseStr[which] << ENDL;
-    //FIXME - which can be > MAX_BITSET!
-    if (which > MAX_BITSET)
-    CDBG << "False too big: " << which << ", size = " << falseStr.size() << ENDL;
+              CDBG << v << " matches FALSE " << falseStr[which] << ENDL;
     #endif
               gotFalse.set(which);
               if (db.combineHistory && (expr >= newOffset))
@@ -3397,30 +4863,24 @@ CDBG << "Adding mcdcInfo[" << k << "] = " << v << ENDL;
               }
             }
             else
+            if (whichTrue != -1)
             {
-              which = checkMatch(mcdcStr, trueStr);
-              if (which != -1)
-              {
     #ifdef VAMP_DEBUG_MCDC
-                CDBG << mcdcStr << " matches TRUE  " << trueStr[which] << ENDL;
-    //FIXME - which can be > MAX_BITSET!
-    if (which > MAX_BITSET)
-    CDBG << "True too big: " << which << ENDL;
+              CDBG << v << " matches TRUE  " << trueStr[whichTrue] << ENDL;
     #endif
-                gotTrue.set(which);
-                if (db.combineHistory && (expr >= newOffset))
-                {
-                  // Save results for expressions covered in current run
-                  gotNewTrue.set(which);
-                }
-              }
-    #ifdef VAMP_DEBUG_MCDC
-              else
+              gotTrue.set(whichTrue);
+              if (db.combineHistory && (expr >= newOffset))
               {
-                CDBG << mcdcStr << " - no matches found!" << ENDL;
+                // Save results for expressions covered in current run
+                gotNewTrue.set(whichTrue);
               }
-    #endif
             }
+    #ifdef VAMP_DEBUG_MCDC
+            else
+            {
+              CDBG << v << " - no matches found!" << ENDL;
+            }
+    #endif
           }
       }
 
@@ -3430,17 +4890,21 @@ CDBG << "Adding mcdcInfo[" << k << "] = " << v << ENDL;
 
       // Count number of times a false/true element is used
       // as part of an independent pair
-      int falseCount[MAX_BITSET] = { 0 };
-      int trueCount[MAX_BITSET] = { 0 };
+      vector<int> falseCount(falseStr.size(), 0);
+      vector<int> trueCount(trueStr.size(), 0);
 
       // Find independant pairs for each operand
       vector<string> indPairs;
       vector<int> indPairCount;
-      vector<mcdcPair> mcdcPairs[32];
+      vector<mcdcPair> mcdcPairs[MCDC_MAX_OPERANDS];
       int mcdcCoverCnt = 0;  // Used for computing percentage covered
 
       char fStr[64], tStr[64], ch;
       // Determine maximum string length for a pair
+      ostringstream pairData;     // Pairs of each operand for report script
+      if (!buildData)
+        pairData.setstate(ios::badbit);
+
       int sz = falseStr.size();
       sprintf(fStr, "F%d:", sz);
       sz = trueStr.size();
@@ -3452,16 +4916,21 @@ CDBG << "Adding mcdcInfo[" << k << "] = " << v << ENDL;
 
       vector<string>::iterator n;
       bool gotNew = false;
-      int opTypes[31][4] = { 0 };
 
       for (int i = 0; i < operandCnt; i++)
       {
         int whichFalse = 0;
         int curCol = 0;
         int cnt = 0;
+        int senses = 0;   // Halves of best pair seen: 1 FALSE, 2 TRUE
         int newCnt = 0;
         int pairCount = 0;
         ostringstream indPair;
+        ostringstream opPairs;
+        if (!buildHtml)
+          indPair.setstate(ios::badbit);
+        if (!buildData)
+          opPairs.setstate(ios::badbit);
         //indPair << opStr.substr(i, 1) << ": ";
 
 #ifdef VAMP_DEBUG_MCDC
@@ -3470,17 +4939,18 @@ CDBG << "MCDC falseStr[0] = " << falseStr[0] << ENDL;
         // Search each False half of pair for match to True side
         for (n = falseStr.begin(); n < falseStr.end(); whichFalse++, n++)
         {
-          char ch = n->c_str()[i];
-          if (ch != '-')
+          mcdcVecType opBit = (mcdcVecType) 1 << i;
+          if (falseVec.mask[whichFalse] & opBit)
           {
-            string testStr(*n);
-            // Convert '0' to '1' or '1' to '0'
-            testStr.replace(i, 1, 1, ch ^ 1);
 #ifdef VAMP_DEBUG_MCDC
             CDBG << "Testing " << opStr.substr(i, 1) << ": " <<
-                    *n << " with " << testStr << ENDL;
+                    *n << " with operand flipped" << ENDL;
 #endif
-            int whichTrue = checkMatch(testStr, trueStr, true);
+            // Flip operand i and look for a True vector that matches,
+            // treating don't cares on either side as wild cards
+            int whichTrue = checkMatch(falseVec.value[whichFalse] ^ opBit,
+                                       falseVec.mask[whichFalse],
+                                       trueVec);
             if (whichTrue != -1)
             {
               // Got match - build pair
@@ -3493,9 +4963,6 @@ CDBG << "MCDC falseStr[0] = " << falseStr[0] << ENDL;
               mcdcPair pair = { whichFalse, whichTrue };
               mcdcPairs[i].push_back(pair);
 #ifdef VAMP_DEBUG_MCDC
-// FIXME: whichFalse or which can be > MAX_BITSET
-if ((whichFalse > MAX_BITSET) || (whichTrue > MAX_BITSET))
-CDBG << "Too big: " << whichFalse << ":" << whichTrue << ENDL;
               CDBG << "Got pair #" << pairCount << ": " << whichFalse << ", " << whichTrue << ENDL;
 #endif
 #ifdef USE_TEXT
@@ -3564,7 +5031,7 @@ CDBG << "Too big: " << whichFalse << ":" << whichTrue << ENDL;
                 indPair << htmlBgColor(BG_GREEN) << fStr << ':' <<
                            tStr << "</span>";
                 cnt = 2;
-                ++opTypes[i][3];
+                senses = 3;
               }
               else
               if (f)
@@ -3574,8 +5041,8 @@ CDBG << "Too big: " << whichFalse << ":" << whichTrue << ENDL;
                 if (!cnt)
                 {
                   cnt = 1;
+                  senses = 1;
                 }
-                ++opTypes[i][2];
               }
               else
               if (t)
@@ -3585,14 +5052,13 @@ CDBG << "Too big: " << whichFalse << ":" << whichTrue << ENDL;
                 if (!cnt)
                 {
                   cnt = 1;
+                  senses = 2;
                 }
-                ++opTypes[i][1];
               }
               else
               {
                 indPair << htmlBgColor(BG_RED) << fStr << ':' <<
                            tStr << "</span>";
-                ++opTypes[i][0];
               }
 
               if (db.combineHistory && newCnt)
@@ -3601,6 +5067,11 @@ CDBG << "Too big: " << whichFalse << ":" << whichTrue << ENDL;
                 ++total;
               }
 
+              opPairs << "," << (whichFalse + 1) << "," << (whichTrue + 1) <<
+                         "," << ((f ? 1 : 0) | (t ? 2 : 0) | (newF ? 4 : 0) |
+                                 (newT ? 8 : 0) |
+                                 ((db.combineHistory && newCnt) ? 16 : 0));
+
               // Pad the string so that pairs align vertically (e.g.)
               // F1:T1    F1:T13   F1:T14
               // F12:T37  F12:T38  F12:T39
@@ -3645,7 +5116,10 @@ CDBG << "Too big: " << whichFalse << ":" << whichTrue << ENDL;
 // FIXME: indPairCount and pairCount not used!
         indPairCount.push_back(pairCount);
 
+        pairData << (i ? ",[" : "[") << cnt << opPairs.str() << "]";
+
         mcdcCoverCnt += cnt;
+        mcdcExport.back().senses.push_back(senses);
         mcdcNewCoverCount += newCnt;
         if (newCnt)
           gotNew = true;
@@ -3654,6 +5128,27 @@ CDBG << "Too big: " << whichFalse << ":" << whichTrue << ENDL;
       CDBG << "Generating MCDC Function results" << ENDL;
 #endif
 
+      if (buildData)
+      {
+        mcdcFuncData << "," << jsString(opStr.substr(0, operandCnt)) << ",[";
+        for (int i = 0; i < mcdcNodeInfo.size(); i++)
+          mcdcFuncData << (i ? "," : "") << jsSourceText(mcdcNodeInfo[i]);
+        mcdcFuncData << "],[";
+        for (int i = 0; i < falseStr.size(); i++)
+          mcdcFuncData << (i ? "," : "") << jsString(falseStr[i]);
+        mcdcFuncData << "],\"";
+        for (int i = 0; i < falseStr.size(); i++)
+          mcdcFuncData << (gotFalse.test(i) ? '1' : '0');
+        mcdcFuncData << "\",[";
+        for (int i = 0; i < trueStr.size(); i++)
+          mcdcFuncData << (i ? "," : "") << jsString(trueStr[i]);
+        mcdcFuncData << "],\"";
+        for (int i = 0; i < trueStr.size(); i++)
+          mcdcFuncData << (gotTrue.test(i) ? '1' : '0');
+        mcdcFuncData << "\",[" << pairData.str() << "]," <<
+                        ((db.combineHistory && gotNew) ? 1 : 0);
+      }
+
       // Display results
       mcdcFuncHTML << "<tr><td colspan=2 bgcolor=#a0a0ff>" << ENDL;
       mcdcFuncHTML << "<center><b><font size=\"5\"><pre>" << ENDL;
@@ -3780,234 +5275,37 @@ CDBG << "Too big: " << whichFalse << ":" << whichTrue << ENDL;
                       ")</font></div></div> </td>" << ENDL;
 */
 
-      // FIXME: Count number of times each failed F# and T# are used as
-      //        members of independent pairs. Then determine which
-      //        are the fewest members needed to reach coverage.
-
 /*
       unsigned int testFalse = gotFalse;
       unsigned int testTrue = gotTrue;
 */
-      bitset<MAX_BITSET> testFalse = gotFalse;
-      bitset<MAX_BITSET> testTrue = gotTrue;
+      mcdcBitset testFalse = gotFalse;
+      mcdcBitset testTrue = gotTrue;
 #ifdef VAMP_DEBUG_MCDC
       CDBG << "Computing minimum number of test cases" << ENDL;
 #endif
-      int minOps;
-
-      if (falseStr.size() * trueStr.size() < 200)
-      {
-        minOps = getMinCond(mcdcPairs, 0, testFalse, testTrue);
-      }
-      else
+      // Search is bounded; if the budget runs out the best answer found
+      // so far is reported as an upper bound rather than the minimum
+      mcdcSolver solver(db.mcdcSolverNodeLimit, db.mcdcSolverTimeLimit);
+      int minOps = 0;
+      if (db.showTestCases)
       {
-        // Create a curtailed version of mcdcPairs to use for determining
-        // minimum number of tests needed to complete MC/DC coverage.
-        // Give priority to partially completed pairs with a high "hit count"
-        // for the incomplete half of the pair.  The term "hit count" implies
-        // the term is used to complete other MC/DC pairs.
-
-        vector<mcdcPair> minMcdcPairs[32];
-        for (int i = 0; i < operandCnt; i++)
-        {
-          int minFalseOnly;  // Minimum # pairs to use with only False covered
-          int minTrueOnly;   // Minimum # pairs to use with only True covered
-          int minNeither;    // Minimum # pairs to use with neither covered
-
-          // FIXME: Create some heuristic to determine reasonable number of
-          // pairs to add based on operandCnt.  Fewer operands mean more pairs
-          // are reasonable to use.
-          minFalseOnly = 32 / operandCnt;
-          minTrueOnly = 32 / operandCnt;
-          minNeither = 0;
-
-          if (opTypes[i][3])
-          {
-            // Already covered - nothing more to add
-            // FIXME: Determine if we need to add one example
-            bool done = false;
-            vector<mcdcPair>::iterator pair = mcdcPairs[i].begin();
-            while (!done && (pair < mcdcPairs[i].end()))
-            {
-              if (gotFalse.test(pair->f) && gotTrue.test(pair->t))
-              {
-                minMcdcPairs[i].push_back(*pair);
-                done = true;
-              }
-
-              ++pair;
-            }
-          }
-          else
-          {
-            // Are there fewer False only covered pairs than requested?
-            if (minFalseOnly > opTypes[i][2])
-            {
-              // Yes - give remainder to minTrueOnly
-              minTrueOnly += minFalseOnly - opTypes[i][2];
-              minFalseOnly = opTypes[i][2];
-            }
-
-            // Are there fewer True only covered pairs than requested?
-            if (minTrueOnly > opTypes[i][1])
-            {
-              // Yes - give remainder to minTrueOnly
-              minNeither += minTrueOnly - opTypes[i][1];
-              minTrueOnly = opTypes[i][1];
-            }
-
-            // Are there fewer non-covered pairs than requested?
-            if (minNeither > opTypes[i][0])
-            {
-              // Yes - reduce to how many are available
-              minNeither = opTypes[i][0];
-            }
-
-            vector<indexPairType> trueIndex;
-            vector<indexPairType> falseIndex;
-            vector<indexPairType> neitherIndex;
-            indexPairType indexPair;
-
-            vector<mcdcPair>::iterator pair = mcdcPairs[i].begin();
-            for (int index = 0; pair < mcdcPairs[i].end(); ++pair, ++index)
-            {
-              if (gotFalse.test(pair->f))
-              {
-                if (!gotTrue.test(pair->t))
-                {
-                  // Prioritize pairs with highest True usage counts
-                  indexPair.usageCount = trueCount[pair->t];
-                  indexPair.index = index;
-                  falseIndex.push_back(indexPair);
-                }
-              }
-              else
-              if (gotTrue.test(pair->t))
-              {
-                // Prioritize pairs with highest False usage counts
-                indexPair.usageCount = falseCount[pair->f];
-                indexPair.index = index;
-                trueIndex.push_back(indexPair);
-              }
-              else
-              {
-                // Prioritize pairs with highest combined usage counts
-                indexPair.usageCount = falseCount[pair->f] + trueCount[pair->t];
-                indexPair.index = index;
-                neitherIndex.push_back(indexPair);
-              }
-            }
-
-            // FIXME: sort each index vector based on usage count
-#ifdef USE_IND_PAIR_CLASS
-            sort(falseIndex.begin(), falseIndex.end());
-#else
-            sort(falseIndex.begin(), falseIndex.end(), indexPairCompare());
-/*
-            // Seems like this would be more efficient than sort,
-            // but we get different results.
-            partial_sort(falseIndex.begin(),
-                         falseIndex.begin() + minFalseOnly,
-                         falseIndex.end(),
-                         indexPairCompare());
-*/
-#endif
-
-#ifdef VAMP_DEBUG_MCDC
-vector<indexPairType>::iterator fpair = falseIndex.begin();
-CDBG << "False pairs[" << i << "]:" << ENDL;
-while (fpair < falseIndex.end())
-{
-  CDBG << "F" << mcdcPairs[i][fpair->index].f+1 << ":T" << mcdcPairs[i][fpair->index].t+1 << ", usage count = " << fpair->usageCount << ENDL;
-  ++fpair;
-}
-#endif
-            // Now add top prioritized pairs
-            for (int j = 0; j < minFalseOnly; j++)
-            {
-               minMcdcPairs[i].push_back(mcdcPairs[i][falseIndex[j].index]);
-#ifdef VAMP_DEBUG_MCDC
-               CDBG << "Adding False Only pair[" << i << "] F" <<
-                       mcdcPairs[i][falseIndex[j].index].f+1 << ":T" <<
-                       mcdcPairs[i][falseIndex[j].index].t+1 << ENDL;
-#endif
-            }
-
-#ifdef USE_IND_PAIR_CLASS
-            sort(trueIndex.begin(), trueIndex.end());
-#else
-            sort(trueIndex.begin(), trueIndex.end(), indexPairCompare());
-/*
-            partial_sort(trueIndex.begin(),
-                         trueIndex.begin() + minTrueOnly,
-                         trueIndex.end(),
-                         indexPairCompare());
-*/
-#endif
-/*
-vector<indexPairType>::iterator tpair = trueIndex.begin();
-CDBG << "True pairs[" << i << "]:" << ENDL;
-while (tpair < trueIndex.end())
-{
-  CDBG << "F" << mcdcPairs[i][tpair->index].f+1 << ":T" << mcdcPairs[i][tpair->index].t+1 << ", usage count = " << tpair->usageCount << ENDL;
-  ++tpair;
-}
-*/
-            for (int j = 0; j < minTrueOnly; j++)
-            {
-               minMcdcPairs[i].push_back(mcdcPairs[i][trueIndex[j].index]);
-#ifdef VAMP_DEBUG_MCDC
-               CDBG << "Adding True Only pair[" << i << "] F" <<
-                       mcdcPairs[i][trueIndex[j].index].f+1 << ":T" <<
-                       mcdcPairs[i][trueIndex[j].index].t+1 << ENDL;
-#endif
-            }
-
-#ifdef USE_IND_PAIR_CLASS
-            sort(neitherIndex.begin(), neitherIndex.end());
-#else
-            sort(neitherIndex.begin(), neitherIndex.end(), indexPairCompare());
-/*
-            partial_sort(neitherIndex.begin(),
-                         neitherIndex.begin() + minNeither,
-                         neitherIndex.end(),
-                         indexPairCompare());
-*/
-#endif
-/*
-//vector<indexPairType>::iterator npair = neitherIndex.begin();
-npair = neitherIndex.begin();
-CDBG << "Neither pairs[" << i << "]:" << ENDL;
-while (npair < neitherIndex.end())
-{
-  CDBG << "F" << mcdcPairs[i][npair->index].f+1 << ":T" << mcdcPairs[i][npair->index].t+1 << ", usage count = " << npair->usageCount << ENDL;
-  ++npair;
-}
-*/
-            for (int j = 0; j < minNeither; j++)
-            {
-               minMcdcPairs[i].push_back(mcdcPairs[i][neitherIndex[j].index]);
-#ifdef VAMP_DEBUG_MCDC
-               CDBG << "Adding False Only pair[" << i << "] F" <<
-                       mcdcPairs[i][neitherIndex[j].index].f+1 << ":T" <<
-                       mcdcPairs[i][neitherIndex[j].index].t+1 << ENDL;
-#endif
-            }
-          }
-        }
-
-        minOps = getMinCond(minMcdcPairs, 0, testFalse, testTrue);
+        minOps = solver.solve(mcdcPairs, operandCnt,
+                              falseCount, trueCount,
+                              testFalse, testTrue);
       }
 
 #ifdef VAMP_DEBUG_MCDC
-      CDBG << "Min pair count = " << minOps << ENDL;
+      CDBG << "Min pair count = " << minOps <<
+              (solver.isOptimal() ? " (optimal)" : " (bound)") <<
+              " after " << solver.getNodeCount() << " nodes" << ENDL;
 #endif
 /*
       unsigned int newFalse = gotFalse ^ testFalse;
       unsigned int newTrue = gotTrue ^ testTrue;
 */
-      bitset<MAX_BITSET> newFalse = gotFalse ^ testFalse;
-      bitset<MAX_BITSET> newTrue = gotTrue ^ testTrue;
+      mcdcBitset newFalse = gotFalse ^ testFalse;
+      mcdcBitset newTrue = gotTrue ^ testTrue;
       if (db.showTestCases && minOps)
       {
         int cnt = 1;
@@ -4015,6 +5313,12 @@ while (npair < neitherIndex.end())
         mcdcFuncHTML << "<tr><td colspan=2 bgcolor=#a0a0ff>" << ENDL;
         mcdcFuncHTML << "<center><b><font size=\"5\"><pre>" << ENDL;
         mcdcFuncHTML << "Recommended Additional Test Cases" << ENDL;
+        if (!solver.isOptimal())
+        {
+          mcdcFuncHTML << "<font size=\"3\">(Search limit reached - " <<
+                          minOps << " cases may not be the minimum)</font>" <<
+                          ENDL;
+        }
         mcdcFuncHTML << "</font></b></center>" << ENDL;
         mcdcFuncHTML << "</td></tr>" << ENDL;
 
@@ -4023,7 +5327,7 @@ while (npair < neitherIndex.end())
 
         if (newFalse.any())
         {
-          for (i = 0; i < MAX_BITSET; i++)
+          for (i = 0; i < newFalse.size(); i++)
           {
             if (newFalse.test(i))
             {
@@ -4037,20 +5341,20 @@ while (npair < neitherIndex.end())
               {
                 if (falseStr[i][j] == '0')
                 {
-                  vector<string> strings;
-                  genHtmlSourceText(mcdcNodeInfo[j], 10, strings);
+                  vector<SourceSlice> strings;
+                  genHtmlSourceText(mcdcNodeInfo[j], strings);
                   mcdcFuncHTML << "   False  " << strings[0] << ENDL;
                   for (int k = 1; k < strings.size(); k++)
-                    mcdcFuncHTML << strings[k] << ENDL;
+                    mcdcFuncHTML << "          " << strings[k] << ENDL;
                 }
                 else
                 if (falseStr[i][j] == '1')
                 {
-                  vector<string> strings;
-                  genHtmlSourceText(mcdcNodeInfo[j], 10, strings);
+                  vector<SourceSlice> strings;
+                  genHtmlSourceText(mcdcNodeInfo[j], strings);
                   mcdcFuncHTML << "   True   " << strings[0] << ENDL;
                   for (int k = 1; k < strings.size(); k++)
-                    mcdcFuncHTML << strings[k] << ENDL;
+                    mcdcFuncHTML << "          " << strings[k] << ENDL;
                 }
               }
 
@@ -4064,7 +5368,7 @@ while (npair < neitherIndex.end())
 
         if (newTrue.any())
         {
-          for (i = 0; i < MAX_BITSET; i++)
+          for (i = 0; i < newTrue.size(); i++)
           {
             if (newTrue.test(i))
             {
@@ -4078,20 +5382,20 @@ while (npair < neitherIndex.end())
               {
                 if (trueStr[i][j] == '0')
                 {
-                  vector<string> strings;
-                  genHtmlSourceText(mcdcNodeInfo[j], 10, strings);
+                  vector<SourceSlice> strings;
+                  genHtmlSourceText(mcdcNodeInfo[j], strings);
                   mcdcFuncHTML << "   False  " << strings[0] << ENDL;
                   for (int k = 1; k < strings.size(); k++)
-                    mcdcFuncHTML << strings[k] << ENDL;
+                    mcdcFuncHTML << "          " << strings[k] << ENDL;
                 }
                 else
                 if (trueStr[i][j] == '1')
                 {
-                  vector<string> strings;
-                  genHtmlSourceText(mcdcNodeInfo[j], 10, strings);
+                  vector<SourceSlice> strings;
+                  genHtmlSourceText(mcdcNodeInfo[j], strings);
                   mcdcFuncHTML << "   True   " << strings[0] << ENDL;
                   for (int k = 1; k < strings.size(); k++)
-                    mcdcFuncHTML << strings[k] << ENDL;
+                    mcdcFuncHTML << "          " << strings[k] << ENDL;
                 }
               }
 
@@ -4103,11 +5407,33 @@ while (npair < neitherIndex.end())
         mcdcFuncHTML << "</pre></b></font></td></tr>" << ENDL;
       }
 
+      if (buildData && db.showTestCases && minOps)
+      {
+        mcdcFuncData << ",[" << (solver.isOptimal() ? 1 : 0) << "," <<
+                        minOps << ",[";
+        int cnt = 0;
+        for (i = 0; i < newFalse.size(); i++)
+        {
+          if (newFalse.test(i))
+            mcdcFuncData << (cnt++ ? "," : "") << (i + 1);
+        }
+        mcdcFuncData << "],[";
+        cnt = 0;
+        for (i = 0; i < newTrue.size(); i++)
+        {
+          if (newTrue.test(i))
+            mcdcFuncData << (cnt++ ? "," : "") << (i + 1);
+        }
+        mcdcFuncData << "]]";
+      }
+      else
+        mcdcFuncData << ",0";
 
       exprTree.destroyTree();
     }
 
     mcdcFuncHTML << "</table>" << ENDL;
+    mcdcFuncData << "]";
 
     mcdcFuncHTML << ENDL;
   }
@@ -4119,9 +5445,11 @@ while (npair < neitherIndex.end())
   mcdcTotalOperandCount += mcdcFuncOperandCnt;
 
   // Save MC/DC Info for current function
-  mcdcHTMLInfo.push_back(mcdcFuncHTML.str());
+  mcdcHTMLInfo.push_back(buildData ? mcdcFuncData.str() :
+                                     mcdcFuncHTML.str());
 
   mcdcFuncHTML.str("");
+  mcdcFuncData.str("");
 
   // Increment count of # MC/DC functions calculated
   ++mcdcCnt;
@@ -4138,17 +5466,411 @@ while (npair < neitherIndex.end())
   }
 }
 
-void VampProcess::genHTML(string htmlName)
+// Save HTML for next function
+void HtmlSpool::push_back(const string &funcHTML)
+{
+  if (!enabled)
+    return;
+
+  if (file && (fwrite(funcHTML.data(), 1, funcHTML.size(), file) == funcHTML.size()))
+  {
+    sizes.push_back(funcHTML.size());
+  }
+  else
+  {
+    // No spool file (or write failed) - hold in memory from here on
+    if (file)
+    {
+      fseek(file, 0, SEEK_SET);
+      for (size_t i = 0; i < sizes.size(); i++)
+      {
+        string prev(sizes[i], 0);
+        if (sizes[i])
+          fread(&prev[0], 1, sizes[i], file);
+        html.push_back(prev);
+      }
+      fclose(file);
+      file = NULL;
+      sizes.clear();
+    }
+    html.push_back(funcHTML);
+  }
+}
+
+// Prepare to read back saved HTML from the first function
+void HtmlSpool::rewind(void)
+{
+  if (file)
+  {
+    fflush(file);
+    fseek(file, 0, SEEK_SET);
+  }
+  readIndex = 0;
+}
+
+// Copy HTML for next function to out
+void HtmlSpool::copyNext(ostream &out)
+{
+  if (!file)
+  {
+    if (readIndex < html.size())
+    {
+      out << html[readIndex];
+      html[readIndex].clear();
+    }
+  }
+  else
+  if (readIndex < sizes.size())
+  {
+    char buf[65536];
+    size_t remain = sizes[readIndex];
+
+    while (remain)
+    {
+      size_t cnt = fread(buf, 1, (remain < sizeof(buf)) ? remain : sizeof(buf), file);
+      if (cnt == 0)
+        break;
+      out.write(buf, cnt);
+      remain -= cnt;
+    }
+  }
+  ++readIndex;
+}
+
+// Index of background color in report style sheet (0 for none)
+static int htmlColorCode(int color)
+{
+  switch (color)
+  {
+    case BG_GREEN:
+      return 1;
+    case BG_RED:
+      return 2;
+    case BG_YELLOW:
+      return 3;
+    case BG_ORANGE:
+      return 4;
+    default:
+      return 0;
+  }
+}
+
+// Add source text shown in bgColor, joining it to the previous run
+// if the color is unchanged
+void CompactRow::add(int bgColor, const SourceSlice &slice)
+{
+  if (bgColor != color)
+  {
+    flush();
+    color = bgColor;
+  }
+
+  text.append(slice.data(), slice.length());
+}
+
+void CompactRow::flush(void)
+{
+  if (color >= 0)
+  {
+    if (count++)
+      runs << ",";
+    runs << htmlColorCode(color) << "," << jsString(text);
+  }
+
+  color = -1;
+  text.clear();
+}
+
+// Return row as [color, "text", ...] and start a new row
+string CompactRow::str(void)
+{
+  flush();
+
+  string row = "[" + runs.str() + "]";
+  runs.str("");
+  count = 0;
+  return row;
+}
+
+// Write the shared style sheet and script for compact reports to
+// htmlDir if not already there. Reports written in parallel may race
+// to do this, so each writes via its own temporary file.
+bool VampProcess::writeHTMLBundle(string htmlDir, string tmpName)
+{
+  const char *names[] = { HTML_BUNDLE_CSS, HTML_BUNDLE_JS };
+  const char *contents[] = { htmlBundleCss, htmlBundleJs };
+
+  for (int i = 0; i < 2; i++)
+  {
+    string bundleName = htmlDir + DIRECTORY_SEPARATOR + names[i];
+    size_t size = strlen(contents[i]);
+    struct stat statInfo;
+
+    reportOutputs.push_back(bundleName);
+
+    if ((stat(bundleName.c_str(), &statInfo) == 0) &&
+        ((size_t) statInfo.st_size == size))
+      continue;
+
+    string tmpBundle = tmpName + "." + names[i] + ".tmp";
+    ofstream bundleFile(tmpBundle.c_str(), ios::out | ios::binary | ios::trunc);
+    bundleFile.write(contents[i], size);
+    bundleFile.close();
+    if (!bundleFile)
+    {
+      *vampErr << "Cannot create " << bundleName << ENDL;
+      remove(tmpBundle.c_str());
+      return false;
+    }
+
+    remove(bundleName.c_str());
+    rename(tmpBundle.c_str(), bundleName.c_str());
+  }
+
+  return true;
+}
+
+// Link a compact report page to the shared style sheet and script, and
+// tell the script which columns this report shows. dir leads from the
+// page to the HTML directory.
+void VampProcess::genCompactHTMLHead(ofstream &htmlFile, const char *dir)
+{
+  htmlFile << "    <link rel=\"stylesheet\" href=\"" << dir <<
+              HTML_BUNDLE_CSS << "\"/>" << ENDL;
+  htmlFile << "    <script src=\"" << dir << HTML_BUNDLE_JS <<
+              "\"></script>" << ENDL;
+  htmlFile << "    <script>vampReport({ ppmap: " << (gotPPMap ? 1 : 0) <<
+              ", stmt: " << ((doStmtSingle || doStmtCount) ? 1 : 0) <<
+              ", count: " << (doStmtCount ? 1 : 0) <<
+              ", combine: " <<
+              ((db.combineHistory && (doStmtSingle || doStmtCount)) ? 1 : 0) <<
+              " });</script>" << ENDL;
+}
+
+// Coverage of one summary column as [covered, total]
+static string summaryCell(int covered, int total)
+{
+  ostringstream cell;
+
+  cell << "[" << covered << "," << total << "]";
+  return cell.str();
+}
+
+// Hand the summary tables of a compact report to vampSummary() as
+//   "columns", [file totals], [[function, page, [totals]], ...], [new]
+// columns: S statement, B branch, M MC/DC, C condition, in that order
+// totals: [covered, total] for each column; new is 0 unless combining
+void VampProcess::genCompactHTMLSummary(ofstream &htmlFile)
+{
+  string columns;
+  vector<string> totals;
+  vector<string> newTotals;
+
+  if (doStmtSingle || doStmtCount)
+  {
+    columns += "S";
+    totals.push_back(summaryCell(totalStmtCoveredCount, db.totalStmtCount));
+    newTotals.push_back(summaryCell(newStmtCoveredCount, db.totalStmtCount));
+  }
+  if (doBranch)
+  {
+    columns += "B";
+    totals.push_back(summaryCell(branchTotalCoverageCount,
+                                 branchTotalOperandCount));
+    newTotals.push_back(summaryCell(newBranchCoveredCount,
+                                    branchTotalOperandCount));
+  }
+  if (doMCDC)
+  {
+    columns += "M";
+    totals.push_back(summaryCell(mcdcTotalCoverageCount,
+                                 mcdcTotalOperandCount));
+    newTotals.push_back(summaryCell(mcdcNewCoverCount, mcdcTotalOperandCount));
+  }
+  if (doCC)
+  {
+    columns += "C";
+    totals.push_back(summaryCell(condTotalCoverageCount,
+                                 condTotalOperandCount));
+    newTotals.push_back(summaryCell(newCondCoveredCount,
+                                    condTotalOperandCount));
+  }
+
+  htmlFile << "      <div id=\"vs\"></div>" << ENDL;
+  htmlFile << "      <script>vampSummary(" << jsString(db.fileName) << ", \"" <<
+              columns << "\", [";
+  for (int c = 0; c < totals.size(); c++)
+    htmlFile << (c ? "," : "") << totals[c];
+  htmlFile << "], [";
+
+  for (int i = 0; i < db.functionInfo.size(); i++)
+  {
+    htmlFile << (i ? "," : "") << "[" <<
+                jsString(db.functionInfo[i].function) << "," <<
+                jsString(htmlPageCount ? htmlPageName(htmlFuncPage[i], false) :
+                                         "");
+    if (doStmtSingle || doStmtCount)
+      htmlFile << "," << summaryCell(functionStmtCoverageCount[i],
+                                     db.functionStmtCount[i]);
+    if (doBranch)
+      htmlFile << "," << summaryCell(branchFunctionCoverageCount[i],
+                                     branchFunctionOperandCount[i]);
+    if (doMCDC)
+      htmlFile << "," << summaryCell(mcdcFunctionCoverageCount[i],
+                                     mcdcFunctionOperandCount[i]);
+    if (doCC)
+      htmlFile << "," << summaryCell(condFunctionCoverageCount[i],
+                                     condFunctionOperandCount[i]);
+    htmlFile << "]";
+  }
+
+  htmlFile << "], ";
+  if (db.combineHistory)
+  {
+    htmlFile << "[";
+    for (int c = 0; c < newTotals.size(); c++)
+      htmlFile << (c ? "," : "") << newTotals[c];
+    htmlFile << "]";
+  }
+  else
+    htmlFile << "0";
+  htmlFile << ");</script>" << ENDL;
+}
+
+// Split functions of a large report into pages of about HTML_PAGE_LINES
+// lines, so a viewer can show the summary without loading all source.
+// Functions are never split across pages. Returns number of pages, or 0
+// if the report fits on one page.
+int VampProcess::assignHTMLPages(void)
+{
+  int totalLines = 0;
+
+  htmlFuncPage.assign(db.functionInfo.size(), 0);
+  for (int i = 0; i < db.functionInfo.size(); i++)
+    totalLines += db.functionInfo[i].loc.rhsLine -
+                  db.functionInfo[i].loc.lhsLine + 1;
+
+  if (totalLines <= HTML_PAGE_LINES)
+    return 0;
+
+  int page = 0;
+  int pageLines = 0;
+  for (int i = 0; i < db.functionInfo.size(); i++)
+  {
+    int lines = db.functionInfo[i].loc.rhsLine -
+                db.functionInfo[i].loc.lhsLine + 1;
+
+    if (pageLines && (pageLines + lines > HTML_PAGE_LINES))
+    {
+      ++page;
+      pageLines = 0;
+    }
+
+    htmlFuncPage[i] = page;
+    pageLines += lines;
+  }
+
+  return page + 1;
+}
+
+// Find page showing line, or -1 if report is not split
+int VampProcess::htmlLinePage(int line)
+{
+  if (htmlPageCount == 0)
+    return -1;
+
+  for (int i = 0; i < db.functionInfo.size(); i++)
+  {
+    if ((line >= db.functionInfo[i].loc.lhsLine) &&
+        (line <= db.functionInfo[i].loc.rhsLine))
+      return htmlFuncPage[i];
+  }
+
+  return -1;
+}
+
+// Name of report page (<report>.pages/page<n>.html), or of the summary
+// page itself if page is -1. Pages are kept in a directory of their own
+// so they cannot clash with the report of another source file. Without
+// the path, the name is as linked from the summary page.
+string VampProcess::htmlPageName(int page, bool withPath)
+{
+  string name(htmlPageBase);
+
+  if (!withPath)
+  {
+    size_t sep = name.find_last_of("/\\");
+    if (sep != name.npos)
+      name = name.substr(sep + 1);
+  }
+
+  if (page >= 0)
+  {
+    ostringstream num;
+    num << HTML_PAGE_DIR_EXT << (withPath ? DIRECTORY_SEPARATOR : "/") <<
+           "page" << (page + 1);
+    name += num.str();
+  }
+
+  return name + ".html";
+}
+
+// Links from a report page back to the summary and to neighboring pages
+void VampProcess::genHTMLPageNav(ofstream &htmlFile, int page)
+{
+  htmlFile << "<p align=\"center\"><a href='../" << htmlPageName(-1, false) <<
+              "'>Summary</a>";
+  if (page > 0)
+    htmlFile << " | <a href='page" << page << ".html'>Previous Page</a>";
+  if (page + 1 < htmlPageCount)
+    htmlFile << " | <a href='page" << (page + 2) << ".html'>Next Page</a>";
+  htmlFile << "</p>" << ENDL;
+}
+
+// Remove pages the previous report wrote that this one does not, and
+// make sure the page directory exists if there are pages. Only files
+// recorded as outputs in the previous fingerprint are removed.
+void VampProcess::removeOldPages(void)
+{
+  string pageDir = htmlPageBase + HTML_PAGE_DIR_EXT;
+  string prefix = pageDir + DIRECTORY_SEPARATOR;
+
+  for (size_t i = 0; i < oldOutputs.size(); i++)
+  {
+    if (oldOutputs[i].compare(0, prefix.size(), prefix) != 0)
+      continue;
+
+    bool current = false;
+    for (int page = 0; !current && (page < htmlPageCount); page++)
+      current = (oldOutputs[i] == htmlPageName(page, true));
+
+    if (!current)
+      remove(oldOutputs[i].c_str());
+  }
+
+  if (htmlPageCount)
+  {
+#ifdef _WIN32
+    mkdir(pageDir.c_str());
+#else
+    mkdir(pageDir.c_str(), 0777);
+#endif
+  }
+  else
+  {
+    // Fails, leaving it alone, unless the directory is now empty
+    rmdir(pageDir.c_str());
+  }
+}
+
+// Write the .vrpt totals read by the GUI and, if wanted, the .rpt file.
+// Written whether or not the HTML report is.
+void VampProcess::genSummary(string reportName)
 {
-  string vrptName = htmlName + ".vrpt";
-  string rptName = htmlName + ".rpt";
-  htmlName += ".html";
-  ofstream htmlFile (htmlName.c_str());
-  ofstream vrptFile (vrptName.c_str());
+  string vrptName = reportName + ".vrpt";
+  string rptName = reportName + ".rpt";
+  ofstream vrptFile(vrptName.c_str());
   ofstream rptFile;
-  int mapIndex = 0;
-  if (mapInfo.size() == 0)
-      gotPPMap = false;
 
   if (db.generateReport)
   {
@@ -4156,212 +5878,189 @@ void VampProcess::genHTML(string htmlName)
   }
 
   vrptFile << "{\n  \"file_name\": \"" << db.fileName << "\",\n";
+  vrptFile << "  \"mcdc_stack_overflow\": " <<
+              ((doMCDC && hist.mcdcCount && hist.stackOverflow) ?
+               "true" : "false") << ",\n";
 
-  htmlFile << "<!DOCTYPE html>" << ENDL;
-  htmlFile << "<html lang=\"en\">" << ENDL;
-  htmlFile << "  <head>" << ENDL;
-  htmlFile << "  <meta charset=\"utf-8\"/>" << ENDL;
-  htmlFile << "    <title>" << db.fileName <<
-              " Coverage Report (Instrumented by VAMP)</title>" << ENDL;
+  genSummaryHeader(rptFile, "File Coverage Summary");
+  if (db.generateReport)
+  {
+    rptFile << db.fileName;
+  }
 
-  // Insert styles needed to provide coverage summary for file
-  if (db.totalStmtCount)
+  if (doStmtSingle || doStmtCount)
   {
-    int coveragePercent = (1000 * totalStmtCoveredCount / 
-                                  db.totalStmtCount + 5) / 10;
+    vrptFile << "  \"total_statement_count\": " << db.totalStmtCount << ",\n";
+    vrptFile << "  \"total_statements_covered\": " << totalStmtCoveredCount << ",\n";
 
-    htmlFile << htmlPercentageStyle("total_stmt_percent", coveragePercent);
+    if (db.generateReport)
+    {
+      rptFile << db.reportSeparator << totalStmtCoveredCount <<
+                 db.reportSeparator << db.totalStmtCount;
+    }
   }
 
-  if (branchTotalOperandCount)
+  if (doBranch)
   {
-    int coveragePercent = (1000 * branchTotalCoverageCount / 
-                                  branchTotalOperandCount + 5) / 10;
+    vrptFile << "  \"total_branch_count\": " << branchTotalOperandCount << ",\n";
+    vrptFile << "  \"total_branches_covered\": " << branchTotalCoverageCount << ",\n";
 
-    htmlFile << htmlPercentageStyle("total_branch_percent", coveragePercent);
+    if (db.generateReport)
+    {
+      rptFile << db.reportSeparator << branchTotalCoverageCount <<
+                 db.reportSeparator << branchTotalOperandCount;
+    }
   }
 
   if (doMCDC)
   {
-    if (mcdcTotalOperandCount)
-    {
-      int coveragePercent = (1000 * mcdcTotalCoverageCount / 
-                                    mcdcTotalOperandCount + 5) / 10;
+    vrptFile << "  \"total_mcdc_count\": " << mcdcTotalOperandCount << ",\n";
+    vrptFile << "  \"total_mcdc_covered\": " << mcdcTotalCoverageCount << ",\n";
 
-      htmlFile << htmlPercentageStyle("total_mcdc_percent", coveragePercent);
+    if (db.generateReport)
+    {
+      rptFile << db.reportSeparator << mcdcTotalCoverageCount <<
+                 db.reportSeparator << mcdcTotalOperandCount;
     }
   }
 
   if (doCC)
   {
-    if (condTotalOperandCount)
-    {
-      int coveragePercent = (1000 * condTotalCoverageCount / 
-                                    condTotalOperandCount + 5) / 10;
+    vrptFile << "  \"total_condition_count\": " << condTotalOperandCount << ",\n";
+    vrptFile << "  \"total_conditions_covered\": " << condTotalCoverageCount << ",\n";
 
-      htmlFile << htmlPercentageStyle("total_cond_percent", coveragePercent);
+    if (db.generateReport)
+    {
+      rptFile << db.reportSeparator << condTotalCoverageCount <<
+                 db.reportSeparator << condTotalOperandCount;
     }
   }
 
-  // Insert styles needed to display percentages
-  for (int i = 0; i < db.functionInfo.size(); i++)
+  if (db.generateReport)
   {
-    if ((doStmtSingle || doStmtCount) && db.functionStmtCount[i])
-    {
-      int coveragePercent = (1000 * functionStmtCoverageCount[i] /
-                                    db.functionStmtCount[i] + 5) / 10;
+    rptFile << ENDL;
+  }
 
-      htmlFile << htmlPercentageStyle(db.functionInfo[i].function +
-                                      "_stmt_percent", coveragePercent);
-    }
+  genSummaryHeader(rptFile, "Function Coverage Summary");
 
-    if (doBranch && branchFunctionOperandCount[i])
-    {
-      int coveragePercent = (1000 * branchFunctionCoverageCount[i] / 
-                                    branchFunctionOperandCount[i] + 5) / 10;
+  vrptFile << "  \"function_info\":\n  [\n";
 
-      htmlFile << htmlPercentageStyle(db.functionInfo[i].function +
-                                      "_branch_percent", coveragePercent);
-    }
+  for (int i = 0; i < db.functionInfo.size(); i++)
+  {
+    string func = db.functionInfo[i].function;
 
-    if (doMCDC)
+    if (db.generateReport)
     {
-      if (mcdcFunctionOperandCount[i])
-      {
-        int coveragePercent = (1000 * mcdcFunctionCoverageCount[i] /
-                                      mcdcFunctionOperandCount[i] + 5) / 10;
-
-        htmlFile << htmlPercentageStyle(db.functionInfo[i].function +
-                                        "_mcdc_percent", coveragePercent);
-      }
+      // Add function name to report file
+      rptFile << func;
     }
 
-    if (doCC)
+    if (i > 0)
+      vrptFile << ",\n";
+    vrptFile << "    \"" << func << "\", ";
+
+    if (doStmtSingle || doStmtCount)
     {
-      if (condFunctionOperandCount[i])
-      {
-        int coveragePercent = (1000 * condFunctionCoverageCount[i] / 
-                                      condFunctionOperandCount[i] + 5) / 10;
+      vrptFile << functionStmtCoverageCount[i] << ", " <<
+                  db.functionStmtCount[i] << ", ";
 
-        htmlFile << htmlPercentageStyle(db.functionInfo[i].function +
-                                        "_cond_percent", coveragePercent);
+      if (db.generateReport)
+      {
+        rptFile << db.reportSeparator << functionStmtCoverageCount[i] <<
+                   db.reportSeparator << db.functionStmtCount[i];
       }
     }
-  }
-
-  if (db.combineHistory)
-  {
-    // Insert styles needed to display new coverage
-    if ((doStmtSingle || doStmtCount) && db.totalStmtCount)
+    else
     {
-      int coveragePercent = (1000 * newStmtCoveredCount / 
-                                    db.totalStmtCount + 5) / 10;
-
-      htmlFile << htmlPercentageStyle("new_stmt_percent", coveragePercent);
+      vrptFile << "0, 0, ";
     }
 
-    if (doBranch && branchTotalOperandCount)
+    if (doBranch)
     {
-      int coveragePercent = (1000 * newBranchCoveredCount / 
-                                    branchTotalOperandCount + 5) / 10;
+      vrptFile << branchFunctionCoverageCount[i] << ", " <<
+                  branchFunctionOperandCount[i] << ", ";
 
-      htmlFile << htmlPercentageStyle("new_branch_percent", coveragePercent);
+      if (db.generateReport)
+      {
+        rptFile << db.reportSeparator << branchFunctionCoverageCount[i] <<
+                   db.reportSeparator << branchFunctionOperandCount[i];
+      }
+    }
+    else
+    {
+      vrptFile << "0, 0, ";
     }
 
     if (doMCDC)
     {
-      if (mcdcTotalOperandCount)
-      {
-        int coveragePercent = (1000 * mcdcNewCoverCount /
-                                      mcdcTotalOperandCount + 5) / 10;
+      vrptFile << mcdcFunctionCoverageCount[i] << ", " <<
+                  mcdcFunctionOperandCount[i];
 
-        htmlFile << htmlPercentageStyle("new_mcdc_percent", coveragePercent);
+      if (db.generateReport)
+      {
+        rptFile << db.reportSeparator << mcdcFunctionCoverageCount[i] <<
+                   db.reportSeparator << mcdcFunctionOperandCount[i];
       }
     }
+    else
+    if (!doCC)
+    {
+      vrptFile << "0, 0";
+    }
 
     if (doCC)
     {
-      if (condTotalOperandCount)
-      {
-        int coveragePercent = (1000 * newCondCoveredCount / 
-                                      condTotalOperandCount + 5) / 10;
+      vrptFile << condFunctionCoverageCount[i] << ", " <<
+                  condFunctionOperandCount[i];
 
-        htmlFile << htmlPercentageStyle("new_cond_percent", coveragePercent);
+      if (db.generateReport)
+      {
+        rptFile << db.reportSeparator << condFunctionCoverageCount[i] <<
+                   db.reportSeparator << condFunctionOperandCount[i];
       }
     }
-  }
-
-  htmlFile << "  </head>" << ENDL;
-
-  htmlFile << "  <body>" << ENDL;
-  htmlFile << "    <h1 align=\"center\">" << db.fileName <<
-              " Coverage Report (Instrumented by VAMP)</h1>" << ENDL;
-  htmlFile << "  <hr />" << ENDL;
 
-  vrptFile << "  \"mcdc_stack_overflow\": ";
+    if (db.generateReport)
+    {
+      rptFile << ENDL;
+    }
+  }
 
-  if (doMCDC && hist.mcdcCount && hist.stackOverflow)
+  if (db.combineHistory && db.generateReport)
   {
-    mcdcOpInfoType firstOperand =
-            db.mcdcExprInfo[hist.stackOverflow - 1].opInfo.front();
-    htmlFile << "<table border bgcolor=\"#d0d0d0\" " <<
-                //"width=80% align=\"center\">" << ENDL;
-                "align=\"center\">" << ENDL;
-    htmlFile << "<tr><td bgcolor=#ffff00>" << ENDL;
-    htmlFile << "<center><b><font size=\"6\" color=#ff0000>" <<
-                "ERROR - MC/DC Expression Stack Overflow at "
-                "<a href='#line_" <<
-                firstOperand.lhsLoc.lhsLine << "'>line " <<
-                firstOperand.lhsLoc.lhsLine << "</a><br />";
-    htmlFile << "MC/DC Data Collection Terminated Early";
-    htmlFile << "</font></b></center>\n";
-    htmlFile << "</td></tr></table>\n";
-    htmlFile << "<br /><br />\n";
+    genSummaryHeader(rptFile, "File Coverage New");
+    rptFile << db.fileName;
 
-    vrptFile << "true,\n";
-  }
-  else
-  {
-    vrptFile << "false,\n";
+    if (doStmtSingle || doStmtCount)
+      rptFile << db.reportSeparator << newStmtCoveredCount <<
+                 db.reportSeparator << db.totalStmtCount;
+    if (doBranch)
+      rptFile << db.reportSeparator << newBranchCoveredCount <<
+                 db.reportSeparator << branchTotalOperandCount;
+    if (doMCDC)
+      rptFile << db.reportSeparator << mcdcNewCoverCount <<
+                 db.reportSeparator << mcdcTotalOperandCount;
+    if (doCC)
+      rptFile << db.reportSeparator << newCondCoveredCount <<
+                 db.reportSeparator << condTotalOperandCount;
+    rptFile << ENDL;
   }
 
-  int coverageTypes = (doStmtSingle || doStmtCount) +
-                      doBranch + (doMCDC || doCC);
-  int coverageCnt = 100 / coverageTypes;     // Normally 33%
-  int summaryCnt = 100 / (coverageTypes + 1);  // Normally 25%
-
-  // Display overall summary of results
-  htmlFile << "<h1><center>Overall Summary of Results for " <<
-              db.fileName << "</center></h1>" << ENDL;
+  vrptFile << "\n  ]\n}\n";
+  vrptFile.close();
 
-  htmlFile << "<table border rules=none frame=box bgcolor=\"#d0d0d0\" " <<
-              "width=60% align=\"center\">" << ENDL;
-  htmlFile << "<tr>";
-  if (doStmtSingle || doStmtCount)
-  {
-    htmlFile << "<th width=" << coverageCnt << "%> Statement </th> <td></td>" << ENDL;
-  }
-  if (doBranch)
-  {
-    htmlFile << "<th width=" << coverageCnt << "%> Branch </th> <td></td>" << ENDL;
-  }
-  if (doMCDC)
-  {
-    htmlFile << "<th width=" << coverageCnt << "%> MC/DC </th> <td></td>" << ENDL;
-  }
-  if (doCC)
+  if (db.generateReport)
   {
-    htmlFile << "<th width=" << coverageCnt << "%> Condition </th> <td></td>" << ENDL;
+    rptFile.close();
   }
-  htmlFile << "</tr>" << ENDL;
-  htmlFile << "<tr></tr>" << ENDL;
-  htmlFile << "<tr></tr>" << ENDL;
-
-  htmlFile << "<tr>" << ENDL;
+}
 
+// Heading row of a section of the .rpt file
+void VampProcess::genSummaryHeader(ofstream &rptFile, const char *title)
+{
   if (db.generateReport)
   {
-    rptFile << "File Coverage Summary";
+    rptFile << title;
     if (doStmtSingle || doStmtCount)
       rptFile << db.reportSeparator << "Statement Covered" <<
                  db.reportSeparator << "Statement Total";
@@ -4375,233 +6074,247 @@ void VampProcess::genHTML(string htmlName)
       rptFile << db.reportSeparator << "Condition Covered" <<
                  db.reportSeparator << "Condition Total";
     rptFile << ENDL;
-    rptFile << db.fileName;
   }
+}
 
-  if (doStmtSingle || doStmtCount)
-  {
-    htmlFile << "<td width=" << coverageCnt << "% style=\"white-space:nowrap\"> ";
-    vrptFile << "  \"total_statement_count\": " << db.totalStmtCount << ",\n";
-    vrptFile << "  \"total_statements_covered\": " << totalStmtCoveredCount << ",\n";
+void VampProcess::genHTML(string htmlName)
+{
+  htmlPageBase = htmlName;
+  htmlPageCount = assignHTMLPages();
+
+  // Drop pages left by an earlier, longer report; they hold stale coverage
+  removeOldPages();
+
+  htmlName += ".html";
+  // Function sections are streamed out as they are built; give the
+  // file a larger buffer than the default
+  char htmlBuf[65536];
+  ofstream htmlFile;
+  htmlFile.rdbuf()->pubsetbuf(htmlBuf, sizeof(htmlBuf));
+  htmlFile.open(htmlName.c_str());
+  if (ppMap.markers.empty())
+      gotPPMap = false;
+
+  htmlFile << "<!DOCTYPE html>" << ENDL;
+  htmlFile << "<html lang=\"en\">" << ENDL;
+  htmlFile << "  <head>" << ENDL;
+  htmlFile << "  <meta charset=\"utf-8\"/>" << ENDL;
+  htmlFile << "    <title>" << db.fileName <<
+              " Coverage Report (Instrumented by VAMP)</title>" << ENDL;
+  if (db.compactHtml)
+    genCompactHTMLHead(htmlFile);
 
+  // The compact layout draws the percentage bars from the summary data
+  if (!db.compactHtml)
+  {
+    // Insert styles needed to provide coverage summary for file
     if (db.totalStmtCount)
     {
       int coveragePercent = (1000 * totalStmtCoveredCount / 
-                                      db.totalStmtCount + 5) / 10;
-      htmlFile << "<div id=\"total_stmt_percent\">" <<
-                  "<div id=\"total_stmt_percent_in\">" <<
-                  coveragePercent << "% <font size=\"1\">&nbsp;&nbsp;(" <<
-                  totalStmtCoveredCount << " / " <<
-                  db.totalStmtCount <<
-                  ")</font></div></div> </td> <td></td>" << ENDL;
-    }
-    else
-    {
-      htmlFile << "<center> No Statements </center>" <<
-                  " </td> <td></td>" << ENDL;
-    }
+                                    db.totalStmtCount + 5) / 10;
 
-    if (db.generateReport)
-    {
-      rptFile << db.reportSeparator << totalStmtCoveredCount <<
-                 db.reportSeparator << db.totalStmtCount;
+      htmlFile << htmlPercentageStyle("total_stmt_percent", coveragePercent);
     }
-  }
-
-  if (doBranch)
-  {
-    htmlFile << "<td width=" << coverageCnt << "% style=\"white-space:nowrap\"> ";
-
-    vrptFile << "  \"total_branch_count\": " << branchTotalOperandCount << ",\n";
-    vrptFile << "  \"total_branches_covered\": " << branchTotalCoverageCount << ",\n";
 
     if (branchTotalOperandCount)
     {
       int coveragePercent = (1000 * branchTotalCoverageCount / 
                                     branchTotalOperandCount + 5) / 10;
-      htmlFile << "<div id=\"total_branch_percent\">" <<
-                  "<div id=\"total_branch_percent_in\">" <<
-                  coveragePercent << "% <font size=\"1\">&nbsp;&nbsp;(" <<
-                  branchTotalCoverageCount << " / " <<
-                  branchTotalOperandCount <<
-                  ")</font></div></div> </td> <td></td>" << ENDL;
+
+      htmlFile << htmlPercentageStyle("total_branch_percent", coveragePercent);
     }
-    else
+
+    if (doMCDC)
     {
-      htmlFile << "<center>   No Branches  </center>" <<
-                  " </td> <td></td>" << ENDL;
+      if (mcdcTotalOperandCount)
+      {
+        int coveragePercent = (1000 * mcdcTotalCoverageCount / 
+                                      mcdcTotalOperandCount + 5) / 10;
+
+        htmlFile << htmlPercentageStyle("total_mcdc_percent", coveragePercent);
+      }
     }
 
-    if (db.generateReport)
+    if (doCC)
     {
-      rptFile << db.reportSeparator << branchTotalCoverageCount <<
-                 db.reportSeparator << branchTotalOperandCount;
+      if (condTotalOperandCount)
+      {
+        int coveragePercent = (1000 * condTotalCoverageCount / 
+                                      condTotalOperandCount + 5) / 10;
+
+        htmlFile << htmlPercentageStyle("total_cond_percent", coveragePercent);
+      }
     }
-  }
 
-  if (doMCDC)
-  {
-    htmlFile << "<td width=" << coverageCnt << "% style=\"white-space:nowrap\"> ";
+    // Insert styles needed to display percentages
+    for (int i = 0; i < db.functionInfo.size(); i++)
+    {
+      if ((doStmtSingle || doStmtCount) && db.functionStmtCount[i])
+      {
+        int coveragePercent = (1000 * functionStmtCoverageCount[i] /
+                                      db.functionStmtCount[i] + 5) / 10;
+
+        htmlFile << htmlPercentageStyle(db.functionInfo[i].function +
+                                        "_stmt_percent", coveragePercent);
+      }
+
+      if (doBranch && branchFunctionOperandCount[i])
+      {
+        int coveragePercent = (1000 * branchFunctionCoverageCount[i] / 
+                                      branchFunctionOperandCount[i] + 5) / 10;
+
+        htmlFile << htmlPercentageStyle(db.functionInfo[i].function +
+                                        "_branch_percent", coveragePercent);
+      }
+
+      if (doMCDC)
+      {
+        if (mcdcFunctionOperandCount[i])
+        {
+          int coveragePercent = (1000 * mcdcFunctionCoverageCount[i] /
+                                        mcdcFunctionOperandCount[i] + 5) / 10;
+
+          htmlFile << htmlPercentageStyle(db.functionInfo[i].function +
+                                          "_mcdc_percent", coveragePercent);
+        }
+      }
 
-    vrptFile << "  \"total_mcdc_count\": " << mcdcTotalOperandCount << ",\n";
-    vrptFile << "  \"total_mcdc_covered\": " << mcdcTotalCoverageCount << ",\n";
+      if (doCC)
+      {
+        if (condFunctionOperandCount[i])
+        {
+          int coveragePercent = (1000 * condFunctionCoverageCount[i] / 
+                                        condFunctionOperandCount[i] + 5) / 10;
 
-    if (mcdcTotalOperandCount)
-    {
-      int coveragePercent = (1000 * mcdcTotalCoverageCount / 
-                                    mcdcTotalOperandCount + 5) / 10;
-      htmlFile << "<div id=\"total_mcdc_percent\">" <<
-                  "<div id=\"total_mcdc_percent_in\">" <<
-                  coveragePercent << "% <font size=\"1\">&nbsp;&nbsp;(" <<
-                  mcdcTotalCoverageCount << " / " <<
-                  mcdcTotalOperandCount <<
-                  ")</font></div></div> </td> <td></td>" << ENDL;
-    }
-    else
-    {
-      htmlFile << "<center> No MC/DC Exprs </center>" <<
-                  " </td> <td></td>" << ENDL;
+          htmlFile << htmlPercentageStyle(db.functionInfo[i].function +
+                                          "_cond_percent", coveragePercent);
+        }
+      }
     }
 
-    if (db.generateReport)
+    if (db.combineHistory)
     {
-      rptFile << db.reportSeparator << mcdcTotalCoverageCount <<
-                 db.reportSeparator << mcdcTotalOperandCount;
-    }
-  }
+      // Insert styles needed to display new coverage
+      if ((doStmtSingle || doStmtCount) && db.totalStmtCount)
+      {
+        int coveragePercent = (1000 * newStmtCoveredCount / 
+                                      db.totalStmtCount + 5) / 10;
 
-  if (doCC)
-  {
-    htmlFile << "<td width=" << coverageCnt << "% style=\"white-space:nowrap\"> ";
+        htmlFile << htmlPercentageStyle("new_stmt_percent", coveragePercent);
+      }
 
-    vrptFile << "  \"total_condition_count\": " << condTotalOperandCount << ",\n";
-    vrptFile << "  \"total_conditions_covered\": " << condTotalCoverageCount << ",\n";
+      if (doBranch && branchTotalOperandCount)
+      {
+        int coveragePercent = (1000 * newBranchCoveredCount / 
+                                      branchTotalOperandCount + 5) / 10;
 
-    if (condTotalOperandCount)
-    {
-      int coveragePercent = (1000 * condTotalCoverageCount / 
-                                    condTotalOperandCount + 5) / 10;
-      htmlFile << "<div id=\"total_cond_percent\">" <<
-                  "<div id=\"total_cond_percent_in\">" <<
-                  coveragePercent << "% <font size=\"1\">&nbsp;&nbsp;(" <<
-                  condTotalCoverageCount << " / " <<
-                  condTotalOperandCount <<
-                  ")</font></div></div> </td> <td></td>" << ENDL;
-    }
-    else
-    {
-      htmlFile << "<center> No Conditions  </center>" <<
-                  " </td> <td></td>" << ENDL;
-    }
+        htmlFile << htmlPercentageStyle("new_branch_percent", coveragePercent);
+      }
 
-    if (db.generateReport)
-    {
-      rptFile << db.reportSeparator << condTotalCoverageCount <<
-                 db.reportSeparator << condTotalOperandCount;
+      if (doMCDC)
+      {
+        if (mcdcTotalOperandCount)
+        {
+          int coveragePercent = (1000 * mcdcNewCoverCount /
+                                        mcdcTotalOperandCount + 5) / 10;
+
+          htmlFile << htmlPercentageStyle("new_mcdc_percent", coveragePercent);
+        }
+      }
+
+      if (doCC)
+      {
+        if (condTotalOperandCount)
+        {
+          int coveragePercent = (1000 * newCondCoveredCount / 
+                                        condTotalOperandCount + 5) / 10;
+
+          htmlFile << htmlPercentageStyle("new_cond_percent", coveragePercent);
+        }
+      }
     }
   }
 
-  if (db.generateReport)
-  {
-    rptFile << ENDL;
-  }
+  htmlFile << "  </head>" << ENDL;
 
-  htmlFile << "</tr>" << ENDL;
-  //htmlFile << "</td></tr>" << ENDL;
-  //htmlFile << "</table></table>" << ENDL;
-  htmlFile << "</table>" << ENDL;
-  htmlFile << "<br /><br />" << ENDL;
-
-  // Display summary of results per function
-  htmlFile << "<h3><center>Summary of Results for Each Function in " <<
-              db.fileName << "</center></h3>" << ENDL;
-
-  htmlFile << "<table border rules=none frame=box bgcolor=\"#d0d0d0\" " <<
-              "width=80% align=\"center\">" << ENDL;
-  //htmlFile << "<table border width=80% align=\"center\">" << ENDL;
-  //htmlFile << "<tr><td>" << ENDL;
-  //htmlFile << "<table bgcolor=\"#d0d0d0\" width=100% >" << ENDL;
-  htmlFile << "<tr>" << ENDL;
-  //htmlFile << "<th colspan = 10> <pre> Function   </pre> </th> <td></td>" << ENDL;
-  //htmlFile << "<th colspan = 10> <pre> Statement  </pre> </th> <td></td>" << ENDL;
-  //htmlFile << "<th colspan = 10> <pre> Branch     </pre> </th> <td></td>" << ENDL;
-  //htmlFile << "<th colspan = 10> <pre> MC/DC      </pre> </th> <td></td>" << ENDL;
-  htmlFile << "<th width=" << summaryCnt << "%> Function </th> <td></td>" << ENDL;
-  if (doStmtSingle || doStmtCount)
-  {
-    htmlFile << "<th width=" << summaryCnt << "%> Statement </th> <td></td>" << ENDL;
-  }
-  if (doBranch)
-  {
-    htmlFile << "<th width=" << summaryCnt << "%> Branch </th> <td></td>" << ENDL;
-  }
-  if (doMCDC)
-  {
-    htmlFile << "<th width=" << summaryCnt << "%> MC/DC </th> <td></td>" << ENDL;
-  }
-  if (doCC)
+  htmlFile << "  <body>" << ENDL;
+  htmlFile << "    <h1 align=\"center\">" << db.fileName <<
+              " Coverage Report (Instrumented by VAMP)</h1>" << ENDL;
+  htmlFile << "  <hr />" << ENDL;
+
+  if (doMCDC && hist.mcdcCount && hist.stackOverflow)
   {
-    htmlFile << "<th width=" << summaryCnt << "%> Condition </th> <td></td>" << ENDL;
+    mcdcOpInfoType firstOperand =
+            db.mcdcExprInfo[hist.stackOverflow - 1].opInfo.front();
+    htmlFile << "<table border bgcolor=\"#d0d0d0\" " <<
+                //"width=80% align=\"center\">" << ENDL;
+                "align=\"center\">" << ENDL;
+    htmlFile << "<tr><td bgcolor=#ffff00>" << ENDL;
+    htmlFile << "<center><b><font size=\"6\" color=#ff0000>" <<
+                "ERROR - MC/DC Expression Stack Overflow at "
+                "<a href='" <<
+                ((htmlLinePage(firstOperand.lhsLoc.lhsLine) >= 0) ?
+                 htmlPageName(htmlLinePage(firstOperand.lhsLoc.lhsLine), false) : "") <<
+                "#line_" <<
+                firstOperand.lhsLoc.lhsLine << "'>line " <<
+                firstOperand.lhsLoc.lhsLine << "</a><br />";
+    htmlFile << "MC/DC Data Collection Terminated Early";
+    htmlFile << "</font></b></center>\n";
+    htmlFile << "</td></tr></table>\n";
+    htmlFile << "<br /><br />\n";
   }
-  htmlFile << "</tr>" << ENDL;
-  htmlFile << "<tr></tr>" << ENDL;
-  htmlFile << "<tr></tr>" << ENDL;
 
-  if (db.generateReport)
+  if (db.compactHtml)
+    genCompactHTMLSummary(htmlFile);
+  else
   {
-    rptFile << "Function Coverage Summary";
+    int coverageTypes = (doStmtSingle || doStmtCount) +
+                        doBranch + (doMCDC || doCC);
+    int coverageCnt = 100 / coverageTypes;     // Normally 33%
+    int summaryCnt = 100 / (coverageTypes + 1);  // Normally 25%
+
+    // Display overall summary of results
+    htmlFile << "<h1><center>Overall Summary of Results for " <<
+                db.fileName << "</center></h1>" << ENDL;
+
+    htmlFile << "<table border rules=none frame=box bgcolor=\"#d0d0d0\" " <<
+                "width=60% align=\"center\">" << ENDL;
+    htmlFile << "<tr>";
     if (doStmtSingle || doStmtCount)
-      rptFile << db.reportSeparator << "Statement Covered" <<
-                 db.reportSeparator << "Statement Total";
+    {
+      htmlFile << "<th width=" << coverageCnt << "%> Statement </th> <td></td>" << ENDL;
+    }
     if (doBranch)
-      rptFile << db.reportSeparator << "Branch Covered" <<
-                 db.reportSeparator << "Branch Total";
+    {
+      htmlFile << "<th width=" << coverageCnt << "%> Branch </th> <td></td>" << ENDL;
+    }
     if (doMCDC)
-      rptFile << db.reportSeparator << "MCDC Covered" <<
-                 db.reportSeparator << "MCDC Total";
+    {
+      htmlFile << "<th width=" << coverageCnt << "%> MC/DC </th> <td></td>" << ENDL;
+    }
     if (doCC)
-      rptFile << db.reportSeparator << "Condition Covered" <<
-                 db.reportSeparator << "Condition Total";
-    rptFile << ENDL;
-  }
-
-  vrptFile << "  \"function_info\":\n  [\n";
-
-  for (int i = 0; i < db.functionInfo.size(); i++)
-  {
-    string func = db.functionInfo[i].function;
-
-    htmlFile << "<tr>" << ENDL;
-    htmlFile << "<td width=" << summaryCnt << "%> <center> <a href='#func_" <<
-                func << "'> " << func <<
-                "</a> </center> </td> <td> </td>" << ENDL;
-
-    if (db.generateReport)
     {
-      // Add function name to report file
-      rptFile << func;
+      htmlFile << "<th width=" << coverageCnt << "%> Condition </th> <td></td>" << ENDL;
     }
+    htmlFile << "</tr>" << ENDL;
+    htmlFile << "<tr></tr>" << ENDL;
+    htmlFile << "<tr></tr>" << ENDL;
 
-    if (i > 0)
-      vrptFile << ",\n";
-    vrptFile << "    \"" << func << "\", ";
+    htmlFile << "<tr>" << ENDL;
 
     if (doStmtSingle || doStmtCount)
     {
-      htmlFile << "<td width=" << summaryCnt << "% style=\"white-space:nowrap\"> ";
-
-      vrptFile << functionStmtCoverageCount[i] << ", " <<
-                  db.functionStmtCount[i] << ", ";
+      htmlFile << "<td width=" << coverageCnt << "% style=\"white-space:nowrap\"> ";
 
-      if (db.functionStmtCount[i])
+      if (db.totalStmtCount)
       {
-        int coveragePercent = (1000 * functionStmtCoverageCount[i] / 
-                                      db.functionStmtCount[i] + 5) / 10;
-        htmlFile << "<div id=\"" << func << "_stmt_percent\">" <<
-                    "<div id=\"" << func << "_stmt_percent_in\">" <<
+        int coveragePercent = (1000 * totalStmtCoveredCount / 
+                                        db.totalStmtCount + 5) / 10;
+        htmlFile << "<div id=\"total_stmt_percent\">" <<
+                    "<div id=\"total_stmt_percent_in\">" <<
                     coveragePercent << "% <font size=\"1\">&nbsp;&nbsp;(" <<
-                    functionStmtCoverageCount[i] << " / " <<
-                    db.functionStmtCount[i] <<
+                    totalStmtCoveredCount << " / " <<
+                    db.totalStmtCount <<
                     ")</font></div></div> </td> <td></td>" << ENDL;
       }
       else
@@ -4609,69 +6322,43 @@ void VampProcess::genHTML(string htmlName)
         htmlFile << "<center> No Statements </center>" <<
                     " </td> <td></td>" << ENDL;
       }
-
-      if (db.generateReport)
-      {
-        rptFile << db.reportSeparator << functionStmtCoverageCount[i] <<
-                   db.reportSeparator << db.functionStmtCount[i];
-      }
-    }
-    else
-    {
-      vrptFile << "0, 0, ";
     }
 
     if (doBranch)
     {
-      htmlFile << "<td width=" << summaryCnt << "% style=\"white-space:nowrap\"> ";
-
-      vrptFile << branchFunctionCoverageCount[i] << ", " <<
-                  branchFunctionOperandCount[i] << ", ";
+      htmlFile << "<td width=" << coverageCnt << "% style=\"white-space:nowrap\"> ";
 
-      if (branchFunctionOperandCount[i])
+      if (branchTotalOperandCount)
       {
-        int coveragePercent = (1000 * branchFunctionCoverageCount[i] / 
-                                      branchFunctionOperandCount[i] + 5) / 10;
-        htmlFile << "<div id=\"" << func << "_branch_percent\">" <<
-                    "<div id=\"" << func << "_branch_percent_in\">" <<
+        int coveragePercent = (1000 * branchTotalCoverageCount / 
+                                      branchTotalOperandCount + 5) / 10;
+        htmlFile << "<div id=\"total_branch_percent\">" <<
+                    "<div id=\"total_branch_percent_in\">" <<
                     coveragePercent << "% <font size=\"1\">&nbsp;&nbsp;(" <<
-                    branchFunctionCoverageCount[i] << " / " <<
-                    branchFunctionOperandCount[i] <<
+                    branchTotalCoverageCount << " / " <<
+                    branchTotalOperandCount <<
                     ")</font></div></div> </td> <td></td>" << ENDL;
       }
       else
       {
-        htmlFile << "<center> No Branches </center>" <<
+        htmlFile << "<center>   No Branches  </center>" <<
                     " </td> <td></td>" << ENDL;
       }
-
-      if (db.generateReport)
-      {
-        rptFile << db.reportSeparator << branchFunctionCoverageCount[i] <<
-                   db.reportSeparator << branchFunctionOperandCount[i];
-      }
-    }
-    else
-    {
-      vrptFile << "0, 0, ";
     }
 
     if (doMCDC)
     {
-      htmlFile << "<td width=" << summaryCnt << "% style=\"white-space:nowrap\"> ";
-
-      vrptFile << mcdcFunctionCoverageCount[i] << ", " <<
-                  mcdcFunctionOperandCount[i];
+      htmlFile << "<td width=" << coverageCnt << "% style=\"white-space:nowrap\"> ";
 
-      if (mcdcFunctionOperandCount[i])
+      if (mcdcTotalOperandCount)
       {
-        int coveragePercent = (1000 * mcdcFunctionCoverageCount[i] / 
-                                      mcdcFunctionOperandCount[i] + 5) / 10;
-        htmlFile << "<div id=\"" << func << "_mcdc_percent\">" <<
-                    "<div id=\"" << func << "_mcdc_percent_in\">" <<
+        int coveragePercent = (1000 * mcdcTotalCoverageCount / 
+                                      mcdcTotalOperandCount + 5) / 10;
+        htmlFile << "<div id=\"total_mcdc_percent\">" <<
+                    "<div id=\"total_mcdc_percent_in\">" <<
                     coveragePercent << "% <font size=\"1\">&nbsp;&nbsp;(" <<
-                    mcdcFunctionCoverageCount[i] << " / " <<
-                    mcdcFunctionOperandCount[i] <<
+                    mcdcTotalCoverageCount << " / " <<
+                    mcdcTotalOperandCount <<
                     ")</font></div></div> </td> <td></td>" << ENDL;
       }
       else
@@ -4679,35 +6366,21 @@ void VampProcess::genHTML(string htmlName)
         htmlFile << "<center> No MC/DC Exprs </center>" <<
                     " </td> <td></td>" << ENDL;
       }
-
-      if (db.generateReport)
-      {
-        rptFile << db.reportSeparator << mcdcFunctionCoverageCount[i] <<
-                   db.reportSeparator << mcdcFunctionOperandCount[i];
-      }
-    }
-    else
-    if (!doCC)
-    {
-      vrptFile << "0, 0";
     }
 
     if (doCC)
     {
-      htmlFile << "<td width=" << summaryCnt << "% style=\"white-space:nowrap\"> ";
-
-      vrptFile << condFunctionCoverageCount[i] << ", " <<
-                  condFunctionOperandCount[i];
+      htmlFile << "<td width=" << coverageCnt << "% style=\"white-space:nowrap\"> ";
 
-      if (condFunctionOperandCount[i])
+      if (condTotalOperandCount)
       {
-        int coveragePercent = (1000 * condFunctionCoverageCount[i] / 
-                                      condFunctionOperandCount[i] + 5) / 10;
-        htmlFile << "<div id=\"" << func << "_cond_percent\">" <<
-                    "<div id=\"" << func << "_cond_percent_in\">" <<
+        int coveragePercent = (1000 * condTotalCoverageCount / 
+                                      condTotalOperandCount + 5) / 10;
+        htmlFile << "<div id=\"total_cond_percent\">" <<
+                    "<div id=\"total_cond_percent_in\">" <<
                     coveragePercent << "% <font size=\"1\">&nbsp;&nbsp;(" <<
-                    condFunctionCoverageCount[i] << " / " <<
-                    condFunctionOperandCount[i] <<
+                    condTotalCoverageCount << " / " <<
+                    condTotalOperandCount <<
                     ")</font></div></div> </td> <td></td>" << ENDL;
       }
       else
@@ -4715,202 +6388,283 @@ void VampProcess::genHTML(string htmlName)
         htmlFile << "<center> No Conditions  </center>" <<
                     " </td> <td></td>" << ENDL;
       }
-
-      if (db.generateReport)
-      {
-        rptFile << db.reportSeparator << condFunctionCoverageCount[i] <<
-                   db.reportSeparator << condFunctionOperandCount[i];
-      }
     }
 
     htmlFile << "</tr>" << ENDL;
     //htmlFile << "</td></tr>" << ENDL;
     //htmlFile << "</table></table>" << ENDL;
+    htmlFile << "</table>" << ENDL;
+    htmlFile << "<br /><br />" << ENDL;
 
-    if (db.generateReport)
-    {
-      rptFile << ENDL;
-    }
-  }
-
-  htmlFile << "</table>" << ENDL;
-  htmlFile << "<br /><br />" << ENDL;
-
-  if (db.combineHistory)
-  {
-    if (db.generateReport)
-    {
-      rptFile << "File Coverage New";
-      if (doStmtSingle || doStmtCount)
-        rptFile << db.reportSeparator << "Statement Covered" <<
-                   db.reportSeparator << "Statement Total";
-      if (doBranch)
-        rptFile << db.reportSeparator << "Branch Covered" <<
-                   db.reportSeparator << "Branch Total";
-      if (doMCDC)
-        rptFile << db.reportSeparator << "MCDC Covered" <<
-                   db.reportSeparator << "MCDC Total";
-      if (doCC)
-        rptFile << db.reportSeparator << "Condition Covered" <<
-                   db.reportSeparator << "Condition Total";
-      rptFile << ENDL;
-      rptFile << db.fileName;
-    }
-
-    // Display summary of results of new coverage
-    htmlFile << "<h3><center>Summary of New Coverage for " <<
+    // Display summary of results per function
+    htmlFile << "<h3><center>Summary of Results for Each Function in " <<
                 db.fileName << "</center></h3>" << ENDL;
 
     htmlFile << "<table border rules=none frame=box bgcolor=\"#d0d0d0\" " <<
-                "width=60% align=\"center\">" << ENDL;
+                "width=80% align=\"center\">" << ENDL;
+    //htmlFile << "<table border width=80% align=\"center\">" << ENDL;
+    //htmlFile << "<tr><td>" << ENDL;
+    //htmlFile << "<table bgcolor=\"#d0d0d0\" width=100% >" << ENDL;
+    htmlFile << "<tr>" << ENDL;
+    //htmlFile << "<th colspan = 10> <pre> Function   </pre> </th> <td></td>" << ENDL;
+    //htmlFile << "<th colspan = 10> <pre> Statement  </pre> </th> <td></td>" << ENDL;
+    //htmlFile << "<th colspan = 10> <pre> Branch     </pre> </th> <td></td>" << ENDL;
+    //htmlFile << "<th colspan = 10> <pre> MC/DC      </pre> </th> <td></td>" << ENDL;
+    htmlFile << "<th width=" << summaryCnt << "%> Function </th> <td></td>" << ENDL;
     if (doStmtSingle || doStmtCount)
     {
-      htmlFile << "<th width=" << coverageCnt << "%> Statement </th> <td></td>" << ENDL;
+      htmlFile << "<th width=" << summaryCnt << "%> Statement </th> <td></td>" << ENDL;
     }
     if (doBranch)
     {
-      htmlFile << "<th width=" << coverageCnt << "%> Branch </th> <td></td>" << ENDL;
+      htmlFile << "<th width=" << summaryCnt << "%> Branch </th> <td></td>" << ENDL;
     }
     if (doMCDC)
     {
-      htmlFile << "<th width=" << coverageCnt << "%> MC/DC </th> <td></td>" << ENDL;
+      htmlFile << "<th width=" << summaryCnt << "%> MC/DC </th> <td></td>" << ENDL;
     }
     if (doCC)
     {
-      htmlFile << "<th width=" << coverageCnt << "%> Condition </th> <td></td>" << ENDL;
+      htmlFile << "<th width=" << summaryCnt << "%> Condition </th> <td></td>" << ENDL;
     }
     htmlFile << "</tr>" << ENDL;
     htmlFile << "<tr></tr>" << ENDL;
     htmlFile << "<tr></tr>" << ENDL;
 
-    htmlFile << "<tr>" << ENDL;
-
-    if (doStmtSingle || doStmtCount)
+    for (int i = 0; i < db.functionInfo.size(); i++)
     {
-      htmlFile << "<td width=" << coverageCnt << "% style=\"white-space:nowrap\"> ";
+      string func = db.functionInfo[i].function;
 
-      if (db.totalStmtCount)
-      {
-        int coveragePercent = (1000 * newStmtCoveredCount / 
-                                      db.totalStmtCount + 5) / 10;
-        htmlFile << "<div id=\"new_stmt_percent\">" <<
-                    "<div id=\"new_stmt_percent_in\">" <<
-                    coveragePercent << "% <font size=\"1\">&nbsp;&nbsp;(" <<
-                    newStmtCoveredCount << " / " <<
-                    db.totalStmtCount <<
-                    ")</font></div></div> </td> <td></td>" << ENDL;
-      }
-      else
+      htmlFile << "<tr>" << ENDL;
+      htmlFile << "<td width=" << summaryCnt << "%> <center> <a href='" <<
+                  (htmlPageCount ? htmlPageName(htmlFuncPage[i], false) : "") <<
+                  "#func_" << func << "'> " << func <<
+                  "</a> </center> </td> <td> </td>" << ENDL;
+
+      if (doStmtSingle || doStmtCount)
       {
-        htmlFile << "<center> No Statements </center>" <<
-                    " </td> <td></td>" << ENDL;
+        htmlFile << "<td width=" << summaryCnt << "% style=\"white-space:nowrap\"> ";
+
+        if (db.functionStmtCount[i])
+        {
+          int coveragePercent = (1000 * functionStmtCoverageCount[i] / 
+                                        db.functionStmtCount[i] + 5) / 10;
+          htmlFile << "<div id=\"" << func << "_stmt_percent\">" <<
+                      "<div id=\"" << func << "_stmt_percent_in\">" <<
+                      coveragePercent << "% <font size=\"1\">&nbsp;&nbsp;(" <<
+                      functionStmtCoverageCount[i] << " / " <<
+                      db.functionStmtCount[i] <<
+                      ")</font></div></div> </td> <td></td>" << ENDL;
+        }
+        else
+        {
+          htmlFile << "<center> No Statements </center>" <<
+                      " </td> <td></td>" << ENDL;
+        }
       }
 
-      if (db.generateReport)
+      if (doBranch)
       {
-        rptFile << db.reportSeparator << newStmtCoveredCount <<
-                   db.reportSeparator << db.totalStmtCount;
-      }
-    }
-
-    if (doBranch)
-    {
-      htmlFile << "<td width=" << coverageCnt << "% style=\"white-space:nowrap\"> ";
+        htmlFile << "<td width=" << summaryCnt << "% style=\"white-space:nowrap\"> ";
 
-      if (branchTotalOperandCount)
-      {
-        int coveragePercent = (1000 * newBranchCoveredCount / 
-                                      branchTotalOperandCount + 5) / 10;
-        htmlFile << "<div id=\"new_branch_percent\">" <<
-                    "<div id=\"new_branch_percent_in\">" <<
-                    coveragePercent << "% <font size=\"1\">&nbsp;&nbsp;(" <<
-                    newBranchCoveredCount << " / " <<
-                    branchTotalOperandCount <<
-                    ")</font></div></div> </td> <td></td>" << ENDL;
+        if (branchFunctionOperandCount[i])
+        {
+          int coveragePercent = (1000 * branchFunctionCoverageCount[i] / 
+                                        branchFunctionOperandCount[i] + 5) / 10;
+          htmlFile << "<div id=\"" << func << "_branch_percent\">" <<
+                      "<div id=\"" << func << "_branch_percent_in\">" <<
+                      coveragePercent << "% <font size=\"1\">&nbsp;&nbsp;(" <<
+                      branchFunctionCoverageCount[i] << " / " <<
+                      branchFunctionOperandCount[i] <<
+                      ")</font></div></div> </td> <td></td>" << ENDL;
+        }
+        else
+        {
+          htmlFile << "<center> No Branches </center>" <<
+                      " </td> <td></td>" << ENDL;
+        }
       }
-      else
+
+      if (doMCDC)
       {
-        htmlFile << "<center>   No Branches  </center>" <<
-                    " </td> <td></td>" << ENDL;
+        htmlFile << "<td width=" << summaryCnt << "% style=\"white-space:nowrap\"> ";
+
+        if (mcdcFunctionOperandCount[i])
+        {
+          int coveragePercent = (1000 * mcdcFunctionCoverageCount[i] / 
+                                        mcdcFunctionOperandCount[i] + 5) / 10;
+          htmlFile << "<div id=\"" << func << "_mcdc_percent\">" <<
+                      "<div id=\"" << func << "_mcdc_percent_in\">" <<
+                      coveragePercent << "% <font size=\"1\">&nbsp;&nbsp;(" <<
+                      mcdcFunctionCoverageCount[i] << " / " <<
+                      mcdcFunctionOperandCount[i] <<
+                      ")</font></div></div> </td> <td></td>" << ENDL;
+        }
+        else
+        {
+          htmlFile << "<center> No MC/DC Exprs </center>" <<
+                      " </td> <td></td>" << ENDL;
+        }
       }
 
-      if (db.generateReport)
+      if (doCC)
       {
-        rptFile << db.reportSeparator << newBranchCoveredCount <<
-                   db.reportSeparator << branchTotalOperandCount;
+        htmlFile << "<td width=" << summaryCnt << "% style=\"white-space:nowrap\"> ";
+
+        if (condFunctionOperandCount[i])
+        {
+          int coveragePercent = (1000 * condFunctionCoverageCount[i] / 
+                                        condFunctionOperandCount[i] + 5) / 10;
+          htmlFile << "<div id=\"" << func << "_cond_percent\">" <<
+                      "<div id=\"" << func << "_cond_percent_in\">" <<
+                      coveragePercent << "% <font size=\"1\">&nbsp;&nbsp;(" <<
+                      condFunctionCoverageCount[i] << " / " <<
+                      condFunctionOperandCount[i] <<
+                      ")</font></div></div> </td> <td></td>" << ENDL;
+        }
+        else
+        {
+          htmlFile << "<center> No Conditions  </center>" <<
+                      " </td> <td></td>" << ENDL;
+        }
       }
+
+      htmlFile << "</tr>" << ENDL;
+      //htmlFile << "</td></tr>" << ENDL;
+      //htmlFile << "</table></table>" << ENDL;
     }
 
-    if (doMCDC)
+    htmlFile << "</table>" << ENDL;
+    htmlFile << "<br /><br />" << ENDL;
+
+    if (db.combineHistory)
     {
-      htmlFile << "<td width=" << coverageCnt << "% style=\"white-space:nowrap\"> ";
+      // Display summary of results of new coverage
+      htmlFile << "<h3><center>Summary of New Coverage for " <<
+                  db.fileName << "</center></h3>" << ENDL;
 
-      if (mcdcTotalOperandCount)
+      htmlFile << "<table border rules=none frame=box bgcolor=\"#d0d0d0\" " <<
+                  "width=60% align=\"center\">" << ENDL;
+      if (doStmtSingle || doStmtCount)
       {
-        int coveragePercent = (1000 * mcdcNewCoverCount / 
-                                      mcdcTotalOperandCount + 5) / 10;
-        htmlFile << "<div id=\"new_mcdc_percent\">" <<
-                    "<div id=\"new_mcdc_percent_in\">" <<
-                    coveragePercent << "% <font size=\"1\">&nbsp;&nbsp;(" <<
-                    mcdcNewCoverCount << " / " <<
-                    mcdcTotalOperandCount <<
-                    ")</font></div></div> </td> <td></td>" << ENDL;
+        htmlFile << "<th width=" << coverageCnt << "%> Statement </th> <td></td>" << ENDL;
       }
-      else
+      if (doBranch)
       {
-        htmlFile << "<center> No MC/DC Exprs </center>" <<
-                    " </td> <td></td>" << ENDL;
+        htmlFile << "<th width=" << coverageCnt << "%> Branch </th> <td></td>" << ENDL;
       }
-
-      if (db.generateReport)
+      if (doMCDC)
       {
-        rptFile << db.reportSeparator << mcdcNewCoverCount <<
-                   db.reportSeparator << mcdcTotalOperandCount;
+        htmlFile << "<th width=" << coverageCnt << "%> MC/DC </th> <td></td>" << ENDL;
       }
-    }
+      if (doCC)
+      {
+        htmlFile << "<th width=" << coverageCnt << "%> Condition </th> <td></td>" << ENDL;
+      }
+      htmlFile << "</tr>" << ENDL;
+      htmlFile << "<tr></tr>" << ENDL;
+      htmlFile << "<tr></tr>" << ENDL;
 
-    if (doCC)
-    {
-      htmlFile << "<td width=" << coverageCnt << "% style=\"white-space:nowrap\"> ";
+      htmlFile << "<tr>" << ENDL;
 
-      if (condTotalOperandCount)
+      if (doStmtSingle || doStmtCount)
       {
-        int coveragePercent = (1000 * newCondCoveredCount / 
-                                      condTotalOperandCount + 5) / 10;
-        htmlFile << "<div id=\"new_cond_percent\">" <<
-                    "<div id=\"new_cond_percent_in\">" <<
-                    coveragePercent << "% <font size=\"1\">&nbsp;&nbsp;(" <<
-                    newCondCoveredCount << " / " <<
-                    condTotalOperandCount <<
-                    ")</font></div></div> </td> <td></td>" << ENDL;
+        htmlFile << "<td width=" << coverageCnt << "% style=\"white-space:nowrap\"> ";
+
+        if (db.totalStmtCount)
+        {
+          int coveragePercent = (1000 * newStmtCoveredCount / 
+                                        db.totalStmtCount + 5) / 10;
+          htmlFile << "<div id=\"new_stmt_percent\">" <<
+                      "<div id=\"new_stmt_percent_in\">" <<
+                      coveragePercent << "% <font size=\"1\">&nbsp;&nbsp;(" <<
+                      newStmtCoveredCount << " / " <<
+                      db.totalStmtCount <<
+                      ")</font></div></div> </td> <td></td>" << ENDL;
+        }
+        else
+        {
+          htmlFile << "<center> No Statements </center>" <<
+                      " </td> <td></td>" << ENDL;
+        }
       }
-      else
+
+      if (doBranch)
       {
-        htmlFile << "<center> No Conditions  </center>" <<
-                    " </td> <td></td>" << ENDL;
+        htmlFile << "<td width=" << coverageCnt << "% style=\"white-space:nowrap\"> ";
+
+        if (branchTotalOperandCount)
+        {
+          int coveragePercent = (1000 * newBranchCoveredCount / 
+                                        branchTotalOperandCount + 5) / 10;
+          htmlFile << "<div id=\"new_branch_percent\">" <<
+                      "<div id=\"new_branch_percent_in\">" <<
+                      coveragePercent << "% <font size=\"1\">&nbsp;&nbsp;(" <<
+                      newBranchCoveredCount << " / " <<
+                      branchTotalOperandCount <<
+                      ")</font></div></div> </td> <td></td>" << ENDL;
+        }
+        else
+        {
+          htmlFile << "<center>   No Branches  </center>" <<
+                      " </td> <td></td>" << ENDL;
+        }
       }
 
-      if (db.generateReport)
+      if (doMCDC)
       {
-        rptFile << db.reportSeparator << newCondCoveredCount <<
-                   db.reportSeparator << condTotalOperandCount;
+        htmlFile << "<td width=" << coverageCnt << "% style=\"white-space:nowrap\"> ";
+
+        if (mcdcTotalOperandCount)
+        {
+          int coveragePercent = (1000 * mcdcNewCoverCount / 
+                                        mcdcTotalOperandCount + 5) / 10;
+          htmlFile << "<div id=\"new_mcdc_percent\">" <<
+                      "<div id=\"new_mcdc_percent_in\">" <<
+                      coveragePercent << "% <font size=\"1\">&nbsp;&nbsp;(" <<
+                      mcdcNewCoverCount << " / " <<
+                      mcdcTotalOperandCount <<
+                      ")</font></div></div> </td> <td></td>" << ENDL;
+        }
+        else
+        {
+          htmlFile << "<center> No MC/DC Exprs </center>" <<
+                      " </td> <td></td>" << ENDL;
+        }
       }
-    }
 
-    htmlFile << "</table>" << ENDL;
-    htmlFile << "<br /><br />" << ENDL;
+      if (doCC)
+      {
+        htmlFile << "<td width=" << coverageCnt << "% style=\"white-space:nowrap\"> ";
 
-    if (db.generateReport)
-    {
-      rptFile << ENDL;
+        if (condTotalOperandCount)
+        {
+          int coveragePercent = (1000 * newCondCoveredCount / 
+                                        condTotalOperandCount + 5) / 10;
+          htmlFile << "<div id=\"new_cond_percent\">" <<
+                      "<div id=\"new_cond_percent_in\">" <<
+                      coveragePercent << "% <font size=\"1\">&nbsp;&nbsp;(" <<
+                      newCondCoveredCount << " / " <<
+                      condTotalOperandCount <<
+                      ")</font></div></div> </td> <td></td>" << ENDL;
+        }
+        else
+        {
+          htmlFile << "<center> No Conditions  </center>" <<
+                      " </td> <td></td>" << ENDL;
+        }
+      }
+
+      htmlFile << "</table>" << ENDL;
+      htmlFile << "<br /><br />" << ENDL;
     }
   }
 
   // Display results for each function
   vector<functionInfoType>::iterator func = db.functionInfo.begin();
-  vector<string>::iterator mcdcFuncHTML = mcdcHTMLInfo.begin();
-  vector<string>::iterator condFuncHTML = condHTMLInfo.begin();
-  vector<string>::iterator branchFuncHTML = branchHTMLInfo.begin();
+  mcdcHTMLInfo.rewind();
+  condHTMLInfo.rewind();
+  branchHTMLInfo.rewind();
   int lineColor = 0;
   int sourceColor = 0;
   int nextSourceColor = 0;
@@ -4958,12 +6712,79 @@ CDBG << "While: " << loopLine << ", " << loopCol << ENDL;
     }
   }
 
+  if (htmlPageCount)
+  {
+    // Finish summary with a list of the pages holding the source
+    htmlFile << "<h3><center>Source Pages for " << db.fileName <<
+                "</center></h3>" << ENDL;
+    htmlFile << "<table border rules=none frame=box bgcolor=\"#d0d0d0\" " <<
+                "width=60% align=\"center\">" << ENDL;
+
+    for (int first = 0; first < db.functionInfo.size(); )
+    {
+      int page = htmlFuncPage[first];
+      int last = first;
+      while ((last + 1 < db.functionInfo.size()) &&
+             (htmlFuncPage[last + 1] == page))
+        ++last;
+
+      htmlFile << "<tr><td> <a href='" << htmlPageName(page, false) <<
+                  "'>Page " << (page + 1) << "</a> </td><td> Lines " <<
+                  db.functionInfo[first].loc.lhsLine << " - " <<
+                  db.functionInfo[last].loc.rhsLine << " </td><td> " <<
+                  db.functionInfo[first].function;
+      if (last > first)
+        htmlFile << " ... " << db.functionInfo[last].function;
+      htmlFile << " </td></tr>" << ENDL;
+
+      first = last + 1;
+    }
+
+    htmlFile << "</table>" << ENDL;
+  }
+
+  int curPage = -1;
   while (func < db.functionInfo.end())
   {
+    int funcNum = func - db.functionInfo.begin();
+    if (htmlPageCount && (htmlFuncPage[funcNum] != curPage))
+    {
+      // Close summary or previous page and start the next page
+      if (curPage >= 0)
+        genHTMLPageNav(htmlFile, curPage);
+      htmlFile << "  </body>" << ENDL;
+      htmlFile << "</html>" << ENDL;
+      htmlFile.close();
+
+      curPage = htmlFuncPage[funcNum];
+      string pageName = htmlPageName(curPage, true);
+      htmlFile.clear();
+      htmlFile.open(pageName.c_str());
+      reportOutputs.push_back(pageName);
+
+      htmlFile << "<!DOCTYPE html>" << ENDL;
+      htmlFile << "<html lang=\"en\">" << ENDL;
+      htmlFile << "  <head>" << ENDL;
+      htmlFile << "  <meta charset=\"utf-8\"/>" << ENDL;
+      htmlFile << "    <title>" << db.fileName << " Coverage Report Page " <<
+                  (curPage + 1) << " of " << htmlPageCount << "</title>" << ENDL;
+      if (db.compactHtml)
+        genCompactHTMLHead(htmlFile, "../");
+      htmlFile << "  </head>" << ENDL;
+      htmlFile << "  <body>" << ENDL;
+      htmlFile << "    <h2 align=\"center\">" << db.fileName <<
+                  " Coverage Report - Page " << (curPage + 1) << " of " <<
+                  htmlPageCount << "</h2>" << ENDL;
+      genHTMLPageNav(htmlFile, curPage);
+    }
+
     ostringstream htmlLine;
     ostringstream htmlSrcLine;
     ostringstream htmlSource;
     ostringstream htmlNew;
+    ostringstream compactRows;   // Rows of a compact report
+    int compactRowCnt = 0;
+    CompactRow compactRow;
 
     // Display function source code with highlights for statement and
     // branch coverage
@@ -4971,33 +6792,39 @@ CDBG << "While: " << loopLine << ", " << loopCol << ENDL;
     int srcLine;
     for (int line = func->loc.lhsLine; line <= func->loc.rhsLine; line++)
     {
-      while (gotPPMap && ((mapIndex + 1) < mapInfo.size()) && (line >= mapInfo[mapIndex + 1].ppSrcLine))
-      {
-        ++mapIndex;
-      }
       char lineNum[64];
       char srcLineNum[64];
       sprintf(lineNum, "<a name=\"line_%d\"></a>%5d", line, line);
+      int rowLine = line;     // Line numbers for compact report row
+      int rowSrcLine = 0;
       if (gotPPMap)
       {
-          srcLine = line - mapInfo[mapIndex].ppSrcLine + mapInfo[mapIndex].srcLine;
-          if (mapInfo[mapIndex].srcLine > 0)
+          srcLine = ppMap.sourceLine(line);
+          if (srcLine > 0)
             sprintf(srcLineNum, "%5d", srcLine);
           else
             sprintf(srcLineNum, "   -");
+          rowSrcLine = (srcLine > 0) ? srcLine : -1;
       }
 
-      while (col <= attribs[line - 1].size())
+      while (col <= attribs.length(line))
       {
-        if (attribs[line - 1][col - 1] & (STMT_NEW_LINE | STMT_NEW_STMT))
+        unsigned char attrib = attribs.get(line, col);
+
+        // Characters up to endCol share the same attributes
+        int endCol = attribs.runEnd(line, col);
+
+        if (attrib & (STMT_NEW_LINE | STMT_NEW_STMT))
         {
+          // Break goes before each flagged character
+          endCol = col;
+
           // Add new line number
           if (lineColor && (doStmtSingle || doStmtCount))
           {
             htmlLine << htmlBgColor(lineColor) << lineNum << "    </span>";
             if (gotPPMap)
                 htmlSrcLine << htmlBgColor(lineColor) << srcLineNum << "    </span>";
-
           }
           else
           {
@@ -5011,38 +6838,62 @@ CDBG << "While: " << loopLine << ", " << loopCol << ENDL;
               htmlSrcLine << ENDL;
           htmlSource << ENDL;
           htmlNew << ENDL;
+          if (db.compactHtml)
+          {
+            if (compactRowCnt++)
+              compactRows << ",";
+            compactRows << "[" << rowLine << "," << rowSrcLine << "," <<
+                           ((doStmtSingle || doStmtCount) ?
+                            htmlColorCode(lineColor) : 0) << "," <<
+                           compactRow.str() << ",[]]";
+          }
           lineColor = 0;
           oldLineCovered = false;
           newLineCovered = false;
           sprintf(lineNum, "   + ");
           sprintf(srcLineNum, "   + ");
+          rowLine = 0;
+          rowSrcLine = 0;
         }
 
-        //if ((lineColor == 0) && (attribs[line - 1][col - 1] & STMT_CODE))
-        if (attribs[line - 1][col - 1] & STMT_CODE)
+        //if ((lineColor == 0) && (attrib & STMT_CODE))
+        if (attrib & STMT_CODE)
         {
-          if (attribs[line - 1][col - 1] & STMT_COVERED)
+          if (attrib & STMT_COVERED)
           {
             if (doStmtCount)
             {
-              while ((line > db.instInfo[whichStmt].line) ||
-                     ((line == db.instInfo[whichStmt].line) &&
-                      (col >= db.instInfo[whichStmt].col)))
+              // Step through the run, stopping at any for/while loop
+              // starting within it
+              int scanCol = col;
+              bool atLoop;
+              do
               {
-                curStmtCount = hist.covCntInfo[whichStmt++];
+                atLoop = (line == loopLine) &&
+                         (loopCol >= scanCol) && (loopCol <= endCol);
+                int stmtCol = atLoop ? loopCol : endCol;
+
+                while ((line > db.instInfo[whichStmt].line) ||
+                       ((line == db.instInfo[whichStmt].line) &&
+                        (stmtCol >= db.instInfo[whichStmt].col)))
+                {
+                  curStmtCount = hist.covCntInfo[whichStmt++];
 #ifdef VAMP_DEBUG
-CDBG << "Line: " << line << ", " << col << "; Statement: " << whichStmt << ", Count = " << curStmtCount << ENDL;
+CDBG << "Line: " << line << ", " << stmtCol << "; Statement: " << whichStmt << ", Count = " << curStmtCount << ENDL;
 #endif
-              }
+                }
+
+                if (!atLoop)
+                  break;
+
+                scanCol = stmtCol + 1;
 
-              if ((line == loopLine) && (col == loopCol))
-              {
                 // Handle for/while loops by adding the previous count and
                 // next count
                 curStmtCount = hist.covCntInfo[whichStmt - 1] +
                                hist.covCntInfo[whichStmt];
 #ifdef VAMP_DEBUG
-CDBG << "Modified Line: " << line << ", " << col << "; Statement: " << whichStmt << ", Count = " << curStmtCount << ENDL;
+CDBG << "Modified Line: " << line << ", " << stmtCol << "; Statement: " << whichStmt << ", Count = " << curStmtCount << ENDL;
 CDBG << "Modified Line counts: " << hist.covCntInfo[whichStmt - 1] << " + " <<  hist.covCntInfo[whichStmt] << ENDL;
 #endif
 
@@ -5077,16 +6928,16 @@ CDBG << "While: " << loopLine << ", " << loopCol << ENDL;
 #endif
                   }
                 }
-              }
+              } while (atLoop);
             }
 
             lineColor = BG_GREEN;  // Color line number green
 
             if (db.combineHistory)
             {
-              if (attribs[line - 1][col - 1] & STMT_COVERED_OLD)
+              if (attrib & STMT_COVERED_OLD)
                 oldLineCovered = true;
-              if (attribs[line - 1][col - 1] & STMT_COVERED_NEW)
+              if (attrib & STMT_COVERED_NEW)
                 newLineCovered = true;
             }
             else
@@ -5095,18 +6946,17 @@ CDBG << "While: " << loopLine << ", " << loopCol << ENDL;
               newLineCovered = true;
             }
 
-            if ((attribs[line - 1][col - 1] & STMT_BR_COV_FULL) ==
-                                              STMT_BR_COV_FULL)
+            if ((attrib & STMT_BR_COV_FULL) == STMT_BR_COV_FULL)
             {
               nextSourceColor = BG_GREEN;  // Color condition green
             }
             else
-            if (attribs[line - 1][col - 1] & STMT_BR_COV_TRUE)
+            if (attrib & STMT_BR_COV_TRUE)
             {
               nextSourceColor = BG_YELLOW;  // Color condition yellow
             }
             else
-            if (attribs[line - 1][col - 1] & STMT_BR_COV_FALSE)
+            if (attrib & STMT_BR_COV_FALSE)
             {
               nextSourceColor = BG_ORANGE;  // Color condition orange
             }
@@ -5129,27 +6979,37 @@ CDBG << "While: " << loopLine << ", " << loopCol << ENDL;
           nextSourceColor = 0;    // Remove color
         }
 
-        if (nextSourceColor != sourceColor)
+        if (db.compactHtml)
+        {
+          compactRow.add(nextSourceColor,
+                         source[line - 1].substr(col - 1, endCol - col + 1));
+        }
+        else
         {
-          if (sourceColor)
+          if (nextSourceColor != sourceColor)
           {
-            // End old color
-            htmlSource << "</span>";
-          }
+            if (sourceColor)
+            {
+              // End old color
+              htmlSource << "</span>";
+            }
 
-          if (nextSourceColor)
-          {
-            htmlSource << htmlBgColor(nextSourceColor);
+            if (nextSourceColor)
+            {
+              htmlSource << htmlBgColor(nextSourceColor);
+            }
+
+            sourceColor = nextSourceColor;
           }
 
-          sourceColor = nextSourceColor;
+          htmlSource << source[line - 1].substr(col - 1, endCol - col + 1);
         }
-
-        htmlSource << source[line - 1][col - 1];
-        ++col;
+        col = endCol + 1;
       }
 
       // Add line number
+      ostringstream compactCov;   // Coverage column of compact report row
+      int rowColor = (doStmtSingle || doStmtCount) ? htmlColorCode(lineColor) : 0;
       if (lineColor && (doStmtSingle || doStmtCount))
       {
         htmlLine << htmlBgColor(lineColor) << lineNum << "    </span>";
@@ -5186,6 +7046,11 @@ CDBG << "While: " << loopLine << ", " << loopCol << ENDL;
           else
             htmlNew << htmlBgColor(BG_RED) << "--";
           htmlNew << "</span>";
+
+          compactCov << (oldLineCovered ? 1 : 0) << "," <<
+                        (newLineCovered ?
+                         (doStmtCount ? (long long) curStmtCount : 1LL) : -1LL) <<
+                        "," << ((lineColor == BG_GREEN) ? 1 : 0);
         }
         else
         if (doStmtCount)
@@ -5200,6 +7065,8 @@ CDBG << "While: " << loopLine << ", " << loopCol << ENDL;
           else
             htmlNew << htmlBgColor(BG_RED) << "--";
           htmlNew << "</span>   ";
+
+          compactCov << (newLineCovered ? (long long) curStmtCount : -1LL);
         }
         lineColor = 0;
         oldLineCovered = false;
@@ -5217,148 +7084,129 @@ CDBG << "While: " << loopLine << ", " << loopCol << ENDL;
           htmlSrcLine << ENDL;
       htmlSource << ENDL;
       htmlNew << ENDL;
+      if (db.compactHtml)
+      {
+        if (compactRowCnt++)
+          compactRows << ",";
+        compactRows << "[" << rowLine << "," << rowSrcLine << "," <<
+                       rowColor << "," << compactRow.str() << ",[" <<
+                       compactCov.str() << "]]";
+      }
       col = 1;
     }
 
-    //htmlFile << "      <table bgcolor=\"#d0d0d0\" border=\"1\" align=\"center\">" << ENDL;
-    //htmlFile << "      <table bgcolor=\"#e0ffff\" border=\"1\" align=\"center\">" << ENDL;
-    htmlFile << "      <table bgcolor=\"#e0efff\" border=\"1\" align=\"center\">" << ENDL;
-    htmlFile << "    <tr>" << ENDL;
-    htmlFile << "      <td align=\"center\">" << ENDL;
-    htmlFile << "        <pre><b>Preproc\nLine:</b></pre>" << ENDL;
-    htmlFile << "      </td>" << ENDL;
-    if (gotPPMap)
+    if (db.compactHtml)
     {
-        htmlFile << "      <td align=\"center\">" << ENDL;
-        htmlFile << "        <pre><b>Source\nLine:</b></pre>" << ENDL;
-        htmlFile << "      </td>" << ENDL;
+      // Source, coverage and detail tables are rendered by the report
+      // script
+      htmlFile << "      <div id=\"vf_" << funcNum << "\"></div>" << ENDL;
+      htmlFile << "      <script>vampFunc(" << funcNum << ", " <<
+                  jsString(func->function) << ", [" << compactRows.str() <<
+                  "], [";
+      if (doBranch)
+        branchHTMLInfo.copyNext(htmlFile);
+      htmlFile << "], [";
+      if (doMCDC)
+        mcdcHTMLInfo.copyNext(htmlFile);
+      htmlFile << "], [";
+      if (doCC)
+        condHTMLInfo.copyNext(htmlFile);
+      htmlFile << "]);</script>" << ENDL;
     }
-    htmlFile << "      <td align=\"center\">" << ENDL;
-    htmlFile << "    <a name=\"func_" << func->function << "\"></a>" << ENDL;
-    htmlFile << "    <b><font size=\"6\">Function: " <<
-                func->function << "</font></b>" << ENDL;
-    htmlFile << "      </td>" << ENDL;
-    if (db.combineHistory && (doStmtSingle || doStmtCount))
+    else
     {
+      //htmlFile << "      <table bgcolor=\"#d0d0d0\" border=\"1\" align=\"center\">" << ENDL;
+      //htmlFile << "      <table bgcolor=\"#e0ffff\" border=\"1\" align=\"center\">" << ENDL;
+      htmlFile << "      <table bgcolor=\"#e0efff\" border=\"1\" align=\"center\">" << ENDL;
+      htmlFile << "    <tr>" << ENDL;
       htmlFile << "      <td align=\"center\">" << ENDL;
-      htmlFile << "   <pre><b>Stmt Count\nPrev Curr Comb\nRuns Run  Runs</b></pre>" << ENDL;
+      htmlFile << "        <pre><b>Preproc\nLine:</b></pre>" << ENDL;
       htmlFile << "      </td>" << ENDL;
-    }
-    else
-    if (doStmtCount)
-    {
+      if (gotPPMap)
+      {
+          htmlFile << "      <td align=\"center\">" << ENDL;
+          htmlFile << "        <pre><b>Source\nLine:</b></pre>" << ENDL;
+          htmlFile << "      </td>" << ENDL;
+      }
       htmlFile << "      <td align=\"center\">" << ENDL;
-      htmlFile << "   <pre>Stmt\nCount</pre>" << ENDL;
+      htmlFile << "    <a name=\"func_" << func->function << "\"></a>" << ENDL;
+      htmlFile << "    <b><font size=\"6\">Function: " <<
+                  func->function << "</font></b>" << ENDL;
       htmlFile << "      </td>" << ENDL;
-    }
-    htmlFile << "    </tr>" << ENDL;
-    htmlFile << "      <td>" << ENDL;
-    htmlFile << "        <pre>" << ENDL;
-    htmlFile << htmlLine.str();
-    htmlFile << "        </pre>" << ENDL;
-    htmlFile << "      </td>" << ENDL;
-    if (gotPPMap)
-    {
-        htmlFile << "      <td>" << ENDL;
-        htmlFile << "        <pre>" << ENDL;
-        htmlFile << htmlSrcLine.str();
-        htmlFile << "        </pre>" << ENDL;
+      if (db.combineHistory && (doStmtSingle || doStmtCount))
+      {
+        htmlFile << "      <td align=\"center\">" << ENDL;
+        htmlFile << "   <pre><b>Stmt Count\nPrev Curr Comb\nRuns Run  Runs</b></pre>" << ENDL;
         htmlFile << "      </td>" << ENDL;
-    }
-    htmlFile << "      <td>" << ENDL;
-    htmlFile << "        <pre>" << ENDL;
-    htmlFile << htmlSource.str();
-    htmlFile << "        </pre>" << ENDL;
-    htmlFile << "      </td>" << ENDL;
-    //if (db.combineHistory && (doStmtSingle || doStmtCount))
-    if (doStmtCount || (db.combineHistory && doStmtSingle))
-    {
-      //htmlFile << "      <td>" << ENDL;
-      htmlFile << "      <td align=\"center\">" << ENDL;
+      }
+      else
+      if (doStmtCount)
+      {
+        htmlFile << "      <td align=\"center\">" << ENDL;
+        htmlFile << "   <pre>Stmt\nCount</pre>" << ENDL;
+        htmlFile << "      </td>" << ENDL;
+      }
+      htmlFile << "    </tr>" << ENDL;
+      htmlFile << "      <td>" << ENDL;
       htmlFile << "        <pre>" << ENDL;
-      htmlFile << htmlNew.str();
+      htmlFile << htmlLine.str();
       htmlFile << "        </pre>" << ENDL;
       htmlFile << "      </td>" << ENDL;
-    }
-    htmlFile << "      </table>" << ENDL;
+      if (gotPPMap)
+      {
+          htmlFile << "      <td>" << ENDL;
+          htmlFile << "        <pre>" << ENDL;
+          htmlFile << htmlSrcLine.str();
+          htmlFile << "        </pre>" << ENDL;
+          htmlFile << "      </td>" << ENDL;
+      }
+      htmlFile << "      <td>" << ENDL;
+      htmlFile << "        <pre>" << ENDL;
+      htmlFile << htmlSource.str();
+      htmlFile << "        </pre>" << ENDL;
+      htmlFile << "      </td>" << ENDL;
+      //if (db.combineHistory && (doStmtSingle || doStmtCount))
+      if (doStmtCount || (db.combineHistory && doStmtSingle))
+      {
+        //htmlFile << "      <td>" << ENDL;
+        htmlFile << "      <td align=\"center\">" << ENDL;
+        htmlFile << "        <pre>" << ENDL;
+        htmlFile << htmlNew.str();
+        htmlFile << "        </pre>" << ENDL;
+        htmlFile << "      </td>" << ENDL;
+      }
+      htmlFile << "      </table>" << ENDL;
 
-    htmlFile << "      <br clear=\"left\" />" << ENDL;
-    htmlFile << "      <pre>" << ENDL;
+      htmlFile << "      <br clear=\"left\" />" << ENDL;
+      htmlFile << "      <pre>" << ENDL;
 
-    if (doBranch)
-    {
-      htmlFile << *branchFuncHTML;
-    }
+      if (doBranch)
+      {
+        branchHTMLInfo.copyNext(htmlFile);
+      }
 
-    if (doMCDC)
-    {
-      htmlFile << *mcdcFuncHTML;
-    }
+      if (doMCDC)
+      {
+        mcdcHTMLInfo.copyNext(htmlFile);
+      }
 
-    if (doCC)
-    {
-      htmlFile << *condFuncHTML;
-    }
+      if (doCC)
+      {
+        condHTMLInfo.copyNext(htmlFile);
+      }
 
-    htmlFile << "      </pre>" << ENDL;
+      htmlFile << "      </pre>" << ENDL;
+    }
 
     htmlLine.str("");
     htmlSrcLine.str("");
     htmlSource.str("");
     ++func;
-
-    if (doMCDC)
-    {
-      ++mcdcFuncHTML;
-    }
-
-    if (doCC)
-    {
-      ++condFuncHTML;
-    }
-    ++branchFuncHTML;
   }
 
+  if (curPage >= 0)
+    genHTMLPageNav(htmlFile, curPage);
   htmlFile << "  </body>" << ENDL;
   htmlFile << "</html>" << ENDL;
   htmlFile.close();
-
-  vrptFile << "\n  ]\n}\n";
-  vrptFile.close();
-
-  if (db.generateReport)
-  {
-    rptFile.close();
-  }
-}
-
-#ifndef USE_QT
-int main(int argc, char *argv[])
-{
-  if (argc != 2)
-  {
-    llvm::errs() << "Usage: " << argv[0] << " <JSON file>" << ENDL;
-    return EXIT_FAILURE;
-  }
-
-  ostringstream cfgErr;
-  ConfigFile cf(&cfgErr);
-  VAMP_REPORT_CONFIG vo;
-
-  // FIXME - Parse this before call to processFile and pass resulting vo in
-  if (!cf.ParseReportConfigFile("vamp_process.cfg", vo))
-  {
-      llvm::errs() << "Bad vamp_process.cfg " << cfgErr.str().data() << ENDL;
-  }
-
-  VampProcess vp(&llvm::outs(), &llvm::errs());
-  if (!vp.processFile(argv[1], vo))
-  {
-    llvm::errs() << "Processing " << argv[1] << " failed\n";
-    return EXIT_SUCCESS;
-  }
-
-  return EXIT_FAILURE;
 }
-#endif
-
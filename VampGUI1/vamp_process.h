@@ -19,11 +19,8 @@
 
 //#define NDEBUG
 
-#ifdef USE_QT
-#define VAMP_ERR_STREAM ostringstream
-#else
-#define VAMP_ERR_STREAM llvm::raw_ostream
-#endif
+// Report output can go to any stream, so the engine builds without Qt
+#define VAMP_REPORT_STREAM ostream
 
 #define ENDL "\n"
 
@@ -34,18 +31,24 @@
 #include <sstream>
 #include <string>
 #include <vector>
-#include <bitset>
 #include <iterator>
 #include <sys/stat.h>
 #include <time.h>
 #include <string.h>
+#include <stdio.h>
 #ifdef _WIN32
 #include <io.h>
+#else
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
 #endif
 
 #include "mcdcExprTree.h"
+#include "mcdcSolver.h"
 #include "configfile.h"
 #include "json.h"
+#include "ppmap.h"
 
 // Attributes for source code
 #define STMT_CODE         0x01   // Character is part of a statement
@@ -66,7 +69,19 @@
 #define BG_ORANGE   0xffc000     // Color for background text light orange
 
 #define MAX_COLUMN 128           // Continue statement on new line here
-#define MAX_BITSET 2048          // Max number of MC/DC conditions for expr
+#define MCDC_LOOKUP_OPERANDS 7   // Max operands for MC/DC match lookup table
+
+#define FINGERPRINT_EXT ".vfp"   // Extension of report input fingerprint file
+#define VDB_EXT ".vdb"           // Extension of binary database file
+#define VDB_MAGIC "VDB"          // Tag at start of binary database file
+#define VDB_VERSION 3            // Layout version of binary database file
+#define HTML_PAGE_LINES 5000     // Split larger HTML reports into pages of this many lines
+#define HTML_PAGE_DIR_EXT ".pages" // Extension of directory holding report pages
+#define LCOV_EXT ".info"                  // Extension of LCOV tracefile export
+#define COBERTURA_EXT ".cobertura.xml"    // Extension of Cobertura XML export
+#define JSON_SUMMARY_EXT ".coverage.json" // Extension of JSON coverage export
+#define HEADER_COV_EXT ".vhc"             // Extension of header coverage for merging
+#define VARIANT_COV_EXT ".vvc"            // Extension of source coverage for merging
 
 // Coverage options from history file
 #define DO_STATEMENT_SINGLE 0x01
@@ -80,33 +95,6 @@
 
 using namespace std;
 
-#ifdef USE_IND_PAIR_CLASS
-class indexPairType {
-public:
-  int index;
-  int usageCount;
-
-  bool operator<(const indexPairType& rhs)
-  {
-    return this->usageCount > rhs.usageCount;
-  }
-};
-#else
-typedef struct {
-  int index;
-  int usageCount;
-} indexPairType;
-
-// Defines a sort routine for indexPairType.  Sort on highest usage count.
-struct indexPairCompare {
-  bool operator ()(indexPairType const& a, indexPairType const& b) const
-  {
-    return (a.usageCount > b.usageCount);
-  }
-};
-#endif
-
-
 typedef struct {
   int lhsLine, lhsCol, rhsLine, rhsCol;
 } sourceLocationType;
@@ -116,10 +104,25 @@ typedef struct {
   sourceLocationType loc;
 } functionInfoType;
 
+// Statement outside of any function (external declaration with an
+// initializer). Not reported, but kept so the .json can be rewritten.
+typedef struct {
+  int stmtNum;                   // Index of statement it came before
+  sourceLocationType loc;
+} outsideStmtInfoType;
+
 typedef struct {
   int line, col;
 } instInfoType;
 
+// Input file state recorded in a report fingerprint
+typedef struct {
+  string fileName;
+  long long size;        // File size; -1 if file does not exist
+  long long modTime;     // Modification time of file
+  string hash;           // Hash of file contents
+} fingerprintType;
+
 typedef struct {
   bool andOp;
   sourceLocationType lhsLoc;
@@ -142,11 +145,27 @@ typedef struct {
   int index;
 } branchInfoType;
 
+// MC/DC results for one expression, kept for the exports
+typedef struct {
+  int line;                      // Line expression starts on
+  string operands;               // Operand labels (A, B, ...)
+  vector<unsigned char> senses;  // Per operand, halves of independence
+                                 // pair seen: 1 FALSE, 2 TRUE, 3 both
+} mcdcExportType;
+
+// Branch or condition outcomes on one line, for the exports
+typedef struct {
+  int line;                      // Line decision starts on
+  string type;                   // if, while, for, switch or condition
+  vector<bool> taken;            // Each outcome (TRUE/FALSE or each case)
+} decisionExportType;
+
 typedef struct {
   sourceLocationType ifLoc;
   sourceLocationType elseLoc;
   sourceLocationType exprLoc;
   int branchNum;
+  bool condExpr;                 // From a "cond" (?:) entry, not "if"
 } ifElseInfoType;
 
 typedef struct {
@@ -173,16 +192,21 @@ typedef struct {
 } switchInfoType;
 
 
-// MC/DC independent pair
-typedef struct {
-  unsigned int f, t;
-} mcdcPair;
+// MC/DC condition vector packed with operand n in bit n
+typedef unsigned long long mcdcVecType;
+
+// Labels for each of up to MCDC_MAX_OPERANDS operands in an expression
+#define MCDC_OPERAND_LABELS \
+  "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789#"
+
 
+// Packed table of MC/DC condition vectors. A '-' (don't care) operand
+// has its mask bit cleared. Masks and values are kept in separate arrays
+// so the matching loops run over contiguous data.
 typedef struct {
-    int ppSrcLine;
-    int srcLine;
-    string fileName;
-} mapType;
+  vector<mcdcVecType> mask;
+  vector<mcdcVecType> value;
+} mcdcVectorTable;
 
 // Class to hold Vamp history information
 class History
@@ -190,7 +214,10 @@ class History
 public :
   History();
   ~History();
-  bool loadHistory(string histName, VAMP_ERR_STREAM *vampErr);
+  bool loadHistory(string histName, VAMP_REPORT_STREAM *vampErr);
+  bool loadHexHistory(string hex, VAMP_REPORT_STREAM *vampErr);
+  bool readHistory(istream &in, VAMP_REPORT_STREAM *vampErr);
+  void writeHistory(ostream &out);
 
   unsigned char coverageOptions; // Coverage options
   unsigned char *coveredInfo;    // Instrumented statements covered info
@@ -218,13 +245,18 @@ public :
   VampDB();
 
   void SetVampOptions(VAMP_REPORT_CONFIG &vo);
-  void parseJsonDb(Json &n, VAMP_ERR_STREAM *errStr);
+  void parseJsonDb(Json &n, VAMP_REPORT_STREAM *errStr);
+  static string vdbName(string jsonName);
+  bool saveVdb(string vdbFileName, string jsonName);
+  bool loadVdb(string vdbFileName, string jsonName);
+  void writeJsonDb(ostream &out);
 
-  // Data extracted from .json file
+  // Data extracted from .json (or .vdb) file
   vector<functionInfoType> functionInfo;
   vector<instInfoType> instInfo;
   vector<mcdcExprInfoType> mcdcExprInfo;
   vector<sourceLocationType> statementInfo;
+  vector<outsideStmtInfoType> outsideStmtInfo;
   vector<ifElseInfoType> ifElseInfo;
   vector<whileInfoType> whileInfo;
   vector<forInfoType> forInfo;
@@ -242,14 +274,26 @@ public :
   string instrFileName;          // Name of instrumented file
   string instrPathName;          // Path to instrumented file
   string instrModTime;           // Modification time of instrumented file
+  string preCovered;             // Coverage of probes left out when
+                                 // instrumented (skip_covered), as hex
+                                 // history
   string histDirectory;          // Directory where history files are found
   bool combineHistory;           // Combine history files
   bool outputCombinedHistory;    // Output combined history files
   bool showTestCases;            // Show recommended test cases for coverage
   string htmlDirectory;          // Save directory for html files
   string htmlSuffix;             // Suffix for html files
+  bool compactHtml;              // Render source client-side from coverage data
+  bool generateHtml;             // Write HTML report (.vrpt/.rpt always written)
+  bool exportLcov;               // Write LCOV tracefile
+  bool exportCobertura;          // Write Cobertura XML
+  bool exportJson;               // Write JSON coverage summary
+  bool mergeHeaders;             // Write header coverage for merging across files
+  bool mergeVariants;            // Write source coverage for merging build variants
   bool generateReport;           // Generate report summary
   string reportSeparator;        // String seperating report fields
+  int mcdcSolverNodeLimit;       // Max nodes searched for min MC/DC tests
+  int mcdcSolverTimeLimit;       // Max msec searching for min MC/DC tests
 
 private:
   sourceLocationType getLoc(vector<JsonNode> &n);
@@ -267,6 +311,7 @@ private:
   condInfoType parseConditionElement(Json &json, vector<JsonNode> &n);
   void parseConditionInfo(Json &json, vector<JsonNode> &n);
   void parseMcdcOverflow(Json &json, vector<JsonNode> &n);
+  void clearDb(void);
 
   int functionCount;     // Number of functions in source
   int ifInfoIndex;       // Index into branchInfo for each if statement
@@ -274,46 +319,201 @@ private:
   int forInfoIndex;      // Index into branchInfo for each for statement
   int switchInfoIndex;   // Index into branchInfo for each switch statement
 
-  VAMP_ERR_STREAM *vampErr;
+  VAMP_REPORT_STREAM *vampErr;
 };
 
 
 
+// Read-only view of part of a source line. Points into the SourceBuffer
+// it came from, so it is only valid while that buffer is open.
+class SourceSlice
+{
+public:
+  SourceSlice() : ptr(""), len(0)
+  {
+  }
+  SourceSlice(const char *p, size_t n) : ptr(p), len(n)
+  {
+  }
+  const char *data(void) const { return ptr; }
+  size_t length(void) const { return len; }
+  // Like string, reading one past the end gives a null character
+  char operator[](size_t i) const { return (i < len) ? ptr[i] : 0; }
+  SourceSlice substr(size_t pos, size_t n = string::npos) const;
+  size_t rfind(char ch, size_t pos = string::npos) const;
+  string str(void) const { return string(ptr, len); }
+
+private:
+  const char *ptr;
+  size_t len;
+};
+
+inline ostream &operator<<(ostream &out, const SourceSlice &slice)
+{
+  return out.write(slice.data(), slice.length());
+}
+
+// Source file mapped into memory once, with the offset of each line.
+// Lines are split as getline() would, so the last line is empty if the
+// file ends with a newline.
+class SourceBuffer
+{
+public:
+  SourceBuffer() : buf(NULL), bufSize(0), mapped(false)
+  {
+  }
+  ~SourceBuffer()
+  {
+    close();
+  }
+  bool open(string fileName);
+  void close(void);
+  int size(void) { return lineStart.size(); }
+  SourceSlice operator[](int i);
+
+private:
+  SourceBuffer(const SourceBuffer &);
+  SourceBuffer &operator=(const SourceBuffer &);
+
+  const char *buf;
+  size_t bufSize;
+  bool mapped;              // buf is mmap'd rather than held in text
+  string text;              // File contents if not mapped
+  vector<size_t> lineStart; // Offset of start of each line
+};
+
+// Run of source characters sharing the same attributes.
+// Covers columns from col up to the start of the next run.
+typedef struct {
+  int col;
+  unsigned char attrib;
+} attribRunType;
+
+// Source code attributes, held per line as sorted runs rather than
+// one attribute byte per character. A line with no runs is all zero.
+class AttribMap
+{
+public:
+  void addLine(int length);
+  int size(void) { return lineLength.size(); }
+  int length(int line) { return lineLength[line - 1]; }
+  unsigned char get(int line, int col);
+  int runEnd(int line, int col);
+  void set(int line, int fromCol, int toCol,
+           unsigned char attrib, unsigned char require = 0);
+  string str(int line);
+
+private:
+  int split(int line, int col);
+
+  vector<int> lineLength;
+  vector< vector<attribRunType> > lineRuns;
+};
+
+// Per-function HTML written out as it is generated and read back in the
+// same order by genHTML, so only one function's HTML is held in memory.
+// Spools to a temporary file; falls back to memory if none can be created.
+class HtmlSpool
+{
+public:
+  HtmlSpool() : file(tmpfile()), readIndex(0), enabled(true)
+  {
+  }
+  ~HtmlSpool()
+  {
+    if (file)
+      fclose(file);
+  }
+  void push_back(const string &html);
+  void rewind(void);
+  void copyNext(ostream &out);
+  void setEnabled(bool on) { enabled = on; }
+
+private:
+  HtmlSpool(const HtmlSpool &);
+  HtmlSpool &operator=(const HtmlSpool &);
+
+  FILE *file;
+  vector<size_t> sizes;     // Size of HTML for each function
+  vector<string> html;      // HTML for each function if no file
+  size_t readIndex;         // Next function to copy out
+  bool enabled;             // HTML is kept; otherwise push_back drops it
+};
+
+// One row of a compact HTML report: runs of source text, each with the
+// background color it is shown in. Output as [color, "text", ...] for
+// the report script to render.
+class CompactRow
+{
+public:
+  CompactRow() : color(-1), count(0)
+  {
+  }
+  void add(int bgColor, const SourceSlice &slice);
+  string str(void);
+
+private:
+  void flush(void);
+
+  ostringstream runs;
+  int color;                // Color of text being collected, -1 if none
+  string text;              // Text collected in current color
+  int count;                // Runs output so far
+};
+
 // Class to process .json file and .hist file and create .html file
 class VampProcess
 {
 public:
-  VampProcess(VAMP_ERR_STREAM *outStr, VAMP_ERR_STREAM *errStr) : vampOut(outStr), vampErr(errStr)
+  VampProcess(VAMP_REPORT_STREAM *outStr, VAMP_REPORT_STREAM *errStr) : vampOut(outStr), vampErr(errStr)
   {
       gotPPMap = false;
+      upToDate = false;
+      coverageOnly = false;
+      buildHtml = true;
+      buildData = false;
   }
-  mapType getMapInfo(vector<JsonNode> &n);
-  void parseLineMarkers(Json &json, vector<JsonNode> &n);
-  void parseJsonMap(Json &n);
+  string fingerprintName(string jsonName);
+  string configHash(VAMP_REPORT_CONFIG &vo);
+  string textHash(int lhsLine, int rhsLine);
+  fingerprintType getFingerprint(string fileName, bool doHash);
+  bool reportUpToDate(string jsonName, VAMP_REPORT_CONFIG &vo);
+  void saveFingerprint(string jsonName, VAMP_REPORT_CONFIG &vo);
+  vector<string> fingerprintOutputs(string jsonName);
+  void writeFingerprint(string jsonName, string config,
+                        vector<fingerprintType> &inputs);
   void processLineMarkers(char *preProcFileName);
-  bool processFile(char *jsonName, VAMP_REPORT_CONFIG &vo);
+  bool processFile(char *jsonName, VAMP_REPORT_CONFIG &vo, bool force = false);
+  bool getCoveredProbes(char *jsonName, VAMP_REPORT_CONFIG &vo,
+                        VAMP_COVERED_PROBES &probes);
+  vector<string> getReportOutputs() { return reportOutputs; }
+  bool isUpToDate() { return upToDate; }
   bool readSource(string fileName);
   string sourceText(sourceLocationType &loc);
-  void genHtmlSourceText(sourceLocationType &loc, int indent, vector<string> &strings);
+  void genHtmlSourceText(sourceLocationType &loc, vector<SourceSlice> &strings);
   string htmlSourceText(sourceLocationType &loc, int indent);
+  string jsSourceText(sourceLocationType &loc);
   void walkTreeNode(int &nodeCnt, mcdcNode *node, bool doRHS,
                     vector<sourceLocationType> &nodeInfo);
   void walkTree(int &nodeCnt, mcdcNode *node,
                 vector<sourceLocationType> &nodeInfo);
-  int checkMatch(string &mcdcStr,
-                 vector<string> &testStr,
-                 bool checkBoth = false);
+  void packVectors(vector<string> &vecStr, mcdcVectorTable &table);
+  int checkMatch(mcdcVecType obs, mcdcVectorTable &table);
+  int checkMatch(mcdcVecType val, mcdcVecType valMask,
+                 mcdcVectorTable &table);
+  void buildMatchLookup(mcdcVectorTable &falseTable,
+                        mcdcVectorTable &trueTable,
+                        int operandCnt,
+                        vector<int> &lookup);
   void setAttrib(unsigned char attrib, sourceLocationType &range);
+  unsigned char stmtCoverAttrib(int inst, bool useCount, bool &newCov);
+  void setStmtCovered(int line, int fromCol, int toCol,
+                      unsigned char attrib, bool newCov,
+                      vector<sourceLocationType>::iterator &stmt,
+                      int &coveredCount);
   void processStmt(void);
   string htmlBgColor(int color);
   string htmlPercentageStyle(string name, int percent);
-  //int getMinCond(vector<mcdcPair> mcdcPairs[32],
-  int getMinCond(vector<mcdcPair> *mcdcPairs,
-                 int mcdcPairIndex,
-                 bitset<MAX_BITSET> &falseConditions,
-                 bitset<MAX_BITSET> &trueConditions);
-                 //unsigned int &falseConditions,
-                 //unsigned int &trueConditions);
   int genCoverageHTML(int covered,
                       bool isBranch,
                       sourceLocationType &s,
@@ -321,20 +521,40 @@ public:
   void processBranch(void);
   void processCondition(void);
   void processMCDC(void);
+  int assignHTMLPages(void);
+  int htmlLinePage(int line);
+  string htmlPageName(int page, bool withPath);
+  void genHTMLPageNav(ofstream &htmlFile, int page);
+  void removeOldPages(void);
+  bool writeHTMLBundle(string htmlDir, string tmpName);
+  void genCompactHTMLHead(ofstream &htmlFile, const char *dir = "");
+  void genCompactHTMLSummary(ofstream &htmlFile);
   void genHTML(string htmlName);
+  void genSummary(string reportName);
+  void genSummaryHeader(ofstream &rptFile, const char *title);
+
+  // Machine-readable exports (vamp_export.cpp)
+  void getLineHits(vector<pair<int, long long> > &lineHits);
+  void getDecisions(vector<decisionExportType> &decisions);
+  bool genLcov(string fileName);
+  bool genCobertura(string fileName);
+  bool genJsonSummary(string fileName);
+  bool genHeaderCoverage(string fileName);
+  bool genVariantCoverage(string fileName);
+  void writeJsonTotals(ostream &out);
 
 private:
   // Source code instrumented to produce .json file
-  vector<string> source;
+  SourceBuffer source;
   // Attributes associated with source
-  vector<string> attribs;
+  AttribMap attribs;
 
   // Collected MC/DC HTML Information per function
-  vector<string> mcdcHTMLInfo;
+  HtmlSpool mcdcHTMLInfo;
   // Collected Branch HTML Information per function
-  vector<string> branchHTMLInfo;
+  HtmlSpool branchHTMLInfo;
   // Collected Condition HTML Information per function
-  vector<string> condHTMLInfo;
+  HtmlSpool condHTMLInfo;
 
   // Coverage options
   bool doStmtSingle;
@@ -345,7 +565,7 @@ private:
 
   // MCDC expression tree
   mcdcExprTree exprTree;
-  vector<int> mcdcByteCnt;   // Number of bytes used (1 or 2) to store
+  vector<int> mcdcByteCnt;   // Number of bytes used (1, 2, 4 or 8) to store
                                   // a MCDC result
   vector<int> mcdcOpCnt;     // Number of operands in expression * number
                                   // of bytes used
@@ -375,13 +595,28 @@ private:
   int condTotalCoverageCount;                   // # conditions covered in source
   int newCondCoveredCount;                      // # new conditions covered in current run
 
-  VAMP_ERR_STREAM *vampOut;
-  VAMP_ERR_STREAM *vampErr;
+  VAMP_REPORT_STREAM *vampOut;
+  VAMP_REPORT_STREAM *vampErr;
 
   bool gotPPMap;
-  string mapFileName;
-  string mapPPFileName;
-  vector<mapType> mapInfo;
+  string ppMapFileName;      // Line marker map requested for this file
+  PPMap ppMap;               // Preprocessed lines to original source
+
+  vector<string> reportInputs;   // Files read to generate the report
+  vector<string> reportOutputs;  // Files written by the report
+  vector<string> oldOutputs;     // Files written by the previous report
+  bool upToDate;                 // Report was current; not regenerated
+  bool coverageOnly;             // Find coverage so far only; no history
+                                 // is combined and no report generated
+  bool buildHtml;                // Build per-function HTML detail tables
+  bool buildData;                // Build them as script data instead, for
+                                 // the compact layout
+
+  string htmlPageBase;       // Report name (less .html) pages are named from
+  int htmlPageCount;         // Pages report is split into, 0 if not split
+  vector<int> htmlFuncPage;  // Page each function is shown on
+
+  vector<mcdcExportType> mcdcExport;   // MC/DC results found by processMCDC
 
   VampDB db;
   History oldHist;   // Old (combined previous) history info
@@ -0,0 +1,608 @@
+/*  Copyright 2016, Robert Ankeney
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/
+*/
+
+
+// vamp-report: generate coverage reports without the GUI.
+// Reports for several databases are generated at once; messages go to
+// stderr in file order and a JSON summary of the run goes to stdout.
+
+#include "reportjob.h"
+#include "headercov.h"
+#include "variantcov.h"
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <stdlib.h>
+#include <limits.h>
+#include <algorithm>
+
+#define EXIT_USAGE 2    // Bad arguments or configuration
+
+// Convert between .json database and binary .vdb database
+static int convertDb(char *option, char *fileName)
+{
+  VampDB db;
+
+  if (strcmp(option, "-vdb") == 0)
+  {
+    ostringstream jsonErr;
+    Json n(&jsonErr);
+    try
+    {
+      n.ParseFile(fileName);
+      db.parseJsonDb(n, &cerr);
+    }
+    catch(int i)
+    {
+      cerr << "Bad database file " << fileName << " - " << jsonErr.str();
+      return EXIT_FAILURE;
+    }
+
+    string vdbFileName = VampDB::vdbName(fileName);
+    if (!db.saveVdb(vdbFileName, fileName))
+    {
+      cerr << "Cannot write " << vdbFileName << ENDL;
+      return EXIT_FAILURE;
+    }
+  }
+  else
+  {
+    if (!db.loadVdb(fileName, ""))
+    {
+      cerr << "Bad binary database file " << fileName << ENDL;
+      return EXIT_FAILURE;
+    }
+
+    string jsonName = fileName;
+    size_t extension = jsonName.rfind(".");
+    if (extension < jsonName.npos)
+      jsonName.erase(extension);
+    jsonName += ".json";
+
+    // Never overwrite a database written by the instrumenter
+    ifstream existing(jsonName.c_str());
+    if (existing.is_open())
+    {
+      cerr << jsonName << " already exists, not overwritten" << ENDL;
+      return EXIT_FAILURE;
+    }
+
+    ofstream jsonFile(jsonName.c_str());
+    db.writeJsonDb(jsonFile);
+    jsonFile.close();
+    if (!jsonFile.good())
+    {
+      cerr << "Cannot write " << jsonName << ENDL;
+      return EXIT_FAILURE;
+    }
+  }
+
+  return EXIT_SUCCESS;
+}
+
+static void usage(char *name)
+{
+  cerr << "Usage: " << name << " [options] [<JSON file> ...]" << ENDL;
+  cerr << "  -p <project>      Report the files of .vproj project, or just " <<
+          "those named, using its vamp_process.cfg and running from its " <<
+          "directory. Merged reports cover every current report in it" <<
+          ENDL;
+  cerr << "  -c <config file>  Report configuration (default vamp_process.cfg)" <<
+          ENDL;
+  cerr << "  -f <list file>    Also process JSON files listed one per line" <<
+          ENDL;
+  cerr << "  -j <jobs>         Generate up to <jobs> reports at once " <<
+          "(default one per core)" << ENDL;
+  cerr << "  -q                Only show errors" << ENDL;
+  cerr << "       " << name << " -vdb <JSON file>   " <<
+          "Convert database to binary .vdb" << ENDL;
+  cerr << "       " << name << " -json <VDB file>   " <<
+          "Convert binary database back to .json, if none exists" << ENDL;
+  cerr << "Exit status is 0 if all reports were generated or up to date, " <<
+          "1 if any failed, 2 on bad arguments." << ENDL;
+}
+
+// True if path is absolute, as the GUI decides it
+static bool isAbsolutePath(const string &path)
+{
+#ifdef _WIN32
+  return ((path[0] == '\\') ||
+          (path[0] == '/') ||
+          (path[1] == ':'));
+#else
+  return (path[0] == '/');
+#endif
+}
+
+// Use forward slashes, and end path with a '/' if addSlash is true or
+// with no '/' if it is false
+static string fixPath(string path, bool addSlash)
+{
+#ifdef _WIN32
+  replace(path.begin(), path.end(), '\\', '/');
+#endif
+  if (addSlash)
+  {
+    if (path.empty() || (path[path.size() - 1] != '/'))
+      path += "/";
+  }
+  else
+  {
+    while (!path.empty() && (path[path.size() - 1] == '/'))
+      path.erase(path.size() - 1);
+  }
+
+  return path;
+}
+
+// Name of the .json database of a project source file, following the
+// GUI: the preprocessed file goes to the preprocessor directory and the
+// instrumented file to the save directory, relative to the source
+// unless absolute. Returns an empty string if the name is not usable.
+static string projectJsonName(string fileName, const string &baseDir,
+                              VAMP_CONFIG &vc, VAMP_PREPROC_CONFIG &pc)
+{
+  fileName = fixPath(fileName, false);
+#ifndef _WIN32
+  // Project files are kept without their starting '/'
+  if (fileName[0] != '/')
+    fileName = "/" + fileName;
+#endif
+
+  size_t slash = fileName.rfind('/');
+  string srcPath = fileName.substr(0, slash + 1);
+  string shortName = fileName.substr(slash + 1);
+  size_t extension = shortName.rfind(".");
+  if (extension == shortName.npos)
+    return "";
+
+  // Directory of preprocessed file
+  string preProcPath = srcPath;
+  if (pc.doPreProcess)
+  {
+    if (isAbsolutePath(pc.preProcDirectory))
+    {
+      if (preProcPath.compare(0, baseDir.size(), baseDir) != 0)
+        return "";
+      preProcPath = fixPath(pc.preProcDirectory + preProcPath.substr(baseDir.size()), true);
+    }
+    else
+    if ((pc.preProcDirectory != "") &&
+        (pc.preProcDirectory != ".") && (pc.preProcDirectory != "./"))
+    {
+      preProcPath += fixPath(pc.preProcDirectory, true);
+    }
+  }
+
+  // Directory of instrumented file
+  string instrPath;
+  if (isAbsolutePath(vc.saveDirectory))
+  {
+    if (srcPath.compare(0, baseDir.size(), baseDir) != 0)
+      return "";
+    instrPath = fixPath(vc.saveDirectory, true) + srcPath.substr(baseDir.size());
+  }
+  else
+    instrPath = preProcPath + fixPath(vc.saveDirectory, true);
+
+  return instrPath + shortName.substr(0, extension) + vc.saveSuffix + ".json";
+}
+
+// Add the database of each source file in a .vproj project, reading
+// the project and its vamp.cfg as the GUI does
+static bool addProjectFiles(const string &projectName, const string &projectDir,
+                            vector<string> &jsonNames)
+{
+  ostringstream jsonErr;
+  Json json(&jsonErr);
+  try
+  {
+    json.ParseFile(projectName);
+  }
+  catch(int i)
+  {
+    cerr << "Bad project file " << projectName << " - " << jsonErr.str();
+    return false;
+  }
+
+  VAMP_CONFIG vc;
+  vc.saveDirectory = "VAMP_INST";
+  vc.saveSuffix = "";
+
+  string vampCfgName = projectDir + "/vamp.cfg";
+  ifstream vampCfgFile(vampCfgName.c_str());
+  if (vampCfgFile.is_open())
+  {
+    vampCfgFile.close();
+
+    ostringstream cfgErr;
+    ConfigFile cf(&cfgErr);
+    if (!cf.ParseConfigFile(vampCfgName, vc))
+    {
+      cerr << "Bad " << vampCfgName << " " << cfgErr.str() << ENDL;
+      return false;
+    }
+  }
+
+  VAMP_PREPROC_CONFIG pc;
+  pc.doPreProcess = false;
+  string baseDir;
+  vector<string> fileNames;
+
+  vector<JsonNode>::iterator i = json.jsonNodes.begin();
+  while (i != json.jsonNodes.end())
+  {
+    string nodeName = i->name();
+
+    if (nodeName == "base_directory")
+      baseDir = fixPath(i->as_string(), false);
+    else
+    if (nodeName == "preprocess_files")
+      pc.doPreProcess = i->as_bool();
+    else
+    if (nodeName == "preprocess_directory")
+      pc.preProcDirectory = i->as_string();
+    else
+    if (nodeName == "preprocess_suffix")
+      pc.preProcSuffix = i->as_string();
+    else
+    if (nodeName == "project_files")
+    {
+      vector<JsonNode> &projFiles = json.GetArray(*i);
+      vector<JsonNode>::const_iterator j = projFiles.begin();
+
+      while (j != projFiles.end())
+      {
+        if (j->nodeData != "")
+          fileNames.push_back(j->nodeData);
+        ++j;
+      }
+    }
+
+    ++i;
+  }
+
+  for (int f = 0; f < fileNames.size(); f++)
+  {
+    string jsonName = projectJsonName(fileNames[f], baseDir, vc, pc);
+    if (jsonName.empty())
+    {
+      cerr << "Cannot find database of project file " << fileNames[f] << ENDL;
+      return false;
+    }
+    jsonNames.push_back(jsonName);
+  }
+
+  return true;
+}
+
+// Line map written beside the database when it was preprocessed, as the
+// GUI finds it (<file>.json -> <file>.ppmap)
+static bool hasLineMap(const string &jsonName)
+{
+  string mapName = jsonName;
+  size_t extension = mapName.rfind(".");
+  struct stat mapStat;
+
+  if (extension == mapName.npos)
+    return false;
+
+  mapName.replace(extension, mapName.npos, PPMAP_EXT);
+  return stat(mapName.c_str(), &mapStat) == 0;
+}
+
+// Make fileName absolute so it survives a change of directory
+static string absoluteName(const string &fileName)
+{
+  char respath[PATH_MAX];
+
+  if (realpath(fileName.c_str(), respath))
+    return respath;
+
+  return fileName;
+}
+
+int main(int argc, char *argv[])
+{
+  if ((argc == 3) &&
+      ((strcmp(argv[1], "-vdb") == 0) || (strcmp(argv[1], "-json") == 0)))
+  {
+    return convertDb(argv[1], argv[2]);
+  }
+
+  string projectName;
+  string projectDir;
+  string cfgName;
+  vector<string> jsonNames;
+  vector<string> projectJsonNames;
+  int jobCnt = thread::hardware_concurrency();
+  bool quiet = false;
+
+  for (int i = 1; i < argc; i++)
+  {
+    string arg = argv[i];
+
+    if ((arg == "-p") || (arg == "-c") || (arg == "-f") || (arg == "-j"))
+    {
+      if (++i == argc)
+      {
+        usage(argv[0]);
+        return EXIT_USAGE;
+      }
+
+      if (arg == "-p")
+      {
+        projectName = argv[i];
+        projectDir = projectName;
+        size_t slash = projectDir.rfind('/');
+        projectDir = (slash == projectDir.npos) ? "." :
+                                                  projectDir.substr(0, slash);
+      }
+      else
+      if (arg == "-c")
+        cfgName = absoluteName(argv[i]);
+      else
+      if (arg == "-f")
+      {
+        ifstream listFile(argv[i]);
+        if (!listFile.is_open())
+        {
+          cerr << "Cannot read " << argv[i] << ENDL;
+          return EXIT_USAGE;
+        }
+
+        string line;
+        while (getline(listFile, line))
+        {
+          if (!line.empty() && (line[line.size() - 1] == '\r'))
+            line.erase(line.size() - 1);
+          if (!line.empty())
+            jsonNames.push_back(line);
+        }
+      }
+      else
+      {
+        jobCnt = atoi(argv[i]);
+        if (jobCnt < 1)
+        {
+          usage(argv[0]);
+          return EXIT_USAGE;
+        }
+      }
+    }
+    else
+    if (arg == "-q")
+      quiet = true;
+    else
+    if (arg[0] == '-')
+    {
+      usage(argv[0]);
+      return EXIT_USAGE;
+    }
+    else
+      jsonNames.push_back(arg);
+  }
+
+  if (!projectName.empty() &&
+      !addProjectFiles(projectName, projectDir, projectJsonNames))
+  {
+    return EXIT_USAGE;
+  }
+
+  if (jsonNames.empty())
+    jsonNames = projectJsonNames;
+
+  if (jsonNames.empty())
+  {
+    usage(argv[0]);
+    return EXIT_USAGE;
+  }
+
+  // Report paths are relative to the project, as in the GUI
+  if (!projectDir.empty())
+  {
+    for (int i = 0; i < jsonNames.size(); i++)
+      jsonNames[i] = absoluteName(jsonNames[i]);
+    for (int i = 0; i < projectJsonNames.size(); i++)
+      projectJsonNames[i] = absoluteName(projectJsonNames[i]);
+
+    if (chdir(projectDir.c_str()) != 0)
+    {
+      cerr << "Cannot change to project directory " << projectDir << ENDL;
+      return EXIT_USAGE;
+    }
+  }
+
+  if (cfgName.empty())
+    cfgName = "vamp_process.cfg";
+
+  ostringstream cfgErr;
+  ConfigFile cf(&cfgErr);
+  VAMP_REPORT_CONFIG vo;
+
+  if (!cf.ParseReportConfigFile(cfgName, vo))
+  {
+    ifstream cfgFile(cfgName.c_str());
+    if (cfgFile.is_open())
+    {
+      // Present but unreadable - don't guess at the settings
+      cerr << "Bad " << cfgName << " " << cfgErr.str() << ENDL;
+      return EXIT_USAGE;
+    }
+
+    if (!quiet)
+      cerr << cfgErr.str();
+  }
+
+  vector<ReportJob *> jobs;
+  for (int i = 0; i < jsonNames.size(); i++)
+    jobs.push_back(new ReportJob(jsonNames[i], jsonNames[i],
+                                 hasLineMap(jsonNames[i]), vo));
+
+  // Workers take the next job; main thread shows results in file order
+  mutex jobLock;
+  condition_variable jobDone;
+  vector<bool> done(jobs.size(), false);
+  int nextJob = 0;
+
+  if (jobCnt < 1)
+    jobCnt = 1;
+  if (jobCnt > jobs.size())
+    jobCnt = jobs.size();
+
+  vector<thread> workers;
+  for (int w = 0; w < jobCnt; w++)
+  {
+    workers.push_back(thread([&]()
+    {
+      for (;;)
+      {
+        int j;
+        {
+          lock_guard<mutex> lock(jobLock);
+          if (nextJob == jobs.size())
+            return;
+          j = nextJob++;
+        }
+
+        jobs[j]->run();
+
+        lock_guard<mutex> lock(jobLock);
+        done[j] = true;
+        jobDone.notify_all();
+      }
+    }));
+  }
+
+  int generatedCnt = 0;
+  int upToDateCnt = 0;
+  int failCnt = 0;
+  HeaderCoverage headerCov;
+  VariantCoverage variantCov;
+
+  cout << "{\n";
+  cout << "  \"files\": [";
+  for (int i = 0; i < jobs.size(); i++)
+  {
+    {
+      unique_lock<mutex> lock(jobLock);
+      while (!done[i])
+        jobDone.wait(lock);
+    }
+
+    ReportJob *job = jobs[i];
+    if (!quiet)
+      cerr << job->outStr;
+    cerr << job->errStr;
+
+    const char *status;
+    if (!job->success)
+    {
+      cerr << "Processing " << job->jsonName << " failed" << ENDL;
+      status = "failed";
+      ++failCnt;
+    }
+    else
+    if (job->upToDate)
+    {
+      status = "up_to_date";
+      ++upToDateCnt;
+    }
+    else
+    {
+      status = "generated";
+      ++generatedCnt;
+    }
+
+    if (job->success && !headerCov.addOutputs(job->outputs, &cerr))
+      ++failCnt;
+    if (job->success && !variantCov.addOutputs(job->outputs, &cerr))
+      ++failCnt;
+
+    cout << (i ? ",\n    " : "\n    ") << "{\"name\": " <<
+            jsonQuote(job->jsonName) << ", \"status\": \"" << status << "\"";
+    if (!job->totals.empty())
+      cout << ", \"totals\": " << job->totals;
+    if (!job->outputs.empty())
+    {
+      cout << ", \"outputs\": [";
+      for (int o = 0; o < job->outputs.size(); o++)
+        cout << (o ? ", " : "") << jsonQuote(job->outputs[o]);
+      cout << "]";
+    }
+    cout << "}";
+    cout.flush();
+  }
+  cout << "\n  ],\n";
+
+  // Merged reports also take in the project files not reported this time,
+  // as long as their last report is still current
+  for (int i = 0; i < projectJsonNames.size(); i++)
+  {
+    const string &jsonName = projectJsonNames[i];
+    if (find(jsonNames.begin(), jsonNames.end(), jsonName) != jsonNames.end())
+      continue;
+
+    ReportJob job(jsonName, jsonName, hasLineMap(jsonName), vo);
+    if (job.checkUpToDate())
+    {
+      if (!headerCov.addOutputs(job.outputs, &cerr))
+        ++failCnt;
+      if (!variantCov.addOutputs(job.outputs, &cerr))
+        ++failCnt;
+    }
+  }
+
+  // Header code folded from all the project's files
+  if (!headerCov.empty())
+  {
+    ostringstream headerOut;
+    if (!headerCov.genReports(&headerOut, &cerr))
+      ++failCnt;
+    if (!quiet)
+      cerr << headerOut.str();
+
+    cout << "  \"headers\": ";
+    headerCov.writeJson(cout);
+    cout << ",\n";
+  }
+
+  // Each source unioned over every variant of it in the project
+  if (!variantCov.empty())
+  {
+    ostringstream variantOut;
+    if (!variantCov.genReports(&variantOut, &cerr))
+      ++failCnt;
+    if (!quiet)
+      cerr << variantOut.str();
+
+    cout << "  \"variants\": ";
+    variantCov.writeJson(cout);
+    cout << ",\n";
+  }
+
+  cout << "  \"generated\": " << generatedCnt << ",\n";
+  cout << "  \"up_to_date\": " << upToDateCnt << ",\n";
+  cout << "  \"failed\": " << failCnt << "\n";
+  cout << "}\n";
+
+  for (int w = 0; w < workers.size(); w++)
+    workers[w].join();
+  for (int i = 0; i < jobs.size(); i++)
+    delete jobs[i];
+
+  return failCnt ? EXIT_FAILURE : EXIT_SUCCESS;
+}
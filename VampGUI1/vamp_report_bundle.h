@@ -0,0 +1,444 @@
+/*  Copyright 2016, Robert Ankeney
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/
+*/
+
+
+#ifndef VAMP_REPORT_BUNDLE_H
+#define VAMP_REPORT_BUNDLE_H
+
+// Shared style sheet and script for compact HTML reports. Written once
+// to each HTML directory and referenced by every report in it.
+
+#define HTML_BUNDLE_CSS "vamp_report.css"
+#define HTML_BUNDLE_JS  "vamp_report.js"
+
+static const char htmlBundleCss[] =
+  "table.vsrc { background: #e0efff; margin-left: auto; margin-right: auto; }\n"
+  "table.vsrc td { border: 1px solid #808080; vertical-align: top; }\n"
+  "table.vsrc td.vhdr { text-align: center; }\n"
+  "table.vsrc td.vcnt { text-align: center; }\n"
+  ".vfunc { font-size: xx-large; font-weight: bold; }\n"
+  ".c1 { background: #60ff60; }\n"
+  ".c2 { background: #ff6060; }\n"
+  ".c3 { background: #ffff40; }\n"
+  ".c4 { background: #ffc000; }\n"
+  "table.vdet { background: #d0d0d0; width: 80%; margin: 0 auto 1em auto; }\n"
+  "table.vdet td { border: 1px solid #808080; font-size: x-large; font-weight: bold; }\n"
+  "td.vbr { background: #e0a0ff; text-align: center; }\n"
+  "td.vexp { background: #ffffa0; text-align: center; }\n"
+  "td.vsec { background: #a0a0ff; text-align: center; }\n"
+  "td.vctr { text-align: center; }\n"
+  "td.vhalf { width: 50%; }\n"
+  "td.vright { width: 50%; text-align: right; }\n"
+  "table.vbox { background: #d0d0d0; margin-left: auto; margin-right: auto; }\n"
+  "table.vbox td { border: none; text-align: left; }\n"
+  ".vnote { font-size: medium; }\n"
+  "table.vsum { background: #d0d0d0; }\n"
+  ".vbar { border: 2px solid blue; background: #ff6060; }\n"
+  ".vbar_in { font-size: 12pt; background: #60ff60; }\n";
+
+// Each function is handed to vampFunc() as the page loads, as rows of
+//   [line, srcLine, lineColor, [color, "text", ...], [coverage]]
+// line/srcLine: 0 for a continued statement, srcLine -1 if not mapped
+// colors: 0 none, 1 green, 2 red, 3 yellow, 4 orange
+// coverage: [prev, curr, comb] when combining histories, [curr] when
+// counting statements; curr is -1 if not covered, else the count.
+// The rows are followed by the branch, MC/DC and condition records of
+// the function, laid out as described in processBranch() and its peers,
+// from which the same detail tables as the full layout are built.
+// The summary tables are likewise drawn by vampSummary() from the
+// totals written by genCompactHTMLSummary().
+static const char htmlBundleJs[] =
+  "var vampOpts = { ppmap: 0, stmt: 0, count: 0, combine: 0 };\n"
+  "\n"
+  "function vampReport(opts)\n"
+  "{\n"
+  "  vampOpts = opts;\n"
+  "}\n"
+  "\n"
+  "function vampEscape(s)\n"
+  "{\n"
+  "  return s.replace(/&/g, '&amp;').replace(/</g, '&lt;').replace(/>/g, '&gt;');\n"
+  "}\n"
+  "\n"
+  "function vampSpan(color, s)\n"
+  "{\n"
+  "  return color ? '<span class=\"c' + color + '\">' + s + '</span>' : s;\n"
+  "}\n"
+  "\n"
+  "function vampLineNum(n, name)\n"
+  "{\n"
+  "  if (n > 0)\n"
+  "    return (name ? '<a name=\"line_' + n + '\"></a>' : '') + ('     ' + n).slice(-5);\n"
+  "  return (n < 0) ? '   -' : '   + ';\n"
+  "}\n"
+  "\n"
+  "function vampCovered(n)\n"
+  "{\n"
+  "  if (n < 0)\n"
+  "    return vampSpan(2, '--');\n"
+  "  return vampSpan(1, vampOpts.count ? String(n) : '++');\n"
+  "}\n"
+  "\n"
+  "// Summary columns: heading and text shown when there is nothing to cover\n"
+  "var vampColumns = { S: ['Statement', 'No Statements'], B: ['Branch', 'No Branches'],\n"
+  "                    M: ['MC/DC', 'No MC/DC Exprs'], C: ['Condition', 'No Conditions'] };\n"
+  "\n"
+  "// Percentage bar for cell [covered, total]\n"
+  "function vampBar(cell, none)\n"
+  "{\n"
+  "  if (!cell[1])\n"
+  "    return '<center> ' + none + ' </center>';\n"
+  "  var p = Math.floor((Math.floor(1000 * cell[0] / cell[1]) + 5) / 10);\n"
+  "  return '<div class=\"vbar\"><div class=\"vbar_in\" style=\"width:' + p + '%\">' + p +\n"
+  "         '% <font size=\"1\">&nbsp;&nbsp;(' + cell[0] + ' / ' + cell[1] +\n"
+  "         ')</font></div></div>';\n"
+  "}\n"
+  "\n"
+  "function vampSumCells(columns, cells, width)\n"
+  "{\n"
+  "  var html = '';\n"
+  "  for (var i = 0; i < columns.length; i++)\n"
+  "    html += '<td width=' + width + '% style=\"white-space:nowrap\"> ' +\n"
+  "            vampBar(cells[i], vampColumns[columns.charAt(i)][1]) + ' </td> <td></td>';\n"
+  "  return html;\n"
+  "}\n"
+  "\n"
+  "function vampSumTable(tableWidth, width, heads, rows)\n"
+  "{\n"
+  "  var html = '<table class=\"vsum\" border rules=none frame=box width=' + tableWidth +\n"
+  "             '% align=\"center\"><tr>';\n"
+  "  for (var i = 0; i < heads.length; i++)\n"
+  "    html += '<th width=' + width + '%> ' + heads[i] + ' </th> <td></td>';\n"
+  "  html += '</tr><tr></tr><tr></tr>';\n"
+  "  for (var i = 0; i < rows.length; i++)\n"
+  "    html += '<tr>' + rows[i] + '</tr>';\n"
+  "  return html + '</table><br /><br />';\n"
+  "}\n"
+  "\n"
+  "// Summary tables of the file, its functions and, when combining\n"
+  "// histories, the new coverage, laid out as in genCompactHTMLSummary()\n"
+  "function vampSummary(file, columns, totals, funcs, newTotals)\n"
+  "{\n"
+  "  var heads = [];\n"
+  "  for (var i = 0; i < columns.length; i++)\n"
+  "    heads.push(vampColumns[columns.charAt(i)][0]);\n"
+  "\n"
+  "  // MC/DC and condition coverage share a third of the width\n"
+  "  var types = columns.replace('C', 'M').replace('MM', 'M').length;\n"
+  "  var width = Math.floor(100 / types), funcWidth = Math.floor(100 / (types + 1));\n"
+  "\n"
+  "  file = vampEscape(file);\n"
+  "  var html = '<h1><center>Overall Summary of Results for ' + file +\n"
+  "             '</center></h1>' +\n"
+  "             vampSumTable(60, width, heads, [vampSumCells(columns, totals, width)]);\n"
+  "\n"
+  "  var rows = [];\n"
+  "  for (var i = 0; i < funcs.length; i++)\n"
+  "  {\n"
+  "    var f = funcs[i];\n"
+  "    rows.push('<td width=' + funcWidth + '%> <center> <a href=\\'' + f[1] +\n"
+  "              '#func_' + f[0] + '\\'> ' + vampEscape(f[0]) +\n"
+  "              '</a> </center> </td> <td> </td>' +\n"
+  "              vampSumCells(columns, f.slice(2), funcWidth));\n"
+  "  }\n"
+  "  html += '<h3><center>Summary of Results for Each Function in ' + file +\n"
+  "          '</center></h3>' +\n"
+  "          vampSumTable(80, funcWidth, ['Function'].concat(heads), rows);\n"
+  "\n"
+  "  if (newTotals)\n"
+  "    html += '<h3><center>Summary of New Coverage for ' + file +\n"
+  "            '</center></h3>' +\n"
+  "            vampSumTable(60, width, heads, [vampSumCells(columns, newTotals, width)]);\n"
+  "\n"
+  "  document.getElementById('vs').innerHTML = html;\n"
+  "}\n"
+  "\n"
+  "function vampFunc(id, name, rows, branches, mcdcs, conds)\n"
+  "{\n"
+  "  var lines = [], srcLines = [], source = [], counts = [];\n"
+  "  var showColor = vampOpts.stmt || vampOpts.count;\n"
+  "\n"
+  "  for (var i = 0; i < rows.length; i++)\n"
+  "  {\n"
+  "    var r = rows[i];\n"
+  "    var color = showColor ? r[2] : 0;\n"
+  "    lines.push(color ? vampSpan(color, vampLineNum(r[0], 1) + '    ') : vampLineNum(r[0], 1));\n"
+  "    if (vampOpts.ppmap)\n"
+  "      srcLines.push(color ? vampSpan(color, vampLineNum(r[1], 0) + '    ') : vampLineNum(r[1], 0));\n"
+  "\n"
+  "    var src = '';\n"
+  "    for (var j = 0; j + 1 < r[3].length; j += 2)\n"
+  "      src += vampSpan(r[3][j], vampEscape(r[3][j + 1]));\n"
+  "    source.push(src);\n"
+  "\n"
+  "    var cov = r[4];\n"
+  "    if (cov.length == 3)\n"
+  "      counts.push(' ' + vampSpan(cov[0] ? 1 : 2, cov[0] ? '++' : '--') + '   ' +\n"
+  "                  vampCovered(cov[1]) + '   ' +\n"
+  "                  vampSpan(cov[2] ? 1 : 2, cov[2] ? '++' : '--'));\n"
+  "    else\n"
+  "    if (cov.length == 1)\n"
+  "      counts.push(' ' + vampCovered(cov[0]) + '   ');\n"
+  "    else\n"
+  "      counts.push('');\n"
+  "  }\n"
+  "\n"
+  "  var html = '<table class=\"vsrc\"><tr>' +\n"
+  "             '<td class=\"vhdr\"><pre><b>Preproc\\nLine:</b></pre></td>';\n"
+  "  if (vampOpts.ppmap)\n"
+  "    html += '<td class=\"vhdr\"><pre><b>Source\\nLine:</b></pre></td>';\n"
+  "  html += '<td class=\"vhdr\"><a name=\"func_' + name + '\"></a>' +\n"
+  "          '<span class=\"vfunc\">Function: ' + vampEscape(name) + '</span></td>';\n"
+  "  if (vampOpts.combine)\n"
+  "    html += '<td class=\"vhdr\"><pre><b>Stmt Count\\nPrev Curr Comb\\nRuns Run  Runs</b></pre></td>';\n"
+  "  else\n"
+  "  if (vampOpts.count)\n"
+  "    html += '<td class=\"vhdr\"><pre>Stmt\\nCount</pre></td>';\n"
+  "  html += '</tr><tr><td><pre>' + lines.join('\\n') + '</pre></td>';\n"
+  "  if (vampOpts.ppmap)\n"
+  "    html += '<td><pre>' + srcLines.join('\\n') + '</pre></td>';\n"
+  "  html += '<td><pre>' + source.join('\\n') + '</pre></td>';\n"
+  "  if (vampOpts.combine || vampOpts.count)\n"
+  "    html += '<td class=\"vcnt\"><pre>' + counts.join('\\n') + '</pre></td>';\n"
+  "  html += '</tr></table><br clear=\"left\" />';\n"
+  "\n"
+  "  for (var i = 0; i < branches.length; i++)\n"
+  "    html += vampBranch(name, branches[i]);\n"
+  "  for (var i = 0; i < mcdcs.length; i++)\n"
+  "    html += vampMCDC(name, mcdcs[i]);\n"
+  "  for (var i = 0; i < conds.length; i++)\n"
+  "    html += vampCond(name, conds[i]);\n"
+  "\n"
+  "  document.getElementById('vf_' + id).innerHTML = html;\n"
+  "}\n"
+  "\n"
+  "function vampPad(s, n)\n"
+  "{\n"
+  "  while (s.length < n)\n"
+  "    s += ' ';\n"
+  "  return s;\n"
+  "}\n"
+  "\n"
+  "// Source lines of an expression joined by sep\n"
+  "function vampLines(lines, sep)\n"
+  "{\n"
+  "  var s = '';\n"
+  "  for (var i = 0; i < lines.length; i++)\n"
+  "    s += (i ? sep : '') + vampEscape(lines[i]);\n"
+  "  return s;\n"
+  "}\n"
+  "\n"
+  "// Detail table heading for the expression at lines r[0]-r[1]\n"
+  "function vampTitle(what, name, r, cls, span, text)\n"
+  "{\n"
+  "  return '<table class=\"vdet\"><tr><td class=\"' + cls + '\"' +\n"
+  "         (span > 1 ? ' colspan=' + span : '') + '>' + what + ' at ' +\n"
+  "         vampEscape(name) + '() <a href=\"#line_' + r[0] + '\">line ' + r[0] +\n"
+  "         '</a>' + (r[1] > r[0] ? '-' + r[1] : '') + ':<br /><br />' + text +\n"
+  "         '</td></tr>';\n"
+  "}\n"
+  "\n"
+  "function vampSection(title)\n"
+  "{\n"
+  "  return '<tr><td colspan=2 class=\"vsec\">' + title + '</td></tr>';\n"
+  "}\n"
+  "\n"
+  "// TRUE/FALSE coverage: 1 FALSE taken, 2 TRUE taken\n"
+  "function vampTrueFalse(c)\n"
+  "{\n"
+  "  var t = vampSpan(c & 2 ? 1 : 2, c & 2 ? 'Covered' : 'Not Covered');\n"
+  "  var f = vampSpan(c & 1 ? 1 : 2, c & 1 ? 'Covered' : 'Not Covered');\n"
+  "  return (c & 2 ? '  ' : '') + t + (c == 3 ? '      ' : (c ? '    ' : '  ')) +\n"
+  "         f + (c & 1 ? '  ' : '');\n"
+  "}\n"
+  "\n"
+  "function vampCoverRow(cov)\n"
+  "{\n"
+  "  var runs = ['     Previous Runs      \\n', '      Current Run       \\n',\n"
+  "              '     Combined Runs      \\n'];\n"
+  "  var html = '<tr>';\n"
+  "  for (var i = 0; i < cov.length; i++)\n"
+  "    html += '<td class=\"vctr\"><pre>' + (cov.length == 3 ? runs[i] : '') +\n"
+  "            '   TRUE         FALSE   \\n' + vampTrueFalse(cov[i]) +\n"
+  "            '\\n</pre></td>';\n"
+  "  return html + '</tr>';\n"
+  "}\n"
+  "\n"
+  "// Branch: [line, lastLine, [expr], [coverage], [case, covered, ...]]\n"
+  "function vampBranch(name, r)\n"
+  "{\n"
+  "  var html = vampTitle('Branch Condition', name, r, 'vbr',\n"
+  "                       r[3].length == 3 ? 3 : 1, vampLines(r[2], '<br />'));\n"
+  "  if (r.length > 4)\n"
+  "  {\n"
+  "    var cases = r[4], maxLen = 0, s = '';\n"
+  "    for (var i = 0; i < cases.length; i += 2)\n"
+  "      maxLen = Math.max(maxLen, cases[i].length);\n"
+  "    for (var i = 0; i < cases.length; i += 2)\n"
+  "      s += vampEscape(vampPad(cases[i], maxLen + 2)) +\n"
+  "           (cases[i + 1] ? '  ' + vampSpan(1, 'Covered') + '  ' :\n"
+  "                           vampSpan(2, 'Not Covered')) + '\\n';\n"
+  "    html += '<tr><td class=\"vctr\"><pre>' + s + '</pre></td></tr>';\n"
+  "  }\n"
+  "  else\n"
+  "    html += vampCoverRow(r[3]);\n"
+  "  return html + '</table>';\n"
+  "}\n"
+  "\n"
+  "// Condition: [line, lastLine, [A], [B], condition, [coverage]]\n"
+  "function vampCond(name, r)\n"
+  "{\n"
+  "  var html = vampTitle('Boolean Condition', name, r, 'vexp',\n"
+  "                       r[5].length == 3 ? 3 : 1,\n"
+  "                       'A = ' + vampLines(r[2], '<br />') + '<br />B = ' +\n"
+  "                       vampLines(r[3], '<br />') +\n"
+  "                       '<br />Boolean Condition: (A ' + vampEscape(r[4]) +\n"
+  "                       ' B)');\n"
+  "  return html + vampCoverRow(r[5]) + '</table>';\n"
+  "}\n"
+  "\n"
+  "// Vectors of one outcome of an MC/DC expression and whether each was seen\n"
+  "function vampVectors(prefix, labels, vecs, seen, headPad, pad)\n"
+  "{\n"
+  "  var s = '      <u>' + labels.split('').join(' ') + '   Covered</u>' +\n"
+  "          headPad + '\\n';\n"
+  "  for (var i = 0; i < vecs.length; i++)\n"
+  "    s += prefix + vampPad(String(i + 1), 2) + ' ' +\n"
+  "         vecs[i].split('').join(' ') + '     ' +\n"
+  "         vampPad(seen.charAt(i) == '1' ? 'Yes' : 'No', 3) + pad + '\\n';\n"
+  "  return s;\n"
+  "}\n"
+  "\n"
+  "// Operands of the given test cases, one of vecs for each\n"
+  "function vampCases(first, tag, cases, vecs, conds, underline)\n"
+  "{\n"
+  "  var s = '';\n"
+  "  for (var i = 0; i < cases.length; i++)\n"
+  "  {\n"
+  "    var v = vecs[cases[i] - 1];\n"
+  "    s += '<b>  Case ' + (first + i) + ': ' + tag + cases[i] + '  ' + v +\n"
+  "         '</b><br />\\n<b>  ' + (underline ? '<u>Result  Condition</u>' :\n"
+  "                                           'Result  Condition') + '</b>\\n';\n"
+  "    for (var j = 0; j < v.length; j++)\n"
+  "      if (v.charAt(j) != '-')\n"
+  "        s += (v.charAt(j) == '1' ? '   True   ' : '   False  ') +\n"
+  "             vampLines(conds[j], '\\n          ') + '\\n';\n"
+  "    s += '\\n';\n"
+  "  }\n"
+  "  return s;\n"
+  "}\n"
+  "\n"
+  "// MC/DC: [line, lastLine, [expr], labels, [[condition], ...],\n"
+  "//         [falseVec, ...], falseCovered, [trueVec, ...], trueCovered,\n"
+  "//         [[pairCover, false, true, flags, ...], ...], newCoverage, tests]\n"
+  "function vampMCDC(name, r)\n"
+  "{\n"
+  "  var html = vampTitle('Expression', name, r, 'vexp', 2,\n"
+  "                       vampLines(r[2], '<br />'));\n"
+  "  if (r.length > 3)\n"
+  "  {\n"
+  "    var labels = r[3], conds = r[4], falses = r[5], trues = r[7];\n"
+  "    var s = '';\n"
+  "    for (var i = 0; i < conds.length; i++)\n"
+  "      s += labels.charAt(i) + ' = ' + vampLines(conds[i], '\\n    ') + '\\n';\n"
+  "    html += vampSection('MC/DC Conditions For Expression') +\n"
+  "            '<tr><td colspan=2><table class=\"vbox\"><tr><td><pre>' + s +\n"
+  "            '</pre></td></tr></table></td></tr>';\n"
+  "\n"
+  "    html += vampSection('MC/DC Possible Combinations') +\n"
+  "            '<tr valign=top><td class=\"vright\"><pre>Outcome = FALSE:  ' +\n"
+  "            vampPad('', 2 * labels.length - 4) + '\\n\\n' +\n"
+  "            vampVectors('F', labels, falses, r[6], '     ', '       ') +\n"
+  "            '</pre></td><td class=\"vhalf\"><pre>      Outcome = TRUE:\\n\\n' +\n"
+  "            vampVectors('  T', labels, trues, r[8], '  ', '') +\n"
+  "            '</pre></td></tr>';\n"
+  "\n"
+  "    // Pairs line up in columns, wrapping before 80 characters\n"
+  "    var width = ('F' + falses.length + ':T' + trues.length + ' ').length;\n"
+  "    var maxCol = Math.floor(80 / width), covered = 0;\n"
+  "    s = '';\n"
+  "    for (var i = 0; i < r[9].length; i++)\n"
+  "    {\n"
+  "      var p = r[9][i], col = 0;\n"
+  "      covered += p[0];\n"
+  "      s += vampSpan(p[0] == 2 ? 1 : (p[0] ? 3 : 2), labels.charAt(i) + ':') +\n"
+  "           ' ';\n"
+  "      for (var j = 1; j < p.length; j += 3)\n"
+  "      {\n"
+  "        var f = 'F' + p[j], t = 'T' + p[j + 1], flags = p[j + 2];\n"
+  "        var len = f.length + t.length + 1;\n"
+  "        if (flags & 4)\n"
+  "          f = '<u>' + f + '</u>';\n"
+  "        if (flags & 8)\n"
+  "          t = '<u>' + t + '</u>';\n"
+  "        if ((flags & 3) == 3 || !(flags & 3))\n"
+  "          s += vampSpan(flags & 1 ? 1 : 2, f + ':' + t);\n"
+  "        else\n"
+  "          s += vampSpan(flags & 1 ? 1 : 2, f) + ':' +\n"
+  "               vampSpan(flags & 2 ? 1 : 2, t);\n"
+  "        if (flags & 16)\n"
+  "        {\n"
+  "          s += '*';\n"
+  "          len++;\n"
+  "        }\n"
+  "        s += vampPad('', width - len);\n"
+  "        if (++col > maxCol)\n"
+  "        {\n"
+  "          s += '\\n   ';\n"
+  "          col = 0;\n"
+  "        }\n"
+  "      }\n"
+  "      s += '\\n';\n"
+  "    }\n"
+  "    var percent = (100 * covered / (2 * labels.length)).toFixed(1);\n"
+  "    while (percent.length < 4)\n"
+  "      percent = ' ' + percent;\n"
+  "    html += vampSection('MC/DC Independent Pairs') +\n"
+  "            '<tr><td colspan=2 class=\"vctr\"><table class=\"vbox\"><tr><td><pre>' +\n"
+  "            s + '</pre></td></tr></table><pre>' +\n"
+  "            (r[10] ? '\\n* = New coverage this run; underscore designates which\\n' : '') +\n"
+  "            '\\nMC/DC coverage: ' + percent +\n"
+  "            '%</pre></td></tr>';\n"
+  "\n"
+  "    var tests = r[11];\n"
+  "    if (tests)\n"
+  "    {\n"
+  "      html += vampSection('Recommended Additional Test Cases' +\n"
+  "                          (tests[0] ? '' : '<br /><span class=\"vnote\">' +\n"
+  "                           '(Search limit reached - ' + tests[1] +\n"
+  "                           ' cases may not be the minimum)</span>')) +\n"
+  "              '<tr valign=top><td class=\"vhalf\"><pre>' +\n"
+  "              vampCases(1, 'F', tests[2], falses, conds, 1) +\n"
+  "              '</pre></td><td class=\"vhalf\"><pre>' +\n"
+  "              vampCases(1 + tests[2].length, 'T', tests[3], trues, conds, 0) +\n"
+  "              '</pre></td></tr>';\n"
+  "    }\n"
+  "  }\n"
+  "  return html + '</table>';\n"
+  "}\n"
+  "\n"
+  "// Anchors only exist once functions are rendered, so jump again\n"
+  "window.onload = function()\n"
+  "{\n"
+  "  if (location.hash.length > 1)\n"
+  "  {\n"
+  "    var a = document.getElementsByName(location.hash.substring(1));\n"
+  "    if (a.length)\n"
+  "      a[0].scrollIntoView();\n"
+  "  }\n"
+  "};\n";
+
+#endif // VAMP_REPORT_BUNDLE_H
@@ -59,7 +59,8 @@ void vampConfigDialog::getVcReportData(VAMP_REPORT_CONFIG &vcReportData, bool &v
                           (vcReportData.showTestCases != vcReport.showTestCases) ||
                           (vcReportData.reportSeparator != vcReport.reportSeparator) ||
                           (vcReportData.htmlDirectory != vcReport.htmlDirectory) ||
-                          (vcReportData.htmlSuffix != vcReport.htmlSuffix);
+                          (vcReportData.htmlSuffix != vcReport.htmlSuffix) ||
+                          (vcReportData.compactHtml != vcReport.compactHtml);
 
     if (vcReportDataChanged)
        vcReportData = vcReport;
@@ -104,6 +105,9 @@ void vampConfigDialog::getVcPreProcData(VAMP_PREPROC_CONFIG &vcPreProcData, bool
 
 void vampConfigDialog::setVcData(VAMP_CONFIG &vcData)
 {
+    // Keep settings not shown in dialog
+    vc = vcData;
+
     // vamp.cfg data
     ui->singleStmtCoverage->setChecked(vcData.doStmtSingle);
     ui->countStmtCoverage->setChecked(vcData.doStmtCount);
@@ -150,6 +154,9 @@ void vampConfigDialog::setVcData(VAMP_CONFIG &vcData)
 
 void vampConfigDialog::setVcReportData(VAMP_REPORT_CONFIG &vcReportData)
 {
+    // Keep settings not shown in dialog
+    vcReport = vcReportData;
+
     // vamp_process.cfg data
     ui->histDirectory->setText(QString::fromStdString(vcReportData.histDirectory));
     ui->combineHistory->setChecked(vcReportData.combineHistory);
@@ -158,6 +165,7 @@ void vampConfigDialog::setVcReportData(VAMP_REPORT_CONFIG &vcReportData)
     ui->reportSeparator->setText(QString::fromStdString(vcReportData.reportSeparator));
     ui->htmlDirectory->setText(QString::fromStdString(vcReportData.htmlDirectory));
     ui->htmlSuffix->setText(QString::fromStdString(vcReportData.htmlSuffix));
+    ui->compactHtml->setChecked(vcReportData.compactHtml);
 }
 
 void vampConfigDialog::setVcPreProcData(VAMP_PREPROC_CONFIG &vcPreProcData)
@@ -305,6 +313,7 @@ void vampConfigDialog::on_buttonBox_accepted()
     vcReport.reportSeparator = ui->reportSeparator->text().toStdString();
     vcReport.htmlDirectory = ui->htmlDirectory->text().toStdString();
     vcReport.htmlSuffix = ui->htmlSuffix->text().toStdString();
+    vcReport.compactHtml = ui->compactHtml->isChecked();
 
     // Preprocessor data
     vcPreProc.doPreProcess = ui->preProcCheckBox->isChecked();
@@ -0,0 +1,39 @@
+#-------------------------------------------------
+#
+# VAMP report engine: reads .json databases and history files and
+# generates the HTML, summary and export reports.
+# Builds without Qt or LLVM libraries (clang headers only, for the
+# language standard in configfile.h). Compile with USE_QT to have
+# configuration errors shown in message boxes.
+#
+#-------------------------------------------------
+
+INCLUDEPATH += $$PWD
+
+SOURCES += $$PWD/vamp_process.cpp \
+    $$PWD/vamp_export.cpp \
+    $$PWD/reportjob.cpp \
+    $$PWD/configfile.cpp \
+    $$PWD/json.cpp \
+    $$PWD/ppmap.cpp \
+    $$PWD/fnvhash.cpp \
+    $$PWD/headercov.cpp \
+    $$PWD/variantcov.cpp \
+    $$PWD/mergedreport.cpp \
+    $$PWD/mcdcExprTree.cpp \
+    $$PWD/mcdcSolver.cpp
+
+HEADERS += $$PWD/vamp_process.h \
+    $$PWD/vamp_report_bundle.h \
+    $$PWD/reportjob.h \
+    $$PWD/configfile.h \
+    $$PWD/json.h \
+    $$PWD/ppmap.h \
+    $$PWD/fnvhash.h \
+    $$PWD/headercov.h \
+    $$PWD/variantcov.h \
+    $$PWD/mergedreport.h \
+    $$PWD/mcdcExprTree.h \
+    $$PWD/mcdcSolver.h \
+    $$PWD/mcdcBitset.h \
+    $$PWD/version.h
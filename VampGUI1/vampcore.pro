@@ -0,0 +1,29 @@
+#-------------------------------------------------
+#
+# Static library of the VAMP report engine, for tools that generate
+# reports without the GUI
+#
+#-------------------------------------------------
+
+CONFIG   -= qt
+CONFIG   += staticlib
+
+TARGET = vampcore
+TEMPLATE = lib
+
+DEFINES += _GNU_SOURCE
+DEFINES += __STDC_CONSTANT_MACROS
+DEFINES += __STDC_FORMAT_MACROS
+DEFINES += __STDC_LIMIT_MACROS
+
+QMAKE_CXXFLAGS += -fpermissive -std=c++11
+QMAKE_CXXFLAGS_WARN_ON = ""
+QMAKE_CXXFLAGS += -Wno-all
+QMAKE_CXXFLAGS += -Wno-unused-variable
+QMAKE_CXXFLAGS += -Wno-unused-parameter
+QMAKE_CXXFLAGS += -Wno-switch
+QMAKE_CXXFLAGS += -Wreturn-type
+
+include(vampcore.pri)
+
+INCLUDEPATH += c:/llvm/3.7/include
@@ -0,0 +1,357 @@
+/*  Copyright 2016, Robert Ankeney
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/
+*/
+
+
+
+// Merge coverage of a source file built as several variants. Each
+// report writes its coverage by original source line to a VARIANT_COV_EXT
+// file; once reports are done, those of every variant in the project whose
+// report is still current are unioned into one report per original source.
+
+#include "variantcov.h"
+#include "mergedreport.h"
+
+void VariantCoverage::clear()
+{
+  variants.clear();
+  summaries.clear();
+  reportDir.clear();
+}
+
+// Write coverage as:
+//   VVC <version>
+//   <file>
+//   <variant>
+//   <line count> <decision count>
+//   <line> <hits>...
+//   <line> <type> <outcomes taken, as 1 or 0 for each; - if none>...
+void VariantCoverage::write(ostream &out, const variantCovType &cov)
+{
+  out << VARIANT_COV_MAGIC << " " << VARIANT_COV_VERSION << "\n";
+  out << cov.file << "\n";
+  out << cov.variant << "\n";
+  out << cov.lineHits.size() << " " << cov.decisions.size() << "\n";
+
+  writeLineHits(out, cov.lineHits);
+  writeDecisions(out, cov.decisions);
+}
+
+// Read coverage written by write()
+bool VariantCoverage::read(istream &in, variantCovType &cov)
+{
+  string magic;
+  int version;
+  int lineCnt;
+  int decisionCnt;
+
+  in >> magic >> version;
+  if (!in.good() || (magic != VARIANT_COV_MAGIC) ||
+      (version != VARIANT_COV_VERSION))
+    return false;
+
+  in.get();
+  getline(in, cov.file);
+  getline(in, cov.variant);
+  in >> lineCnt >> decisionCnt;
+  if (!in.good() || (lineCnt < 0) || (decisionCnt < 0))
+    return false;
+
+  readLineHits(in, lineCnt, cov.lineHits);
+  readDecisions(in, decisionCnt, cov.decisions);
+
+  return !in.fail();
+}
+
+bool VariantCoverage::save(string fileName, const variantCovType &cov)
+{
+  ofstream out(fileName.c_str(), ios::out | ios::binary | ios::trunc);
+  if (!out.is_open())
+    return false;
+
+  write(out, cov);
+  out.close();
+  return !out.fail();
+}
+
+bool VariantCoverage::load(string fileName, ostream *errStr)
+{
+  ifstream in(fileName.c_str(), ios::in | ios::binary);
+  if (!in.is_open())
+  {
+    *errStr << "Cannot read variant coverage file " << fileName << ENDL;
+    return false;
+  }
+
+  variantCovType cov;
+  if (!read(in, cov))
+  {
+    *errStr << "Bad variant coverage file " << fileName << ENDL;
+    return false;
+  }
+
+  variants.push_back(cov);
+  return true;
+}
+
+// Load the variant coverage files among the outputs of a report.
+// Merged reports are written beside the first one loaded.
+bool VariantCoverage::addOutputs(const vector<string> &outputs,
+                                 ostream *errStr)
+{
+  bool result = true;
+  vector<string> names = findOutputs(outputs, VARIANT_COV_EXT, reportDir);
+
+  for (int i = 0; i < names.size(); i++)
+  {
+    if (!load(names[i], errStr))
+      result = false;
+  }
+
+  return result;
+}
+
+// covered/total and percentage, e.g. "12/16 (75%)"
+static string coverageText(int covered, int total)
+{
+  ostringstream text;
+
+  text << covered << "/" << total;
+  if (total)
+    text << " (" << (100 * covered / total) << "%)";
+
+  return text.str();
+}
+
+// Write one report for each original source, named after it
+bool VariantCoverage::genReports(ostream *outStr, ostream *errStr)
+{
+  bool result = true;
+  map<string, vector<variantCovType *> > files;
+  set<string> reportNames;
+
+  summaries.clear();
+
+  for (int i = 0; i < variants.size(); i++)
+    files[variants[i].file].push_back(&variants[i]);
+
+  map<string, vector<variantCovType *> >::iterator it;
+  for (it = files.begin(); it != files.end(); ++it)
+  {
+    const string &file = it->first;
+
+    // foo.c -> foo_c_variants, numbered if another source has the same name
+    string name = mergedReportName(file, VARIANT_REPORT_SUFFIX, reportNames);
+
+    variantSummaryType summary;
+    summary.file = file;
+    summary.report = reportDir + DIRECTORY_SEPARATOR + name + ".html";
+
+    *outStr << "Generating " << summary.report << ENDL;
+    if (genReport(it->second, summary, errStr))
+    {
+      for (int v = 0; v < summary.variants.size(); v++)
+        *outStr << file << " [" << summary.variants[v] << "]: " <<
+                   coverageText(summary.totals[v].linesHit,
+                                summary.totals[v].lines) << " lines, " <<
+                   coverageText(summary.totals[v].outcomesTaken,
+                                summary.totals[v].outcomes) <<
+                   " outcomes" << ENDL;
+      *outStr << file << " [combined]: " <<
+                 coverageText(summary.combined.linesHit,
+                              summary.combined.lines) << " lines, " <<
+                 coverageText(summary.combined.outcomesTaken,
+                              summary.combined.outcomes) << " outcomes" <<
+                 ENDL;
+      summaries.push_back(summary);
+    }
+    else
+      result = false;
+  }
+
+  return result;
+}
+
+// Write merged report for one original source. Each variant's totals
+// and the union of all are gathered in a single pass over the variants.
+// Decisions are unioned by mergeDecisions().
+bool VariantCoverage::genReport(vector<variantCovType *> &fileVariants,
+                                variantSummaryType &summary,
+                                ostream *errStr)
+{
+  map<int, pair<int, int> > lineVariants;        // Variants hitting, holding
+                                                 // each line
+  vector<decisionExportType> decisions;          // Union of outcomes taken
+
+  for (int v = 0; v < fileVariants.size(); v++)
+  {
+    variantCovType *cov = fileVariants[v];
+    variantTotalsType t = { 0, 0, 0, 0 };
+
+    map<int, long long>::iterator l;
+    for (l = cov->lineHits.begin(); l != cov->lineHits.end(); ++l)
+    {
+      pair<int, int> &lineCnt = lineVariants[l->first];
+
+      ++t.lines;
+      ++lineCnt.second;
+      if (l->second)
+      {
+        ++t.linesHit;
+        ++lineCnt.first;
+      }
+    }
+
+    for (int d = 0; d < cov->decisions.size(); d++)
+    {
+      vector<bool> &taken = cov->decisions[d].taken;
+      t.outcomes += taken.size();
+      t.outcomesTaken += count(taken.begin(), taken.end(), true);
+    }
+    mergeDecisions(decisions, cov->decisions);
+
+    summary.variants.push_back(cov->variant);
+    summary.totals.push_back(t);
+  }
+
+  // Union of the variants, and its outcomes on each line
+  variantTotalsType &c = summary.combined;
+  map<int, pair<int, int> > lineOutcomes;
+
+  c.lines = lineVariants.size();
+  c.linesHit = 0;
+  c.outcomes = 0;
+  c.outcomesTaken = 0;
+
+  map<int, pair<int, int> >::iterator lv;
+  for (lv = lineVariants.begin(); lv != lineVariants.end(); ++lv)
+  {
+    if (lv->second.first)
+      ++c.linesHit;
+  }
+
+  for (int d = 0; d < decisions.size(); d++)
+  {
+    vector<bool> &taken = decisions[d].taken;
+    int takenCnt = count(taken.begin(), taken.end(), true);
+    pair<int, int> &o = lineOutcomes[decisions[d].line];
+
+    o.first += taken.size();
+    o.second += takenCnt;
+    c.outcomes += taken.size();
+    c.outcomesTaken += takenCnt;
+  }
+
+  // Source text; without it only the lines with code are shown
+  vector<string> text;
+  if (!readSourceLines(summary.file, text))
+    *errStr << "Cannot read " << summary.file <<
+               "; showing lines with code only" << ENDL;
+
+  ofstream htmlFile(summary.report.c_str());
+  if (!htmlFile.is_open())
+  {
+    *errStr << "Cannot create " << summary.report << ENDL;
+    return false;
+  }
+
+  writeMergedHead(htmlFile, summary.file);
+  htmlFile << "    <table border=\"1\" cellpadding=\"4\">" << ENDL;
+  htmlFile << "      <tr><th>Variant</th><th>Lines</th><th>Outcomes</th>" <<
+              "</tr>" << ENDL;
+  for (int v = 0; v < summary.variants.size(); v++)
+  {
+    variantTotalsType &t = summary.totals[v];
+
+    htmlFile << "      <tr><td>" << htmlEscape(summary.variants[v]) <<
+                "</td><td>" << coverageText(t.linesHit, t.lines) <<
+                "</td><td>" << coverageText(t.outcomesTaken, t.outcomes) <<
+                "</td></tr>" << ENDL;
+  }
+  htmlFile << "      <tr><th>Combined</th><th>" <<
+              coverageText(c.linesHit, c.lines) << "</th><th>" <<
+              coverageText(c.outcomesTaken, c.outcomes) << "</th></tr>" <<
+              ENDL;
+  htmlFile << "    </table>" << ENDL;
+
+  // Line, variants hitting it of those holding it, then the source text
+  map<int, mergedLineType> lines;
+  for (lv = lineVariants.begin(); lv != lineVariants.end(); ++lv)
+  {
+    mergedLineType &m = lines[lv->first];
+    char hitsText[24];
+
+    snprintf(hitsText, sizeof(hitsText), "%4d/%-4d", lv->second.first,
+             lv->second.second);
+    m.hits = hitsText;
+    m.hit = (lv->second.first != 0);
+  }
+
+  map<int, pair<int, int> >::iterator o;
+  for (o = lineOutcomes.begin(); o != lineOutcomes.end(); ++o)
+  {
+    mergedLineType &m = lines[o->first];
+
+    m.hasDecision = true;
+    m.outcomes = o->second.first;
+    m.taken = o->second.second;
+  }
+
+  writeMergedSource(htmlFile, text, lines);
+
+  htmlFile.close();
+  if (htmlFile.fail())
+  {
+    *errStr << "Cannot write " << summary.report << ENDL;
+    return false;
+  }
+
+  return true;
+}
+
+// Totals as {"lines": [hit, total], "outcomes": [taken, total]}
+static void writeJsonTotals(ostream &out, const variantTotalsType &t)
+{
+  out << "{\"lines\": [" << t.linesHit << "," << t.lines << "]" <<
+         ", \"outcomes\": [" << t.outcomesTaken << "," << t.outcomes << "]}";
+}
+
+// Write summaries of the reports as a JSON array of
+//   {"file": <source>, "report": <report>,
+//    "variants": [{"name": <variant>, "totals": <totals>}, ...],
+//    "combined": <totals>}
+void VariantCoverage::writeJson(ostream &out)
+{
+  out << "[";
+  for (int i = 0; i < summaries.size(); i++)
+  {
+    variantSummaryType &s = summaries[i];
+
+    out << (i ? ",\n    " : "\n    ") << "{\"file\": " <<
+           jsonQuote(s.file) << ", \"report\": " << jsonQuote(s.report) <<
+           ", \"variants\": [";
+    for (int v = 0; v < s.variants.size(); v++)
+    {
+      out << (v ? ", " : "") << "{\"name\": " << jsonQuote(s.variants[v]) <<
+             ", \"totals\": ";
+      writeJsonTotals(out, s.totals[v]);
+      out << "}";
+    }
+    out << "], \"combined\": ";
+    writeJsonTotals(out, s.combined);
+    out << "}";
+  }
+  out << (summaries.empty() ? "]" : "\n  ]");
+}
@@ -0,0 +1,84 @@
+/*  Copyright 2016, Robert Ankeney
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/
+*/
+
+
+#ifndef VARIANTCOV_H
+#define VARIANTCOV_H
+
+#include "vamp_process.h"
+#include <map>
+
+#define VARIANT_COV_MAGIC "VVC"           // Tag at start of source coverage file
+#define VARIANT_COV_VERSION 1             // Layout version of source coverage file
+#define VARIANT_REPORT_SUFFIX "_variants" // Added to name of merged variant report
+
+// Coverage of an original source file as built in one variant. Lines
+// are those of the original source, mapped back through the .ppmap.
+typedef struct {
+  string file;                           // Original source
+  string variant;                        // Instrumented file of variant
+  map<int, long long> lineHits;          // Hits of each line with code
+  vector<decisionExportType> decisions;  // Outcomes of each decision
+} variantCovType;
+
+// Lines and outcomes covered of those found
+typedef struct {
+  int lines;
+  int linesHit;
+  int outcomes;
+  int outcomesTaken;
+} variantTotalsType;
+
+// Totals of one merged variant report
+typedef struct {
+  string file;                         // Original source
+  string report;                       // Report written for it
+  vector<string> variants;             // Variants merged
+  vector<variantTotalsType> totals;    // Totals of each variant
+  variantTotalsType combined;          // Totals of union of variants
+} variantSummaryType;
+
+// The same source built under different defines is preprocessed,
+// instrumented and run separately for each variant. Mapped back to the
+// original source, each variant's lines and decisions are unioned so
+// one report per source shows each variant's coverage and the combined
+// coverage of them all.
+class VariantCoverage
+{
+public:
+  void clear();
+  bool empty() const { return variants.empty(); }
+
+  static void write(ostream &out, const variantCovType &cov);
+  static bool read(istream &in, variantCovType &cov);
+  static bool save(string fileName, const variantCovType &cov);
+  bool load(string fileName, ostream *errStr);
+  bool addOutputs(const vector<string> &outputs, ostream *errStr);
+
+  bool genReports(ostream *outStr, ostream *errStr);
+  void writeJson(ostream &out);
+
+  string reportDir;              // Where genReports writes; set by addOutputs
+  vector<variantSummaryType> summaries;  // Reports written by genReports
+
+private:
+  bool genReport(vector<variantCovType *> &fileVariants,
+                 variantSummaryType &summary, ostream *errStr);
+
+  vector<variantCovType> variants;
+};
+
+#endif // VARIANTCOV_H